@@ -0,0 +1,390 @@
+/**********************************************************************
+ * blocking_queue.c                                        October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Blocking queue
+ *
+ * A vanessa_queue protected by a mutex, with a condition variable
+ * that consumers wait on for elements to be pushed or for the queue
+ * to be closed. Optionally an eventfd is kept readable while the
+ * queue is not empty, so that a consumer may wait for elements in
+ * an event loop along with other file descriptors.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+
+#include "vanessa_adt.h"
+
+struct vanessa_blocking_queue_t_struct {
+	vanessa_queue_t *q;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int nowaiter;
+	int closed;
+	int fd;
+};
+
+
+/**********************************************************************
+ * vanessa_blocking_queue_create
+ * Create a new, empty blocking queue
+ * pre: e_destroy: pointer to a function to destroy elements of the
+ *                 queue, as for vanessa_queue_create. It is passed a
+ *                 pointer to the element. If NULL, then elements will
+ *                 not be freed on calls to
+ *                 vanessa_blocking_queue_destroy
+ *      flag: VANESSA_BLOCKING_QUEUE_EVENTFD to create an eventfd that
+ *            is readable while the queue is not empty or is closed.
+ *            See vanessa_blocking_queue_fd.
+ * post: memory is allocated for queue and values are initialised
+ *       Any number of threads may push and pop elements concurrently.
+ * return: new, empty queue
+ *         NULL on error, including if VANESSA_BLOCKING_QUEUE_EVENTFD
+ *         is given and eventfds are not supported
+ **********************************************************************/
+
+vanessa_blocking_queue_t *vanessa_blocking_queue_create(
+		void (*e_destroy) (const void *), vanessa_adt_flag_t flag)
+{
+	vanessa_blocking_queue_t *bq;
+	pthread_condattr_t attr;
+
+	bq = (vanessa_blocking_queue_t *)
+		malloc(sizeof(vanessa_blocking_queue_t));
+	if(bq == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+
+	bq->q = vanessa_queue_create(e_destroy);
+	if(bq->q == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_queue_create");
+		free(bq);
+		return(NULL);
+	}
+
+	bq->fd = -1;
+	if(flag & VANESSA_BLOCKING_QUEUE_EVENTFD) {
+#ifdef HAVE_SYS_EVENTFD_H
+		bq->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#else
+		errno = ENOSYS;
+#endif
+		if(bq->fd < 0) {
+			VANESSA_LOGGER_DEBUG_ERRNO("eventfd");
+			vanessa_queue_destroy(bq->q);
+			free(bq);
+			return(NULL);
+		}
+	}
+
+	/* Timeouts are measured against the monotonic clock */
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&bq->cond, &attr);
+	pthread_condattr_destroy(&attr);
+	pthread_mutex_init(&bq->lock, NULL);
+	bq->nowaiter = 0;
+	bq->closed = 0;
+
+	return(bq);
+}
+
+
+/**********************************************************************
+ * vanessa_blocking_queue_destroy
+ * Destroy a blocking queue, destroying each element present in the
+ * queue first
+ * pre: bq: queue to destroy, which no thread is using or waiting on
+ * post: queue and all elements in the queue are destroyed, and its
+ *       eventfd, if any, is closed
+ * return: none
+ **********************************************************************/
+
+void vanessa_blocking_queue_destroy(vanessa_blocking_queue_t *bq)
+{
+	if(bq == NULL) {
+		return;
+	}
+
+	vanessa_queue_destroy(bq->q);
+	if(bq->fd >= 0) {
+		close(bq->fd);
+	}
+	pthread_cond_destroy(&bq->cond);
+	pthread_mutex_destroy(&bq->lock);
+	free(bq);
+}
+
+
+/*
+ * Make the eventfd readable, or not. Called with the lock held
+ * whenever the queue becomes non-empty or empty, or is closed.
+ */
+
+static void __vanessa_blocking_queue_signal_fd(vanessa_blocking_queue_t *bq,
+		int readable)
+{
+	uint64_t n = 1;
+
+	if(bq->fd < 0) {
+		return;
+	}
+
+	if(readable) {
+		if(write(bq->fd, &n, sizeof(n)) < 0) {
+			VANESSA_LOGGER_DEBUG_ERRNO("write");
+		}
+	}
+	else if(read(bq->fd, &n, sizeof(n)) < 0 && errno != EAGAIN) {
+		VANESSA_LOGGER_DEBUG_ERRNO("read");
+	}
+}
+
+
+/**********************************************************************
+ * vanessa_blocking_queue_push
+ * Push an element onto the end of a blocking queue, waking a thread
+ * waiting to pop it
+ * pre: bq: queue
+ *      value: element to push
+ * post: element is added to the queue, unless it is closed
+ * return: bq
+ *         NULL on error, or if the queue is closed, in which case
+ *         errno is set to EPIPE. The queue is unchanged and the
+ *         caller keeps ownership of value.
+ **********************************************************************/
+
+vanessa_blocking_queue_t *vanessa_blocking_queue_push(
+		vanessa_blocking_queue_t *bq, void *value)
+{
+	vanessa_blocking_queue_t *status = bq;
+
+	pthread_mutex_lock(&bq->lock);
+
+	if(bq->closed) {
+		errno = EPIPE;
+		status = NULL;
+	}
+	else if(vanessa_queue_push_n(bq->q, &value, 1) == NULL) {
+		/* Unlike vanessa_queue_push, this left the queue intact */
+		VANESSA_LOGGER_DEBUG("vanessa_queue_push_n");
+		status = NULL;
+	}
+	else if(vanessa_queue_length(bq->q) == 1) {
+		__vanessa_blocking_queue_signal_fd(bq, 1);
+	}
+
+	if(status != NULL && bq->nowaiter > 0) {
+		pthread_cond_signal(&bq->cond);
+	}
+
+	pthread_mutex_unlock(&bq->lock);
+
+	return(status);
+}
+
+
+/**********************************************************************
+ * vanessa_blocking_queue_pop_n
+ * Pop up to n elements off the front of a blocking queue, waiting
+ * for at least one to be pushed if the queue is empty
+ * pre: bq: queue
+ *      value: array to place elements in
+ *      n: maximum number of elements to pop, at least 1
+ *      timeout: time to wait in milliseconds. 0 to return at once,
+ *               negative to wait indefinitely.
+ * post: as many elements as are present, up to n, are removed from
+ *       the queue, oldest first
+ * return: number of elements popped
+ *         0 if the timeout expired with the queue empty
+ *         -1 if the queue is closed and empty, so no more elements
+ *         will ever be popped
+ **********************************************************************/
+
+ssize_t vanessa_blocking_queue_pop_n(vanessa_blocking_queue_t *bq,
+		void **value, size_t n, int timeout)
+{
+	struct timespec deadline;
+	ssize_t i;
+
+	if(timeout > 0) {
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += timeout / 1000;
+		deadline.tv_nsec += (timeout % 1000) * 1000000L;
+		if(deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+	}
+
+	pthread_mutex_lock(&bq->lock);
+
+	while(vanessa_queue_length(bq->q) == 0 && !bq->closed &&
+			timeout != 0) {
+		bq->nowaiter++;
+		if(timeout < 0) {
+			pthread_cond_wait(&bq->cond, &bq->lock);
+		}
+		else if(pthread_cond_timedwait(&bq->cond, &bq->lock,
+					&deadline) == ETIMEDOUT) {
+			timeout = 0;
+		}
+		bq->nowaiter--;
+	}
+
+	for(i = 0; (size_t)i < n; i++) {
+		if(vanessa_queue_pop(bq->q, value + i) == NULL) {
+			break;
+		}
+	}
+
+	if(i == 0 && bq->closed) {
+		i = -1;
+	}
+	else if(i > 0 && vanessa_queue_length(bq->q) == 0 && !bq->closed) {
+		__vanessa_blocking_queue_signal_fd(bq, 0);
+	}
+	else if(i > 0 && bq->nowaiter > 0) {
+		/* Elements are left, pass the wakeup on */
+		pthread_cond_signal(&bq->cond);
+	}
+
+	pthread_mutex_unlock(&bq->lock);
+
+	return(i);
+}
+
+
+/**********************************************************************
+ * vanessa_blocking_queue_pop
+ * Pop an element off the front of a blocking queue, waiting for one
+ * to be pushed if the queue is empty
+ * pre: bq: queue
+ *      value: element removed from the queue is assigned to *value
+ *      timeout: as for vanessa_blocking_queue_pop_n
+ * post: oldest element is removed from the queue
+ * return: bq
+ *         NULL if the timeout expired, in which case errno is set to
+ *         ETIMEDOUT, or if the queue is closed and empty, in which
+ *         case errno is set to EPIPE
+ **********************************************************************/
+
+vanessa_blocking_queue_t *vanessa_blocking_queue_pop(
+		vanessa_blocking_queue_t *bq, void **value, int timeout)
+{
+	switch(vanessa_blocking_queue_pop_n(bq, value, 1, timeout)) {
+	case 1:
+		return(bq);
+	case 0:
+		errno = ETIMEDOUT;
+		return(NULL);
+	default:
+		errno = EPIPE;
+		return(NULL);
+	}
+}
+
+
+/**********************************************************************
+ * vanessa_blocking_queue_close
+ * Close a blocking queue, so that no more elements may be pushed
+ * onto it
+ * pre: bq: queue
+ * post: further pushes fail. Elements already in the queue may still
+ *       be popped, after which pops return at once, indicating that
+ *       the queue is closed. Threads waiting to pop are woken and the
+ *       eventfd, if any, is made readable so that event loops notice.
+ * return: none
+ **********************************************************************/
+
+void vanessa_blocking_queue_close(vanessa_blocking_queue_t *bq)
+{
+	pthread_mutex_lock(&bq->lock);
+
+	if(!bq->closed) {
+		bq->closed = 1;
+		if(vanessa_queue_length(bq->q) == 0) {
+			__vanessa_blocking_queue_signal_fd(bq, 1);
+		}
+		pthread_cond_broadcast(&bq->cond);
+	}
+
+	pthread_mutex_unlock(&bq->lock);
+}
+
+
+/**********************************************************************
+ * vanessa_blocking_queue_fd
+ * Return the eventfd of a blocking queue
+ * pre: bq: queue created with VANESSA_BLOCKING_QUEUE_EVENTFD
+ * post: none
+ * return: file descriptor which polls readable while the queue is not
+ *         empty or is closed. It should not be read from or written
+ *         to, only polled, and is closed by
+ *         vanessa_blocking_queue_destroy. As another thread may pop
+ *         elements first, a pop after it polls readable should use a
+ *         timeout of 0.
+ *         -1 if bq was created without VANESSA_BLOCKING_QUEUE_EVENTFD
+ **********************************************************************/
+
+int vanessa_blocking_queue_fd(const vanessa_blocking_queue_t *bq)
+{
+	return(bq->fd);
+}
+
+
+/**********************************************************************
+ * vanessa_blocking_queue_length
+ * Return the number of elements in a blocking queue
+ * pre: bq: queue
+ * post: none
+ * return: number of elements in the queue, which may be out of date
+ *         by the time it is returned if the queue is in use
+ *         -1 if bq is NULL
+ **********************************************************************/
+
+ssize_t vanessa_blocking_queue_length(vanessa_blocking_queue_t *bq)
+{
+	ssize_t len;
+
+	if(bq == NULL) {
+		return(-1);
+	}
+
+	pthread_mutex_lock(&bq->lock);
+	len = vanessa_queue_length(bq->q);
+	pthread_mutex_unlock(&bq->lock);
+
+	return(len);
+}
@@ -0,0 +1,665 @@
+/**********************************************************************
+ * cache.c                                                 October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Fixed capacity cache of elements.
+ *
+ * The default replacement policy is ARC, Adaptive Replacement Cache,
+ * as described by Megiddo and Modha. Resident elements are kept on
+ * two lists, T1 for elements seen once recently and T2 for elements
+ * seen at least twice. Ghost lists, B1 and B2, remember the hashes of
+ * elements recently evicted from T1 and T2 and are used to adapt the
+ * target size of T1. A single scan of many elements only passes
+ * through T1 and so does not flush frequently used elements from T2.
+ *
+ * Plain LRU is also available so that the two may be compared.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include "vanessa_adt.h"
+
+#define CACHE_T1   0
+#define CACHE_T2   1
+#define CACHE_B1   2
+#define CACHE_B2   3
+#define CACHE_FREE 4
+
+typedef struct vanessa_cache_elem_struct vanessa_cache_elem_t;
+
+struct vanessa_cache_elem_struct {
+	vanessa_cache_elem_t *chain;
+	vanessa_cache_elem_t *next;
+	vanessa_cache_elem_t *prev;
+	size_t hash;
+	int list;
+	void *value;
+};
+
+typedef struct {
+	vanessa_cache_elem_t *first;
+	vanessa_cache_elem_t *last;
+	size_t count;
+} vanessa_cache_list_t;
+
+struct vanessa_cache_t_struct {
+	vanessa_cache_elem_t *elem;
+	vanessa_cache_elem_t *free;
+	vanessa_cache_elem_t **bucket;
+	size_t mask;
+	size_t capacity;
+	size_t target;
+	vanessa_adt_flag_t policy;
+	vanessa_cache_list_t list[4];
+	unsigned long long hits;
+	unsigned long long misses;
+	void (*e_destroy) (void *e);
+	void *(*e_duplicate) (void *e);
+	int (*e_match) (void *e, void *key);
+	size_t (*e_hash) (void *e);
+};
+
+
+/**********************************************************************
+ * vanessa_cache_create
+ * Create a new, empty cache
+ * pre: capacity: maximum number of elements held in the cache
+ *      policy: VANESSA_CACHE_ARC or VANESSA_CACHE_LRU
+ *      element_destroy:   Pointer to a function to destroy an element
+ *                         May be NULL
+ *      element_duplicate: Pointer to a function to duplicate an element
+ *                         May be NULL in which case elements are
+ *                         inserted by reference
+ *      element_match:     Pointer to a function to match an element
+ *                         by a key.
+ *      element_hash:      Pointer to a function that returns a hash
+ *                         of an element. Unlike vanessa_hash this is
+ *                         not a bucket index and should use the
+ *                         full range of size_t.
+ * post: cache is allocated, including space for all the elements
+ *       and ghost entries it may hold.
+ * return: pointer to cache
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_cache_t *vanessa_cache_create(size_t capacity,
+		vanessa_adt_flag_t policy,
+		void (*element_destroy) (void *e),
+		void *(*element_duplicate) (void *e),
+		int (*element_match) (void *e, void *key),
+		size_t (*element_hash) (void *e))
+{
+	vanessa_cache_t *c;
+	size_t noelem;
+	size_t nobucket;
+	size_t i;
+
+	if(capacity == 0 || element_hash == NULL) {
+		VANESSA_LOGGER_DEBUG("invalid argument");
+		return(NULL);
+	}
+
+	c = (vanessa_cache_t *)malloc(sizeof(vanessa_cache_t));
+	if(c == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+	memset(c, 0, sizeof(vanessa_cache_t));
+
+	/* ARC tracks up to capacity ghosts as well as capacity elements */
+	noelem = (policy == VANESSA_CACHE_LRU) ? capacity : capacity * 2;
+	for(nobucket = 1; nobucket < noelem; nobucket <<= 1)
+		;
+
+	c->elem = (vanessa_cache_elem_t *)malloc(noelem *
+			sizeof(vanessa_cache_elem_t));
+	c->bucket = (vanessa_cache_elem_t **)calloc(nobucket,
+			sizeof(vanessa_cache_elem_t *));
+	if(c->elem == NULL || c->bucket == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		free(c->elem);
+		free(c->bucket);
+		free(c);
+		return(NULL);
+	}
+
+	for(i = 0; i < noelem; i++) {
+		c->elem[i].list = CACHE_FREE;
+		c->elem[i].next = (i + 1 < noelem) ? c->elem + i + 1 : NULL;
+	}
+	c->free = c->elem;
+
+	c->mask = nobucket - 1;
+	c->capacity = capacity;
+	c->policy = policy;
+	c->e_destroy = element_destroy;
+	c->e_duplicate = element_duplicate;
+	c->e_match = element_match;
+	c->e_hash = element_hash;
+
+	return(c);
+}
+
+
+/**********************************************************************
+ * vanessa_cache_destroy
+ * Destroy a cache and all the elements it holds
+ * pre: c: cache
+ * post: all elements of c are destroyed
+ **********************************************************************/
+
+void vanessa_cache_destroy(vanessa_cache_t *c)
+{
+	vanessa_cache_elem_t *e;
+
+	if(c == NULL) {
+		return;
+	}
+
+	if(c->e_destroy != NULL) {
+		for(e = c->list[CACHE_T1].first; e != NULL; e = e->next) {
+			c->e_destroy(e->value);
+		}
+		for(e = c->list[CACHE_T2].first; e != NULL; e = e->next) {
+			c->e_destroy(e->value);
+		}
+	}
+
+	free(c->bucket);
+	free(c->elem);
+	free(c);
+}
+
+
+/**********************************************************************
+ * __vanessa_cache_unlink
+ * Remove an element from the list it is on
+ * pre: c: cache
+ *      e: element
+ * post: e is not on any list
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_cache_unlink(vanessa_cache_t *c,
+		vanessa_cache_elem_t *e)
+{
+	vanessa_cache_list_t *l;
+
+	l = c->list + e->list;
+	if(e->prev != NULL) {
+		e->prev->next = e->next;
+	}
+	else {
+		l->first = e->next;
+	}
+	if(e->next != NULL) {
+		e->next->prev = e->prev;
+	}
+	else {
+		l->last = e->prev;
+	}
+	l->count--;
+}
+
+
+/**********************************************************************
+ * __vanessa_cache_link
+ * Add an element to the most recently used end of a list
+ * pre: c: cache
+ *      e: element, not on any list
+ *      list: list to add e to
+ * post: e is first on list
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_cache_link(vanessa_cache_t *c,
+		vanessa_cache_elem_t *e, int list)
+{
+	vanessa_cache_list_t *l;
+
+	l = c->list + list;
+	e->list = list;
+	e->prev = NULL;
+	e->next = l->first;
+	if(l->first != NULL) {
+		l->first->prev = e;
+	}
+	else {
+		l->last = e;
+	}
+	l->first = e;
+	l->count++;
+}
+
+
+/**********************************************************************
+ * __vanessa_cache_release
+ * Remove an element from the cache entirely
+ * pre: c: cache
+ *      e: element, a ghost or resident
+ * post: e is unlinked from its list and hash chain, its value is
+ *       destroyed if it is resident and it is put on the free list
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_cache_release(vanessa_cache_t *c,
+		vanessa_cache_elem_t *e)
+{
+	vanessa_cache_elem_t **p;
+
+	__vanessa_cache_unlink(c, e);
+
+	for(p = c->bucket + (e->hash & c->mask); *p != e; p = &(*p)->chain)
+		;
+	*p = e->chain;
+
+	if((e->list == CACHE_T1 || e->list == CACHE_T2) &&
+			c->e_destroy != NULL) {
+		c->e_destroy(e->value);
+	}
+
+	e->value = NULL;
+	e->list = CACHE_FREE;
+	e->next = c->free;
+	c->free = e;
+}
+
+
+/**********************************************************************
+ * __vanessa_cache_demote
+ * Move the least recently used element of a resident list to the
+ * most recently used end of a ghost list, destroying its value
+ * pre: c: cache
+ *      from: CACHE_T1 or CACHE_T2, must not be empty
+ *      to: CACHE_B1 or CACHE_B2
+ * post: element is now a ghost
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_cache_demote(vanessa_cache_t *c, int from, int to)
+{
+	vanessa_cache_elem_t *e;
+
+	e = c->list[from].last;
+	__vanessa_cache_unlink(c, e);
+	if(c->e_destroy != NULL) {
+		c->e_destroy(e->value);
+	}
+	e->value = NULL;
+	__vanessa_cache_link(c, e, to);
+}
+
+
+/**********************************************************************
+ * __vanessa_cache_replace
+ * ARC's REPLACE: evict a resident element to make room
+ * pre: c: cache
+ *      in_b2: non-zero if the element being inserted was found in B2
+ * post: the least recently used element of T1 or T2 becomes a ghost
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_cache_replace(vanessa_cache_t *c, int in_b2)
+{
+	size_t t1;
+
+	t1 = c->list[CACHE_T1].count;
+	if(t1 > 0 && (t1 > c->target || (in_b2 && t1 == c->target))) {
+		__vanessa_cache_demote(c, CACHE_T1, CACHE_B1);
+	}
+	else if(c->list[CACHE_T2].count > 0) {
+		__vanessa_cache_demote(c, CACHE_T2, CACHE_B2);
+	}
+	else {
+		__vanessa_cache_demote(c, CACHE_T1, CACHE_B1);
+	}
+}
+
+
+/**********************************************************************
+ * __vanessa_cache_find
+ * Find an element or ghost by hash and key
+ * pre: c: cache
+ *      hash: hash of key
+ *      key: key to match resident elements against
+ *      ghost: set to a ghost whose hash matches, if no resident
+ *             element matches. Otherwise set to NULL.
+ * return: matching resident element
+ *         NULL if there is none
+ **********************************************************************/
+
+static vanessa_cache_elem_t *__vanessa_cache_find(vanessa_cache_t *c,
+		size_t hash, void *key, vanessa_cache_elem_t **ghost)
+{
+	vanessa_cache_elem_t *e;
+
+	*ghost = NULL;
+	for(e = c->bucket[hash & c->mask]; e != NULL; e = e->chain) {
+		if(e->hash != hash) {
+			continue;
+		}
+		if(e->list == CACHE_B1 || e->list == CACHE_B2) {
+			*ghost = e;
+			continue;
+		}
+		if(c->e_match != NULL ? c->e_match(e->value, key) == 0 :
+				e->value == key) {
+			return(e);
+		}
+	}
+
+	return(NULL);
+}
+
+
+/**********************************************************************
+ * vanessa_cache_get_element
+ * Retrieve an element from the cache
+ * pre: c: cache to search
+ *      key: key to match
+ * post: hit or miss is counted. On a hit the element is promoted
+ *       according to the replacement policy.
+ * return: element if found
+ *         NULL if c or key is NULL or if the element is not cached
+ **********************************************************************/
+
+void *vanessa_cache_get_element(vanessa_cache_t *c, void *key)
+{
+	vanessa_cache_elem_t *e;
+	vanessa_cache_elem_t *ghost;
+
+	if(c == NULL || key == NULL) {
+		return(NULL);
+	}
+
+	e = __vanessa_cache_find(c, c->e_hash(key), key, &ghost);
+	if(e == NULL) {
+		c->misses++;
+		return(NULL);
+	}
+
+	c->hits++;
+	__vanessa_cache_unlink(c, e);
+	__vanessa_cache_link(c, e, (c->policy == VANESSA_CACHE_LRU) ?
+			CACHE_T1 : CACHE_T2);
+
+	return(e->value);
+}
+
+
+/**********************************************************************
+ * vanessa_cache_add_element
+ * Insert an element into the cache
+ * Typically called after vanessa_cache_get_element() misses
+ * pre: c: cache to insert value into
+ *      value: value to insert
+ * post: value is inserted into the cache, evicting and destroying
+ *       another element if the cache is full.
+ *       If an element matching value is already cached it is
+ *       destroyed and replaced by value.
+ * return: NULL if c is NULL or on error
+ *         c, unchanged if value is NULL
+ **********************************************************************/
+
+vanessa_cache_t *vanessa_cache_add_element(vanessa_cache_t *c, void *value)
+{
+	vanessa_cache_elem_t *e;
+	vanessa_cache_elem_t *ghost;
+	size_t hash;
+	size_t b1;
+	size_t b2;
+	size_t delta;
+	int list = CACHE_T1;
+
+	if(c == NULL) {
+		return(NULL);
+	}
+	if(value == NULL) {
+		return(c);
+	}
+
+	if(c->e_duplicate != NULL) {
+		value = c->e_duplicate(value);
+		if(value == NULL) {
+			VANESSA_LOGGER_DEBUG("e_duplicate");
+			return(NULL);
+		}
+	}
+
+	hash = c->e_hash(value);
+	e = __vanessa_cache_find(c, hash, value, &ghost);
+
+	if(e != NULL) {
+		/* Already resident: replace the value and treat as a hit */
+		if(c->e_destroy != NULL) {
+			c->e_destroy(e->value);
+		}
+		e->value = value;
+		__vanessa_cache_unlink(c, e);
+		__vanessa_cache_link(c, e, (c->policy == VANESSA_CACHE_LRU) ?
+				CACHE_T1 : CACHE_T2);
+		return(c);
+	}
+
+	if(c->policy == VANESSA_CACHE_LRU) {
+		if(c->list[CACHE_T1].count == c->capacity) {
+			__vanessa_cache_release(c, c->list[CACHE_T1].last);
+		}
+	}
+	else if(ghost != NULL) {
+		/* ARC cases II and III: adapt the target size of T1 */
+		b1 = c->list[CACHE_B1].count;
+		b2 = c->list[CACHE_B2].count;
+		if(ghost->list == CACHE_B1) {
+			delta = (b2 > b1) ? b2 / b1 : 1;
+			c->target = (c->target + delta > c->capacity) ?
+				c->capacity : c->target + delta;
+		}
+		else {
+			delta = (b1 > b2) ? b1 / b2 : 1;
+			c->target = (c->target > delta) ?
+				c->target - delta : 0;
+		}
+		if(c->list[CACHE_T1].count + c->list[CACHE_T2].count ==
+				c->capacity) {
+			__vanessa_cache_replace(c, ghost->list == CACHE_B2);
+		}
+		__vanessa_cache_release(c, ghost);
+		list = CACHE_T2;
+	}
+	else {
+		/* ARC case IV */
+		b1 = c->list[CACHE_T1].count + c->list[CACHE_B1].count;
+		b2 = c->list[CACHE_T2].count + c->list[CACHE_B2].count;
+		if(b1 == c->capacity) {
+			if(c->list[CACHE_T1].count < c->capacity) {
+				__vanessa_cache_release(c,
+						c->list[CACHE_B1].last);
+				if(c->list[CACHE_T1].count +
+						c->list[CACHE_T2].count ==
+						c->capacity) {
+					__vanessa_cache_replace(c, 0);
+				}
+			}
+			else {
+				__vanessa_cache_release(c,
+						c->list[CACHE_T1].last);
+			}
+		}
+		else if(b1 + b2 >= c->capacity) {
+			if(b1 + b2 == 2 * c->capacity) {
+				__vanessa_cache_release(c,
+						c->list[CACHE_B2].last);
+			}
+			if(c->list[CACHE_T1].count +
+					c->list[CACHE_T2].count ==
+					c->capacity) {
+				__vanessa_cache_replace(c, 0);
+			}
+		}
+	}
+
+	e = c->free;
+	c->free = e->next;
+	e->hash = hash;
+	e->value = value;
+	e->chain = c->bucket[hash & c->mask];
+	c->bucket[hash & c->mask] = e;
+	__vanessa_cache_link(c, e, list);
+
+	return(c);
+}
+
+
+/**********************************************************************
+ * vanessa_cache_remove_element
+ * Remove an element from the cache
+ * pre: c: cache to remove element from
+ *      key: key of element to remove
+ * post: matching element is removed from the cache and destroyed
+ * return: NULL if c is NULL
+ *         c otherwise
+ **********************************************************************/
+
+vanessa_cache_t *vanessa_cache_remove_element(vanessa_cache_t *c, void *key)
+{
+	vanessa_cache_elem_t *e;
+	vanessa_cache_elem_t *ghost;
+
+	if(c == NULL) {
+		return(NULL);
+	}
+	if(key == NULL) {
+		return(c);
+	}
+
+	e = __vanessa_cache_find(c, c->e_hash(key), key, &ghost);
+	if(e != NULL) {
+		__vanessa_cache_release(c, e);
+	}
+
+	return(c);
+}
+
+
+/**********************************************************************
+ * vanessa_cache_get_count
+ * Get the number of elements held in the cache
+ * pre: c: cache
+ * return: number of elements in the cache, not including ghosts
+ *         0 if c is NULL
+ **********************************************************************/
+
+size_t vanessa_cache_get_count(vanessa_cache_t *c)
+{
+	if(c == NULL) {
+		return(0);
+	}
+
+	return(c->list[CACHE_T1].count + c->list[CACHE_T2].count);
+}
+
+
+/**********************************************************************
+ * vanessa_cache_get_hits
+ * Get the number of lookups that found an element
+ * pre: c: cache
+ * return: number of hits since the cache was created or the
+ *         counters were reset
+ *         0 if c is NULL
+ **********************************************************************/
+
+unsigned long long vanessa_cache_get_hits(vanessa_cache_t *c)
+{
+	return(c == NULL ? 0 : c->hits);
+}
+
+
+/**********************************************************************
+ * vanessa_cache_get_misses
+ * Get the number of lookups that did not find an element
+ * pre: c: cache
+ * return: number of misses since the cache was created or the
+ *         counters were reset
+ *         0 if c is NULL
+ **********************************************************************/
+
+unsigned long long vanessa_cache_get_misses(vanessa_cache_t *c)
+{
+	return(c == NULL ? 0 : c->misses);
+}
+
+
+/**********************************************************************
+ * vanessa_cache_reset_stats
+ * Reset the hit and miss counters of a cache
+ * pre: c: cache
+ * post: hit and miss counters are zero
+ * return: none
+ **********************************************************************/
+
+void vanessa_cache_reset_stats(vanessa_cache_t *c)
+{
+	if(c == NULL) {
+		return;
+	}
+
+	c->hits = 0;
+	c->misses = 0;
+}
+
+
+/**********************************************************************
+ * vanessa_cache_iterate
+ * Run a function over each element in the cache
+ * pre: c: cache run the function over
+ *      action: function to run
+ *              action should return < 0 if an error occurs,
+ *              which indicates that processing will be stopped
+ *      data: data passed to action
+ * post: action is run with the value of each element as its first
+ *       argument. Elements are not promoted.
+ * return: 0 on success
+ *         < 0 if action returns < 0
+ **********************************************************************/
+
+int vanessa_cache_iterate(vanessa_cache_t *c,
+		int (*action)(void *e, void *data), void *data)
+{
+	vanessa_cache_elem_t *e;
+	int status;
+	int list;
+
+	if(c == NULL) {
+		return(0);
+	}
+
+	for(list = CACHE_T1; list <= CACHE_T2; list++) {
+		for(e = c->list[list].first; e != NULL; e = e->next) {
+			status = action(e->value, data);
+			if(status < 0) {
+				return(status);
+			}
+		}
+	}
+
+	return(0);
+}
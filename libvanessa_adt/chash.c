@@ -0,0 +1,749 @@
+/**********************************************************************
+ * chash.c                                                 October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Consistent hash ring
+ *
+ * Each member is placed at a number of pseudo-random points on a
+ * 32bit ring, proportional to its weight. A key belongs to the
+ * member owning the first point at or after the key's hash, wrapping
+ * around. Adding or removing a member only moves the keys adjacent
+ * to its points, about 1/N of them.
+ *
+ * The points are kept sorted in a contiguous array, separately from
+ * the array of their owners so that a search only touches the
+ * points. A jump table, indexed by the top bits of the hash, gives
+ * the range of points that a lookup needs to search, which is only a
+ * handful, so a lookup is a table index and a short binary search.
+ *
+ * Also stateless jump consistent hashing and rendezvous hashing,
+ * which need no allocation, for sharding within a process.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <math.h>
+
+#include "vanessa_adt.h"
+
+/* Aim for this many points per jump table entry */
+#define CHASH_POINTS_PER_JUMP 4
+
+typedef struct {
+	void *value;
+	unsigned int weight;
+	unsigned long long seed;
+} vanessa_chash_member_t;
+
+struct vanessa_chash_t_struct {
+	vanessa_chash_member_t **member;
+	size_t nomember;
+	size_t member_size;
+	unsigned int *point;
+	vanessa_chash_member_t **owner;
+	size_t nopoint;
+	unsigned int *jump;
+	size_t jump_size;
+	int shift;
+	unsigned int nopoint_per_weight;
+	void (*e_destroy) (void *e);
+	void *(*e_duplicate) (void *e);
+	int (*e_match) (void *e, void *key);
+	size_t (*e_hash) (void *e);
+};
+
+
+/**********************************************************************
+ * __vanessa_chash_mix
+ * Mix a 64 bit value, the finaliser of splitmix64
+ * pre: x: value to mix
+ * return: mixed value
+ **********************************************************************/
+
+static unsigned long long __vanessa_chash_mix(unsigned long long x)
+{
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return(x);
+}
+
+
+/**********************************************************************
+ * __vanessa_chash_point
+ * Find the position of a hash on the ring
+ * pre: hash: hash of a key
+ * return: position on the ring
+ **********************************************************************/
+
+static unsigned int __vanessa_chash_point(size_t hash)
+{
+	return((unsigned int)(__vanessa_chash_mix(hash) >> 32));
+}
+
+
+/**********************************************************************
+ * vanessa_chash_create
+ * Create a new, empty consistent hash ring
+ * pre: nopoint: number of points on the ring per unit of weight
+ *               of a member. 100 to 200 gives a reasonably even
+ *               distribution of keys.
+ *      element_destroy:   Pointer to a function to destroy a member
+ *                         May be NULL
+ *      element_duplicate: Pointer to a function to duplicate a member
+ *                         May be NULL in which case members are
+ *                         inserted by reference
+ *      element_match:     Pointer to a function to match a member
+ *                         by a key
+ *      element_hash:      Pointer to a function that returns a hash
+ *                         of a member. The hash determines where the
+ *                         member is placed on the ring so it should
+ *                         be the same each time the member is added.
+ * post: ring is allocated and initialised
+ * return: pointer to ring
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_chash_t *vanessa_chash_create(unsigned int nopoint,
+		void (*element_destroy) (void *e),
+		void *(*element_duplicate) (void *e),
+		int (*element_match) (void *e, void *key),
+		size_t (*element_hash) (void *e))
+{
+	vanessa_chash_t *c;
+
+	if(nopoint == 0 || element_hash == NULL) {
+		VANESSA_LOGGER_DEBUG("invalid argument");
+		return(NULL);
+	}
+
+	c = (vanessa_chash_t *)malloc(sizeof(vanessa_chash_t));
+	if(c == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+
+	c->member = NULL;
+	c->nomember = 0;
+	c->member_size = 0;
+	c->point = NULL;
+	c->owner = NULL;
+	c->nopoint = 0;
+	c->jump = NULL;
+	c->jump_size = 0;
+	c->shift = 0;
+	c->nopoint_per_weight = nopoint;
+	c->e_destroy = element_destroy;
+	c->e_duplicate = element_duplicate;
+	c->e_match = element_match;
+	c->e_hash = element_hash;
+
+	return(c);
+}
+
+
+/**********************************************************************
+ * vanessa_chash_destroy
+ * Destroy a consistent hash ring and all of its members
+ * pre: c: ring to destroy
+ * post: c and its members are destroyed
+ * return: none
+ **********************************************************************/
+
+void vanessa_chash_destroy(vanessa_chash_t *c)
+{
+	size_t i;
+
+	if(c == NULL) {
+		return;
+	}
+
+	for(i = 0; i < c->nomember; i++) {
+		if(c->e_destroy != NULL) {
+			c->e_destroy(c->member[i]->value);
+		}
+		free(c->member[i]);
+	}
+
+	free(c->member);
+	free(c->point);
+	free(c->owner);
+	free(c->jump);
+	free(c);
+}
+
+
+/**********************************************************************
+ * __vanessa_chash_build_jump
+ * Rebuild the jump table of a ring after its points have changed
+ * pre: c: ring
+ * post: jump table of c is sized for the number of points
+ *       and entry t is the index of the first point whose top bits
+ *       are at least t. The table is only reallocated if it
+ *       needs to grow.
+ * return: 0 on success
+ *         -1 on error, c is unchanged
+ **********************************************************************/
+
+static int __vanessa_chash_build_jump(vanessa_chash_t *c)
+{
+	unsigned int *jump;
+	size_t nojump;
+	size_t t;
+	size_t i;
+	int bits;
+
+	for(bits = 1; bits < 24 && ((size_t)1 << bits) *
+			CHASH_POINTS_PER_JUMP < c->nopoint; bits++)
+		;
+	nojump = (size_t)1 << bits;
+
+	if(nojump + 1 > c->jump_size) {
+		jump = (unsigned int *)malloc((nojump + 1) *
+				sizeof(unsigned int));
+		if(jump == NULL) {
+			VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+			return(-1);
+		}
+		free(c->jump);
+		c->jump = jump;
+		c->jump_size = nojump + 1;
+	}
+
+	c->shift = 32 - bits;
+	for(t = 0, i = 0; t < nojump; t++) {
+		while(i < c->nopoint && (c->point[i] >> c->shift) < t) {
+			i++;
+		}
+		c->jump[t] = i;
+	}
+	c->jump[nojump] = c->nopoint;
+
+	return(0);
+}
+
+
+/**********************************************************************
+ * __vanessa_chash_remove_member
+ * Remove a member from a consistent hash ring
+ * pre: c: ring
+ *      i: index of member to remove
+ * post: member and its points are removed from c and it is destroyed
+ *       This can't fail as the jump table only ever shrinks
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_chash_remove_member(vanessa_chash_t *c, size_t i)
+{
+	vanessa_chash_member_t *m;
+	size_t j;
+
+	m = c->member[i];
+	c->member[i] = c->member[--c->nomember];
+
+	for(i = 0, j = 0; i < c->nopoint; i++) {
+		if(c->owner[i] == m) {
+			continue;
+		}
+		c->point[j] = c->point[i];
+		c->owner[j] = c->owner[i];
+		j++;
+	}
+	c->nopoint = j;
+	__vanessa_chash_build_jump(c);
+
+	if(c->e_destroy != NULL) {
+		c->e_destroy(m->value);
+	}
+	free(m);
+}
+
+
+/**********************************************************************
+ * __vanessa_chash_cmp_point
+ * Compare two points, for qsort(3)
+ **********************************************************************/
+
+static int __vanessa_chash_cmp_point(const void *a, const void *b)
+{
+	unsigned int x = *(const unsigned int *)a;
+	unsigned int y = *(const unsigned int *)b;
+
+	return(x < y ? -1 : x > y);
+}
+
+
+/**********************************************************************
+ * vanessa_chash_add_element
+ * Add a member to a consistent hash ring
+ * pre: c: ring to add member to
+ *      value: member to add
+ *      weight: relative weight of the member, must be at least 1.
+ *              The member is placed at weight times the number of
+ *              points per unit of weight given to
+ *              vanessa_chash_create.
+ * post: value is added to the ring. If a member matching value
+ *       is already present it is destroyed and replaced, allowing
+ *       the weight of a member to be changed.
+ *       O(n) where n is the number of points on the ring.
+ * return: c on success
+ *         NULL on error, c is unchanged other than that a member
+ *         matching value may have been removed
+ **********************************************************************/
+
+vanessa_chash_t *vanessa_chash_add_element(vanessa_chash_t *c, void *value,
+		unsigned int weight)
+{
+	vanessa_chash_member_t *m;
+	vanessa_chash_member_t **member;
+	vanessa_chash_member_t **owner = NULL;
+	unsigned int *new_point = NULL;
+	unsigned int *point = NULL;
+	size_t nonew;
+	size_t size;
+	size_t i;
+	size_t j;
+	size_t k;
+
+	if(c == NULL || value == NULL || weight == 0) {
+		return(NULL);
+	}
+
+	if(c->e_match != NULL) {
+		vanessa_chash_remove_element(c, value);
+	}
+
+	if(c->nomember == c->member_size) {
+		size = c->member_size ? c->member_size * 2 : 8;
+		member = (vanessa_chash_member_t **)realloc(c->member,
+				size * sizeof(vanessa_chash_member_t *));
+		if(member == NULL) {
+			VANESSA_LOGGER_DEBUG_ERRNO("realloc");
+			return(NULL);
+		}
+		c->member = member;
+		c->member_size = size;
+	}
+
+	m = (vanessa_chash_member_t *)malloc(sizeof(vanessa_chash_member_t));
+	if(m == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+	m->weight = weight;
+	/* Mixed so that nearby hashes do not share points */
+	m->seed = __vanessa_chash_mix(c->e_hash(value));
+
+	/* Work out the new member's points and merge them in */
+	nonew = (size_t)weight * c->nopoint_per_weight;
+	new_point = (unsigned int *)malloc(nonew * sizeof(unsigned int));
+	point = (unsigned int *)malloc((c->nopoint + nonew) *
+			sizeof(unsigned int));
+	owner = (vanessa_chash_member_t **)malloc((c->nopoint + nonew) *
+			sizeof(vanessa_chash_member_t *));
+	if(new_point == NULL || point == NULL || owner == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		goto err;
+	}
+
+	for(i = 0; i < nonew; i++) {
+		new_point[i] = (unsigned int)(__vanessa_chash_mix(m->seed +
+				(i + 1) * 0x9e3779b97f4a7c15ULL) >> 32);
+	}
+	qsort(new_point, nonew, sizeof(unsigned int),
+			__vanessa_chash_cmp_point);
+
+	for(i = 0, j = 0, k = 0; i < c->nopoint || j < nonew; k++) {
+		if(j == nonew || (i < c->nopoint &&
+					c->point[i] <= new_point[j])) {
+			point[k] = c->point[i];
+			owner[k] = c->owner[i];
+			i++;
+		}
+		else {
+			point[k] = new_point[j];
+			owner[k] = m;
+			j++;
+		}
+	}
+
+	if(c->e_duplicate != NULL) {
+		m->value = c->e_duplicate(value);
+		if(m->value == NULL) {
+			VANESSA_LOGGER_DEBUG("e_duplicate");
+			goto err;
+		}
+	}
+	else {
+		m->value = value;
+	}
+
+	free(c->point);
+	free(c->owner);
+	c->point = point;
+	c->owner = owner;
+	c->nopoint += nonew;
+	c->member[c->nomember++] = m;
+	free(new_point);
+
+	if(__vanessa_chash_build_jump(c) < 0) {
+		__vanessa_chash_remove_member(c, c->nomember - 1);
+		return(NULL);
+	}
+
+	return(c);
+
+err:
+	free(new_point);
+	free(point);
+	free(owner);
+	free(m);
+	return(NULL);
+}
+
+
+/**********************************************************************
+ * vanessa_chash_remove_element
+ * Remove a member from a consistent hash ring
+ * pre: c: ring to remove member from
+ *      key: key to match the member
+ * post: matching member is removed from the ring and destroyed.
+ *       O(n) where n is the number of points on the ring.
+ * return: c, including if there is no matching member
+ *         NULL if c is NULL
+ **********************************************************************/
+
+vanessa_chash_t *vanessa_chash_remove_element(vanessa_chash_t *c, void *key)
+{
+	size_t i;
+
+	if(c == NULL) {
+		return(NULL);
+	}
+
+	for(i = 0; i < c->nomember; i++) {
+		if(c->e_match != NULL ?
+				c->e_match(c->member[i]->value, key) == 0 :
+				c->member[i]->value == key) {
+			__vanessa_chash_remove_member(c, i);
+			break;
+		}
+	}
+
+	return(c);
+}
+
+
+/**********************************************************************
+ * vanessa_chash_get_element
+ * Find the member of a consistent hash ring that a key maps to
+ * pre: c: ring to search
+ *      hash: hash of the key. Should use the full range of size_t,
+ *            vanessa_chash_hash_str may be used for strings.
+ * post: none
+ * return: member that the key maps to
+ *         NULL if c is NULL or has no members
+ **********************************************************************/
+
+void *vanessa_chash_get_element(vanessa_chash_t *c, size_t hash)
+{
+	unsigned int p;
+	size_t lo;
+	size_t hi;
+	size_t mid;
+
+	if(c == NULL || c->nopoint == 0) {
+		return(NULL);
+	}
+
+	p = __vanessa_chash_point(hash);
+	lo = c->jump[p >> c->shift];
+	hi = c->jump[(p >> c->shift) + 1];
+
+	/* First point at or after p, hi if all in range are before */
+	while(lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if(c->point[mid] < p) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+
+	if(lo == c->nopoint) {
+		lo = 0;
+	}
+
+	return(c->owner[lo]->value);
+}
+
+
+/**********************************************************************
+ * vanessa_chash_get_count
+ * Get the number of members of a consistent hash ring
+ * pre: c: ring
+ * return: number of members
+ *         0 if c is NULL
+ **********************************************************************/
+
+size_t vanessa_chash_get_count(vanessa_chash_t *c)
+{
+	if(c == NULL) {
+		return(0);
+	}
+
+	return(c->nomember);
+}
+
+
+/**********************************************************************
+ * vanessa_chash_iterate
+ * Run a function over each member of a consistent hash ring
+ * pre: c: ring run the function over
+ *      action: function to run
+ *              action should return < 0 if an error occurs,
+ *              which indicates that processing will be stopped
+ *      data: data passed to action
+ * post: action is run with the value of each member as its first
+ *       argument, in no particular order
+ * return: 0 on success
+ *         < 0 if action returns < 0
+ **********************************************************************/
+
+int vanessa_chash_iterate(vanessa_chash_t *c,
+		int (*action)(void *e, void *data), void *data)
+{
+	size_t i;
+	int status;
+
+	if(c == NULL) {
+		return(0);
+	}
+
+	for(i = 0; i < c->nomember; i++) {
+		status = action(c->member[i]->value, data);
+		if(status < 0) {
+			return(status);
+		}
+	}
+
+	return(0);
+}
+
+
+/**********************************************************************
+ * vanessa_chash_hash_str
+ * Hash a string, FNV-1a
+ * Suitable for use as the hash of a key or as element_hash
+ * pre: str: string to hash
+ * return: hash of str
+ **********************************************************************/
+
+size_t vanessa_chash_hash_str(const char *str)
+{
+	unsigned long long h = 0xcbf29ce484222325ULL;
+
+	while(*str != '\0') {
+		h ^= (unsigned char)*str++;
+		h *= 0x100000001b3ULL;
+	}
+
+	return((size_t)h);
+}
+
+
+/**********************************************************************
+ * vanessa_chash_jump
+ * Jump consistent hash, Lamping and Veach
+ * Maps a key to one of nobucket buckets, without any state, such
+ * that when nobucket grows by one only about 1/nobucket of keys move,
+ * all of them to the new bucket. Buckets are numbered, so only the
+ * last bucket may be removed.
+ * pre: hash: hash of the key
+ *      nobucket: number of buckets, must be at least 1
+ * post: none
+ * return: bucket, between 0 and nobucket - 1
+ *         -1 if nobucket is less than 1
+ **********************************************************************/
+
+int vanessa_chash_jump(size_t hash, int nobucket)
+{
+	unsigned long long key = hash;
+	long long b = -1;
+	long long j = 0;
+
+	while(j < nobucket) {
+		b = j;
+		key = key * 2862933555777941757ULL + 1;
+		j = (long long)((b + 1) * ((double)(1LL << 31) /
+					(double)((key >> 33) + 1)));
+	}
+
+	return((int)b);
+}
+
+
+/**********************************************************************
+ * vanessa_chash_jump_n
+ * Jump consistent hash of an array of keys
+ * pre: hash: hashes of the keys
+ *      bucket: array to store the buckets in
+ *      n: number of keys
+ *      nobucket: number of buckets, must be at least 1
+ * post: bucket[i] is vanessa_chash_jump(hash[i], nobucket)
+ * return: none
+ **********************************************************************/
+
+void vanessa_chash_jump_n(const size_t *hash, int *bucket, size_t n,
+		int nobucket)
+{
+	size_t i;
+
+	for(i = 0; i < n; i++) {
+		bucket[i] = vanessa_chash_jump(hash[i], nobucket);
+	}
+}
+
+
+/**********************************************************************
+ * __vanessa_chash_hrw_score
+ * Score of a member for a key, for rendezvous hashing
+ * pre: hash: hash of the key
+ *      member_hash: hash of the member
+ *      weight: weight of the member
+ * return: weight / -ln(u) where u is uniform in (0, 1) for the pair,
+ *         whose maximum over the members is attained by each member
+ *         with probability proportional to its weight.
+ **********************************************************************/
+
+static double __vanessa_chash_hrw_score(size_t hash, size_t member_hash,
+		double weight)
+{
+	double u;
+
+	u = ((double)(__vanessa_chash_mix((unsigned long long)hash ^
+			__vanessa_chash_mix(member_hash)) >> 11) + 0.5) /
+		9007199254740992.0;
+
+	return(weight / -log(u));
+}
+
+
+/**********************************************************************
+ * vanessa_chash_hrw
+ * Weighted rendezvous, highest random weight, hashing
+ * Maps a key to the member that scores highest for it. Removing a
+ * member only moves the keys that mapped to it and adding one only
+ * moves keys to it. Unlike vanessa_chash_jump any member may be
+ * removed, but a lookup is O(n) in the number of members.
+ * pre: hash: hash of the key
+ *      member_hash: hashes of the members, e.g. of their names
+ *      weight: relative weights of the members, each > 0
+ *              May be NULL in which case members are weighted equally
+ *      nomember: number of members
+ * post: none
+ * return: index of the member
+ *         -1 if nomember is less than 1
+ **********************************************************************/
+
+int vanessa_chash_hrw(size_t hash, const size_t *member_hash,
+		const double *weight, int nomember)
+{
+	unsigned long long score;
+	unsigned long long max_score = 0;
+	double wscore;
+	double max_wscore = 0;
+	int max = -1;
+	int i;
+
+	for(i = 0; i < nomember; i++) {
+		if(weight == NULL) {
+			/* Equal weights, no need to scale the score */
+			score = __vanessa_chash_mix((unsigned long long)hash ^
+					__vanessa_chash_mix(member_hash[i]));
+			if(max < 0 || score > max_score) {
+				max_score = score;
+				max = i;
+			}
+			continue;
+		}
+		wscore = __vanessa_chash_hrw_score(hash, member_hash[i],
+				weight[i]);
+		if(max < 0 || wscore > max_wscore) {
+			max_wscore = wscore;
+			max = i;
+		}
+	}
+
+	return(max);
+}
+
+
+/**********************************************************************
+ * vanessa_chash_hrw_n
+ * Weighted rendezvous hashing of an array of keys
+ * pre: hash: hashes of the keys
+ *      member: array to store the indexes of the members in
+ *      n: number of keys
+ *      member_hash: hashes of the members
+ *      weight: relative weights of the members, or NULL
+ *      nomember: number of members
+ * post: member[i] is vanessa_chash_hrw(hash[i], member_hash, weight,
+ *       nomember)
+ * return: none
+ **********************************************************************/
+
+void vanessa_chash_hrw_n(const size_t *hash, int *member, size_t n,
+		const size_t *member_hash, const double *weight, int nomember)
+{
+	size_t i;
+
+	for(i = 0; i < n; i++) {
+		member[i] = vanessa_chash_hrw(hash[i], member_hash, weight,
+				nomember);
+	}
+}
+
+
+/**********************************************************************
+ * vanessa_chash_get_element_n
+ * Find the members of a consistent hash ring that an array of keys
+ * map to
+ * pre: c: ring to search
+ *      hash: hashes of the keys
+ *      value: array to store the members in
+ *      n: number of keys
+ * post: value[i] is vanessa_chash_get_element(c, hash[i])
+ * return: none
+ **********************************************************************/
+
+void vanessa_chash_get_element_n(vanessa_chash_t *c, const size_t *hash,
+		void **value, size_t n)
+{
+	size_t i;
+
+	for(i = 0; i < n; i++) {
+		value[i] = vanessa_chash_get_element(c, hash[i]);
+	}
+}
@@ -224,11 +224,12 @@ vanessa_dynamic_array_t *vanessa_config_file_read_fd(int fd,
 		return(NULL);
 	}
 
-	a = vanessa_dynamic_array_create(0, VANESSA_DESTROY_STR,
+	a = vanessa_dynamic_array_create_growth(0,
+		      VANESSA_DYNAMIC_ARRAY_GEOMETRIC, VANESSA_DESTROY_STR,
 		      VANESSA_DUPLICATE_STR, VANESSA_DISPLAY_STR,
 		      VANESSA_LENGTH_STR);
 	if (!a) {
-		VANESSA_LOGGER_DEBUG("vanessa_dynamic_array_create");
+		VANESSA_LOGGER_DEBUG("vanessa_dynamic_array_create_growth");
 		return (NULL);
 	}
 
@@ -0,0 +1,426 @@
+/**********************************************************************
+ * deque.c                                                 October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Double ended queue
+ *
+ * Elements are kept in a circular array, whose size is a power of
+ * two, as for vanessa_queue, so pushing and popping at either end
+ * and indexing are O(1). The array grows in place with realloc, and
+ * only the elements that wrapped around the end of the old array,
+ * or those before it if fewer, are moved.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include "vanessa_adt.h"
+
+/* Smallest number of slots allocated */
+#define DEQUE_MINSLOT 16
+
+struct vanessa_deque_t_struct {
+	void **slot;
+	size_t mask;
+	size_t head;
+	size_t count;
+	void (*e_destroy) (const void *);
+};
+
+/* Slot of the ith element from the first */
+#define DEQUE_SLOT(d, i) ((d)->slot[((d)->head + (i)) & (d)->mask])
+
+
+/*
+ * Change the number of slots of a deque to noslot, a power of two
+ * no smaller than the number of elements in it.
+ * Returns 0 on success, -1 on error, in which case d is unchanged.
+ */
+
+static int __vanessa_deque_resize(vanessa_deque_t *d, size_t noslot)
+{
+	void **slot;
+	size_t oldnoslot = d->mask + 1;
+	size_t nowrap;
+	size_t i;
+
+	if(noslot < oldnoslot) {
+		slot = (void **)malloc(noslot * sizeof(void *));
+		if(slot == NULL) {
+			VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+			return(-1);
+		}
+		for(i = 0; i < d->count; i++) {
+			slot[i] = DEQUE_SLOT(d, i);
+		}
+		free(d->slot);
+		d->slot = slot;
+		d->mask = noslot - 1;
+		d->head = 0;
+		return(0);
+	}
+
+	slot = (void **)realloc(d->slot, noslot * sizeof(void *));
+	if(slot == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("realloc");
+		return(-1);
+	}
+	d->slot = slot;
+	d->mask = noslot - 1;
+
+	/*
+	 * Elements from head to the end of the old array stay put. If
+	 * the rest wrapped around to its beginning then either move them
+	 * to follow on after it, or move those from head to its end up
+	 * to the end of the new array, whichever moves fewer.
+	 */
+	if(d->head + d->count > oldnoslot) {
+		nowrap = d->head + d->count - oldnoslot;
+		if(nowrap <= oldnoslot - d->head) {
+			memcpy(slot + oldnoslot, slot, nowrap * sizeof(void *));
+		}
+		else {
+			memcpy(slot + noslot - (oldnoslot - d->head),
+					slot + d->head,
+					(oldnoslot - d->head) * sizeof(void *));
+			d->head += noslot - oldnoslot;
+		}
+	}
+
+	return(0);
+}
+
+
+/*
+ * Make room for one more element, doubling the array if it is full.
+ * Returns 0 on success, -1 on error.
+ */
+
+static int __vanessa_deque_grow(vanessa_deque_t *d)
+{
+	if(d->count <= d->mask) {
+		return(0);
+	}
+	return(__vanessa_deque_resize(d, (d->mask + 1) * 2));
+}
+
+
+/*
+ * Halve the array if it is less than 1/8 full. Failing to shrink is
+ * harmless.
+ */
+
+static void __vanessa_deque_shrink(vanessa_deque_t *d)
+{
+	if(d->mask + 1 > DEQUE_MINSLOT && d->count * 8 < d->mask + 1) {
+		__vanessa_deque_resize(d, (d->mask + 1) / 2);
+	}
+}
+
+
+/**********************************************************************
+ * vanessa_deque_create
+ * Create a new, empty double ended queue
+ * pre: e_destroy: pointer to a function to destroy elements of the
+ *                 deque, as for vanessa_queue_create. It is passed a
+ *                 pointer to the element. If NULL, then elements will
+ *                 not be freed on calls to vanessa_deque_destroy
+ * post: memory is allocated for deque and values are initialised
+ * return: new, empty deque
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_deque_t *vanessa_deque_create(void (*e_destroy) (const void *))
+{
+	vanessa_deque_t *d;
+
+	d = (vanessa_deque_t *)malloc(sizeof(vanessa_deque_t));
+	if(d == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+
+	d->slot = (void **)malloc(DEQUE_MINSLOT * sizeof(void *));
+	if(d->slot == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		free(d);
+		return(NULL);
+	}
+
+	d->mask = DEQUE_MINSLOT - 1;
+	d->head = 0;
+	d->count = 0;
+	d->e_destroy = e_destroy;
+
+	return(d);
+}
+
+
+/**********************************************************************
+ * vanessa_deque_destroy
+ * Destroy a double ended queue, destroying each element present in
+ * the deque first
+ * pre: d: deque to destroy
+ * post: deque and all elements in the deque are destroyed
+ * return: none
+ **********************************************************************/
+
+void vanessa_deque_destroy(vanessa_deque_t *d)
+{
+	size_t i;
+
+	if(d == NULL) {
+		return;
+	}
+
+	for(i = 0; d->e_destroy != NULL && i < d->count; i++) {
+		if(DEQUE_SLOT(d, i) != NULL) {
+			d->e_destroy(&DEQUE_SLOT(d, i));
+		}
+	}
+
+	free(d->slot);
+	free(d);
+}
+
+
+/**********************************************************************
+ * vanessa_deque_reserve
+ * Make room in a double ended queue for a number of elements
+ * pre: d: deque
+ *      n: number of elements
+ * post: the deque is grown, if needed, so that it can hold n elements
+ *       without allocating memory. It may shrink again if elements
+ *       are popped until it is less than 1/8 full.
+ * return: d
+ *         NULL on error, in which case d is unchanged
+ **********************************************************************/
+
+vanessa_deque_t *vanessa_deque_reserve(vanessa_deque_t *d, size_t n)
+{
+	size_t noslot = d->mask + 1;
+
+	while(noslot < n) {
+		noslot <<= 1;
+	}
+	if(noslot != d->mask + 1 && __vanessa_deque_resize(d, noslot) < 0) {
+		return(NULL);
+	}
+
+	return(d);
+}
+
+
+/**********************************************************************
+ * vanessa_deque_push_first
+ * Push an element onto the beginning of a double ended queue
+ * pre: d: deque
+ *      value: element to push
+ * post: element is added to the deque, as its first element
+ *       The array of elements is doubled in size if it is full
+ * return: d
+ *         NULL on error, in which case d is unchanged
+ **********************************************************************/
+
+vanessa_deque_t *vanessa_deque_push_first(vanessa_deque_t *d, void *value)
+{
+	if(__vanessa_deque_grow(d) < 0) {
+		return(NULL);
+	}
+
+	d->head = (d->head - 1) & d->mask;
+	d->slot[d->head] = value;
+	d->count++;
+
+	return(d);
+}
+
+
+/**********************************************************************
+ * vanessa_deque_push_last
+ * Push an element onto the end of a double ended queue
+ * pre: d: deque
+ *      value: element to push
+ * post: element is added to the deque, as its last element
+ *       The array of elements is doubled in size if it is full
+ * return: d
+ *         NULL on error, in which case d is unchanged
+ **********************************************************************/
+
+vanessa_deque_t *vanessa_deque_push_last(vanessa_deque_t *d, void *value)
+{
+	if(__vanessa_deque_grow(d) < 0) {
+		return(NULL);
+	}
+
+	DEQUE_SLOT(d, d->count) = value;
+	d->count++;
+
+	return(d);
+}
+
+
+/**********************************************************************
+ * vanessa_deque_pop_first
+ * Pop the first element off a double ended queue
+ * pre: d: deque
+ *      value: element removed from the deque is assigned to *value
+ * post: first element is removed from the deque
+ *       The array of elements is halved in size if it is less than
+ *       1/8 full
+ * return: d
+ *         NULL if the deque is empty
+ **********************************************************************/
+
+vanessa_deque_t *vanessa_deque_pop_first(vanessa_deque_t *d, void **value)
+{
+	if(d == NULL || d->count == 0) {
+		return(NULL);
+	}
+
+	*value = d->slot[d->head];
+	d->head = (d->head + 1) & d->mask;
+	d->count--;
+	__vanessa_deque_shrink(d);
+
+	return(d);
+}
+
+
+/**********************************************************************
+ * vanessa_deque_pop_last
+ * Pop the last element off a double ended queue
+ * pre: d: deque
+ *      value: element removed from the deque is assigned to *value
+ * post: last element is removed from the deque
+ *       The array of elements is halved in size if it is less than
+ *       1/8 full
+ * return: d
+ *         NULL if the deque is empty
+ **********************************************************************/
+
+vanessa_deque_t *vanessa_deque_pop_last(vanessa_deque_t *d, void **value)
+{
+	if(d == NULL || d->count == 0) {
+		return(NULL);
+	}
+
+	*value = DEQUE_SLOT(d, d->count - 1);
+	d->count--;
+	__vanessa_deque_shrink(d);
+
+	return(d);
+}
+
+
+/**********************************************************************
+ * vanessa_deque_peek_first
+ * Retrieve the first element of a double ended queue without
+ * removing it
+ * pre: d: deque
+ * post: none
+ * return: first element
+ *         NULL if the deque is empty
+ **********************************************************************/
+
+void *vanessa_deque_peek_first(const vanessa_deque_t *d)
+{
+	return((d == NULL || d->count == 0) ? NULL : d->slot[d->head]);
+}
+
+
+/**********************************************************************
+ * vanessa_deque_peek_last
+ * Retrieve the last element of a double ended queue without
+ * removing it
+ * pre: d: deque
+ * post: none
+ * return: last element
+ *         NULL if the deque is empty
+ **********************************************************************/
+
+void *vanessa_deque_peek_last(const vanessa_deque_t *d)
+{
+	return((d == NULL || d->count == 0) ?
+			NULL : DEQUE_SLOT(d, d->count - 1));
+}
+
+
+/**********************************************************************
+ * vanessa_deque_get_element
+ * Retrieve an element of a double ended queue by its index
+ * pre: d: deque
+ *      index: index of element, counting from 0 for the first
+ * post: none
+ * return: element at index
+ *         NULL if index is out of range
+ **********************************************************************/
+
+void *vanessa_deque_get_element(const vanessa_deque_t *d, size_t index)
+{
+	if(d == NULL || index >= d->count) {
+		return(NULL);
+	}
+
+	return(DEQUE_SLOT(d, index));
+}
+
+
+/**********************************************************************
+ * vanessa_deque_set_element
+ * Replace an element of a double ended queue by its index
+ * pre: d: deque
+ *      index: index of element, counting from 0 for the first
+ *      value: new element
+ * post: value is stored at index. The element it replaces is not
+ *       destroyed.
+ * return: element replaced
+ *         NULL if index is out of range
+ **********************************************************************/
+
+void *vanessa_deque_set_element(vanessa_deque_t *d, size_t index,
+		void *value)
+{
+	void *old;
+
+	if(d == NULL || index >= d->count) {
+		return(NULL);
+	}
+
+	old = DEQUE_SLOT(d, index);
+	DEQUE_SLOT(d, index) = value;
+
+	return(old);
+}
+
+
+/**********************************************************************
+ * vanessa_deque_length
+ * Return the number of elements in a double ended queue
+ * pre: d: deque
+ * post: none
+ * return: number of elements in the deque
+ *         -1 if d is NULL
+ **********************************************************************/
+
+ssize_t vanessa_deque_length(const vanessa_deque_t *d)
+{
+	return(d == NULL ? -1 : (ssize_t)d->count);
+}
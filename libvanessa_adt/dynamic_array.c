@@ -42,6 +42,7 @@ struct vanessa_dynamic_array_t_struct {
         size_t count;
         size_t allocated_size;
         size_t block_size;
+        vanessa_adt_flag_t growth;
         void (*e_destroy) (void *);
         void *(*e_duplicate) (void *s);
         void (*e_display) (char *, void *);
@@ -50,6 +51,35 @@ struct vanessa_dynamic_array_t_struct {
 
 
 
+/**********************************************************************
+ * vanessa_dynamic_array_resize
+ * Change the number of elements allocated for a dynamic array
+ * pre: a: dynamic array
+ *      allocated_size: new number of elements, no smaller than the
+ *                      number of elements in the array
+ * return: 0 on success
+ *         -1 on error, in which case a is unchanged
+ **********************************************************************/
+
+static int vanessa_dynamic_array_resize(vanessa_dynamic_array_t * a,
+		size_t allocated_size)
+{
+	void **vector;
+
+	vector = (void **) realloc(a->vector,
+			allocated_size * sizeof(void *));
+	if (!vector) {
+		VANESSA_LOGGER_DEBUG_ERRNO("realloc");
+		return (-1);
+	}
+
+	a->vector = vector;
+	a->allocated_size = allocated_size;
+
+	return (0);
+}
+
+
 /**********************************************************************
  * vanessa_dynamic_array_create
  * Create a dynamic array
@@ -96,6 +126,37 @@ vanessa_dynamic_array_t *vanessa_dynamic_array_create(size_t block_size,
 		void (*element_destroy) (void *), void *(*element_duplicate)
 		(void *s), void (*element_display) (char *, void *),
 		size_t (*element_length) (void *))
+{
+	return (vanessa_dynamic_array_create_growth(block_size,
+				VANESSA_DYNAMIC_ARRAY_LINEAR, element_destroy,
+				element_duplicate, element_display,
+				element_length));
+}
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_create_growth
+ * Create a dynamic array that grows as given
+ * pre: block_size: as for vanessa_dynamic_array_create
+ *      growth: VANESSA_DYNAMIC_ARRAY_LINEAR: grow and shrink the array
+ *              by block_size elements at a time, as
+ *              vanessa_dynamic_array_create does.
+ *              VANESSA_DYNAMIC_ARRAY_GEOMETRIC: grow the array by half
+ *              its size, and by at least block_size, so that adding
+ *              n elements copies O(n) of them. The array is halved
+ *              when it is less than 1/4 full.
+ *      element_destroy, element_duplicate, element_display,
+ *      element_length: as for vanessa_dynamic_array_create
+ * post: Dynamic array is allocated and initialised.
+ * return: An empty dynamic array 
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_dynamic_array_t *vanessa_dynamic_array_create_growth(
+		size_t block_size, vanessa_adt_flag_t growth,
+		void (*element_destroy) (void *), void *(*element_duplicate)
+		(void *s), void (*element_display) (char *, void *),
+		size_t (*element_length) (void *))
 {
 	vanessa_dynamic_array_t *a;
 
@@ -111,6 +172,7 @@ vanessa_dynamic_array_t *vanessa_dynamic_array_create(size_t block_size,
 	a->block_size =
 	    block_size ? block_size :
 	    VANESSA_DEFAULT_DYNAMIC_ARRAY_BLOCK_SIZE;
+	a->growth = growth;
 
 	a->e_destroy = element_destroy;
 	a->e_duplicate = element_duplicate;
@@ -155,7 +217,8 @@ void vanessa_dynamic_array_destroy(vanessa_dynamic_array_t * a)
  * post: element in inserted in the first unused position in the array
  *       array size is increased by block_size, as passed to
  *       vanessa_dynamic_array_create,  if there is insufficient room in the 
- *       array to add the element.
+ *       array to add the element, or by half its size if it was
+ *       created with VANESSA_DYNAMIC_ARRAY_GEOMETRIC.
  *       Nothing is done if e is NULL
  * return: a on success
  *         NULL if a is NULL or an error occurs
@@ -164,6 +227,8 @@ void vanessa_dynamic_array_destroy(vanessa_dynamic_array_t * a)
 vanessa_dynamic_array_t *vanessa_dynamic_array_add_element(
 		vanessa_dynamic_array_t * a, void *e)
 {
+	size_t grow;
+
 	/* Make sure arguments are sane */
 	if (!a) {
 		return (NULL);
@@ -178,11 +243,13 @@ vanessa_dynamic_array_t *vanessa_dynamic_array_add_element(
 
 	/* Grow vector as required */
 	if (a->count == a->allocated_size) {
-		a->allocated_size += a->block_size;
-		a->vector = (void **) realloc(a->vector, 
-				a->allocated_size * sizeof(void *));
-		if (!(a->vector)) {
-			VANESSA_LOGGER_DEBUG_ERRNO("realloc");
+		grow = a->block_size;
+		if (a->growth == VANESSA_DYNAMIC_ARRAY_GEOMETRIC &&
+				a->allocated_size / 2 > grow) {
+			grow = a->allocated_size / 2;
+		}
+		if (vanessa_dynamic_array_resize(a,
+					a->allocated_size + grow)) {
 			vanessa_dynamic_array_destroy(a);
 			return (NULL);
 		}
@@ -211,8 +278,12 @@ vanessa_dynamic_array_t *vanessa_dynamic_array_add_element(
  * post: Element is destroyed and removed from array. Subsequent
  *       elements in the array are shuffled up to fill the gap.
  *       array size is decreased by block_size, as passed to
- *       vanessa_dynamic_array_create,  if there number if used elements in
- *       the array falls below a block boundary.
+ *       vanessa_dynamic_array_create,  if more than a block beyond
+ *       the last used element would remain unused, so that adding
+ *       and deleting an element at a block boundary does not
+ *       reallocate the array each time.
+ *       If the array was created with VANESSA_DYNAMIC_ARRAY_GEOMETRIC
+ *       it is instead halved when it is less than 1/4 full.
  *       Nothing is done if e is NULL or index is not a valid element
  *       in the array.
  * return: a on success
@@ -240,17 +311,20 @@ vanessa_dynamic_array_t *vanessa_dynamic_array_delete_element(
 	}
 	a->count--;
 
-	/* Shrink vector as required */
-	if (a->count && a->count <= a->allocated_size - a->block_size) {
-		a->allocated_size -= a->block_size;
-		a->vector = (void **) realloc(a->vector, 
-				a->allocated_size * sizeof(void *));
-		if (!(a->vector)) {
-			VANESSA_LOGGER_DEBUG_ERRNO("realloc");
-			vanessa_dynamic_array_destroy(a);
-			return (NULL);
+	/* Shrink vector as required, failing to do so is harmless */
+	if (a->count == 0) {
+		return (a);
+	}
+	if (a->growth == VANESSA_DYNAMIC_ARRAY_GEOMETRIC) {
+		if (a->count < a->allocated_size / 4 &&
+				a->allocated_size / 2 >= a->block_size) {
+			vanessa_dynamic_array_resize(a, a->allocated_size / 2);
 		}
 	}
+	else if (a->count + 2 * a->block_size <= a->allocated_size) {
+		vanessa_dynamic_array_resize(a,
+				a->allocated_size - a->block_size);
+	}
 
 	return (a);
 }
@@ -260,6 +334,8 @@ vanessa_dynamic_array_t *vanessa_dynamic_array_delete_element(
  * vanessa_dynamic_array_duplicate
  * Duplicate a dynamic array
  * pre: a: Dynamic Array to duplicate
+ * post: a vector of exactly the number of elements in a is allocated
+ *       and the elements are copied into it, in order
  * return: An empty dynamic array 
  *         NULL on error
  **********************************************************************/
@@ -270,22 +346,42 @@ vanessa_dynamic_array_t *vanessa_dynamic_array_duplicate(
 	vanessa_dynamic_array_t *new_a;
 	size_t i;
 
-	extern int errno;
-
-	new_a = vanessa_dynamic_array_create(a->block_size, a->e_destroy,
-			a->e_duplicate, a->e_display, a->e_length);
+	new_a = vanessa_dynamic_array_create_growth(a->block_size, a->growth,
+			a->e_destroy, a->e_duplicate, a->e_display, a->e_length);
 	if(!new_a) {
-		VANESSA_LOGGER_DEBUG("vanessa_dynamic_array_create");
+		VANESSA_LOGGER_DEBUG("vanessa_dynamic_array_create_growth");
 		return (NULL);
 	}
 
+	if (a->count == 0) {
+		return (new_a);
+	}
+
+	new_a->vector = (void **) malloc(a->count * sizeof(void *));
+	if (!(new_a->vector)) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		vanessa_dynamic_array_destroy(new_a);
+		return (NULL);
+	}
+	new_a->allocated_size = a->count;
+
+	if (!a->e_duplicate) {
+		memcpy(new_a->vector, a->vector, a->count * sizeof(void *));
+		new_a->count = a->count;
+		return (new_a);
+	}
+
 	for (i = 0; i < a->count; i++) {
-		if (!vanessa_dynamic_array_add_element(new_a, a->vector[i])) {
-			VANESSA_LOGGER_DEBUG(
-					"vanessa_dynamic_array_add_element");
-			vanessa_dynamic_array_destroy(new_a);
-			return (NULL);
+		new_a->vector[i] = a->vector[i];
+		if (a->vector[i]) {
+			new_a->vector[i] = a->e_duplicate(a->vector[i]);
+			if (!new_a->vector[i]) {
+				VANESSA_LOGGER_DEBUG("a->e_duplicate");
+				vanessa_dynamic_array_destroy(new_a);
+				return (NULL);
+			}
 		}
+		new_a->count++;
 	}
 
 	return (new_a);
@@ -503,11 +599,12 @@ vanessa_dynamic_array_t *vanessa_dynamic_array_split_str(char *string,
 	if (string == NULL) {
 		return (NULL);
 	}
-	a = vanessa_dynamic_array_create(0, VANESSA_DESTROY_STR,
+	a = vanessa_dynamic_array_create_growth(0,
+			VANESSA_DYNAMIC_ARRAY_GEOMETRIC, VANESSA_DESTROY_STR,
 			VANESSA_DUPLICATE_STR, VANESSA_DISPLAY_STR,
 			VANESSA_LENGTH_STR);
 	if(!a) {
-		VANESSA_LOGGER_DEBUG("vanessa_dynamic_array_create");
+		VANESSA_LOGGER_DEBUG("vanessa_dynamic_array_create_growth");
 		return (NULL);
 	}
 	while ((sub_string = strchr(string, delimiter)) != NULL) {
@@ -551,11 +648,12 @@ vanessa_dynamic_array_t *vanessa_dynamic_array_split_str_to_int(char *string,
 	if (string == NULL) {
 		return (NULL);
 	}
-	a = vanessa_dynamic_array_create(0, VANESSA_DESTROY_INT,
+	a = vanessa_dynamic_array_create_growth(0,
+			VANESSA_DYNAMIC_ARRAY_GEOMETRIC, VANESSA_DESTROY_INT,
 			VANESSA_DUPLICATE_INT, VANESSA_DISPLAY_INT,
 			VANESSA_LENGTH_INT);
 	if(!a) {
-		VANESSA_LOGGER_DEBUG("vanessa_dynamic_array_create");
+		VANESSA_LOGGER_DEBUG("vanessa_dynamic_array_create_growth");
 		return (NULL);
 	}
 	while ((sub_string = strchr(string, delimiter)) != NULL) {
@@ -408,7 +408,8 @@ vanessa_hash_t *vanessa_hash_remove_element(vanessa_hash_t *h, void *value)
  * vanessa_hash_duplicate
  * Duplicate a hash
  * pre: h: hash to duplicate
- * post: hash is duplicated
+ * post: hash is duplicated, in O(n). The elements of all the buckets
+ *       of the new hash are allocated from a single pool.
  * return: NULL if h is NULL or on error
  *         duplicated hash 
  **********************************************************************/
@@ -417,6 +418,7 @@ vanessa_hash_t *vanessa_hash_duplicate(vanessa_hash_t *h)
 {
 	size_t i;
 	vanessa_hash_t *new_h;
+	vanessa_pool_t *pool;
 
 	new_h = vanessa_hash_create(h->nobucket, h->e_destroy, h->e_duplicate,
 			 h->e_match, h->e_display, h->e_length, h->e_hash);
@@ -425,19 +427,31 @@ vanessa_hash_t *vanessa_hash_duplicate(vanessa_hash_t *h)
 		return(NULL);
 	}
 
+	pool = vanessa_list_pool_create(VANESSA_POOL_RELEASE);
+	if(pool == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_list_pool_create");
+		vanessa_hash_destroy(new_h);
+		return(NULL);
+	}
+
 	for(i = 0 ; i < h->nobucket ; i++ ){
 		if(h->bucket[i] == NULL) {
 			continue;
 		}
 
-		new_h->bucket[i]=vanessa_list_duplicate(h->bucket[i]);
+		new_h->bucket[i]=vanessa_list_duplicate_pool(h->bucket[i],
+				pool);
 		if(new_h->bucket[i] == NULL) {
-			VANESSA_LOGGER_DEBUG("vanessa_list_duplicate");
+			VANESSA_LOGGER_DEBUG("vanessa_list_duplicate_pool");
+			vanessa_pool_destroy(pool);
 			vanessa_hash_destroy(new_h);
 			return(NULL);
 		}
 	}
 
+	/* Each bucket holds a reference to the pool */
+	vanessa_pool_destroy(pool);
+
 	return(new_h);
 }
 
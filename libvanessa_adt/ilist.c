@@ -0,0 +1,165 @@
+/**********************************************************************
+ * ilist.c                                                 October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Intrusive doubly linked list
+ *
+ * The links live in the objects that are listed, so adding an object
+ * to a list or removing it never allocates memory, and an object may
+ * be on several lists at once by having several links. Lists are
+ * circular, with a head that is not part of an object, so inserting,
+ * removing and splicing are O(1) and have no special cases.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include "vanessa_adt.h"
+
+
+/**********************************************************************
+ * vanessa_ilist_init
+ * Initialise the head of an intrusive list, or a link
+ * pre: head: head or link to initialise
+ * post: head is an empty list. A link initialised like this may be
+ *       tested with vanessa_ilist_empty to see if it is on a list,
+ *       and removed from a list more than once.
+ * return: none
+ **********************************************************************/
+
+void vanessa_ilist_init(vanessa_ilist_t *head)
+{
+	head->next = head;
+	head->prev = head;
+}
+
+
+/**********************************************************************
+ * vanessa_ilist_empty
+ * Check if an intrusive list is empty
+ * pre: head: head of list, or a link
+ * post: none
+ * return: non-zero if head is an empty list, or a link that is not
+ *         on a list
+ *         0 otherwise
+ **********************************************************************/
+
+int vanessa_ilist_empty(const vanessa_ilist_t *head)
+{
+	return(head->next == head);
+}
+
+
+/**********************************************************************
+ * vanessa_ilist_insert_after
+ * Insert a link into an intrusive list after a given link
+ * pre: pos: head of a list, or a link on it
+ *      link: link that is not on a list
+ * post: link is on the list after pos. If pos is the head link is
+ *       the first element of the list.
+ * return: none
+ **********************************************************************/
+
+void vanessa_ilist_insert_after(vanessa_ilist_t *pos, vanessa_ilist_t *link)
+{
+	link->prev = pos;
+	link->next = pos->next;
+	pos->next->prev = link;
+	pos->next = link;
+}
+
+
+/**********************************************************************
+ * vanessa_ilist_insert_before
+ * Insert a link into an intrusive list before a given link
+ * pre: pos: head of a list, or a link on it
+ *      link: link that is not on a list
+ * post: link is on the list before pos. If pos is the head link is
+ *       the last element of the list.
+ * return: none
+ **********************************************************************/
+
+void vanessa_ilist_insert_before(vanessa_ilist_t *pos, vanessa_ilist_t *link)
+{
+	vanessa_ilist_insert_after(pos->prev, link);
+}
+
+
+/**********************************************************************
+ * vanessa_ilist_remove
+ * Remove a link from the intrusive list it is on
+ * pre: link: link that is on a list, or initialised with
+ *            vanessa_ilist_init
+ * post: link is not on a list, and is initialised as for
+ *       vanessa_ilist_init
+ * return: none
+ **********************************************************************/
+
+void vanessa_ilist_remove(vanessa_ilist_t *link)
+{
+	link->prev->next = link->next;
+	link->next->prev = link->prev;
+	vanessa_ilist_init(link);
+}
+
+
+/**********************************************************************
+ * vanessa_ilist_splice
+ * Move all the elements of one intrusive list to the end of another
+ * pre: head: head of list to add elements to
+ *      other: head of list to take elements from
+ * post: elements of other are at the end of head, in order
+ *       other is empty
+ * return: none
+ **********************************************************************/
+
+void vanessa_ilist_splice(vanessa_ilist_t *head, vanessa_ilist_t *other)
+{
+	if(vanessa_ilist_empty(other)) {
+		return;
+	}
+
+	other->next->prev = head->prev;
+	head->prev->next = other->next;
+	other->prev->next = head;
+	head->prev = other->prev;
+	vanessa_ilist_init(other);
+}
+
+
+/**********************************************************************
+ * vanessa_ilist_get_count
+ * Count the elements of an intrusive list
+ * pre: head: head of list
+ * post: none
+ * return: number of elements in the list, O(n)
+ **********************************************************************/
+
+size_t vanessa_ilist_get_count(const vanessa_ilist_t *head)
+{
+	const vanessa_ilist_t *link;
+	size_t count = 0;
+
+	for(link = head->next; link != head; link = link->next) {
+		count++;
+	}
+
+	return(count);
+}
@@ -38,12 +38,64 @@
 
 #define DEFAULT_NORECENT 7
 
+/* Levels of a skip list above the list itself */
+#define LIST_SKIP_MAXLEVEL 24
+
+/* Smallest number of slots in an index */
+#define LIST_INDEX_MINSLOT 16
+
+/* Fewest elements for which a duplicate of a list without a pool is
+ * given a pool of its own, smaller lists would waste most of a slab */
+#define LIST_DUPLICATE_MINPOOL 64
+
+typedef struct vanessa_list_tower_struct vanessa_list_tower_t;
+
 struct vanessa_list_elem_struct {
 	struct vanessa_list_elem_struct *next;
 	struct vanessa_list_elem_struct *prev;
+	vanessa_list_tower_t *tower;
 	void *value;
 };
 
+/*
+ * When VANESSA_LIST_SKIP is set, the list itself is the lowest level
+ * of a skip list. An element that is also present on higher levels
+ * has a tower holding its next and previous pointers on each of
+ * them: link[i] is next and link[level + i] is prev on level i + 2.
+ * About three quarters of elements have no tower.
+ */
+struct vanessa_list_tower_struct {
+	int level;
+	vanessa_list_elem_t *link[1];
+};
+
+#define TOWER_NEXT(e, i) ((e)->tower->link[(i)])
+#define TOWER_PREV(e, i) ((e)->tower->link[(e)->tower->level + (i)])
+
+struct vanessa_list_skip_struct {
+	int level;
+	unsigned int seed;
+	vanessa_list_elem_t *first[LIST_SKIP_MAXLEVEL];
+};
+
+/*
+ * An index is an open addressed hash table, with linear probing, of
+ * the elements of a list by the hash of their value. The hash is kept
+ * in each slot so that probing and resizing rarely call element_hash
+ * or element_match.
+ */
+typedef struct {
+	size_t hash;
+	vanessa_list_elem_t *elem;
+} vanessa_list_index_slot_t;
+
+struct vanessa_list_index_struct {
+	size_t (*e_hash)(void *e);
+	size_t mask;
+	size_t count;
+	vanessa_list_index_slot_t *slot;
+};
+
 
 /**********************************************************************
  * vanessa_list_elem_assign
@@ -67,6 +119,7 @@ vanessa_list_elem_t *vanessa_list_elem_assign(vanessa_list_elem_t * e,
 	}
 	e->next = next;
 	e->prev = prev;
+	e->tower = NULL;
 	e->value = value;
 
 	return (e);
@@ -77,13 +130,15 @@ vanessa_list_elem_t *vanessa_list_elem_assign(vanessa_list_elem_t * e,
  * vanessa_list_elem_destroy
  * Destroy a list element
  * pre: e: pointer to elelemt to destroy
+ *      destroy_value: function to destroy the value of e, may be NULL
+ *      pool: pool e was allocated from, NULL if it was malloced
  * post: e and values in e are dstroyed
  *       nothing if e is NULL
  **********************************************************************/
 
 static
 void vanessa_list_elem_destroy(vanessa_list_elem_t * e, 
-		void (*destroy_value) (void *))
+		void (*destroy_value) (void *), vanessa_pool_t *pool)
 {
 	if (!e) {
 		return;
@@ -91,7 +146,12 @@ void vanessa_list_elem_destroy(vanessa_list_elem_t * e,
 	if(destroy_value != NULL) {
 		destroy_value(e->value);
 	}
-	free(e);
+	if(pool != NULL) {
+		vanessa_pool_free(pool, e);
+	}
+	else {
+		free(e);
+	}
 }
 
 
@@ -101,6 +161,8 @@ void vanessa_list_elem_destroy(vanessa_list_elem_t * e,
  * pre: prev: previous element in list
  *      next: next element in list
  *      value: value to store
+ *      element_duplicate: function to duplicate value, may be NULL
+ *      pool: pool to allocate e from, NULL to use malloc
  * post: e is initialised and values are seeded
  * return: pointer to e
  *         NULL on error
@@ -109,12 +171,17 @@ void vanessa_list_elem_destroy(vanessa_list_elem_t * e,
 static
 vanessa_list_elem_t *vanessa_list_elem_create(vanessa_list_elem_t * prev,
 	vanessa_list_elem_t * next, void *value,
-	void *(*element_duplicate) (void *e))
+	void *(*element_duplicate) (void *e), vanessa_pool_t *pool)
 {
 	vanessa_list_elem_t *e;
 	void *new_value;
 
-	e = (vanessa_list_elem_t *) malloc(sizeof(vanessa_list_elem_t));
+	if (pool != NULL) {
+		e = (vanessa_list_elem_t *) vanessa_pool_alloc(pool);
+	}
+	else {
+		e = (vanessa_list_elem_t *) malloc(sizeof(vanessa_list_elem_t));
+	}
 	if (!e) {
 		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
 		return (NULL);
@@ -124,7 +191,7 @@ vanessa_list_elem_t *vanessa_list_elem_create(vanessa_list_elem_t * prev,
 		new_value = element_duplicate(value);
 		if(!new_value) {
 			VANESSA_LOGGER_DEBUG("element_duplicate");
-			free(e);
+			vanessa_list_elem_destroy(e, NULL, pool);
 			return(NULL);
 		}
 	}
@@ -228,6 +295,11 @@ vanessa_list_t *vanessa_list_create(int norecent,
 	l->e_length = element_size;
 	l->e_match = element_match;
 	l->e_sort = element_sort;
+	l->pool = NULL;
+	l->flag = 0;
+	l->skip = NULL;
+	l->index = NULL;
+	l->count = 0;
 
 	return (l);
 }
@@ -248,17 +320,17 @@ void vanessa_list_destroy(vanessa_list_t * l)
 		return;
 	}
 
-	if(l->e_destroy != NULL) {
-		while (l->first != NULL) {
-			next = l->first->next;
-			if(l->first->value) {
-				l->e_destroy(l->first->value);
-			}
-			free(l->first);
-			l->first = next;
-		}
+	vanessa_list_clear_flag(l, VANESSA_LIST_SKIP);
+	vanessa_list_set_index(l, NULL);
+	while (l->first != NULL) {
+		next = l->first->next;
+		vanessa_list_elem_destroy(l->first, l->first->value ?
+				l->e_destroy : NULL, l->pool);
+		l->first = next;
 	}
 
+	vanessa_pool_destroy(l->pool);
+	free(l->recent);
 	free(l);
 	return;
 }
@@ -365,10 +437,456 @@ char *vanessa_list_display(vanessa_list_t * l, char delimiter) {
 }
 
 
+/**********************************************************************
+ * __vanessa_list_skip_find
+ * Search the skip list of a list
+ * pre: l: list with VANESSA_LIST_SKIP set
+ *      key: key to search for, compared using element_sort
+ *      insert: if non-zero find where to insert key, after any equal
+ *              elements. Otherwise find the first element equal to key.
+ *      update: if non-NULL filled in with the last element before
+ *              that position on each level above the list,
+ *              NULL where it is the start of the level
+ * post: none
+ * return: last element before the position, NULL if it is the start
+ *         of the list
+ **********************************************************************/
+
+static vanessa_list_elem_t *__vanessa_list_skip_find(vanessa_list_t *l,
+		void *key, int insert, vanessa_list_elem_t **update)
+{
+	vanessa_list_elem_t *e = NULL;
+	vanessa_list_elem_t *next;
+	int i;
+
+	for(i = l->skip->level - 1; i >= 0; i--) {
+		for(;;) {
+			next = e ? TOWER_NEXT(e, i) : l->skip->first[i];
+			if(next == NULL || (insert ?
+					l->e_sort(key, next->value) < 0 :
+					l->e_sort(next->value, key) >= 0)) {
+				break;
+			}
+			e = next;
+		}
+		if(update != NULL) {
+			update[i] = e;
+		}
+	}
+
+	for(;;) {
+		next = e ? e->next : l->first;
+		if(next == NULL || (insert ?
+				l->e_sort(key, next->value) < 0 :
+				l->e_sort(next->value, key) >= 0)) {
+			break;
+		}
+		e = next;
+	}
+
+	return(e);
+}
+
+
+/**********************************************************************
+ * __vanessa_list_skip_level
+ * Pick the number of levels above the list for a new element
+ * pre: l: list with VANESSA_LIST_SKIP set
+ * post: random seed of l is advanced
+ * return: number of levels, 0 with probability 3/4, 1 with 3/16...
+ **********************************************************************/
+
+static int __vanessa_list_skip_level(vanessa_list_t *l)
+{
+	unsigned int x = l->skip->seed;
+	int level = 0;
+
+	/* xorshift32 */
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	l->skip->seed = x;
+
+	while((x & 3) == 0 && level < LIST_SKIP_MAXLEVEL) {
+		level++;
+		x >>= 2;
+	}
+
+	return(level);
+}
+
+
+/**********************************************************************
+ * __vanessa_list_skip_link
+ * Link an element into the levels of the skip list above the list
+ * pre: l: list with VANESSA_LIST_SKIP set
+ *      e: element with a tower, in the list
+ *      update: last element before e on each level of its tower,
+ *              NULL where e will be the start of a level.
+ *              Only used for levels currently in the skip list,
+ *              e will be the only element on any others.
+ * post: e is linked into each level of its tower
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_list_skip_link(vanessa_list_t *l,
+		vanessa_list_elem_t *e, vanessa_list_elem_t **update)
+{
+	vanessa_list_elem_t *prev = NULL;
+	vanessa_list_elem_t *next = NULL;
+	int i;
+
+	for(i = 0; i < e->tower->level; i++) {
+		if(i < l->skip->level) {
+			prev = update[i];
+			next = prev ? TOWER_NEXT(prev, i) : l->skip->first[i];
+		}
+		else {
+			prev = next = NULL;
+		}
+		TOWER_NEXT(e, i) = next;
+		TOWER_PREV(e, i) = prev;
+		if(prev != NULL) {
+			TOWER_NEXT(prev, i) = e;
+		}
+		else {
+			l->skip->first[i] = e;
+		}
+		if(next != NULL) {
+			TOWER_PREV(next, i) = e;
+		}
+	}
+
+	if(e->tower->level > l->skip->level) {
+		l->skip->level = e->tower->level;
+	}
+}
+
+
+/**********************************************************************
+ * __vanessa_list_skip_unlink
+ * Unlink an element from the levels of the skip list above the list
+ * pre: l: list with VANESSA_LIST_SKIP set
+ *      e: element in the list
+ * post: e is unlinked from each level of its tower, if it has one,
+ *       unless a bulk load is in progress, and the tower is freed
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_list_skip_unlink(vanessa_list_t *l,
+		vanessa_list_elem_t *e)
+{
+	int i;
+
+	if(e->tower == NULL) {
+		return;
+	}
+
+	/* The skip list is rebuilt when a bulk load is sorted */
+	if(l->flag & VANESSA_LIST_BULK) {
+		free(e->tower);
+		e->tower = NULL;
+		return;
+	}
+
+	for(i = 0; i < e->tower->level; i++) {
+		if(TOWER_PREV(e, i) != NULL) {
+			TOWER_NEXT(TOWER_PREV(e, i), i) = TOWER_NEXT(e, i);
+		}
+		else {
+			l->skip->first[i] = TOWER_NEXT(e, i);
+		}
+		if(TOWER_NEXT(e, i) != NULL) {
+			TOWER_PREV(TOWER_NEXT(e, i), i) = TOWER_PREV(e, i);
+		}
+	}
+
+	while(l->skip->level > 0 &&
+			l->skip->first[l->skip->level - 1] == NULL) {
+		l->skip->level--;
+	}
+
+	free(e->tower);
+	e->tower = NULL;
+}
+
+
+/**********************************************************************
+ * __vanessa_list_skip_tower_create
+ * Allocate a tower of random height for a new element
+ * pre: l: list with VANESSA_LIST_SKIP set
+ *      tower: set to the tower, or NULL if the element should
+ *             have none
+ * post: none
+ * return: 0 on success
+ *         -1 on error
+ **********************************************************************/
+
+static int __vanessa_list_skip_tower_create(vanessa_list_t *l,
+		vanessa_list_tower_t **tower)
+{
+	int level;
+
+	*tower = NULL;
+
+	level = __vanessa_list_skip_level(l);
+	if(level == 0) {
+		return(0);
+	}
+
+	*tower = (vanessa_list_tower_t *)malloc(sizeof(vanessa_list_tower_t)
+			+ (2 * level - 1) * sizeof(vanessa_list_elem_t *));
+	if(*tower == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(-1);
+	}
+	(*tower)->level = level;
+
+	return(0);
+}
+
+
+/**********************************************************************
+ * __vanessa_list_skip_rebuild
+ * Relink the levels of the skip list above the list
+ * pre: l: list with VANESSA_LIST_SKIP set, whose elements have
+ *         towers that may not be linked
+ * post: each level of the skip list links the elements whose towers
+ *       reach it, in list order
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_list_skip_rebuild(vanessa_list_t *l)
+{
+	vanessa_list_elem_t *last[LIST_SKIP_MAXLEVEL];
+	vanessa_list_elem_t *e;
+	int i;
+
+	l->skip->level = 0;
+	for(e = l->first; e != NULL; e = e->next) {
+		if(e->tower == NULL) {
+			continue;
+		}
+		for(i = 0; i < e->tower->level; i++) {
+			if(i < l->skip->level) {
+				TOWER_NEXT(last[i], i) = e;
+				TOWER_PREV(e, i) = last[i];
+			}
+			else {
+				l->skip->first[i] = e;
+				TOWER_PREV(e, i) = NULL;
+			}
+			TOWER_NEXT(e, i) = NULL;
+			last[i] = e;
+		}
+		if(e->tower->level > l->skip->level) {
+			l->skip->level = e->tower->level;
+		}
+	}
+}
+
+
+/**********************************************************************
+ * __vanessa_list_index_resize
+ * Change the number of slots in the index of a list
+ * pre: index: index
+ *      noslot: new number of slots, a power of two larger than the
+ *              number of elements in the index
+ * post: elements are rehashed into the new slots
+ * return: 0 on success
+ *         -1 on error, in which case index is unchanged
+ **********************************************************************/
+
+static int __vanessa_list_index_resize(vanessa_list_index_t *index,
+		size_t noslot)
+{
+	vanessa_list_index_slot_t *slot;
+	size_t i;
+	size_t j;
+
+	slot = (vanessa_list_index_slot_t *)
+		calloc(noslot, sizeof(vanessa_list_index_slot_t));
+	if(slot == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("calloc");
+		return(-1);
+	}
+
+	for(i = 0; index->slot != NULL && i <= index->mask; i++) {
+		if(index->slot[i].elem == NULL) {
+			continue;
+		}
+		j = index->slot[i].hash & (noslot - 1);
+		while(slot[j].elem != NULL) {
+			j = (j + 1) & (noslot - 1);
+		}
+		slot[j] = index->slot[i];
+	}
+
+	free(index->slot);
+	index->slot = slot;
+	index->mask = noslot - 1;
+
+	return(0);
+}
+
+
+/**********************************************************************
+ * __vanessa_list_index_reserve
+ * Make sure there is room in the index of a list for more elements
+ * pre: index: index
+ *      n: number of elements to make room for
+ * post: index is grown if it would be more than 3/4 full
+ * return: 0 on success
+ *         -1 on error
+ **********************************************************************/
+
+static int __vanessa_list_index_reserve(vanessa_list_index_t *index,
+		size_t n)
+{
+	size_t noslot = index->mask + 1;
+
+	while((index->count + n) * 4 > noslot * 3) {
+		noslot *= 2;
+	}
+	if(noslot == index->mask + 1) {
+		return(0);
+	}
+
+	return(__vanessa_list_index_resize(index, noslot));
+}
+
+
+/**********************************************************************
+ * __vanessa_list_index_insert
+ * Add an element to the index of a list
+ * pre: index: index with room for another element
+ *      e: element
+ * post: e is in the index
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_list_index_insert(vanessa_list_index_t *index,
+		vanessa_list_elem_t *e)
+{
+	size_t hash;
+	size_t i;
+
+	hash = index->e_hash(e->value);
+	for(i = hash & index->mask; index->slot[i].elem != NULL;
+			i = (i + 1) & index->mask) {
+		;
+	}
+
+	index->slot[i].hash = hash;
+	index->slot[i].elem = e;
+	index->count++;
+}
+
+
+/**********************************************************************
+ * __vanessa_list_index_remove
+ * Remove an element from the index of a list
+ * Entries after it in its probe sequence are shifted back, so that
+ * no deleted markers are needed.
+ * pre: index: index
+ *      e: element in index
+ * post: e is not in the index, which may be shrunk
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_list_index_remove(vanessa_list_index_t *index,
+		vanessa_list_elem_t *e)
+{
+	size_t i;
+	size_t j;
+	size_t k;
+
+	for(i = index->e_hash(e->value) & index->mask;
+			index->slot[i].elem != e; i = (i + 1) & index->mask) {
+		;
+	}
+
+	for(j = (i + 1) & index->mask; index->slot[j].elem != NULL;
+			j = (j + 1) & index->mask) {
+		/* Move j back to i unless its home slot k is in (i, j] */
+		k = index->slot[j].hash & index->mask;
+		if((j > i && (k <= i || k > j)) ||
+				(j < i && k <= i && k > j)) {
+			index->slot[i] = index->slot[j];
+			i = j;
+		}
+	}
+	index->slot[i].elem = NULL;
+	index->count--;
+
+	/* Failing to shrink is harmless */
+	if(index->mask + 1 > LIST_INDEX_MINSLOT &&
+			index->count * 8 < index->mask + 1) {
+		__vanessa_list_index_resize(index, (index->mask + 1) / 2);
+	}
+}
+
+
+/**********************************************************************
+ * __vanessa_list_index_rebuild
+ * Index all the elements of a list afresh
+ * pre: l: list with an index with room for its elements, whose
+ *         entries may refer to elements that have been freed
+ * post: index refers to each element of l
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_list_index_rebuild(vanessa_list_t *l)
+{
+	vanessa_list_elem_t *e;
+
+	memset(l->index->slot, 0, (l->index->mask + 1) *
+			sizeof(vanessa_list_index_slot_t));
+	l->index->count = 0;
+	for(e = l->first; e != NULL; e = e->next) {
+		__vanessa_list_index_insert(l->index, e);
+	}
+}
+
+
+/**********************************************************************
+ * __vanessa_list_index_find
+ * Find an element in the index of a list by key
+ * pre: l: list with an index
+ *      key: key to match
+ *      match: function to match elements with key
+ * post: none
+ * return: an element matching key
+ *         NULL if there is none
+ **********************************************************************/
+
+static vanessa_list_elem_t *__vanessa_list_index_find(vanessa_list_t *l,
+		void *key, int (*match)(void *value, void *key))
+{
+	vanessa_list_index_t *index = l->index;
+	vanessa_list_elem_t *e;
+	size_t hash;
+	size_t i;
+
+	hash = index->e_hash(key);
+	for(i = hash & index->mask; (e = index->slot[i].elem) != NULL;
+			i = (i + 1) & index->mask) {
+		if(index->slot[i].hash == hash && match(e->value, key) == 0) {
+			return(e);
+		}
+	}
+
+	return(NULL);
+}
+
+
 /**********************************************************************
  * vanessa_list_get_element
  * Find an element in the list by key using the element_match function
  * passed to vanessa_list_create
+ * If VANESSA_LIST_SKIP is set this is O(log n) but key must also be
+ * suitable for comparing with elements using element_sort.
+ * If the list has an index, see vanessa_list_set_index, this is O(1).
  * pre: l: list to search
  *      key: key to match
  * post: none
@@ -392,6 +910,10 @@ static vanessa_list_elem_t *__vanessa_list_get_element(vanessa_list_t *l,
 
 	match=(l->e_match != NULL)?l->e_match:__vanessa_list_get_element_match;
 
+	if(l->index != NULL) {
+		return(__vanessa_list_index_find(l, key, match));
+	}
+
 	for(i=0 ; i < l->norecent ; i++) {
 		e = *(l->recent + i);
 		if(e != NULL && match(e->value, key) == 0) {
@@ -399,6 +921,19 @@ static vanessa_list_elem_t *__vanessa_list_get_element(vanessa_list_t *l,
 		}
 	}
 
+	if(l->flag & VANESSA_LIST_SKIP && !(l->flag & VANESSA_LIST_BULK)) {
+		e = __vanessa_list_skip_find(l, key, 0, NULL);
+		for(e = e ? e->next : l->first; e != NULL; e = e->next) {
+			if(l->e_sort(e->value, key) != 0) {
+				return(NULL);
+			}
+			if(match(e->value, key) == 0) {
+				return(e);
+			}
+		}
+		return(NULL);
+	}
+
 	for(e = l->first; e != NULL ; e = e->next ) {
 		if(match(e->value, key) == 0) {
 			break;
@@ -441,23 +976,16 @@ void *vanessa_list_get_element(vanessa_list_t *l, void *key) {
  * Count the number of elements in the list
  * pre: l: list to count
  * post: none
- * return: number of elements in the list
+ * return: number of elements in the list, O(1)
  *         0 if l is NULL
  **********************************************************************/
 
 size_t vanessa_list_get_count(vanessa_list_t *l){
-	size_t count = 0;
-	vanessa_list_elem_t *e;
-
 	if (l == NULL) {
 		return(0);
 	}
 
-	for(e = l->first; e != NULL ; e = e->next ) {
-		count++;
-	}
-
-	return(count);
+	return(l->count);
 }
 
 
@@ -467,9 +995,11 @@ size_t vanessa_list_get_count(vanessa_list_t *l){
  * pre: l: list to insert value into
  *      value: value to insert
  * post: value is inserted into the list
- *       if element_sort passed to vanessa_list_create is non-NULL
- *       then the element will be inserted in order. Otherwise
- *       the element will be inserted at the begining of the list.
+ *       if VANESSA_LIST_BULK is set the element is appended to the
+ *       end of the list. Otherwise if element_sort passed to
+ *       vanessa_list_create is non-NULL then the element will be
+ *       inserted in order, or else the element will be inserted at
+ *       the begining of the list.
  * return: NULL if l is NULL
  *         l, unchanged if value is null
  **********************************************************************/
@@ -478,14 +1008,36 @@ vanessa_list_t *vanessa_list_add_element(vanessa_list_t * l, void *value)
 {
 	vanessa_list_elem_t *e;
 	vanessa_list_elem_t *prev;
+	vanessa_list_elem_t *update[LIST_SKIP_MAXLEVEL];
+	vanessa_list_tower_t *tower = NULL;
 
 	if(l == NULL) {
 		return(NULL);
 	}
 
-	if(l->e_sort == NULL) {
+	if(l->index != NULL && __vanessa_list_index_reserve(l->index, 1) < 0) {
+		vanessa_list_destroy(l);
+		return(NULL);
+	}
+
+	if(l->flag & VANESSA_LIST_BULK) {
+		prev = l->last;
+		if(l->skip != NULL &&
+				__vanessa_list_skip_tower_create(l, &tower) < 0) {
+			vanessa_list_destroy(l);
+			return(NULL);
+		}
+	}
+	else if(l->e_sort == NULL) {
 		prev = l->first;
 	}
+	else if(l->flag & VANESSA_LIST_SKIP) {
+		prev = __vanessa_list_skip_find(l, value, 1, update);
+		if(__vanessa_list_skip_tower_create(l, &tower) < 0) {
+			vanessa_list_destroy(l);
+			return(NULL);
+		}
+	}
 	else {
 		for(prev = l->last ; prev != NULL ; prev = prev->prev) {
 			if(l->e_sort(value, prev->value) >= 0) {
@@ -495,9 +1047,10 @@ vanessa_list_t *vanessa_list_add_element(vanessa_list_t * l, void *value)
 	}
 	
 	e = vanessa_list_elem_create(prev, (prev==NULL)?NULL:prev->next, 
-			value, l->e_duplicate);
+			value, l->e_duplicate, l->pool);
 	if (e == NULL) {
 		VANESSA_LOGGER_DEBUG_ERRNO("vanessa_list_elem_create");
+		free(tower);
 		vanessa_list_destroy(l);
 		return (NULL);
 	}
@@ -519,34 +1072,42 @@ vanessa_list_t *vanessa_list_add_element(vanessa_list_t * l, void *value)
 		l->first = e;
 	}
 
+	if(tower != NULL) {
+		e->tower = tower;
+		/* Linked when the bulk load is sorted */
+		if(!(l->flag & VANESSA_LIST_BULK)) {
+			__vanessa_list_skip_link(l, e, update);
+		}
+	}
+
+	if(l->index != NULL) {
+		__vanessa_list_index_insert(l->index, e);
+	}
+
 	if(l->norecent > 0) {
 		l->recent_offset = (l->recent_offset + 1) % l->norecent;
 		*(l->recent + l->recent_offset) = e;
 	}
+	l->count++;
 
 	return (l);
 }
 
 
 /**********************************************************************
- * vanessa_list_remove_element
- * Insert element into a list
- * pre: l: list to insert value into
- *      value: value to insert
- * post: value is removed from the list
- * return: NULL if l is NULL
- *         l, unchanged if value is null
+ * __vanessa_list_unlink
+ * Unlink an element from a list, without destroying it
+ * pre: l: list
+ *      e: element in l
+ * post: e is not in the list, its recent cache, skip list or index
+ *       e->next and e->prev are unchanged
+ * return: none
  **********************************************************************/
 
-static void __vanessa_list_remove_element(vanessa_list_t * l, 
-		vanessa_list_elem_t *e)
+static void __vanessa_list_unlink(vanessa_list_t *l, vanessa_list_elem_t *e)
 {
 	int i;
 
-	if(l == NULL || e == NULL) {
-		return;
-	}
-
 	if (l->first == e) {
 		l->first = e->next;
 	}
@@ -567,30 +1128,112 @@ static void __vanessa_list_remove_element(vanessa_list_t * l,
 		}
 	}
 
-	vanessa_list_elem_destroy(e, l->e_destroy);
-}
+	if(l->skip != NULL) {
+		__vanessa_list_skip_unlink(l, e);
+	}
 
-void vanessa_list_remove_element(vanessa_list_t *l, void *key) {
-	vanessa_list_elem_t *e;
+	if(l->index != NULL) {
+		__vanessa_list_index_remove(l->index, e);
+	}
 
-	e = __vanessa_list_get_element(l, key);
-	__vanessa_list_remove_element(l, e);
+	l->count--;
 }
 
 
 /**********************************************************************
- * vanessa_list_duplicate
- * Duplicate a list
+ * vanessa_list_remove_element
+ * Insert element into a list
+ * pre: l: list to insert value into
+ *      value: value to insert
+ * post: value is removed from the list
+ * return: NULL if l is NULL
+ *         l, unchanged if value is null
+ **********************************************************************/
+
+static void __vanessa_list_remove_element(vanessa_list_t * l, 
+		vanessa_list_elem_t *e)
+{
+	if(l == NULL || e == NULL) {
+		return;
+	}
+
+	__vanessa_list_unlink(l, e);
+	vanessa_list_elem_destroy(e, l->e_destroy, l->pool);
+}
+
+void vanessa_list_remove_element(vanessa_list_t *l, void *key) {
+	vanessa_list_elem_t *e;
+
+	e = __vanessa_list_get_element(l, key);
+	__vanessa_list_remove_element(l, e);
+}
+
+
+/**********************************************************************
+ * vanessa_list_duplicate
+ * Duplicate a list
  * pre: l: list to duplicate
- * post: list is duplicated
+ * post: list is duplicated, in the same order, in O(n)
+ *       Elements of the new list are allocated from the pool of l,
+ *       if it has one. Otherwise, if l has at least 64 elements,
+ *       the new list is given a pool of its own, so that its
+ *       elements are allocated a slab at a time rather than one
+ *       by one.
  * return: NULL if l is NULL or on error
  *         duplicated list 
  **********************************************************************/
 
 vanessa_list_t *vanessa_list_duplicate(vanessa_list_t *l) {
+	vanessa_list_t *new_list;
+	vanessa_pool_t *pool;
+
+	if(l==NULL) {
+		return(NULL);
+	}
+
+	if(l->pool != NULL || l->count < LIST_DUPLICATE_MINPOOL) {
+		return(vanessa_list_duplicate_pool(l, l->pool));
+	}
+
+	pool = vanessa_list_pool_create(VANESSA_POOL_RELEASE);
+	if(pool == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_list_pool_create");
+		return(NULL);
+	}
+
+	new_list = vanessa_list_duplicate_pool(l, pool);
+
+	/* The new list, if any, holds a reference to the pool */
+	vanessa_pool_destroy(pool);
+
+	return(new_list);
+}
+
+
+/**********************************************************************
+ * vanessa_list_duplicate_pool
+ * Duplicate a list, allocating its elements from a given pool
+ * pre: l: list to duplicate
+ *      pool: pool created by vanessa_list_pool_create, which may be
+ *            shared with other lists. NULL to allocate elements
+ *            using malloc.
+ * post: list is duplicated, in the same order, in O(n)
+ *       Elements are copied rather than inserted, so element_sort
+ *       is not called, and the skip list and index of l, if any, are
+ *       built once the copy is complete. A copy of a list that is
+ *       being bulk loaded is too, and is sorted when
+ *       VANESSA_LIST_BULK is cleared.
+ * return: NULL if l is NULL or on error
+ *         duplicated list
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_duplicate_pool(vanessa_list_t *l,
+		vanessa_pool_t *pool)
+{
 	vanessa_list_t *new_list;
 	vanessa_list_elem_t *e;
-	
+	vanessa_list_elem_t *new_e;
+
 	if(l==NULL) {
 		return(NULL);
 	}
@@ -602,10 +1245,37 @@ vanessa_list_t *vanessa_list_duplicate(vanessa_list_t *l) {
 		VANESSA_LOGGER_DEBUG("vanessa_list_create");
 		return(NULL);
 	}
+	new_list->pool = vanessa_pool_ref(pool);
+
+	for(e=l->first; e!=NULL; e=e->next) {
+		new_e = vanessa_list_elem_create(new_list->last, NULL,
+				e->value, l->e_duplicate, pool);
+		if(new_e == NULL) {
+			VANESSA_LOGGER_DEBUG("vanessa_list_elem_create");
+			vanessa_list_destroy(new_list);
+			return(NULL);
+		}
+		if(new_list->last != NULL) {
+			new_list->last->next = new_e;
+		}
+		else {
+			new_list->first = new_e;
+		}
+		new_list->last = new_e;
+		new_list->count++;
+	}
 
-
-	for(e=l->last; e!=NULL; e=e->prev) {
-		vanessa_list_add_element(new_list, e->value);
+	if(vanessa_list_set_flag(new_list, l->flag) == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_list_set_flag");
+		vanessa_list_destroy(new_list);
+		return(NULL);
+	}
+	if(l->index != NULL &&
+			vanessa_list_set_index(new_list,
+				l->index->e_hash) == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_list_set_index");
+		vanessa_list_destroy(new_list);
+		return(NULL);
 	}
 
 	return(new_list);
@@ -642,3 +1312,1001 @@ int vanessa_list_iterate(vanessa_list_t *l, int(* action)(void *e, void *data),
 
 	return(0);
 }
+
+
+/**********************************************************************
+ * vanessa_list_first
+ * Get the first element of a list
+ * Elements may be used as cursors, to walk a list and change it
+ * as it is walked, and as handles, to remove or move elements without
+ * searching for them. An element remains valid until it is removed
+ * from its list or the list is destroyed, or vanessa_list_set_pool is
+ * called.
+ * pre: l: list
+ * post: none
+ * return: first element of l
+ *         NULL if l is NULL or empty
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_first(vanessa_list_t *l)
+{
+	if(l == NULL) {
+		return(NULL);
+	}
+
+	return(l->first);
+}
+
+
+/**********************************************************************
+ * vanessa_list_last
+ * Get the last element of a list
+ * pre: l: list
+ * post: none
+ * return: last element of l
+ *         NULL if l is NULL or empty
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_last(vanessa_list_t *l)
+{
+	if(l == NULL) {
+		return(NULL);
+	}
+
+	return(l->last);
+}
+
+
+/**********************************************************************
+ * vanessa_list_next
+ * Get the element after an element of a list
+ * pre: e: element
+ * post: none
+ * return: element after e
+ *         NULL if e is NULL or the last element
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_next(vanessa_list_elem_t *e)
+{
+	if(e == NULL) {
+		return(NULL);
+	}
+
+	return(e->next);
+}
+
+
+/**********************************************************************
+ * vanessa_list_prev
+ * Get the element before an element of a list
+ * pre: e: element
+ * post: none
+ * return: element before e
+ *         NULL if e is NULL or the first element
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_prev(vanessa_list_elem_t *e)
+{
+	if(e == NULL) {
+		return(NULL);
+	}
+
+	return(e->prev);
+}
+
+
+/**********************************************************************
+ * vanessa_list_elem_value
+ * Get the value of an element of a list
+ * pre: e: element
+ * post: none
+ * return: value of e
+ *         NULL if e is NULL
+ **********************************************************************/
+
+void *vanessa_list_elem_value(vanessa_list_elem_t *e)
+{
+	if(e == NULL) {
+		return(NULL);
+	}
+
+	return(e->value);
+}
+
+
+/**********************************************************************
+ * vanessa_list_get_elem
+ * Find an element in the list by key, as for vanessa_list_get_element
+ * pre: l: list to search
+ *      key: key to match
+ * post: none
+ * return: element whose value matches key
+ *         NULL if l or key is NULL or if no value matches key
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_get_elem(vanessa_list_t *l, void *key)
+{
+	return(__vanessa_list_get_element(l, key));
+}
+
+
+/**********************************************************************
+ * __vanessa_list_link_before
+ * Link an element into a list
+ * pre: l: list, with room in its index if it has one
+ *      pos: element of l to link e before, NULL for the end of l
+ *      e: element that is not in a list, without a tower
+ * post: e is in l before pos, and in its index
+ *       e is not in the skip list above the list, if there is one,
+ *       which is correct, if slower, as long as order is kept
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_list_link_before(vanessa_list_t *l,
+		vanessa_list_elem_t *pos, vanessa_list_elem_t *e)
+{
+	e->next = pos;
+	e->prev = pos ? pos->prev : l->last;
+	if(e->prev != NULL) {
+		e->prev->next = e;
+	}
+	else {
+		l->first = e;
+	}
+	if(pos != NULL) {
+		pos->prev = e;
+	}
+	else {
+		l->last = e;
+	}
+
+	if(l->index != NULL) {
+		__vanessa_list_index_insert(l->index, e);
+	}
+
+	l->count++;
+}
+
+
+/**********************************************************************
+ * vanessa_list_insert_before
+ * Insert a value into a list at a given position, in O(1)
+ * The position is used even if the list has element_sort, so it is
+ * up to the caller to keep a sorted list in order.
+ * pre: l: list
+ *      pos: element of l to insert before, NULL to append to l
+ *      value: value to insert, duplicated if element_duplicate passed
+ *             to vanessa_list_create is non-NULL
+ * post: value is inserted before pos
+ * return: element holding value
+ *         NULL if l or value is NULL or on error, in which case l is
+ *         unchanged
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_insert_before(vanessa_list_t *l,
+		vanessa_list_elem_t *pos, void *value)
+{
+	vanessa_list_elem_t *e;
+
+	if(l == NULL || value == NULL) {
+		return(NULL);
+	}
+
+	if(l->index != NULL && __vanessa_list_index_reserve(l->index, 1) < 0) {
+		return(NULL);
+	}
+
+	e = vanessa_list_elem_create(NULL, NULL, value, l->e_duplicate,
+			l->pool);
+	if(e == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_list_elem_create");
+		return(NULL);
+	}
+
+	__vanessa_list_link_before(l, pos, e);
+
+	return(e);
+}
+
+
+/**********************************************************************
+ * vanessa_list_remove_elem
+ * Remove an element from a list, in O(1) unless the list has a recent
+ * element cache, in which case it is O(norecent)
+ * pre: l: list
+ *      e: element of l, or one taken out of l with vanessa_list_unlink
+ * post: e is removed from l, unless it was unlinked, and destroyed,
+ *       along with its value if element_destroy was passed to
+ *       vanessa_list_create
+ * return: element that was after e, so that a list may be filtered
+ *         while it is walked
+ *         NULL if l or e is NULL, e was the last element or e had
+ *         been unlinked
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_remove_elem(vanessa_list_t *l,
+		vanessa_list_elem_t *e)
+{
+	vanessa_list_elem_t *next;
+
+	if(l == NULL || e == NULL) {
+		return(NULL);
+	}
+
+	/* An element taken out with vanessa_list_unlink is not in l */
+	if(e->next == NULL && e->prev == NULL && l->first != e) {
+		vanessa_list_elem_destroy(e, l->e_destroy, l->pool);
+		return(NULL);
+	}
+
+	next = e->next;
+	__vanessa_list_remove_element(l, e);
+
+	return(next);
+}
+
+
+/**********************************************************************
+ * vanessa_list_unlink
+ * Take an element out of a list without destroying it, so that it can
+ * be linked back in elsewhere with vanessa_list_link_before
+ * pre: l: list
+ *      e: element of l
+ * post: e is not in l, but it and its value remain allocated
+ *       e must be linked back into l, or removed from it with
+ *       vanessa_list_remove_elem, before l is destroyed
+ * return: element that was after e
+ *         NULL if l or e is NULL or e was the last element
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_unlink(vanessa_list_t *l,
+		vanessa_list_elem_t *e)
+{
+	vanessa_list_elem_t *next;
+
+	if(l == NULL || e == NULL) {
+		return(NULL);
+	}
+
+	next = e->next;
+	__vanessa_list_unlink(l, e);
+	e->next = NULL;
+	e->prev = NULL;
+
+	return(next);
+}
+
+
+/**********************************************************************
+ * vanessa_list_link_before
+ * Link an element taken out of a list with vanessa_list_unlink back
+ * into it, in O(1)
+ * As for vanessa_list_insert_before, the position is used even if the
+ * list has element_sort.
+ * pre: l: list e was unlinked from
+ *      pos: element of l to link e before, NULL to append to l
+ *      e: element unlinked from l
+ * post: e is in l before pos
+ * return: l
+ *         NULL if l or e is NULL or on error, in which case e is
+ *         still unlinked
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_link_before(vanessa_list_t *l,
+		vanessa_list_elem_t *pos, vanessa_list_elem_t *e)
+{
+	if(l == NULL || e == NULL) {
+		return(NULL);
+	}
+
+	if(l->index != NULL && __vanessa_list_index_reserve(l->index, 1) < 0) {
+		return(NULL);
+	}
+
+	__vanessa_list_link_before(l, pos, e);
+
+	return(l);
+}
+
+
+/**********************************************************************
+ * __vanessa_list_take_tail
+ * Take the elements from a given element to the end of a list out of
+ * it, as a chain that is ready to be added to another list
+ * pre: src: list
+ *      e: element of src
+ *      dst: list that the elements will be added to
+ * post: elements from e onwards are not in src, its recent cache,
+ *       skip list or index. They remain linked to each other, with
+ *       e->prev NULL. Their towers are freed unless dst has
+ *       VANESSA_LIST_SKIP set.
+ * return: number of elements taken
+ **********************************************************************/
+
+static size_t __vanessa_list_take_tail(vanessa_list_t *src,
+		vanessa_list_elem_t *e, vanessa_list_t *dst)
+{
+	vanessa_list_elem_t *x;
+	size_t n = 0;
+	int all;
+	int i;
+
+	all = (e == src->first);
+	if(all) {
+		src->first = NULL;
+		src->last = NULL;
+	}
+	else {
+		e->prev->next = NULL;
+		src->last = e->prev;
+		e->prev = NULL;
+	}
+
+	/*
+	 * Taking a whole list needs no walk, unless towers are to be
+	 * freed, so that vanessa_list_splice is O(1) for plain lists
+	 */
+	if(all) {
+		n = src->count;
+		x = (src->skip != NULL && dst->skip == NULL) ? e : NULL;
+	}
+	else {
+		x = e;
+	}
+
+	for(; x != NULL; x = x->next) {
+		if(!all) {
+			n++;
+			for(i = 0; i < src->norecent; i++) {
+				if(src->recent[i] == x) {
+					src->recent[i] = NULL;
+				}
+			}
+			if(src->index != NULL) {
+				__vanessa_list_index_remove(src->index, x);
+			}
+		}
+		if(dst->skip == NULL) {
+			free(x->tower);
+			x->tower = NULL;
+		}
+	}
+
+	if(all) {
+		for(i = 0; i < src->norecent; i++) {
+			src->recent[i] = NULL;
+		}
+		if(src->index != NULL) {
+			__vanessa_list_index_rebuild(src);
+		}
+	}
+	if(src->skip != NULL && !(src->flag & VANESSA_LIST_BULK)) {
+		__vanessa_list_skip_rebuild(src);
+	}
+	src->count -= n;
+
+	return(n);
+}
+
+
+/**********************************************************************
+ * __vanessa_list_give
+ * Account for elements taken from another list
+ * pre: dst: list with room in its index, if it has one, for n more
+ *           elements
+ *      e: first of a chain of n elements returned by
+ *         __vanessa_list_take_tail
+ *      n: number of elements in the chain
+ * post: elements are in the index of dst and counted
+ *       They still need to be linked into the list itself, after
+ *       which the skip list of dst must be rebuilt, if it has one.
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_list_give(vanessa_list_t *dst, vanessa_list_elem_t *e,
+		size_t n)
+{
+	if(dst->index != NULL) {
+		for(; e != NULL; e = e->next) {
+			__vanessa_list_index_insert(dst->index, e);
+		}
+	}
+
+	dst->count += n;
+}
+
+
+/**********************************************************************
+ * __vanessa_list_compatible
+ * Check if elements may be moved from one list to another
+ * pre: dst: list
+ *      src: list
+ * post: none
+ * return: 0 if dst and src are distinct and allocate elements from
+ *           the same pool, and dst has room in its index for the
+ *           elements of src
+ *         -1 otherwise
+ **********************************************************************/
+
+static int __vanessa_list_compatible(vanessa_list_t *dst,
+		vanessa_list_t *src)
+{
+	if(dst == NULL || src == NULL || dst == src) {
+		return(-1);
+	}
+
+	if(dst->pool != src->pool) {
+		VANESSA_LOGGER_DEBUG("lists use different pools");
+		return(-1);
+	}
+
+	if(dst->index != NULL &&
+			__vanessa_list_index_reserve(dst->index,
+				src->count) < 0) {
+		return(-1);
+	}
+
+	return(0);
+}
+
+
+/**********************************************************************
+ * vanessa_list_splice
+ * Move all the elements of one list to the end of another
+ * The lists should have the same element functions, and if dst is
+ * sorted it is up to the caller to keep it in order.
+ * pre: dst: list to move elements to
+ *      src: list to move elements from
+ * post: elements of src are at the end of dst, in order, and src is
+ *       empty. Nothing is allocated or freed, other than to grow the
+ *       index of dst. O(1), unless either list has an index or
+ *       VANESSA_LIST_SKIP set.
+ * return: dst
+ *         NULL if dst or src is NULL, dst and src are the same list,
+ *         they use different pools, or on error. In which case
+ *         neither list is changed.
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_splice(vanessa_list_t *dst, vanessa_list_t *src)
+{
+	vanessa_list_elem_t *e;
+	vanessa_list_elem_t *last;
+	size_t n;
+
+	if(__vanessa_list_compatible(dst, src) < 0) {
+		return(NULL);
+	}
+
+	e = src->first;
+	if(e == NULL) {
+		return(dst);
+	}
+
+	last = src->last;
+	n = __vanessa_list_take_tail(src, e, dst);
+	__vanessa_list_give(dst, e, n);
+
+	e->prev = dst->last;
+	if(dst->last != NULL) {
+		dst->last->next = e;
+	}
+	else {
+		dst->first = e;
+	}
+	dst->last = last;
+
+	if(dst->skip != NULL && !(dst->flag & VANESSA_LIST_BULK)) {
+		__vanessa_list_skip_rebuild(dst);
+	}
+
+	return(dst);
+}
+
+
+/**********************************************************************
+ * vanessa_list_merge
+ * Merge the elements of one sorted list into another
+ * pre: dst: sorted list to move elements to
+ *      src: sorted list to move elements from
+ * post: elements of src are in dst, which is sorted using the
+ *       element_sort function passed to vanessa_list_create for dst.
+ *       Equal elements of dst come before those of src. src is empty.
+ *       O(n + m). Nothing is allocated or freed, other than to grow
+ *       the index of dst.
+ * return: dst
+ *         NULL if dst or src is NULL, dst has no element_sort, dst and
+ *         src are the same list, they use different pools, or on
+ *         error. In which case neither list is changed.
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_merge(vanessa_list_t *dst, vanessa_list_t *src)
+{
+	vanessa_list_elem_t *p;
+	vanessa_list_elem_t *q;
+	vanessa_list_elem_t *e;
+	vanessa_list_elem_t *tail = NULL;
+	size_t n;
+
+	if(dst == NULL || dst->e_sort == NULL ||
+			__vanessa_list_compatible(dst, src) < 0) {
+		return(NULL);
+	}
+
+	q = src->first;
+	if(q == NULL) {
+		return(dst);
+	}
+
+	n = __vanessa_list_take_tail(src, q, dst);
+	__vanessa_list_give(dst, q, n);
+
+	p = dst->first;
+	dst->first = NULL;
+	while(p != NULL || q != NULL) {
+		if(q == NULL || (p != NULL &&
+				dst->e_sort(p->value, q->value) <= 0)) {
+			e = p;
+			p = p->next;
+		}
+		else {
+			e = q;
+			q = q->next;
+		}
+
+		e->prev = tail;
+		if(tail != NULL) {
+			tail->next = e;
+		}
+		else {
+			dst->first = e;
+		}
+		tail = e;
+	}
+	tail->next = NULL;
+	dst->last = tail;
+
+	if(dst->skip != NULL && !(dst->flag & VANESSA_LIST_BULK)) {
+		__vanessa_list_skip_rebuild(dst);
+	}
+
+	return(dst);
+}
+
+
+/**********************************************************************
+ * vanessa_list_split
+ * Split a list in two at an element
+ * pre: l: list to split
+ *      e: element of l, the first to move to the new list
+ *         NULL to create an empty list
+ * post: e and the elements after it are moved, in order, to a new
+ *       list with the same element functions, flags, pool and index
+ *       as l. O(k) in the number of elements moved, unless l has
+ *       VANESSA_LIST_SKIP set.
+ * return: new list
+ *         NULL if l is NULL or on error, in which case l is unchanged
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_split(vanessa_list_t *l, vanessa_list_elem_t *e)
+{
+	vanessa_list_t *new_list;
+	vanessa_list_elem_t *x;
+	vanessa_list_elem_t *last;
+	size_t n = 0;
+
+	if(l == NULL) {
+		return(NULL);
+	}
+
+	new_list = vanessa_list_create(l->norecent, l->e_destroy,
+			l->e_duplicate, l->e_display,
+			l->e_length, l->e_match, l->e_sort);
+	if(new_list == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_list_create");
+		return(NULL);
+	}
+	new_list->pool = vanessa_pool_ref(l->pool);
+	if(vanessa_list_set_flag(new_list, l->flag) == NULL ||
+			(l->index != NULL &&
+			 vanessa_list_set_index(new_list,
+				 l->index->e_hash) == NULL)) {
+		VANESSA_LOGGER_DEBUG("vanessa_list_set_flag");
+		vanessa_list_destroy(new_list);
+		return(NULL);
+	}
+
+	if(e == NULL) {
+		return(new_list);
+	}
+
+	for(x = e; x != NULL; x = x->next) {
+		n++;
+	}
+	if(new_list->index != NULL &&
+			__vanessa_list_index_reserve(new_list->index, n) < 0) {
+		vanessa_list_destroy(new_list);
+		return(NULL);
+	}
+
+	last = l->last;
+	__vanessa_list_take_tail(l, e, new_list);
+	__vanessa_list_give(new_list, e, n);
+	new_list->first = e;
+	new_list->last = last;
+
+	if(new_list->skip != NULL && !(new_list->flag & VANESSA_LIST_BULK)) {
+		__vanessa_list_skip_rebuild(new_list);
+	}
+
+	return(new_list);
+}
+
+
+/**********************************************************************
+ * vanessa_list_pool_create
+ * Create a pool for list elements
+ * pre: flag: flag passed to vanessa_pool_create,
+ *            VANESSA_POOL_RELEASE to free empty slabs
+ * post: pool is allocated
+ * return: pool suitable for use with vanessa_list_set_pool
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_pool_t *vanessa_list_pool_create(vanessa_adt_flag_t flag)
+{
+	return(vanessa_pool_create(sizeof(vanessa_list_elem_t), flag));
+}
+
+
+/**********************************************************************
+ * vanessa_list_set_pool
+ * Allocate the elements of a list from a pool
+ * pre: l: list
+ *      pool: pool created by vanessa_list_pool_create, which may be
+ *            shared with other lists. NULL to allocate elements
+ *            using malloc.
+ * post: l takes a reference to pool and drops its reference to
+ *       any pool it was previously using. Existing elements are
+ *       moved to the new pool, in order, so their values are
+ *       unchanged but they are contiguous in memory.
+ * return: l on success
+ *         NULL if l is NULL or on error, in which case l is unchanged
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_set_pool(vanessa_list_t *l, vanessa_pool_t *pool)
+{
+	vanessa_list_elem_t *e;
+	vanessa_list_elem_t *new_e;
+	vanessa_list_elem_t *first = NULL;
+	vanessa_list_elem_t *last = NULL;
+	int i;
+
+	if(l == NULL) {
+		return(NULL);
+	}
+
+	/* Copy the elements, so l is untouched if allocation fails */
+	for(e = l->first; e != NULL; e = e->next) {
+		new_e = vanessa_list_elem_create(last, NULL, e->value, NULL,
+				pool);
+		if(new_e == NULL) {
+			VANESSA_LOGGER_DEBUG("vanessa_list_elem_create");
+			for(; first != NULL; first = new_e) {
+				new_e = first->next;
+				vanessa_list_elem_destroy(first, NULL, pool);
+			}
+			return(NULL);
+		}
+		if(last != NULL) {
+			last->next = new_e;
+		}
+		else {
+			first = new_e;
+		}
+		last = new_e;
+	}
+
+	for(e = l->first, new_e = first; e != NULL; e = l->first) {
+		for(i = 0; i < l->norecent; i++) {
+			if(l->recent[i] == e) {
+				l->recent[i] = new_e;
+			}
+		}
+		new_e->tower = e->tower;
+		l->first = e->next;
+		vanessa_list_elem_destroy(e, NULL, l->pool);
+		new_e = new_e->next;
+	}
+
+	vanessa_pool_destroy(l->pool);
+	l->pool = vanessa_pool_ref(pool);
+	l->first = first;
+	l->last = last;
+	if(l->skip != NULL) {
+		__vanessa_list_skip_rebuild(l);
+	}
+	if(l->index != NULL) {
+		__vanessa_list_index_rebuild(l);
+	}
+
+	return(l);
+}
+
+
+/**********************************************************************
+ * vanessa_list_set_index
+ * Index the elements of a list by hash
+ * pre: l: list
+ *      element_hash: Pointer to a function that returns a hash of an
+ *                    element. It is also passed the keys given to
+ *                    vanessa_list_get_element and
+ *                    vanessa_list_remove_element, and must return the
+ *                    same hash for a key as for the elements that
+ *                    match it. NULL to drop the index.
+ * post: l keeps a hash table of its elements, so that
+ *       vanessa_list_get_element and vanessa_list_remove_element are
+ *       O(1) and the recently accessed element cache is not used.
+ *       The order of the list is unchanged. If more than one element
+ *       matches a key it is not defined which is found. Adds about
+ *       three to five pointers per element.
+ * return: l on success
+ *         NULL if l is NULL or on error, in which case l is unchanged
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_set_index(vanessa_list_t *l,
+		size_t (*element_hash)(void *e))
+{
+	vanessa_list_index_t *index;
+	size_t noslot = LIST_INDEX_MINSLOT;
+
+	if(l == NULL) {
+		return(NULL);
+	}
+
+	if(element_hash == NULL) {
+		if(l->index != NULL) {
+			free(l->index->slot);
+			free(l->index);
+			l->index = NULL;
+		}
+		return(l);
+	}
+
+	while(l->count * 4 > noslot * 3) {
+		noslot *= 2;
+	}
+
+	index = (vanessa_list_index_t *)malloc(sizeof(vanessa_list_index_t));
+	if(index == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+	index->e_hash = element_hash;
+	index->mask = 0;
+	index->count = 0;
+	index->slot = NULL;
+	if(__vanessa_list_index_resize(index, noslot) < 0) {
+		free(index);
+		return(NULL);
+	}
+
+	vanessa_list_set_index(l, NULL);
+	l->index = index;
+	__vanessa_list_index_rebuild(l);
+
+	return(l);
+}
+
+
+/**********************************************************************
+ * vanessa_list_set_flag
+ * Set flags that change how a list is stored
+ * pre: l: list
+ *      flag: flags to set, may be ored together
+ *            VANESSA_LIST_SKIP: Keep a skip list over the elements of
+ *            a sorted list, so that vanessa_list_add_element,
+ *            vanessa_list_get_element and vanessa_list_remove_element
+ *            are O(log n) rather than O(n). Requires element_sort and
+ *            that keys passed to vanessa_list_get_element and
+ *            vanessa_list_remove_element can be compared to elements
+ *            using it. Adds about 1/3 of a pointer pair per element.
+ *            VANESSA_LIST_BULK: Append elements added with
+ *            vanessa_list_add_element to the end of the list, without
+ *            ordering them, until the flag is cleared, at which time
+ *            a sorted list is sorted. Loads a large sorted list in
+ *            O(n log n). Lookups do not use the skip list meanwhile.
+ * post: flags are set, existing elements are indexed as needed
+ * return: l on success
+ *         NULL if l is NULL or on error, in which case l is unchanged
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_set_flag(vanessa_list_t *l,
+		vanessa_adt_flag_t flag)
+{
+	vanessa_list_elem_t *e;
+
+	if(l == NULL) {
+		return(NULL);
+	}
+
+	if(flag & VANESSA_LIST_SKIP && !(l->flag & VANESSA_LIST_SKIP)) {
+		if(l->e_sort == NULL) {
+			VANESSA_LOGGER_DEBUG("VANESSA_LIST_SKIP requires "
+					"element_sort");
+			return(NULL);
+		}
+		l->skip = (vanessa_list_skip_t *)
+			malloc(sizeof(vanessa_list_skip_t));
+		if(l->skip == NULL) {
+			VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+			return(NULL);
+		}
+		l->skip->seed = 0x9e3779b9;
+		for(e = l->first; e != NULL; e = e->next) {
+			if(__vanessa_list_skip_tower_create(l,
+						&e->tower) < 0) {
+				l->flag |= VANESSA_LIST_SKIP;
+				vanessa_list_clear_flag(l, VANESSA_LIST_SKIP);
+				return(NULL);
+			}
+		}
+		__vanessa_list_skip_rebuild(l);
+	}
+
+	l->flag |= flag;
+
+	return(l);
+}
+
+
+/**********************************************************************
+ * vanessa_list_clear_flag
+ * Clear flags set by vanessa_list_set_flag
+ * pre: l: list
+ *      flag: flags to clear, may be ored together
+ * post: flags are cleared and any index they required is freed
+ *       Clearing VANESSA_LIST_BULK sorts the list if element_sort is
+ *       non-NULL.
+ * return: l
+ *         NULL if l is NULL
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_clear_flag(vanessa_list_t *l,
+		vanessa_adt_flag_t flag)
+{
+	vanessa_list_elem_t *e;
+
+	if(l == NULL) {
+		return(NULL);
+	}
+
+	if(flag & VANESSA_LIST_SKIP && l->flag & VANESSA_LIST_SKIP) {
+		for(e = l->first; e != NULL; e = e->next) {
+			free(e->tower);
+			e->tower = NULL;
+		}
+		free(l->skip);
+		l->skip = NULL;
+	}
+
+	if(flag & VANESSA_LIST_BULK && l->flag & VANESSA_LIST_BULK) {
+		l->flag &= ~VANESSA_LIST_BULK;
+		if(l->e_sort != NULL) {
+			vanessa_list_sort(l);
+		}
+		if(l->skip != NULL) {
+			__vanessa_list_skip_rebuild(l);
+		}
+	}
+
+	l->flag &= ~flag;
+
+	return(l);
+}
+
+
+/**********************************************************************
+ * vanessa_list_sort
+ * Sort a list using the element_sort function passed to
+ * vanessa_list_create
+ * Bottom up merge sort of the list elements themselves, O(n log n)
+ * and O(n) if the list is already sorted. Stable, so equal elements
+ * keep their order, and nothing is allocated.
+ * pre: l: list to sort
+ * post: elements of l are in order
+ * return: l
+ *         NULL if l is NULL or element_sort is NULL
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_sort(vanessa_list_t *l)
+{
+	vanessa_list_elem_t *p;
+	vanessa_list_elem_t *q;
+	vanessa_list_elem_t *e;
+	vanessa_list_elem_t *first;
+	vanessa_list_elem_t *tail;
+	size_t insize;
+	size_t psize;
+	size_t qsize;
+	size_t nomerge;
+
+	if(l == NULL || l->e_sort == NULL) {
+		return(NULL);
+	}
+
+	for(e = l->first; e != NULL && e->next != NULL; e = e->next) {
+		if(l->e_sort(e->value, e->next->value) > 0) {
+			break;
+		}
+	}
+	if(e == NULL || e->next == NULL) {
+		return(l);
+	}
+
+	/*
+	 * Merge runs of insize elements pairwise, doubling insize on
+	 * each pass until a pass merges only once
+	 */
+	first = l->first;
+	tail = NULL;
+	for(insize = 1; ; insize *= 2) {
+		p = first;
+		first = NULL;
+		tail = NULL;
+		nomerge = 0;
+
+		while(p != NULL) {
+			nomerge++;
+			q = p;
+			for(psize = 0; psize < insize && q != NULL; psize++) {
+				q = q->next;
+			}
+			qsize = insize;
+
+			while(psize > 0 || (qsize > 0 && q != NULL)) {
+				if(psize == 0) {
+					e = q;
+					q = q->next;
+					qsize--;
+				}
+				else if(qsize == 0 || q == NULL ||
+						l->e_sort(p->value,
+							q->value) <= 0) {
+					e = p;
+					p = p->next;
+					psize--;
+				}
+				else {
+					e = q;
+					q = q->next;
+					qsize--;
+				}
+
+				if(tail != NULL) {
+					tail->next = e;
+				}
+				else {
+					first = e;
+				}
+				e->prev = tail;
+				tail = e;
+			}
+
+			p = q;
+		}
+		tail->next = NULL;
+
+		if(nomerge <= 1) {
+			break;
+		}
+	}
+
+	l->first = first;
+	l->last = tail;
+
+	if(l->skip != NULL) {
+		__vanessa_list_skip_rebuild(l);
+	}
+
+	return(l);
+}
@@ -0,0 +1,325 @@
+/**********************************************************************
+ * mpmc_queue.c                                            October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Lock-free bounded multiple producer, multiple consumer queue
+ *
+ * A ring of slots, each holding an element and a sequence number.
+ * A slot at position pos is free for a producer when its sequence
+ * number is pos, and holds an element for a consumer when it is
+ * pos + 1. Producers and consumers claim positions by advancing tail
+ * and head respectively with compare and swap, then hand the slot to
+ * the other side by storing the next sequence number with release
+ * semantics. Threads only contend on the index they share, and never
+ * wait for a thread on the other side other than to find the queue
+ * full or empty.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include "vanessa_adt.h"
+
+#define CACHE_LINE 64
+
+typedef struct {
+	size_t seq;
+	void *value;
+} vanessa_mpmc_queue_slot_t;
+
+struct vanessa_mpmc_queue_t_struct {
+	vanessa_mpmc_queue_slot_t *slot;
+	size_t mask;
+	void (*e_destroy) (const void *);
+	char pad0[CACHE_LINE];
+	size_t tail;
+	char pad1[CACHE_LINE];
+	size_t head;
+	char pad2[CACHE_LINE];
+};
+
+
+/**********************************************************************
+ * vanessa_mpmc_queue_create
+ * Create a new, empty multiple producer, multiple consumer queue
+ * pre: size: maximum number of elements in the queue, rounded up to a
+ *            power of two
+ *      e_destroy: pointer to a function to destroy elements of the
+ *                 queue, as for vanessa_queue_create. It is passed a
+ *                 pointer to the element. If NULL, then elements will
+ *                 not be freed on calls to vanessa_mpmc_queue_destroy
+ * post: memory is allocated for queue and values are initialised
+ *       Any number of threads may push and pop elements concurrently,
+ *       without locking.
+ * return: new, empty queue
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_mpmc_queue_t *vanessa_mpmc_queue_create(size_t size,
+		void (*e_destroy) (const void *))
+{
+	vanessa_mpmc_queue_t *q;
+	void *mem;
+	size_t noslot = 2;
+	size_t i;
+
+	if(size == 0) {
+		VANESSA_LOGGER_DEBUG("invalid argument");
+		return(NULL);
+	}
+	while(noslot < size) {
+		noslot <<= 1;
+	}
+
+	if(posix_memalign(&mem, CACHE_LINE,
+				sizeof(vanessa_mpmc_queue_t)) != 0) {
+		VANESSA_LOGGER_DEBUG("posix_memalign");
+		return(NULL);
+	}
+	q = (vanessa_mpmc_queue_t *)mem;
+
+	q->slot = (vanessa_mpmc_queue_slot_t *)
+		malloc(noslot * sizeof(vanessa_mpmc_queue_slot_t));
+	if(q->slot == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		free(q);
+		return(NULL);
+	}
+	for(i = 0; i < noslot; i++) {
+		q->slot[i].seq = i;
+		q->slot[i].value = NULL;
+	}
+
+	q->mask = noslot - 1;
+	q->e_destroy = e_destroy;
+	q->tail = 0;
+	q->head = 0;
+
+	return(q);
+}
+
+
+/**********************************************************************
+ * vanessa_mpmc_queue_destroy
+ * Destroy a multiple producer, multiple consumer queue, destroying
+ * each element present in the queue first
+ * pre: q: queue to destroy, which no thread is using
+ * post: queue and all elements in the queue are destroyed
+ * return: none
+ **********************************************************************/
+
+void vanessa_mpmc_queue_destroy(vanessa_mpmc_queue_t *q)
+{
+	size_t i;
+
+	if(q == NULL) {
+		return;
+	}
+
+	for(i = q->head; q->e_destroy != NULL && i != q->tail; i++) {
+		if(q->slot[i & q->mask].value != NULL) {
+			q->e_destroy(&q->slot[i & q->mask].value);
+		}
+	}
+
+	free(q->slot);
+	free(q);
+}
+
+
+/*
+ * Claim up to n consecutive positions from *index, each of whose
+ * slots must have the sequence number of the position plus offset:
+ * 0 for producers, 1 for consumers. Once a slot has the sequence
+ * number looked for it keeps it until whoever claims that position
+ * is done with it, so checking the slots and then advancing the
+ * index with a single compare and swap is enough to own all of them.
+ * Returns the number of positions claimed, the first being *pos.
+ */
+
+static size_t __vanessa_mpmc_queue_claim(vanessa_mpmc_queue_t *q,
+		size_t *index, size_t offset, size_t n, size_t *pos)
+{
+	size_t i;
+	ssize_t diff = 0;
+
+	if(n == 0) {
+		return(0);
+	}
+
+	*pos = __atomic_load_n(index, __ATOMIC_RELAXED);
+	while(1) {
+		for(i = 0; i < n && i <= q->mask; i++) {
+			diff = (ssize_t)(__atomic_load_n(
+					&q->slot[(*pos + i) & q->mask].seq,
+					__ATOMIC_ACQUIRE) - (*pos + i + offset));
+			if(diff != 0) {
+				break;
+			}
+		}
+
+		if(i == 0 && diff < 0) {
+			/* Full or empty */
+			return(0);
+		}
+		if(i == 0) {
+			/* Another thread claimed *pos, try again */
+			*pos = __atomic_load_n(index, __ATOMIC_RELAXED);
+			continue;
+		}
+
+		if(__atomic_compare_exchange_n(index, pos, *pos + i, 0,
+					__ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			return(i);
+		}
+		/* *pos now holds the current value of *index */
+	}
+}
+
+
+/**********************************************************************
+ * vanessa_mpmc_queue_try_push_n
+ * Push elements onto the end of a multiple producer, multiple
+ * consumer queue, without blocking
+ * pre: q: queue
+ *      value: elements to push
+ *      n: number of elements to push
+ * post: as many elements as there is room for, up to n, are added to
+ *       the queue. Elements pushed by one call are consecutive in the
+ *       queue.
+ * return: number of elements pushed, 0 if the queue is full
+ **********************************************************************/
+
+size_t vanessa_mpmc_queue_try_push_n(vanessa_mpmc_queue_t *q,
+		void **value, size_t n)
+{
+	vanessa_mpmc_queue_slot_t *slot;
+	size_t pos;
+	size_t i;
+
+	n = __vanessa_mpmc_queue_claim(q, &q->tail, 0, n, &pos);
+
+	for(i = 0; i < n; i++) {
+		slot = &q->slot[(pos + i) & q->mask];
+		slot->value = value[i];
+		__atomic_store_n(&slot->seq, pos + i + 1, __ATOMIC_RELEASE);
+	}
+
+	return(n);
+}
+
+
+/**********************************************************************
+ * vanessa_mpmc_queue_try_push
+ * Push an element onto the end of a multiple producer, multiple
+ * consumer queue, without blocking
+ * pre: q: queue
+ *      value: element to push
+ * post: element is added to the queue, if there is room
+ * return: q
+ *         NULL if the queue is full
+ **********************************************************************/
+
+vanessa_mpmc_queue_t *vanessa_mpmc_queue_try_push(vanessa_mpmc_queue_t *q,
+		void *value)
+{
+	return(vanessa_mpmc_queue_try_push_n(q, &value, 1) ? q : NULL);
+}
+
+
+/**********************************************************************
+ * vanessa_mpmc_queue_try_pop_n
+ * Pop elements off the front of a multiple producer, multiple
+ * consumer queue, without blocking
+ * pre: q: queue
+ *      value: array to place elements in
+ *      n: maximum number of elements to pop
+ * post: up to n consecutive elements are removed from the queue,
+ *       oldest first
+ * return: number of elements popped, 0 if the queue is empty
+ **********************************************************************/
+
+size_t vanessa_mpmc_queue_try_pop_n(vanessa_mpmc_queue_t *q,
+		void **value, size_t n)
+{
+	vanessa_mpmc_queue_slot_t *slot;
+	size_t pos;
+	size_t i;
+
+	n = __vanessa_mpmc_queue_claim(q, &q->head, 1, n, &pos);
+
+	for(i = 0; i < n; i++) {
+		slot = &q->slot[(pos + i) & q->mask];
+		value[i] = slot->value;
+		__atomic_store_n(&slot->seq, pos + i + q->mask + 1,
+				__ATOMIC_RELEASE);
+	}
+
+	return(n);
+}
+
+
+/**********************************************************************
+ * vanessa_mpmc_queue_try_pop
+ * Pop an element off the front of a multiple producer, multiple
+ * consumer queue, without blocking
+ * pre: q: queue
+ *      value: element removed from the queue is assigned to *value
+ * post: oldest element is removed from the queue
+ * return: q
+ *         NULL if the queue is empty
+ **********************************************************************/
+
+vanessa_mpmc_queue_t *vanessa_mpmc_queue_try_pop(vanessa_mpmc_queue_t *q,
+		void **value)
+{
+	return(vanessa_mpmc_queue_try_pop_n(q, value, 1) ? q : NULL);
+}
+
+
+/**********************************************************************
+ * vanessa_mpmc_queue_length
+ * Return the number of elements in a multiple producer, multiple
+ * consumer queue
+ * pre: q: queue
+ * post: none
+ * return: number of elements claimed by producers and not yet claimed
+ *         by consumers, which may be out of date by the time it is
+ *         returned if the queue is in use
+ *         -1 if q is NULL
+ **********************************************************************/
+
+ssize_t vanessa_mpmc_queue_length(const vanessa_mpmc_queue_t *q)
+{
+	size_t head;
+	size_t tail;
+
+	if(q == NULL) {
+		return(-1);
+	}
+
+	/* Read head first so that tail is no less than it */
+	head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+	tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+	if(tail - head > q->mask + 1) {
+		return((ssize_t)(q->mask + 1));
+	}
+	return((ssize_t)(tail - head));
+}
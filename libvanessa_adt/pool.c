@@ -0,0 +1,356 @@
+/**********************************************************************
+ * pool.c                                                  October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Pool of fixed size objects, allocated in slabs
+ *
+ * Objects are carved out of page sized slabs, which are aligned to
+ * their size so that the slab an object belongs to can be found by
+ * masking its address. Each slab keeps its own free list, and the
+ * pool keeps a list of slabs that have free objects. Allocating and
+ * freeing are O(1) and, for most calls, touch no memory other than
+ * the object and its slab header. Objects allocated together are
+ * close together in memory.
+ *
+ * A pool may be shared, for instance by several lists. It is
+ * reference counted and freed once the last user destroys it.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <unistd.h>
+
+#include "vanessa_adt.h"
+
+/* Each slab should hold at least this many objects */
+#define POOL_MIN_OBJECTS 8
+
+typedef struct vanessa_pool_slab_struct vanessa_pool_slab_t;
+
+struct vanessa_pool_slab_struct {
+	vanessa_pool_slab_t *next;
+	vanessa_pool_slab_t *prev;
+	vanessa_pool_slab_t *free_next;
+	vanessa_pool_slab_t *free_prev;
+	void *free;
+	char *unused;
+	size_t nofree;
+};
+
+struct vanessa_pool_t_struct {
+	vanessa_pool_slab_t *slab;
+	vanessa_pool_slab_t *free_slab;
+	size_t size;
+	size_t slab_size;
+	size_t noobject;
+	size_t noslab;
+	int refcount;
+	vanessa_adt_flag_t flag;
+};
+
+/* Objects start after the slab header, suitably aligned */
+#define POOL_HEADER_SIZE \
+	((sizeof(vanessa_pool_slab_t) + sizeof(double) - 1) & \
+	 ~(sizeof(double) - 1))
+
+
+/**********************************************************************
+ * vanessa_pool_create
+ * Create a new, empty pool
+ * pre: size: size of each object in bytes
+ *      flag: VANESSA_POOL_RELEASE to free slabs as soon as all their
+ *            objects are freed. Otherwise slabs are kept for reuse
+ *            until the pool is destroyed.
+ * post: pool is allocated and initialised, no slabs are allocated
+ *       The reference count of the pool is 1
+ * return: pointer to pool
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_pool_t *vanessa_pool_create(size_t size, vanessa_adt_flag_t flag)
+{
+	vanessa_pool_t *p;
+	long page_size;
+
+	if(size == 0) {
+		VANESSA_LOGGER_DEBUG("invalid argument");
+		return(NULL);
+	}
+
+	p = (vanessa_pool_t *)malloc(sizeof(vanessa_pool_t));
+	if(p == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+
+	/* Room for the free list pointer, and keep objects aligned */
+	if(size < sizeof(void *)) {
+		size = sizeof(void *);
+	}
+	size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+	page_size = sysconf(_SC_PAGESIZE);
+	if(page_size <= 0) {
+		page_size = 4096;
+	}
+	p->slab_size = page_size;
+	while(p->slab_size - POOL_HEADER_SIZE < size * POOL_MIN_OBJECTS) {
+		p->slab_size <<= 1;
+	}
+
+	p->slab = NULL;
+	p->free_slab = NULL;
+	p->size = size;
+	p->noobject = (p->slab_size - POOL_HEADER_SIZE) / size;
+	p->noslab = 0;
+	p->refcount = 1;
+	p->flag = flag;
+
+	return(p);
+}
+
+
+/**********************************************************************
+ * vanessa_pool_ref
+ * Take a reference to a pool, so that it may be shared
+ * pre: p: pool
+ * post: reference count of p is incremented
+ *       vanessa_pool_destroy must be called once more before it is
+ *       freed
+ * return: p
+ **********************************************************************/
+
+vanessa_pool_t *vanessa_pool_ref(vanessa_pool_t *p)
+{
+	if(p != NULL) {
+		p->refcount++;
+	}
+
+	return(p);
+}
+
+
+/**********************************************************************
+ * vanessa_pool_destroy
+ * Drop a reference to a pool, destroying it if it was the last
+ * pre: p: pool
+ * post: reference count of p is decremented. If it reaches zero
+ *       all slabs are freed, along with any objects still allocated
+ *       from them, and p is freed.
+ * return: none
+ **********************************************************************/
+
+void vanessa_pool_destroy(vanessa_pool_t *p)
+{
+	vanessa_pool_slab_t *s;
+	vanessa_pool_slab_t *next;
+
+	if(p == NULL || --p->refcount > 0) {
+		return;
+	}
+
+	for(s = p->slab; s != NULL; s = next) {
+		next = s->next;
+		free(s);
+	}
+
+	free(p);
+}
+
+
+/**********************************************************************
+ * __vanessa_pool_slab_create
+ * Add a new slab to a pool
+ * pre: p: pool
+ * post: a new, empty slab is added to the lists of slabs and of slabs
+ *       with free objects
+ * return: the new slab
+ *         NULL on error
+ **********************************************************************/
+
+static vanessa_pool_slab_t *__vanessa_pool_slab_create(vanessa_pool_t *p)
+{
+	vanessa_pool_slab_t *s;
+	void *mem;
+
+	if(posix_memalign(&mem, p->slab_size, p->slab_size) != 0) {
+		VANESSA_LOGGER_DEBUG("posix_memalign");
+		return(NULL);
+	}
+	s = (vanessa_pool_slab_t *)mem;
+
+	s->free = NULL;
+	s->unused = (char *)mem + POOL_HEADER_SIZE;
+	s->nofree = p->noobject;
+
+	s->prev = NULL;
+	s->next = p->slab;
+	if(p->slab != NULL) {
+		p->slab->prev = s;
+	}
+	p->slab = s;
+
+	s->free_prev = NULL;
+	s->free_next = p->free_slab;
+	if(p->free_slab != NULL) {
+		p->free_slab->free_prev = s;
+	}
+	p->free_slab = s;
+
+	p->noslab++;
+
+	return(s);
+}
+
+
+/**********************************************************************
+ * __vanessa_pool_slab_unlink_free
+ * Remove a slab from the list of slabs with free objects
+ * pre: p: pool
+ *      s: slab in the list of slabs with free objects
+ * post: s is not in the list of slabs with free objects
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_pool_slab_unlink_free(vanessa_pool_t *p,
+		vanessa_pool_slab_t *s)
+{
+	if(s->free_prev != NULL) {
+		s->free_prev->free_next = s->free_next;
+	}
+	else {
+		p->free_slab = s->free_next;
+	}
+	if(s->free_next != NULL) {
+		s->free_next->free_prev = s->free_prev;
+	}
+}
+
+
+/**********************************************************************
+ * vanessa_pool_alloc
+ * Allocate an object from a pool
+ * pre: p: pool
+ * post: an object is allocated, adding a slab to the pool if needed
+ * return: pointer to uninitialised object of the size given to
+ *         vanessa_pool_create
+ *         NULL on error
+ **********************************************************************/
+
+void *vanessa_pool_alloc(vanessa_pool_t *p)
+{
+	vanessa_pool_slab_t *s;
+	void *obj;
+
+	s = p->free_slab;
+	if(s == NULL) {
+		s = __vanessa_pool_slab_create(p);
+		if(s == NULL) {
+			return(NULL);
+		}
+	}
+
+	/* Reuse freed objects first, then those never used */
+	if(s->free != NULL) {
+		obj = s->free;
+		s->free = *(void **)obj;
+	}
+	else {
+		obj = s->unused;
+		s->unused += p->size;
+	}
+
+	if(--s->nofree == 0) {
+		__vanessa_pool_slab_unlink_free(p, s);
+	}
+
+	return(obj);
+}
+
+
+/**********************************************************************
+ * vanessa_pool_free
+ * Return an object to a pool
+ * pre: p: pool
+ *      obj: object allocated from p, may be NULL
+ * post: obj is returned to the free list of its slab. If the slab
+ *       is now empty and p was created with VANESSA_POOL_RELEASE
+ *       then the slab is freed.
+ * return: none
+ **********************************************************************/
+
+void vanessa_pool_free(vanessa_pool_t *p, void *obj)
+{
+	vanessa_pool_slab_t *s;
+
+	if(obj == NULL) {
+		return;
+	}
+
+	s = (vanessa_pool_slab_t *)((size_t)obj & ~(p->slab_size - 1));
+
+	*(void **)obj = s->free;
+	s->free = obj;
+
+	if(s->nofree++ == 0) {
+		s->free_prev = NULL;
+		s->free_next = p->free_slab;
+		if(p->free_slab != NULL) {
+			p->free_slab->free_prev = s;
+		}
+		p->free_slab = s;
+	}
+
+	if(s->nofree < p->noobject || !(p->flag & VANESSA_POOL_RELEASE)) {
+		return;
+	}
+
+	__vanessa_pool_slab_unlink_free(p, s);
+	if(s->prev != NULL) {
+		s->prev->next = s->next;
+	}
+	else {
+		p->slab = s->next;
+	}
+	if(s->next != NULL) {
+		s->next->prev = s->prev;
+	}
+	p->noslab--;
+	free(s);
+}
+
+
+/**********************************************************************
+ * vanessa_pool_get_slab_count
+ * Get the number of slabs allocated by a pool
+ * pre: p: pool
+ * return: number of slabs
+ *         0 if p is NULL
+ **********************************************************************/
+
+size_t vanessa_pool_get_slab_count(vanessa_pool_t *p)
+{
+	if(p == NULL) {
+		return(0);
+	}
+
+	return(p->noslab);
+}
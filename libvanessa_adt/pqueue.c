@@ -0,0 +1,392 @@
+/**********************************************************************
+ * pqueue.c                                                October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Priority queue
+ *
+ * A 4-ary heap stored in an array. Compared to a binary heap it is
+ * half as deep, and the four children of an element, which are
+ * compared with each other when sifting down, are adjacent in memory
+ * and usually share a cache line. Each slot holds the value as well
+ * as its handle so that comparisons do not need to follow the handle.
+ * Handles, which are allocated from a pool, record the position of
+ * their element in the heap so that it can be moved or removed in
+ * O(log n) time.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include "vanessa_adt.h"
+
+#define PQUEUE_MINSLOT 16
+#define PQUEUE_ARITY 4
+
+#define PQUEUE_PARENT(i) (((i) - 1) / PQUEUE_ARITY)
+#define PQUEUE_CHILD(i) ((i) * PQUEUE_ARITY + 1)
+
+/* Place slot s at index i, updating the index recorded by its handle */
+#define PQUEUE_PLACE(pq, i, s) \
+	do { \
+		(pq)->slot[i] = (s); \
+		(s).e->index = (i); \
+	} while(0)
+
+struct vanessa_pqueue_elem_t_struct {
+	void *value;
+	size_t index;
+};
+
+typedef struct {
+	void *value;
+	vanessa_pqueue_elem_t *e;
+} vanessa_pqueue_slot_t;
+
+struct vanessa_pqueue_t_struct {
+	vanessa_pqueue_slot_t *slot;
+	size_t noslot;
+	size_t count;
+	vanessa_pool_t *pool;
+	void (*e_destroy) (void *e);
+	int (*e_sort) (void *a, void *b);
+};
+
+
+/**********************************************************************
+ * vanessa_pqueue_create
+ * Create a new, empty priority queue
+ * pre: element_destroy: Pointer to a function to destroy an element,
+ *                       as for vanessa_list_create. May be NULL in
+ *                       which case elements are not freed on calls
+ *                       to vanessa_pqueue_destroy.
+ *      element_sort:    Pointer to a function that will compare two
+ *                       elements a and b, as for vanessa_list_create.
+ *                       Will return < 0 if a should be popped before
+ *                       b, > 0 if after, and 0 if they are equal.
+ * post: memory is allocated for queue and values are initialised
+ * return: new, empty priority queue
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_pqueue_t *vanessa_pqueue_create(void (*element_destroy) (void *e),
+		int (*element_sort) (void *a, void *b))
+{
+	vanessa_pqueue_t *pq;
+
+	if(element_sort == NULL) {
+		VANESSA_LOGGER_DEBUG("invalid argument");
+		return(NULL);
+	}
+
+	pq = (vanessa_pqueue_t *)malloc(sizeof(vanessa_pqueue_t));
+	if(pq == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+
+	pq->slot = (vanessa_pqueue_slot_t *)
+		malloc(PQUEUE_MINSLOT * sizeof(vanessa_pqueue_slot_t));
+	if(pq->slot == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		free(pq);
+		return(NULL);
+	}
+
+	pq->pool = vanessa_pool_create(sizeof(vanessa_pqueue_elem_t), 0);
+	if(pq->pool == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_pool_create");
+		free(pq->slot);
+		free(pq);
+		return(NULL);
+	}
+
+	pq->noslot = PQUEUE_MINSLOT;
+	pq->count = 0;
+	pq->e_destroy = element_destroy;
+	pq->e_sort = element_sort;
+
+	return(pq);
+}
+
+
+/**********************************************************************
+ * vanessa_pqueue_destroy
+ * Destroy a priority queue, destroying each element present in the
+ * queue first
+ * pre: pq: priority queue to destroy
+ * post: priority queue and all elements in it are destroyed, and all
+ *       handles to its elements are invalid
+ * return: none
+ **********************************************************************/
+
+void vanessa_pqueue_destroy(vanessa_pqueue_t *pq)
+{
+	size_t i;
+
+	if(pq == NULL) {
+		return;
+	}
+
+	for(i = 0; pq->e_destroy != NULL && i < pq->count; i++) {
+		if(pq->slot[i].value != NULL) {
+			pq->e_destroy(pq->slot[i].value);
+		}
+	}
+
+	vanessa_pool_destroy(pq->pool);
+	free(pq->slot);
+	free(pq);
+}
+
+
+/*
+ * Move the slot at index i towards the root until its parent sorts no
+ * later than it. Returns the index it ends up at.
+ */
+
+static size_t __vanessa_pqueue_sift_up(vanessa_pqueue_t *pq, size_t i)
+{
+	vanessa_pqueue_slot_t s = pq->slot[i];
+	size_t parent;
+
+	while(i > 0) {
+		parent = PQUEUE_PARENT(i);
+		if(pq->e_sort(s.value, pq->slot[parent].value) >= 0) {
+			break;
+		}
+		PQUEUE_PLACE(pq, i, pq->slot[parent]);
+		i = parent;
+	}
+	PQUEUE_PLACE(pq, i, s);
+
+	return(i);
+}
+
+
+/*
+ * Move the slot at index i towards the leaves until none of its
+ * children sort earlier than it
+ */
+
+static void __vanessa_pqueue_sift_down(vanessa_pqueue_t *pq, size_t i)
+{
+	vanessa_pqueue_slot_t s = pq->slot[i];
+	size_t child;
+	size_t end;
+	size_t min;
+
+	while((child = PQUEUE_CHILD(i)) < pq->count) {
+		end = child + PQUEUE_ARITY;
+		if(end > pq->count) {
+			end = pq->count;
+		}
+		for(min = child++; child < end; child++) {
+			if(pq->e_sort(pq->slot[child].value,
+						pq->slot[min].value) < 0) {
+				min = child;
+			}
+		}
+		if(pq->e_sort(pq->slot[min].value, s.value) >= 0) {
+			break;
+		}
+		PQUEUE_PLACE(pq, i, pq->slot[min]);
+		i = min;
+	}
+	PQUEUE_PLACE(pq, i, s);
+}
+
+
+/*
+ * Remove the slot at index i, filling the hole with the last slot
+ */
+
+static void __vanessa_pqueue_remove(vanessa_pqueue_t *pq, size_t i)
+{
+	vanessa_pool_free(pq->pool, pq->slot[i].e);
+
+	if(i == --pq->count) {
+		return;
+	}
+	PQUEUE_PLACE(pq, i, pq->slot[pq->count]);
+	if(__vanessa_pqueue_sift_up(pq, i) == i) {
+		__vanessa_pqueue_sift_down(pq, i);
+	}
+}
+
+
+/**********************************************************************
+ * vanessa_pqueue_push
+ * Add an element to a priority queue
+ * pre: pq: priority queue
+ *      value: element to add
+ * post: element is added to the queue, in O(log n) time
+ * return: handle to the element, which is valid until it is popped
+ *         or removed from the queue
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_pqueue_elem_t *vanessa_pqueue_push(vanessa_pqueue_t *pq,
+		void *value)
+{
+	vanessa_pqueue_slot_t *slot;
+	vanessa_pqueue_slot_t s;
+
+	if(pq->count == pq->noslot) {
+		slot = (vanessa_pqueue_slot_t *)realloc(pq->slot,
+				pq->noslot * 2 * sizeof(vanessa_pqueue_slot_t));
+		if(slot == NULL) {
+			VANESSA_LOGGER_DEBUG_ERRNO("realloc");
+			return(NULL);
+		}
+		pq->slot = slot;
+		pq->noslot *= 2;
+	}
+
+	s.e = (vanessa_pqueue_elem_t *)vanessa_pool_alloc(pq->pool);
+	if(s.e == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_pool_alloc");
+		return(NULL);
+	}
+	s.e->value = value;
+	s.value = value;
+
+	PQUEUE_PLACE(pq, pq->count, s);
+	__vanessa_pqueue_sift_up(pq, pq->count++);
+
+	return(s.e);
+}
+
+
+/**********************************************************************
+ * vanessa_pqueue_peek
+ * Retrieve the first element of a priority queue without removing it
+ * pre: pq: priority queue
+ * post: none
+ * return: element which sorts before all others
+ *         NULL if the queue is empty
+ **********************************************************************/
+
+void *vanessa_pqueue_peek(const vanessa_pqueue_t *pq)
+{
+	if(pq == NULL || pq->count == 0) {
+		return(NULL);
+	}
+
+	return(pq->slot[0].value);
+}
+
+
+/**********************************************************************
+ * vanessa_pqueue_pop
+ * Remove the first element of a priority queue
+ * pre: pq: priority queue
+ *      value: element removed from the queue is assigned to *value
+ * post: element which sorts before all others is removed from the
+ *       queue, but not destroyed, in O(log n) time. Its handle is
+ *       invalid.
+ * return: pq
+ *         NULL if the queue is empty
+ **********************************************************************/
+
+vanessa_pqueue_t *vanessa_pqueue_pop(vanessa_pqueue_t *pq, void **value)
+{
+	if(pq == NULL || pq->count == 0) {
+		return(NULL);
+	}
+
+	*value = pq->slot[0].value;
+	__vanessa_pqueue_remove(pq, 0);
+
+	return(pq);
+}
+
+
+/**********************************************************************
+ * vanessa_pqueue_update
+ * Restore the order of a priority queue after the sort key of one
+ * of its elements has changed
+ * pre: pq: priority queue
+ *      e: handle of the element whose key has changed, in place,
+ *         whether it should now sort earlier (decrease-key) or later
+ * post: element is moved to its place in the queue, in O(log n) time
+ * return: none
+ **********************************************************************/
+
+void vanessa_pqueue_update(vanessa_pqueue_t *pq, vanessa_pqueue_elem_t *e)
+{
+	size_t i = e->index;
+
+	if(__vanessa_pqueue_sift_up(pq, i) == i) {
+		__vanessa_pqueue_sift_down(pq, i);
+	}
+}
+
+
+/**********************************************************************
+ * vanessa_pqueue_remove
+ * Remove an element from a priority queue by its handle
+ * pre: pq: priority queue
+ *      e: handle of element to remove
+ * post: element is removed from the queue, but not destroyed, in
+ *       O(log n) time. e is invalid.
+ * return: the element removed
+ **********************************************************************/
+
+void *vanessa_pqueue_remove(vanessa_pqueue_t *pq, vanessa_pqueue_elem_t *e)
+{
+	void *value = e->value;
+
+	__vanessa_pqueue_remove(pq, e->index);
+
+	return(value);
+}
+
+
+/**********************************************************************
+ * vanessa_pqueue_elem_value
+ * Return the element a handle refers to
+ * pre: e: handle of an element in a priority queue
+ * post: none
+ * return: element
+ **********************************************************************/
+
+void *vanessa_pqueue_elem_value(const vanessa_pqueue_elem_t *e)
+{
+	return(e->value);
+}
+
+
+/**********************************************************************
+ * vanessa_pqueue_length
+ * Return the number of elements in a priority queue
+ * pre: pq: priority queue
+ * post: none
+ * return: number of elements in the queue
+ *         -1 if pq is NULL
+ **********************************************************************/
+
+ssize_t vanessa_pqueue_length(const vanessa_pqueue_t *pq)
+{
+	if(pq == NULL) {
+		return(-1);
+	}
+
+	return((ssize_t)pq->count);
+}
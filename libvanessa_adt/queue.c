@@ -7,6 +7,11 @@
  * Useless Note: This code was origionally written as a queue of a
  *               fixed data type on some steps at St. Marys Public
  *               School, NSW, Australia in June 1997.
+ *
+ * Elements are kept in a circular array, whose size is a power of
+ * two, so pushing and popping do not allocate memory unless the
+ * array needs to grow or shrink.
+ *
  * vanessa_adt
  * Library of Abstract Data Types
  * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
@@ -30,40 +35,54 @@
 
 #include "vanessa_adt.h"
 
-struct vanessa_queue_member_t_struct {
-        void *value;
-        struct vanessa_queue_member_t_struct *prev;
-        struct vanessa_queue_member_t_struct *next;
-};
+/* Smallest number of slots allocated */
+#define QUEUE_MINSLOT 16
 
 struct vanessa_queue_t_struct {
-        vanessa_queue_member_t *first;
-        vanessa_queue_member_t *last;
+        void **slot;
+        size_t mask;
+        size_t head;
         void (*e_destroy) (const void *);
         int size;
 };
 
+/* Slot of the ith element from the end that is popped */
+#define QUEUE_SLOT(q, i) ((q)->slot[((q)->head + (i)) & (q)->mask])
 
 
 /**********************************************************************
- * vanessa_queue_member_free
- * Free a vanessa_queue member
- * pre: vanessa_queue_member: element to free
- * post: vanessa_queue_member is freed
- * return: none
+ * vanessa_queue_resize
+ * Change the number of slots of a vanessa_queue
+ * pre: q: vanessa_queue
+ *      noslot: new number of slots, a power of two no smaller than
+ *              the number of elements in the queue
+ * post: elements are moved to a new array of noslot slots, starting
+ *       at its beginning
+ * return: 0 on success
+ *         -1 on error, in which case q is unchanged
  **********************************************************************/
 
-static void vanessa_queue_member_free(vanessa_queue_member_t * mem,
-		void (*e_destroy) (const void *))
+static int vanessa_queue_resize(vanessa_queue_t * q, size_t noslot)
 {
-	if (mem == NULL) {
-		return;
+	void **slot;
+	int i;
+
+	slot = (void **)malloc(noslot * sizeof(void *));
+	if (!slot) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return (-1);
 	}
 
-	if (mem->value != NULL && e_destroy != NULL) {
-		e_destroy(&(mem->value));
+	for (i = 0; i < q->size; i++) {
+		slot[i] = QUEUE_SLOT(q, i);
 	}
-	free(mem);
+
+	free(q->slot);
+	q->slot = slot;
+	q->mask = noslot - 1;
+	q->head = 0;
+
+	return (0);
 }
 
 
@@ -89,8 +108,9 @@ vanessa_queue_t *vanessa_queue_create(void (*e_destroy) (const void *))
 		return (NULL);
 	}
 
-	q->first = NULL;
-	q->last = NULL;
+	q->slot = NULL;
+	q->mask = 0;
+	q->head = 0;
 	q->e_destroy = e_destroy;
 	q->size = 0;
 
@@ -104,6 +124,7 @@ vanessa_queue_t *vanessa_queue_create(void (*e_destroy) (const void *))
  * pre: q: vanessa_queue
  *      value: element to push onto the vanessa_queue
  * post: element is added to the queue
+ *       The array of elements is doubled in size if it is full
  * return: vanessa_queue with element added
  *       NULL on error. On error, where possible the vanessa_queue is 
  *       destroyed.
@@ -111,31 +132,19 @@ vanessa_queue_t *vanessa_queue_create(void (*e_destroy) (const void *))
 
 vanessa_queue_t *vanessa_queue_push(vanessa_queue_t * q, void *value)
 {
-	vanessa_queue_member_t *new;
-
 	if (q == NULL) {
 		return (NULL);
 	}
 
-	new = (vanessa_queue_member_t *)malloc(sizeof(vanessa_queue_member_t));
-	if (!new) {
-		VANESSA_LOGGER_DEBUG("malloc");
-		vanessa_queue_destroy(q);
-		return (NULL);
+	if (q->slot == NULL || (size_t)q->size > q->mask) {
+		if (vanessa_queue_resize(q, q->slot == NULL ?
+					QUEUE_MINSLOT : (q->mask + 1) * 2)) {
+			vanessa_queue_destroy(q);
+			return (NULL);
+		}
 	}
 
-	/*Put in payload */
-	new->value = value;
-
-	/*Update vanessa_queue pointers */
-	new->next = q->first;
-	new->prev = NULL;
-	if (q->first == NULL) {
-		q->last = new;
-	} else {
-		q->first->prev = new;
-	}
-	q->first = new;
+	QUEUE_SLOT(q, q->size) = value;
 
 	/*Increment vanessa_queue size */
 	q->size++;
@@ -151,39 +160,136 @@ vanessa_queue_t *vanessa_queue_push(vanessa_queue_t * q, void *value)
  *      value: element removed from the vanessa_queue is assigned to 
  *             *value
  * post: elelemt is removed from queue
+ *       The array of elements is halved in size if it is less than
+ *       1/8 full
  * return: vanessa_queue with element removed
  * Note: popping an empty vanessa_queue results in NULL being returned
  **********************************************************************/
 
 vanessa_queue_t *vanessa_queue_pop(vanessa_queue_t * q, void **value)
 {
-	vanessa_queue_member_t *old;
-
-	if (q == NULL || q->last == NULL) {
+	if (q == NULL || q->size == 0) {
 		return (NULL);
 	}
 
 	/*Grab payload */
-	*value = q->last->value;
-
-	/*Fix pointers */
-	old = q->last;
-	if ((q->last = old->prev) == NULL) {
-		q->first = NULL;
-	} else {
-		q->last->next = NULL;
-	}
+	*value = q->slot[q->head];
+	q->head = (q->head + 1) & q->mask;
 
 	/*Decrement vanessa_queue size */
 	q->size--;
 
-	/* Free queue member, but not value */
-	vanessa_queue_member_free(old, NULL);
+	/* Failing to shrink is harmless */
+	if (q->mask + 1 > QUEUE_MINSLOT && (size_t)q->size * 8 < q->mask + 1) {
+		vanessa_queue_resize(q, (q->mask + 1) / 2);
+	}
+
+	return q;
+}
+
+
+/**********************************************************************
+ * vanessa_queue_push_n
+ * Push several elements onto the beginning of a vanessa_queue
+ * pre: q: vanessa_queue
+ *      value: elements to push, value[0] being pushed first
+ *      n: number of elements to push
+ * post: elements are added to the queue, so that they will be popped
+ *       in the order they appear in value
+ *       The array of elements is grown at most once, to fit them all
+ * return: vanessa_queue with elements added
+ *         NULL on error, in which case the vanessa_queue is unchanged
+ **********************************************************************/
+
+vanessa_queue_t *vanessa_queue_push_n(vanessa_queue_t * q, void **value,
+		size_t n)
+{
+	size_t noslot;
+	size_t tail;
+	size_t first;
+
+	if (q == NULL) {
+		return (NULL);
+	}
+
+	if (q->slot == NULL || (size_t)q->size + n > q->mask + 1) {
+		noslot = q->slot == NULL ? QUEUE_MINSLOT : q->mask + 1;
+		while (noslot < (size_t)q->size + n) {
+			noslot *= 2;
+		}
+		if (vanessa_queue_resize(q, noslot)) {
+			return (NULL);
+		}
+	}
+
+	/* Copy up to the end of the array, and the rest to its start */
+	tail = (q->head + q->size) & q->mask;
+	first = q->mask + 1 - tail;
+	if (first > n) {
+		first = n;
+	}
+	memcpy(q->slot + tail, value, first * sizeof(void *));
+	memcpy(q->slot, value + first, (n - first) * sizeof(void *));
+
+	q->size += n;
 
 	return q;
 }
 
 
+/**********************************************************************
+ * vanessa_queue_pop_n
+ * Pop several elements off the end of a vanessa_queue
+ * pre: q: vanessa_queue to pop the elements off
+ *      value: array to place elements in
+ *      n: maximum number of elements to pop
+ * post: up to n elements are removed from the queue, in the order
+ *       vanessa_queue_pop would remove them
+ *       The array of elements is shrunk at most once, if it is then
+ *       less than 1/8 full
+ * return: number of elements popped, 0 if the queue is empty or NULL
+ **********************************************************************/
+
+size_t vanessa_queue_pop_n(vanessa_queue_t * q, void **value, size_t n)
+{
+	size_t noslot;
+	size_t first;
+
+	if (q == NULL) {
+		return (0);
+	}
+
+	if (n > (size_t)q->size) {
+		n = q->size;
+	}
+	if (n == 0) {
+		return (0);
+	}
+
+	/* Copy up to the end of the array, and the rest from its start */
+	first = q->mask + 1 - q->head;
+	if (first > n) {
+		first = n;
+	}
+	memcpy(value, q->slot + q->head, first * sizeof(void *));
+	memcpy(value + first, q->slot, (n - first) * sizeof(void *));
+	q->head = (q->head + n) & q->mask;
+
+	q->size -= n;
+
+	/* Failing to shrink is harmless */
+	noslot = q->mask + 1;
+	while (noslot > QUEUE_MINSLOT && (size_t)q->size * 8 < noslot) {
+		noslot /= 2;
+	}
+	if (noslot != q->mask + 1) {
+		vanessa_queue_resize(q, noslot);
+	}
+
+	return (n);
+}
+
+
 /**********************************************************************
  * vanessa_queue_peek_last 
  * Retrieve the last element from a vanessa_queue without removing it 
@@ -199,7 +305,7 @@ vanessa_queue_t *vanessa_queue_pop(vanessa_queue_t * q, void **value)
 
 void *vanessa_queue_peek_last(const vanessa_queue_t * q)
 {
-	return((q == NULL || q->last == NULL)?NULL:q->last->value);
+	return((q == NULL || q->size == 0)?NULL:q->slot[q->head]);
 }
 
 
@@ -218,7 +324,7 @@ void *vanessa_queue_peek_last(const vanessa_queue_t * q)
 
 void *vanessa_queue_peek_first(const vanessa_queue_t * q)
 {
-	return((q==NULL || q->first==NULL)?NULL:q->first->value);
+	return((q==NULL || q->size==0)?NULL:QUEUE_SLOT(q, q->size - 1));
 }
 
 
@@ -236,18 +342,20 @@ void *vanessa_queue_peek_first(const vanessa_queue_t * q)
 
 void vanessa_queue_destroy(vanessa_queue_t * q)
 {
-	vanessa_queue_member_t *old_first;
+	int i;
 
 	if (q == NULL) {
 		return;
 	}
 
-	while (q->first != NULL) {
-		old_first = q->first;
-		q->first = old_first->next;
-		vanessa_queue_member_free(old_first, q->e_destroy);
+	/* Newest first, as e_destroy has always been called */
+	for (i = q->size - 1; q->e_destroy != NULL && i >= 0; i--) {
+		if (QUEUE_SLOT(q, i) != NULL) {
+			q->e_destroy(&QUEUE_SLOT(q, i));
+		}
 	}
 
+	free(q->slot);
 	free(q);
 }
 
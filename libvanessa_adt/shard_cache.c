@@ -0,0 +1,689 @@
+/**********************************************************************
+ * shard_cache.c                                           October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Fixed capacity LRU cache that may be shared between threads.
+ *
+ * Elements are spread by hash over a number of segments, each with
+ * its own lock, hash table and LRU list. Lookups only take their
+ * segment's lock for reading. Rather than promoting an element to
+ * the front of the LRU list on every hit, which would need the lock
+ * for writing, readers note the element in one of several small
+ * ring buffers belonging to the segment, chosen per thread. The
+ * buffered promotions are applied in a batch by whichever thread
+ * next holds the lock for writing, or by a reader that fills a
+ * buffer and can get the write lock without waiting. If a buffer is
+ * full when a reader wants to use it the promotion is dropped; this
+ * only makes the LRU order approximate.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <pthread.h>
+
+#include "vanessa_adt.h"
+
+#define CACHE_LINE 64
+
+/* Read buffers per segment, and entries per read buffer */
+#define SHARD_CACHE_STRIPES 8
+#define SHARD_CACHE_RING    32
+
+typedef struct vanessa_shard_cache_elem_struct vanessa_shard_cache_elem_t;
+
+struct vanessa_shard_cache_elem_struct {
+	vanessa_shard_cache_elem_t *chain;
+	vanessa_shard_cache_elem_t *next;
+	vanessa_shard_cache_elem_t *prev;
+	size_t hash;
+	void *value;
+};
+
+/*
+ * Readers reserve a slot by incrementing tail while holding the
+ * segment lock for reading. head and the slots are only read, and
+ * head only written, while holding the lock for writing, at which
+ * time there are no readers.
+ */
+typedef struct {
+	unsigned long tail;
+	unsigned long head;
+	unsigned long long hits;
+	unsigned long long misses;
+	vanessa_shard_cache_elem_t *slot[SHARD_CACHE_RING];
+	char pad[CACHE_LINE];
+} vanessa_shard_cache_buffer_t;
+
+typedef struct {
+	pthread_rwlock_t lock;
+	vanessa_shard_cache_elem_t **bucket;
+	size_t mask;
+	vanessa_shard_cache_elem_t *first;
+	vanessa_shard_cache_elem_t *last;
+	size_t count;
+	size_t capacity;
+	char pad[CACHE_LINE];
+	vanessa_shard_cache_buffer_t buffer[SHARD_CACHE_STRIPES];
+} vanessa_shard_cache_segment_t;
+
+struct vanessa_shard_cache_t_struct {
+	vanessa_shard_cache_segment_t *segment;
+	size_t nosegment;
+	void (*e_destroy) (void *e);
+	void *(*e_duplicate) (void *e);
+	int (*e_match) (void *e, void *key);
+	size_t (*e_hash) (void *e);
+};
+
+static unsigned int __vanessa_shard_cache_next_stripe;
+static __thread unsigned int __vanessa_shard_cache_stripe;
+
+
+/**********************************************************************
+ * __vanessa_shard_cache_get_stripe
+ * Get the read buffer index used by the calling thread
+ * pre: none
+ * return: read buffer index
+ **********************************************************************/
+
+static unsigned int __vanessa_shard_cache_get_stripe(void)
+{
+	if(__vanessa_shard_cache_stripe == 0) {
+		__vanessa_shard_cache_stripe = __atomic_add_fetch(
+				&__vanessa_shard_cache_next_stripe, 1,
+				__ATOMIC_RELAXED);
+	}
+
+	return(__vanessa_shard_cache_stripe % SHARD_CACHE_STRIPES);
+}
+
+
+/**********************************************************************
+ * vanessa_shard_cache_create
+ * Create a new, empty sharded cache
+ * pre: capacity: maximum number of elements held in the cache
+ *                This is divided evenly between the segments
+ *      nosegment: number of independently locked segments
+ *                 Should be somewhat more than the number of threads
+ *                 that use the cache concurrently
+ *      element_destroy:   Pointer to a function to destroy an element
+ *                         May be NULL
+ *      element_duplicate: Pointer to a function to duplicate an element
+ *                         Used when inserting and when retrieving
+ *                         elements. May be NULL in which case elements
+ *                         are inserted and retrieved by reference.
+ *      element_match:     Pointer to a function to match an element
+ *                         by a key.
+ *      element_hash:      Pointer to a function that returns a hash
+ *                         of an element. Should use the full range
+ *                         of size_t.
+ * post: cache is allocated and initialised
+ * return: pointer to cache
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_shard_cache_t *vanessa_shard_cache_create(size_t capacity,
+		size_t nosegment,
+		void (*element_destroy) (void *e),
+		void *(*element_duplicate) (void *e),
+		int (*element_match) (void *e, void *key),
+		size_t (*element_hash) (void *e))
+{
+	vanessa_shard_cache_t *c;
+	vanessa_shard_cache_segment_t *s;
+	size_t nobucket;
+	size_t i;
+
+	if(capacity == 0 || nosegment == 0 || element_hash == NULL) {
+		VANESSA_LOGGER_DEBUG("invalid argument");
+		return(NULL);
+	}
+
+	c = (vanessa_shard_cache_t *)malloc(sizeof(vanessa_shard_cache_t));
+	if(c == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+
+	c->segment = (vanessa_shard_cache_segment_t *)calloc(nosegment,
+			sizeof(vanessa_shard_cache_segment_t));
+	if(c->segment == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("calloc");
+		free(c);
+		return(NULL);
+	}
+	c->nosegment = nosegment;
+	c->e_destroy = element_destroy;
+	c->e_duplicate = element_duplicate;
+	c->e_match = element_match;
+	c->e_hash = element_hash;
+
+	for(i = 0; i < nosegment; i++) {
+		s = c->segment + i;
+		s->capacity = (capacity + nosegment - 1) / nosegment;
+		for(nobucket = 1; nobucket < s->capacity; nobucket <<= 1)
+			;
+		s->mask = nobucket - 1;
+		s->bucket = (vanessa_shard_cache_elem_t **)calloc(nobucket,
+				sizeof(vanessa_shard_cache_elem_t *));
+		if(s->bucket == NULL) {
+			VANESSA_LOGGER_DEBUG_ERRNO("calloc");
+			c->nosegment = i;
+			vanessa_shard_cache_destroy(c);
+			return(NULL);
+		}
+		if(pthread_rwlock_init(&s->lock, NULL) != 0) {
+			VANESSA_LOGGER_DEBUG("pthread_rwlock_init");
+			free(s->bucket);
+			c->nosegment = i;
+			vanessa_shard_cache_destroy(c);
+			return(NULL);
+		}
+	}
+
+	return(c);
+}
+
+
+/**********************************************************************
+ * vanessa_shard_cache_destroy
+ * Destroy a sharded cache and all the elements it holds
+ * pre: c: cache, no other thread may be using it
+ * post: all elements of c are destroyed
+ **********************************************************************/
+
+void vanessa_shard_cache_destroy(vanessa_shard_cache_t *c)
+{
+	vanessa_shard_cache_segment_t *s;
+	vanessa_shard_cache_elem_t *e;
+	vanessa_shard_cache_elem_t *next;
+	size_t i;
+
+	if(c == NULL) {
+		return;
+	}
+
+	for(i = 0; i < c->nosegment; i++) {
+		s = c->segment + i;
+		for(e = s->first; e != NULL; e = next) {
+			next = e->next;
+			if(c->e_destroy != NULL) {
+				c->e_destroy(e->value);
+			}
+			free(e);
+		}
+		free(s->bucket);
+		pthread_rwlock_destroy(&s->lock);
+	}
+
+	free(c->segment);
+	free(c);
+}
+
+
+/**********************************************************************
+ * __vanessa_shard_cache_mix
+ * Mix a 64 bit value, the finaliser of splitmix64
+ * pre: x: value to mix
+ * return: mixed value
+ **********************************************************************/
+
+static unsigned long long __vanessa_shard_cache_mix(unsigned long long x)
+{
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return(x);
+}
+
+
+/**********************************************************************
+ * __vanessa_shard_cache_get_segment
+ * Find the segment for a hash
+ * pre: c: cache
+ *      hash: hash of element or key
+ * return: segment
+ **********************************************************************/
+
+static vanessa_shard_cache_segment_t *__vanessa_shard_cache_get_segment(
+		vanessa_shard_cache_t *c, size_t hash)
+{
+	/*
+	 * The bucket is selected by the low bits of hash, which may be
+	 * all that varies, so mix them all into the choice of segment
+	 */
+	return(c->segment + (size_t)(__vanessa_shard_cache_mix(hash) >> 32) %
+			c->nosegment);
+}
+
+
+/**********************************************************************
+ * __vanessa_shard_cache_find
+ * Find an element in a segment
+ * pre: c: cache
+ *      s: segment, locked for reading or writing
+ *      hash: hash of key
+ *      key: key to match
+ * return: element if found
+ *         NULL otherwise
+ **********************************************************************/
+
+static vanessa_shard_cache_elem_t *__vanessa_shard_cache_find(
+		vanessa_shard_cache_t *c, vanessa_shard_cache_segment_t *s,
+		size_t hash, void *key)
+{
+	vanessa_shard_cache_elem_t *e;
+
+	for(e = s->bucket[hash & s->mask]; e != NULL; e = e->chain) {
+		if(e->hash != hash) {
+			continue;
+		}
+		if(c->e_match != NULL ? c->e_match(e->value, key) == 0 :
+				e->value == key) {
+			return(e);
+		}
+	}
+
+	return(NULL);
+}
+
+
+/**********************************************************************
+ * __vanessa_shard_cache_promote
+ * Move an element to the most recently used end of its segment
+ * pre: s: segment, locked for writing
+ *      e: element in s
+ * post: e is first in s
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_shard_cache_promote(vanessa_shard_cache_segment_t *s,
+		vanessa_shard_cache_elem_t *e)
+{
+	if(s->first == e) {
+		return;
+	}
+
+	/* Unlink, e is not first so e->prev is not NULL */
+	e->prev->next = e->next;
+	if(e->next != NULL) {
+		e->next->prev = e->prev;
+	}
+	else {
+		s->last = e->prev;
+	}
+
+	e->prev = NULL;
+	e->next = s->first;
+	s->first->prev = e;
+	s->first = e;
+}
+
+
+/**********************************************************************
+ * __vanessa_shard_cache_drain
+ * Apply buffered promotions
+ * pre: s: segment, locked for writing
+ * post: buffered promotions are applied in the order they were made,
+ *       per read buffer, and the read buffers are empty
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_shard_cache_drain(vanessa_shard_cache_segment_t *s)
+{
+	vanessa_shard_cache_buffer_t *b;
+	unsigned long tail;
+	unsigned long end;
+	unsigned long i;
+	int stripe;
+
+	for(stripe = 0; stripe < SHARD_CACHE_STRIPES; stripe++) {
+		b = s->buffer + stripe;
+		tail = __atomic_load_n(&b->tail, __ATOMIC_RELAXED);
+		/* Reservations past the end of the ring were dropped */
+		end = tail;
+		if(tail - b->head > SHARD_CACHE_RING) {
+			end = b->head + SHARD_CACHE_RING;
+		}
+		for(i = b->head; i != end; i++) {
+			__vanessa_shard_cache_promote(s,
+					b->slot[i % SHARD_CACHE_RING]);
+		}
+		b->head = tail;
+	}
+}
+
+
+/**********************************************************************
+ * vanessa_shard_cache_get_element
+ * Retrieve an element from the cache
+ * pre: c: cache to search
+ *      key: key to match
+ * post: hit or miss is counted and on a hit a promotion of the
+ *       element is buffered
+ * return: If element_duplicate passed to vanessa_shard_cache_create
+ *         is non-NULL, a duplicate of the element which the caller
+ *         must destroy. Otherwise the element itself, in which case
+ *         the caller must ensure that it is not evicted or removed by
+ *         another thread while it is in use.
+ *         NULL if c or key is NULL, if the element is not cached,
+ *         or on error.
+ **********************************************************************/
+
+void *vanessa_shard_cache_get_element(vanessa_shard_cache_t *c, void *key)
+{
+	vanessa_shard_cache_segment_t *s;
+	vanessa_shard_cache_buffer_t *b;
+	vanessa_shard_cache_elem_t *e;
+	unsigned long i;
+	size_t hash;
+	void *value = NULL;
+	int full = 0;
+
+	if(c == NULL || key == NULL) {
+		return(NULL);
+	}
+
+	hash = c->e_hash(key);
+	s = __vanessa_shard_cache_get_segment(c, hash);
+	b = s->buffer + __vanessa_shard_cache_get_stripe();
+
+	pthread_rwlock_rdlock(&s->lock);
+	e = __vanessa_shard_cache_find(c, s, hash, key);
+	if(e == NULL) {
+		__atomic_add_fetch(&b->misses, 1, __ATOMIC_RELAXED);
+		pthread_rwlock_unlock(&s->lock);
+		return(NULL);
+	}
+
+	__atomic_add_fetch(&b->hits, 1, __ATOMIC_RELAXED);
+	value = e->value;
+	if(c->e_duplicate != NULL) {
+		value = c->e_duplicate(value);
+		if(value == NULL) {
+			VANESSA_LOGGER_DEBUG("e_duplicate");
+		}
+	}
+
+	if(s->first != e) {
+		i = __atomic_fetch_add(&b->tail, 1, __ATOMIC_RELAXED);
+		if(i - b->head < SHARD_CACHE_RING) {
+			b->slot[i % SHARD_CACHE_RING] = e;
+		}
+		full = (i - b->head >= SHARD_CACHE_RING - 1);
+	}
+	pthread_rwlock_unlock(&s->lock);
+
+	if(full && pthread_rwlock_trywrlock(&s->lock) == 0) {
+		__vanessa_shard_cache_drain(s);
+		pthread_rwlock_unlock(&s->lock);
+	}
+
+	return(value);
+}
+
+
+/**********************************************************************
+ * __vanessa_shard_cache_release
+ * Remove an element from a segment and destroy it
+ * pre: c: cache
+ *      s: segment, locked for writing and drained
+ *      e: element in s
+ * post: e is unlinked and destroyed
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_shard_cache_release(vanessa_shard_cache_t *c,
+		vanessa_shard_cache_segment_t *s,
+		vanessa_shard_cache_elem_t *e)
+{
+	vanessa_shard_cache_elem_t **p;
+
+	for(p = s->bucket + (e->hash & s->mask); *p != e; p = &(*p)->chain)
+		;
+	*p = e->chain;
+
+	if(e->prev != NULL) {
+		e->prev->next = e->next;
+	}
+	else {
+		s->first = e->next;
+	}
+	if(e->next != NULL) {
+		e->next->prev = e->prev;
+	}
+	else {
+		s->last = e->prev;
+	}
+	s->count--;
+
+	if(c->e_destroy != NULL) {
+		c->e_destroy(e->value);
+	}
+	free(e);
+}
+
+
+/**********************************************************************
+ * vanessa_shard_cache_add_element
+ * Insert an element into the cache
+ * pre: c: cache to insert value into
+ *      value: value to insert
+ * post: value is inserted into the cache, evicting and destroying
+ *       the least recently used element of its segment if the
+ *       segment is full. If an element matching value is already
+ *       cached it is destroyed and replaced by value.
+ * return: NULL if c is NULL or on error
+ *         c, unchanged if value is NULL
+ **********************************************************************/
+
+vanessa_shard_cache_t *vanessa_shard_cache_add_element(
+		vanessa_shard_cache_t *c, void *value)
+{
+	vanessa_shard_cache_segment_t *s;
+	vanessa_shard_cache_elem_t *e;
+	vanessa_shard_cache_elem_t *old;
+	size_t hash;
+
+	if(c == NULL) {
+		return(NULL);
+	}
+	if(value == NULL) {
+		return(c);
+	}
+
+	e = (vanessa_shard_cache_elem_t *)malloc(
+			sizeof(vanessa_shard_cache_elem_t));
+	if(e == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+	if(c->e_duplicate != NULL) {
+		value = c->e_duplicate(value);
+		if(value == NULL) {
+			VANESSA_LOGGER_DEBUG("e_duplicate");
+			free(e);
+			return(NULL);
+		}
+	}
+
+	hash = c->e_hash(value);
+	e->hash = hash;
+	e->value = value;
+	s = __vanessa_shard_cache_get_segment(c, hash);
+
+	pthread_rwlock_wrlock(&s->lock);
+	__vanessa_shard_cache_drain(s);
+
+	old = __vanessa_shard_cache_find(c, s, hash, value);
+	if(old != NULL) {
+		__vanessa_shard_cache_release(c, s, old);
+	}
+	else if(s->count == s->capacity) {
+		__vanessa_shard_cache_release(c, s, s->last);
+	}
+
+	e->chain = s->bucket[hash & s->mask];
+	s->bucket[hash & s->mask] = e;
+	e->prev = NULL;
+	e->next = s->first;
+	if(s->first != NULL) {
+		s->first->prev = e;
+	}
+	else {
+		s->last = e;
+	}
+	s->first = e;
+	s->count++;
+
+	pthread_rwlock_unlock(&s->lock);
+
+	return(c);
+}
+
+
+/**********************************************************************
+ * vanessa_shard_cache_remove_element
+ * Remove an element from the cache
+ * pre: c: cache to remove element from
+ *      key: key of element to remove
+ * post: matching element is removed from the cache and destroyed
+ * return: NULL if c is NULL
+ *         c otherwise
+ **********************************************************************/
+
+vanessa_shard_cache_t *vanessa_shard_cache_remove_element(
+		vanessa_shard_cache_t *c, void *key)
+{
+	vanessa_shard_cache_segment_t *s;
+	vanessa_shard_cache_elem_t *e;
+	size_t hash;
+
+	if(c == NULL) {
+		return(NULL);
+	}
+	if(key == NULL) {
+		return(c);
+	}
+
+	hash = c->e_hash(key);
+	s = __vanessa_shard_cache_get_segment(c, hash);
+
+	pthread_rwlock_wrlock(&s->lock);
+	__vanessa_shard_cache_drain(s);
+	e = __vanessa_shard_cache_find(c, s, hash, key);
+	if(e != NULL) {
+		__vanessa_shard_cache_release(c, s, e);
+	}
+	pthread_rwlock_unlock(&s->lock);
+
+	return(c);
+}
+
+
+/**********************************************************************
+ * vanessa_shard_cache_get_count
+ * Get the number of elements held in the cache
+ * pre: c: cache
+ * return: number of elements in the cache. This is only a snapshot
+ *         if other threads are modifying the cache.
+ *         0 if c is NULL
+ **********************************************************************/
+
+size_t vanessa_shard_cache_get_count(vanessa_shard_cache_t *c)
+{
+	size_t count = 0;
+	size_t i;
+
+	if(c == NULL) {
+		return(0);
+	}
+
+	for(i = 0; i < c->nosegment; i++) {
+		pthread_rwlock_rdlock(&c->segment[i].lock);
+		count += c->segment[i].count;
+		pthread_rwlock_unlock(&c->segment[i].lock);
+	}
+
+	return(count);
+}
+
+
+/**********************************************************************
+ * vanessa_shard_cache_get_hits
+ * Get the number of lookups that found an element
+ * pre: c: cache
+ * return: number of hits since the cache was created
+ *         0 if c is NULL
+ **********************************************************************/
+
+unsigned long long vanessa_shard_cache_get_hits(vanessa_shard_cache_t *c)
+{
+	unsigned long long hits = 0;
+	size_t i;
+	int stripe;
+
+	if(c == NULL) {
+		return(0);
+	}
+
+	for(i = 0; i < c->nosegment; i++) {
+		for(stripe = 0; stripe < SHARD_CACHE_STRIPES; stripe++) {
+			hits += __atomic_load_n(
+					&c->segment[i].buffer[stripe].hits,
+					__ATOMIC_RELAXED);
+		}
+	}
+
+	return(hits);
+}
+
+
+/**********************************************************************
+ * vanessa_shard_cache_get_misses
+ * Get the number of lookups that did not find an element
+ * pre: c: cache
+ * return: number of misses since the cache was created
+ *         0 if c is NULL
+ **********************************************************************/
+
+unsigned long long vanessa_shard_cache_get_misses(vanessa_shard_cache_t *c)
+{
+	unsigned long long misses = 0;
+	size_t i;
+	int stripe;
+
+	if(c == NULL) {
+		return(0);
+	}
+
+	for(i = 0; i < c->nosegment; i++) {
+		for(stripe = 0; stripe < SHARD_CACHE_STRIPES; stripe++) {
+			misses += __atomic_load_n(
+					&c->segment[i].buffer[stripe].misses,
+					__ATOMIC_RELAXED);
+		}
+	}
+
+	return(misses);
+}
@@ -0,0 +1,632 @@
+/**********************************************************************
+ * shm_queue.c                                             October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Shared memory queue
+ *
+ * A bounded queue of messages in shared memory, for passing messages
+ * between processes, such as a daemon and the workers it forks,
+ * without a system call per message. The memory is a memfd, so it
+ * may also be passed to an unrelated process, where available, or
+ * else an anonymous shared mapping inherited across fork().
+ *
+ * Messages are copied into fixed size slots. As for
+ * vanessa_mpmc_queue, each slot has a sequence number which says
+ * whether it is free for a producer or holds a message for a
+ * consumer, and producers and consumers claim slots by advancing tail
+ * and head with compare and swap. So any number of processes may
+ * push and pop.
+ *
+ * Processes that find the queue empty or full may sleep on a futex,
+ * which is only woken, by a system call, if a process is sleeping.
+ * Each side counts its sleepers before checking the queue one last
+ * time, and the other side checks the count after updating the
+ * queue, each with a full barrier in between, so wakeups are not
+ * lost.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+/* For memfd_create and syscall */
+#define _GNU_SOURCE
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef HAVE_LINUX_FUTEX_H
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "vanessa_adt.h"
+
+#define CACHE_LINE 64
+#define CACHE_ALIGN(n) (((n) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1))
+
+#define SHM_QUEUE_MAGIC 0x76736871
+
+/* A futex word, and the number of processes sleeping on it */
+typedef struct {
+	uint32_t word;
+	uint32_t nowaiter;
+} vanessa_shm_queue_event_t;
+
+/* Start of the shared memory, followed by the slots */
+typedef struct {
+	uint32_t magic;
+	uint64_t mask;
+	uint64_t slot_size;
+	uint64_t stride;
+	char pad0[CACHE_LINE];
+	uint64_t tail;
+	vanessa_shm_queue_event_t not_full;
+	char pad1[CACHE_LINE];
+	uint64_t head;
+	vanessa_shm_queue_event_t not_empty;
+	char pad2[CACHE_LINE];
+} vanessa_shm_queue_shared_t;
+
+typedef struct {
+	uint64_t seq;
+	uint64_t len;
+	char data[1];
+} vanessa_shm_queue_slot_t;
+
+struct vanessa_shm_queue_t_struct {
+	vanessa_shm_queue_shared_t *shared;
+	size_t maplen;
+	int fd;
+};
+
+#define SHM_QUEUE_SLOT(s, i) \
+	((vanessa_shm_queue_slot_t *)((char *)(s) + \
+		CACHE_ALIGN(sizeof(vanessa_shm_queue_shared_t)) + \
+		((i) & (s)->mask) * (s)->stride))
+
+
+/*
+ * Sleep until e is woken, if its word is still val, or until the
+ * deadline passes. Returns -1 if the deadline has passed, 0 otherwise.
+ * Without futexes it just sleeps for a short while.
+ */
+
+static int __vanessa_shm_queue_sleep(vanessa_shm_queue_event_t *e,
+		uint32_t val, const struct timespec *deadline)
+{
+	struct timespec ts;
+	struct timespec *timeout = NULL;
+
+	if(deadline != NULL) {
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		ts.tv_sec = deadline->tv_sec - ts.tv_sec;
+		ts.tv_nsec = deadline->tv_nsec - ts.tv_nsec;
+		if(ts.tv_nsec < 0) {
+			ts.tv_sec--;
+			ts.tv_nsec += 1000000000L;
+		}
+		if(ts.tv_sec < 0) {
+			return(-1);
+		}
+		timeout = &ts;
+	}
+
+#ifdef HAVE_LINUX_FUTEX_H
+	syscall(SYS_futex, &e->word, FUTEX_WAIT, val, timeout, NULL, 0);
+#else
+	(void)e;
+	(void)val;
+	if(timeout == NULL || timeout->tv_sec > 0 ||
+			timeout->tv_nsec > 1000000L) {
+		ts.tv_sec = 0;
+		ts.tv_nsec = 1000000L;
+		timeout = &ts;
+	}
+	nanosleep(timeout, NULL);
+#endif
+
+	return(0);
+}
+
+
+/*
+ * Wake a process sleeping on e, if there is one
+ */
+
+static void __vanessa_shm_queue_wake(vanessa_shm_queue_event_t *e)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&e->nowaiter, __ATOMIC_SEQ_CST) == 0) {
+		return;
+	}
+
+	__atomic_add_fetch(&e->word, 1, __ATOMIC_SEQ_CST);
+#ifdef HAVE_LINUX_FUTEX_H
+	syscall(SYS_futex, &e->word, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+}
+
+
+/*
+ * Map the shared memory of q, of q->maplen bytes, from q->fd, or
+ * anonymously if it is -1
+ */
+
+static int __vanessa_shm_queue_map(vanessa_shm_queue_t *q)
+{
+	void *mem;
+
+	mem = mmap(NULL, q->maplen, PROT_READ | PROT_WRITE,
+			q->fd < 0 ? MAP_SHARED | MAP_ANONYMOUS : MAP_SHARED,
+			q->fd, 0);
+	if(mem == MAP_FAILED) {
+		VANESSA_LOGGER_DEBUG_ERRNO("mmap");
+		return(-1);
+	}
+	q->shared = (vanessa_shm_queue_shared_t *)mem;
+
+	return(0);
+}
+
+
+/**********************************************************************
+ * vanessa_shm_queue_create
+ * Create a new, empty queue of messages in shared memory
+ * pre: size: maximum number of messages in the queue, rounded up to a
+ *            power of two
+ *      slot_size: maximum size of a message in bytes
+ * post: shared memory is allocated and mapped for the queue. It is
+ *       shared with processes forked after this call, and with those
+ *       that open it with vanessa_shm_queue_open. Any of these
+ *       processes may push and pop messages concurrently.
+ * return: new, empty queue
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_shm_queue_t *vanessa_shm_queue_create(size_t size,
+		size_t slot_size)
+{
+	vanessa_shm_queue_t *q;
+	vanessa_shm_queue_shared_t *s;
+	size_t noslot = 2;
+	size_t stride;
+	size_t i;
+
+	if(size == 0 || slot_size == 0) {
+		VANESSA_LOGGER_DEBUG("invalid argument");
+		return(NULL);
+	}
+	while(noslot < size) {
+		noslot <<= 1;
+	}
+	stride = CACHE_ALIGN(offsetof(vanessa_shm_queue_slot_t, data) +
+			slot_size);
+
+	q = (vanessa_shm_queue_t *)malloc(sizeof(vanessa_shm_queue_t));
+	if(q == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+	q->maplen = CACHE_ALIGN(sizeof(vanessa_shm_queue_shared_t)) +
+		noslot * stride;
+
+#ifdef HAVE_MEMFD_CREATE
+	q->fd = memfd_create("vanessa_shm_queue", MFD_CLOEXEC);
+	if(q->fd < 0) {
+		VANESSA_LOGGER_DEBUG_ERRNO("memfd_create");
+		free(q);
+		return(NULL);
+	}
+	if(ftruncate(q->fd, q->maplen) < 0) {
+		VANESSA_LOGGER_DEBUG_ERRNO("ftruncate");
+		close(q->fd);
+		free(q);
+		return(NULL);
+	}
+#else
+	q->fd = -1;
+#endif
+
+	if(__vanessa_shm_queue_map(q) < 0) {
+		if(q->fd >= 0) {
+			close(q->fd);
+		}
+		free(q);
+		return(NULL);
+	}
+
+	s = q->shared;
+	memset(s, 0, sizeof(vanessa_shm_queue_shared_t));
+	s->mask = noslot - 1;
+	s->slot_size = slot_size;
+	s->stride = stride;
+	for(i = 0; i < noslot; i++) {
+		SHM_QUEUE_SLOT(s, i)->seq = i;
+	}
+	__atomic_store_n(&s->magic, SHM_QUEUE_MAGIC, __ATOMIC_RELEASE);
+
+	return(q);
+}
+
+
+/**********************************************************************
+ * vanessa_shm_queue_open
+ * Map a queue created by another process
+ * pre: fd: file descriptor of the queue, as returned by
+ *          vanessa_shm_queue_fd in the process that created it and
+ *          passed to this one. It is owned by the queue on success.
+ * post: the queue's shared memory is mapped
+ * return: queue
+ *         NULL on error, including if fd is not a queue
+ **********************************************************************/
+
+vanessa_shm_queue_t *vanessa_shm_queue_open(int fd)
+{
+	vanessa_shm_queue_t *q;
+	vanessa_shm_queue_shared_t *s;
+	size_t maplen;
+
+	q = (vanessa_shm_queue_t *)malloc(sizeof(vanessa_shm_queue_t));
+	if(q == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+	q->fd = fd;
+
+	/* Map the fixed part to find out the size of the rest */
+	q->maplen = sizeof(vanessa_shm_queue_shared_t);
+	if(__vanessa_shm_queue_map(q) < 0) {
+		free(q);
+		return(NULL);
+	}
+	s = q->shared;
+	if(__atomic_load_n(&s->magic, __ATOMIC_ACQUIRE) != SHM_QUEUE_MAGIC) {
+		VANESSA_LOGGER_DEBUG("not a vanessa_shm_queue");
+		munmap(s, q->maplen);
+		free(q);
+		return(NULL);
+	}
+	maplen = CACHE_ALIGN(sizeof(vanessa_shm_queue_shared_t)) +
+		(s->mask + 1) * s->stride;
+	munmap(s, q->maplen);
+
+	q->maplen = maplen;
+	if(__vanessa_shm_queue_map(q) < 0) {
+		free(q);
+		return(NULL);
+	}
+
+	return(q);
+}
+
+
+/**********************************************************************
+ * vanessa_shm_queue_fd
+ * Return the file descriptor of a queue's shared memory
+ * pre: q: queue
+ * post: none
+ * return: file descriptor, which may be passed to another process
+ *         for use with vanessa_shm_queue_open. It is closed on exec
+ *         and by vanessa_shm_queue_destroy.
+ *         -1 if the system does not support memfds, in which case
+ *         the queue is only shared with forked processes
+ **********************************************************************/
+
+int vanessa_shm_queue_fd(const vanessa_shm_queue_t *q)
+{
+	return(q->fd);
+}
+
+
+/**********************************************************************
+ * vanessa_shm_queue_destroy
+ * Unmap a queue from this process
+ * pre: q: queue
+ * post: the queue's shared memory is unmapped and its file descriptor
+ *       closed. Messages in the queue are lost once every process
+ *       sharing it has done so.
+ * return: none
+ **********************************************************************/
+
+void vanessa_shm_queue_destroy(vanessa_shm_queue_t *q)
+{
+	if(q == NULL) {
+		return;
+	}
+
+	munmap(q->shared, q->maplen);
+	if(q->fd >= 0) {
+		close(q->fd);
+	}
+	free(q);
+}
+
+
+/*
+ * Claim the slot at the next position from *index, whose sequence
+ * number must be the position plus offset: 0 for producers, 1 for
+ * consumers. Returns the slot, with its position in *pos, or NULL if
+ * the queue is full or empty.
+ */
+
+static vanessa_shm_queue_slot_t *__vanessa_shm_queue_claim(
+		vanessa_shm_queue_shared_t *s, uint64_t *index,
+		uint64_t offset, uint64_t *pos)
+{
+	vanessa_shm_queue_slot_t *slot;
+	int64_t diff;
+
+	*pos = __atomic_load_n(index, __ATOMIC_RELAXED);
+	while(1) {
+		slot = SHM_QUEUE_SLOT(s, *pos);
+		diff = (int64_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) -
+				(*pos + offset));
+		if(diff < 0) {
+			return(NULL);
+		}
+		if(diff > 0) {
+			*pos = __atomic_load_n(index, __ATOMIC_RELAXED);
+		}
+		else if(__atomic_compare_exchange_n(index, pos, *pos + 1, 0,
+					__ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			return(slot);
+		}
+	}
+}
+
+
+/**********************************************************************
+ * vanessa_shm_queue_try_push
+ * Copy a message onto the end of a shared memory queue, without
+ * blocking
+ * pre: q: queue
+ *      buf: message
+ *      len: length of message, no more than the slot_size given to
+ *           vanessa_shm_queue_create
+ * post: message is added to the queue, if there is room, and a
+ *       process waiting for a message is woken
+ * return: q
+ *         NULL if the queue is full, in which case errno is set to
+ *         EAGAIN, or if len is too large, in which case it is set to
+ *         EMSGSIZE
+ **********************************************************************/
+
+vanessa_shm_queue_t *vanessa_shm_queue_try_push(vanessa_shm_queue_t *q,
+		const void *buf, size_t len)
+{
+	vanessa_shm_queue_shared_t *s = q->shared;
+	vanessa_shm_queue_slot_t *slot;
+	uint64_t pos;
+
+	if(len > s->slot_size) {
+		errno = EMSGSIZE;
+		return(NULL);
+	}
+
+	slot = __vanessa_shm_queue_claim(s, &s->tail, 0, &pos);
+	if(slot == NULL) {
+		errno = EAGAIN;
+		return(NULL);
+	}
+	slot->len = len;
+	memcpy(slot->data, buf, len);
+	__atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+	__vanessa_shm_queue_wake(&s->not_empty);
+
+	return(q);
+}
+
+
+/**********************************************************************
+ * vanessa_shm_queue_try_pop
+ * Copy a message off the front of a shared memory queue, without
+ * blocking
+ * pre: q: queue
+ *      buf: buffer of at least the slot_size given to
+ *           vanessa_shm_queue_create
+ * post: oldest message is removed from the queue and copied into buf,
+ *       and a process waiting for room is woken
+ * return: length of the message
+ *         -1 if the queue is empty, in which case errno is set to
+ *         EAGAIN
+ **********************************************************************/
+
+ssize_t vanessa_shm_queue_try_pop(vanessa_shm_queue_t *q, void *buf)
+{
+	vanessa_shm_queue_shared_t *s = q->shared;
+	vanessa_shm_queue_slot_t *slot;
+	uint64_t pos;
+	size_t len;
+
+	slot = __vanessa_shm_queue_claim(s, &s->head, 1, &pos);
+	if(slot == NULL) {
+		errno = EAGAIN;
+		return(-1);
+	}
+	len = slot->len;
+	memcpy(buf, slot->data, len);
+	__atomic_store_n(&slot->seq, pos + s->mask + 1, __ATOMIC_RELEASE);
+
+	__vanessa_shm_queue_wake(&s->not_full);
+
+	return((ssize_t)len);
+}
+
+
+/*
+ * Compute the deadline timeout milliseconds from now. Returns
+ * deadline, or NULL if timeout is negative, meaning no deadline.
+ */
+
+static struct timespec *__vanessa_shm_queue_deadline(
+		struct timespec *deadline, int timeout)
+{
+	if(timeout < 0) {
+		return(NULL);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, deadline);
+	deadline->tv_sec += timeout / 1000;
+	deadline->tv_nsec += (timeout % 1000) * 1000000L;
+	if(deadline->tv_nsec >= 1000000000L) {
+		deadline->tv_sec++;
+		deadline->tv_nsec -= 1000000000L;
+	}
+
+	return(deadline);
+}
+
+
+/**********************************************************************
+ * vanessa_shm_queue_push
+ * Copy a message onto the end of a shared memory queue, waiting for
+ * room if it is full
+ * pre: q: queue
+ *      buf: message
+ *      len: length of message, as for vanessa_shm_queue_try_push
+ *      timeout: time to wait in milliseconds. 0 to return at once,
+ *               negative to wait indefinitely.
+ * post: message is added to the queue, and a process waiting for a
+ *       message is woken
+ * return: q
+ *         NULL if the timeout expired, in which case errno is set to
+ *         ETIMEDOUT, or if len is too large, in which case it is set
+ *         to EMSGSIZE
+ **********************************************************************/
+
+vanessa_shm_queue_t *vanessa_shm_queue_push(vanessa_shm_queue_t *q,
+		const void *buf, size_t len, int timeout)
+{
+	vanessa_shm_queue_event_t *e = &q->shared->not_full;
+	struct timespec ts;
+	struct timespec *deadline;
+	vanessa_shm_queue_t *status;
+	uint32_t val;
+	int err;
+
+	status = vanessa_shm_queue_try_push(q, buf, len);
+	if(status != NULL || errno != EAGAIN) {
+		return(status);
+	}
+
+	deadline = __vanessa_shm_queue_deadline(&ts, timeout);
+	do {
+		val = __atomic_load_n(&e->word, __ATOMIC_SEQ_CST);
+		__atomic_add_fetch(&e->nowaiter, 1, __ATOMIC_SEQ_CST);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		status = vanessa_shm_queue_try_push(q, buf, len);
+		err = errno;
+		if(status == NULL && err == EAGAIN &&
+				__vanessa_shm_queue_sleep(e, val, deadline) < 0) {
+			err = ETIMEDOUT;
+		}
+		__atomic_sub_fetch(&e->nowaiter, 1, __ATOMIC_SEQ_CST);
+	} while(status == NULL && err == EAGAIN);
+
+	if(status == NULL) {
+		errno = err;
+	}
+	return(status);
+}
+
+
+/**********************************************************************
+ * vanessa_shm_queue_pop
+ * Copy a message off the front of a shared memory queue, waiting for
+ * one to be pushed if it is empty
+ * pre: q: queue
+ *      buf: buffer, as for vanessa_shm_queue_try_pop
+ *      timeout: time to wait in milliseconds. 0 to return at once,
+ *               negative to wait indefinitely.
+ * post: oldest message is removed from the queue and copied into buf,
+ *       and a process waiting for room is woken
+ * return: length of the message
+ *         -1 if the timeout expired, in which case errno is set to
+ *         ETIMEDOUT
+ **********************************************************************/
+
+ssize_t vanessa_shm_queue_pop(vanessa_shm_queue_t *q, void *buf,
+		int timeout)
+{
+	vanessa_shm_queue_event_t *e = &q->shared->not_empty;
+	struct timespec ts;
+	struct timespec *deadline;
+	ssize_t len;
+	uint32_t val;
+	int expired = 0;
+
+	len = vanessa_shm_queue_try_pop(q, buf);
+	if(len >= 0) {
+		return(len);
+	}
+
+	deadline = __vanessa_shm_queue_deadline(&ts, timeout);
+	do {
+		val = __atomic_load_n(&e->word, __ATOMIC_SEQ_CST);
+		__atomic_add_fetch(&e->nowaiter, 1, __ATOMIC_SEQ_CST);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		len = vanessa_shm_queue_try_pop(q, buf);
+		if(len < 0) {
+			expired = __vanessa_shm_queue_sleep(e, val,
+					deadline) < 0;
+		}
+		__atomic_sub_fetch(&e->nowaiter, 1, __ATOMIC_SEQ_CST);
+	} while(len < 0 && !expired);
+
+	if(len < 0) {
+		errno = ETIMEDOUT;
+	}
+	return(len);
+}
+
+
+/**********************************************************************
+ * vanessa_shm_queue_length
+ * Return the number of messages in a shared memory queue
+ * pre: q: queue
+ * post: none
+ * return: number of messages claimed by producers and not yet claimed
+ *         by consumers, which may be out of date by the time it is
+ *         returned if the queue is in use
+ *         -1 if q is NULL
+ **********************************************************************/
+
+ssize_t vanessa_shm_queue_length(const vanessa_shm_queue_t *q)
+{
+	uint64_t head;
+	uint64_t tail;
+
+	if(q == NULL) {
+		return(-1);
+	}
+
+	head = __atomic_load_n(&q->shared->head, __ATOMIC_ACQUIRE);
+	tail = __atomic_load_n(&q->shared->tail, __ATOMIC_ACQUIRE);
+	if(tail - head > q->shared->mask + 1) {
+		return((ssize_t)(q->shared->mask + 1));
+	}
+	return((ssize_t)(tail - head));
+}
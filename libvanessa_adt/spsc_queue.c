@@ -0,0 +1,266 @@
+/**********************************************************************
+ * spsc_queue.c                                            October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Lock-free single producer, single consumer queue
+ *
+ * A bounded ring of pointers. The producer owns tail and the consumer
+ * owns head, each on its own cache line. Each side keeps a copy of
+ * the other's index and only reads the shared one, with acquire
+ * semantics, when its copy says the ring is full or empty, so in the
+ * common case no cache line is shared between the two threads other
+ * than the slots themselves.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include "vanessa_adt.h"
+
+#define CACHE_LINE 64
+
+struct vanessa_spsc_queue_t_struct {
+	void **slot;
+	size_t mask;
+	void (*e_destroy) (const void *);
+	char pad0[CACHE_LINE];
+	/* Producer */
+	size_t tail;
+	size_t head_cache;
+	char pad1[CACHE_LINE];
+	/* Consumer */
+	size_t head;
+	size_t tail_cache;
+	char pad2[CACHE_LINE];
+};
+
+
+/**********************************************************************
+ * vanessa_spsc_queue_create
+ * Create a new, empty single producer, single consumer queue
+ * pre: size: maximum number of elements in the queue, rounded up to a
+ *            power of two
+ *      e_destroy: pointer to a function to destroy elements of the
+ *                 queue, as for vanessa_queue_create. It is passed a
+ *                 pointer to the element. If NULL, then elements will
+ *                 not be freed on calls to vanessa_spsc_queue_destroy
+ * post: memory is allocated for queue and values are initialised
+ *       One thread may push elements onto the queue and one thread
+ *       may pop them, concurrently, without locking.
+ * return: new, empty queue
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_spsc_queue_t *vanessa_spsc_queue_create(size_t size,
+		void (*e_destroy) (const void *))
+{
+	vanessa_spsc_queue_t *q;
+	void *mem;
+	size_t noslot = 1;
+
+	if(size == 0) {
+		VANESSA_LOGGER_DEBUG("invalid argument");
+		return(NULL);
+	}
+	while(noslot < size) {
+		noslot <<= 1;
+	}
+
+	if(posix_memalign(&mem, CACHE_LINE,
+				sizeof(vanessa_spsc_queue_t)) != 0) {
+		VANESSA_LOGGER_DEBUG("posix_memalign");
+		return(NULL);
+	}
+	q = (vanessa_spsc_queue_t *)mem;
+
+	q->slot = (void **)malloc(noslot * sizeof(void *));
+	if(q->slot == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		free(q);
+		return(NULL);
+	}
+
+	q->mask = noslot - 1;
+	q->e_destroy = e_destroy;
+	q->tail = 0;
+	q->head_cache = 0;
+	q->head = 0;
+	q->tail_cache = 0;
+
+	return(q);
+}
+
+
+/**********************************************************************
+ * vanessa_spsc_queue_destroy
+ * Destroy a single producer, single consumer queue, destroying each
+ * element present in the queue first
+ * pre: q: queue to destroy, which neither thread is using
+ * post: queue and all elements in the queue are destroyed
+ * return: none
+ **********************************************************************/
+
+void vanessa_spsc_queue_destroy(vanessa_spsc_queue_t *q)
+{
+	size_t i;
+
+	if(q == NULL) {
+		return;
+	}
+
+	for(i = q->head; q->e_destroy != NULL && i != q->tail; i++) {
+		if(q->slot[i & q->mask] != NULL) {
+			q->e_destroy(&q->slot[i & q->mask]);
+		}
+	}
+
+	free(q->slot);
+	free(q);
+}
+
+
+/**********************************************************************
+ * vanessa_spsc_queue_push_n
+ * Push elements onto the end of a single producer, single consumer
+ * queue. May only be called by the producer.
+ * pre: q: queue
+ *      value: elements to push
+ *      n: number of elements to push
+ * post: as many elements as there is room for, up to n, are added to
+ *       the queue, in order, and made visible to the consumer at once
+ * return: number of elements pushed, 0 if the queue is full
+ **********************************************************************/
+
+size_t vanessa_spsc_queue_push_n(vanessa_spsc_queue_t *q, void **value,
+		size_t n)
+{
+	size_t tail;
+	size_t i;
+
+	tail = q->tail;
+	if(n > q->mask + 1 - (tail - q->head_cache)) {
+		q->head_cache = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+		if(n > q->mask + 1 - (tail - q->head_cache)) {
+			n = q->mask + 1 - (tail - q->head_cache);
+		}
+	}
+
+	for(i = 0; i < n; i++) {
+		q->slot[(tail + i) & q->mask] = value[i];
+	}
+	__atomic_store_n(&q->tail, tail + n, __ATOMIC_RELEASE);
+
+	return(n);
+}
+
+
+/**********************************************************************
+ * vanessa_spsc_queue_push
+ * Push an element onto the end of a single producer, single consumer
+ * queue. May only be called by the producer.
+ * pre: q: queue
+ *      value: element to push
+ * post: element is added to the queue, if there is room
+ * return: q
+ *         NULL if the queue is full
+ **********************************************************************/
+
+vanessa_spsc_queue_t *vanessa_spsc_queue_push(vanessa_spsc_queue_t *q,
+		void *value)
+{
+	return(vanessa_spsc_queue_push_n(q, &value, 1) ? q : NULL);
+}
+
+
+/**********************************************************************
+ * vanessa_spsc_queue_pop_n
+ * Pop elements off the front of a single producer, single consumer
+ * queue. May only be called by the consumer.
+ * pre: q: queue
+ *      value: array to place elements in
+ *      n: maximum number of elements to pop
+ * post: up to n elements are removed from the queue, oldest first
+ * return: number of elements popped, 0 if the queue is empty
+ **********************************************************************/
+
+size_t vanessa_spsc_queue_pop_n(vanessa_spsc_queue_t *q, void **value,
+		size_t n)
+{
+	size_t head;
+	size_t i;
+
+	head = q->head;
+	if(n > q->tail_cache - head) {
+		q->tail_cache = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+		if(n > q->tail_cache - head) {
+			n = q->tail_cache - head;
+		}
+	}
+
+	for(i = 0; i < n; i++) {
+		value[i] = q->slot[(head + i) & q->mask];
+	}
+	__atomic_store_n(&q->head, head + n, __ATOMIC_RELEASE);
+
+	return(n);
+}
+
+
+/**********************************************************************
+ * vanessa_spsc_queue_pop
+ * Pop an element off the front of a single producer, single consumer
+ * queue. May only be called by the consumer.
+ * pre: q: queue
+ *      value: element removed from the queue is assigned to *value
+ * post: oldest element is removed from the queue
+ * return: q
+ *         NULL if the queue is empty
+ **********************************************************************/
+
+vanessa_spsc_queue_t *vanessa_spsc_queue_pop(vanessa_spsc_queue_t *q,
+		void **value)
+{
+	return(vanessa_spsc_queue_pop_n(q, value, 1) ? q : NULL);
+}
+
+
+/**********************************************************************
+ * vanessa_spsc_queue_length
+ * Return the number of elements in a single producer, single consumer
+ * queue
+ * pre: q: queue
+ * post: none
+ * return: number of elements in the queue, which may be out of date
+ *         by the time it is returned if the queue is in use
+ *         -1 if q is NULL
+ **********************************************************************/
+
+ssize_t vanessa_spsc_queue_length(const vanessa_spsc_queue_t *q)
+{
+	size_t head;
+
+	if(q == NULL) {
+		return(-1);
+	}
+
+	/* Read head first so that tail is no less than it */
+	head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+	return((ssize_t)(__atomic_load_n(&q->tail, __ATOMIC_ACQUIRE) - head));
+}
@@ -0,0 +1,458 @@
+/**********************************************************************
+ * thread_pool.c                                           October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Thread pool
+ *
+ * Each worker has a work stealing deque. Tasks submitted by a worker,
+ * typically while running another task, are pushed onto its own
+ * deque and popped most recent first, while they are likely to still
+ * be in its cache. Tasks submitted by other threads are placed on a
+ * shared injection queue. A worker that runs out of tasks takes one
+ * from the injection queue or steals the oldest task of another
+ * worker, starting from a random victim so that thieves spread out.
+ * Only when both fail does it park on a condition variable.
+ *
+ * A thread that adds a task only takes the lock to wake a worker
+ * if one is parked. To avoid lost wakeups the counting of parked
+ * workers and the adding of tasks are each followed by a full
+ * barrier before the other is checked, so either the worker sees
+ * the task or the thread adding it sees the worker.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <pthread.h>
+
+#include "vanessa_adt.h"
+
+typedef struct {
+	int (*action) (void *e, void *data);
+	void *e;
+	void *data;
+} vanessa_thread_pool_task_t;
+
+typedef struct {
+	vanessa_thread_pool_t *tp;
+	vanessa_ws_deque_t *d;
+	pthread_t thread;
+	unsigned int seed;
+} vanessa_thread_pool_worker_t;
+
+struct vanessa_thread_pool_t_struct {
+	vanessa_thread_pool_worker_t *worker;
+	int noworker;
+	vanessa_deque_t *inject;
+	size_t noinject;
+	size_t nopending;
+	int noparked;
+	int error;
+	int closed;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_cond_t done;
+};
+
+/* Worker running in this thread, if any */
+static __thread vanessa_thread_pool_worker_t *__vanessa_thread_pool_self;
+
+
+static void __vanessa_thread_pool_run(vanessa_thread_pool_t *tp,
+		vanessa_thread_pool_task_t *task)
+{
+	if(task->action(task->e, task->data) < 0) {
+		__atomic_store_n(&tp->error, 1, __ATOMIC_RELAXED);
+	}
+	free(task);
+
+	/* Wake waiters, and workers waiting to exit if the pool is closed */
+	if(__atomic_sub_fetch(&tp->nopending, 1, __ATOMIC_ACQ_REL) == 0) {
+		pthread_mutex_lock(&tp->lock);
+		pthread_cond_broadcast(&tp->done);
+		if(tp->closed) {
+			pthread_cond_broadcast(&tp->cond);
+		}
+		pthread_mutex_unlock(&tp->lock);
+	}
+}
+
+
+/*
+ * Find a task for worker w: its own newest, then the oldest from the
+ * injection queue, then the oldest of another worker.
+ * Returns the task, or NULL if none was found.
+ */
+
+static vanessa_thread_pool_task_t *__vanessa_thread_pool_find(
+		vanessa_thread_pool_worker_t *w)
+{
+	vanessa_thread_pool_t *tp = w->tp;
+	void *task = NULL;
+	int victim;
+	int retry;
+	int i;
+
+	if(vanessa_ws_deque_pop(w->d, &task) != NULL) {
+		return((vanessa_thread_pool_task_t *)task);
+	}
+
+	if(__atomic_load_n(&tp->noinject, __ATOMIC_ACQUIRE) > 0) {
+		/* Another worker may empty the queue before we lock it */
+		task = NULL;
+		pthread_mutex_lock(&tp->lock);
+		if(vanessa_deque_pop_first(tp->inject, &task) != NULL) {
+			__atomic_sub_fetch(&tp->noinject, 1,
+					__ATOMIC_RELAXED);
+		}
+		pthread_mutex_unlock(&tp->lock);
+		if(task != NULL) {
+			return((vanessa_thread_pool_task_t *)task);
+		}
+	}
+
+	do {
+		retry = 0;
+		victim = rand_r(&w->seed) % tp->noworker;
+		for(i = 0; i < tp->noworker; i++) {
+			if(tp->worker + victim != w) {
+				switch(vanessa_ws_deque_steal(
+						tp->worker[victim].d, &task)) {
+				case 1:
+					return((vanessa_thread_pool_task_t *)
+							task);
+				case -1:
+					retry = 1;
+					break;
+				}
+			}
+			victim = (victim + 1) % tp->noworker;
+		}
+	} while(retry);
+
+	return(NULL);
+}
+
+
+/*
+ * Check whether there is any task to be found, or the pool is closed
+ * and all tasks have run so the worker should exit.
+ * Called with the lock held by a worker about to park.
+ */
+
+static int __vanessa_thread_pool_has_work(vanessa_thread_pool_t *tp)
+{
+	int i;
+
+	if((tp->closed && __atomic_load_n(&tp->nopending,
+					__ATOMIC_ACQUIRE) == 0) ||
+			vanessa_deque_length(tp->inject) > 0) {
+		return(1);
+	}
+	for(i = 0; i < tp->noworker; i++) {
+		if(vanessa_ws_deque_length(tp->worker[i].d) > 0) {
+			return(1);
+		}
+	}
+
+	return(0);
+}
+
+
+static void *__vanessa_thread_pool_worker(void *data)
+{
+	vanessa_thread_pool_worker_t *w;
+	vanessa_thread_pool_t *tp;
+	vanessa_thread_pool_task_t *task;
+
+	w = (vanessa_thread_pool_worker_t *)data;
+	tp = w->tp;
+	__vanessa_thread_pool_self = w;
+
+	while(1) {
+		task = __vanessa_thread_pool_find(w);
+		if(task != NULL) {
+			__vanessa_thread_pool_run(tp, task);
+			continue;
+		}
+
+		pthread_mutex_lock(&tp->lock);
+		__atomic_add_fetch(&tp->noparked, 1, __ATOMIC_SEQ_CST);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if(!__vanessa_thread_pool_has_work(tp)) {
+			pthread_cond_wait(&tp->cond, &tp->lock);
+		}
+		__atomic_sub_fetch(&tp->noparked, 1, __ATOMIC_SEQ_CST);
+		if(tp->closed && __atomic_load_n(&tp->nopending,
+					__ATOMIC_ACQUIRE) == 0) {
+			pthread_mutex_unlock(&tp->lock);
+			break;
+		}
+		pthread_mutex_unlock(&tp->lock);
+	}
+
+	return(NULL);
+}
+
+
+/*
+ * Wake a parked worker, if there is one, after a task has been added
+ */
+
+static void __vanessa_thread_pool_wake(vanessa_thread_pool_t *tp)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&tp->noparked, __ATOMIC_SEQ_CST) > 0) {
+		pthread_mutex_lock(&tp->lock);
+		pthread_cond_signal(&tp->cond);
+		pthread_mutex_unlock(&tp->lock);
+	}
+}
+
+
+/*
+ * Close a pool, wait for the first nothread workers to finish the
+ * tasks that remain and exit, and free the pool
+ */
+
+static void __vanessa_thread_pool_stop(vanessa_thread_pool_t *tp,
+		int nothread)
+{
+	int i;
+
+	pthread_mutex_lock(&tp->lock);
+	tp->closed = 1;
+	pthread_cond_broadcast(&tp->cond);
+	pthread_mutex_unlock(&tp->lock);
+
+	for(i = 0; i < nothread; i++) {
+		pthread_join(tp->worker[i].thread, NULL);
+	}
+
+	for(i = 0; i < tp->noworker; i++) {
+		vanessa_ws_deque_destroy(tp->worker[i].d);
+	}
+	vanessa_deque_destroy(tp->inject);
+	pthread_cond_destroy(&tp->done);
+	pthread_cond_destroy(&tp->cond);
+	pthread_mutex_destroy(&tp->lock);
+	free(tp->worker);
+	free(tp);
+}
+
+
+/**********************************************************************
+ * vanessa_thread_pool_create
+ * Create a pool of threads to run tasks
+ * pre: noworker: number of worker threads
+ * post: worker threads are started, and wait for tasks
+ * return: new thread pool
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_thread_pool_t *vanessa_thread_pool_create(int noworker)
+{
+	vanessa_thread_pool_t *tp;
+	int i;
+
+	if(noworker < 1) {
+		VANESSA_LOGGER_DEBUG("invalid argument");
+		return(NULL);
+	}
+
+	tp = (vanessa_thread_pool_t *)malloc(sizeof(vanessa_thread_pool_t));
+	if(tp == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+
+	tp->worker = (vanessa_thread_pool_worker_t *)calloc(noworker,
+			sizeof(vanessa_thread_pool_worker_t));
+	if(tp->worker == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("calloc");
+		free(tp);
+		return(NULL);
+	}
+
+	tp->noworker = noworker;
+	tp->noinject = 0;
+	tp->nopending = 0;
+	tp->noparked = 0;
+	tp->error = 0;
+	tp->closed = 0;
+	pthread_mutex_init(&tp->lock, NULL);
+	pthread_cond_init(&tp->cond, NULL);
+	pthread_cond_init(&tp->done, NULL);
+
+	/* Deques which were not created are NULL, which is harmless */
+	tp->inject = vanessa_deque_create(NULL);
+	if(tp->inject == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_deque_create");
+		__vanessa_thread_pool_stop(tp, 0);
+		return(NULL);
+	}
+	for(i = 0; i < noworker; i++) {
+		tp->worker[i].tp = tp;
+		tp->worker[i].seed = i;
+		tp->worker[i].d = vanessa_ws_deque_create(NULL);
+		if(tp->worker[i].d == NULL) {
+			VANESSA_LOGGER_DEBUG("vanessa_ws_deque_create");
+			__vanessa_thread_pool_stop(tp, 0);
+			return(NULL);
+		}
+	}
+
+	for(i = 0; i < noworker; i++) {
+		if(pthread_create(&tp->worker[i].thread, NULL,
+					__vanessa_thread_pool_worker,
+					tp->worker + i) != 0) {
+			VANESSA_LOGGER_DEBUG("pthread_create");
+			__vanessa_thread_pool_stop(tp, i);
+			return(NULL);
+		}
+	}
+
+	return(tp);
+}
+
+
+/**********************************************************************
+ * vanessa_thread_pool_destroy
+ * Destroy a thread pool, once all tasks submitted to it have run
+ * pre: tp: thread pool. No threads other than its workers may be
+ *          submitting tasks to it.
+ * post: tasks already submitted, and any they submit, are run, then
+ *       the workers exit and the pool is freed
+ * return: none
+ **********************************************************************/
+
+void vanessa_thread_pool_destroy(vanessa_thread_pool_t *tp)
+{
+	if(tp == NULL) {
+		return;
+	}
+
+	__vanessa_thread_pool_stop(tp, tp->noworker);
+}
+
+
+/**********************************************************************
+ * vanessa_thread_pool_submit
+ * Submit a task to a thread pool
+ * pre: tp: thread pool
+ *      action: function to run, as for vanessa_list_iterate.
+ *              It should return < 0 if an error occurs, which is
+ *              reported by vanessa_thread_pool_wait.
+ *      e: element passed to action as its first argument
+ *      data: data passed to action as its second argument
+ * post: the task is queued to be run by a worker. If called by a
+ *       worker of tp, it is queued on the worker's own deque, to be
+ *       run by it next unless another worker steals it first.
+ * return: tp
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_thread_pool_t *vanessa_thread_pool_submit(vanessa_thread_pool_t *tp,
+		int (*action) (void *e, void *data), void *e, void *data)
+{
+	vanessa_thread_pool_worker_t *w = __vanessa_thread_pool_self;
+	vanessa_thread_pool_task_t *task;
+
+	task = (vanessa_thread_pool_task_t *)
+		malloc(sizeof(vanessa_thread_pool_task_t));
+	if(task == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+	task->action = action;
+	task->e = e;
+	task->data = data;
+
+	__atomic_add_fetch(&tp->nopending, 1, __ATOMIC_RELAXED);
+
+	if(w != NULL && w->tp == tp) {
+		if(vanessa_ws_deque_push(w->d, task) == NULL) {
+			VANESSA_LOGGER_DEBUG("vanessa_ws_deque_push");
+			goto err;
+		}
+	}
+	else {
+		pthread_mutex_lock(&tp->lock);
+		if(vanessa_deque_push_last(tp->inject, task) == NULL) {
+			pthread_mutex_unlock(&tp->lock);
+			VANESSA_LOGGER_DEBUG("vanessa_deque_push_last");
+			goto err;
+		}
+		__atomic_add_fetch(&tp->noinject, 1, __ATOMIC_RELEASE);
+		pthread_mutex_unlock(&tp->lock);
+	}
+
+	__vanessa_thread_pool_wake(tp);
+
+	return(tp);
+
+err:
+	__atomic_sub_fetch(&tp->nopending, 1, __ATOMIC_RELAXED);
+	free(task);
+	return(NULL);
+}
+
+
+/**********************************************************************
+ * vanessa_thread_pool_wait
+ * Wait for all tasks submitted to a thread pool to be run
+ * pre: tp: thread pool. Should not be called by its workers.
+ * post: all tasks submitted before, or while, waiting have been run
+ * return: 0 if all tasks run since vanessa_thread_pool_create, or the
+ *         last call to vanessa_thread_pool_wait, returned >= 0
+ *         -1 otherwise
+ **********************************************************************/
+
+int vanessa_thread_pool_wait(vanessa_thread_pool_t *tp)
+{
+	pthread_mutex_lock(&tp->lock);
+	while(__atomic_load_n(&tp->nopending, __ATOMIC_ACQUIRE) > 0) {
+		pthread_cond_wait(&tp->done, &tp->lock);
+	}
+	pthread_mutex_unlock(&tp->lock);
+
+	return(__atomic_exchange_n(&tp->error, 0, __ATOMIC_RELAXED) ? -1 : 0);
+}
+
+
+/**********************************************************************
+ * vanessa_thread_pool_length
+ * Return the number of tasks submitted to a thread pool which have
+ * not yet finished running
+ * pre: tp: thread pool
+ * post: none
+ * return: number of tasks, which may be out of date by the time it
+ *         is returned
+ *         -1 if tp is NULL
+ **********************************************************************/
+
+ssize_t vanessa_thread_pool_length(const vanessa_thread_pool_t *tp)
+{
+	if(tp == NULL) {
+		return(-1);
+	}
+
+	return((ssize_t)__atomic_load_n(&tp->nopending, __ATOMIC_RELAXED));
+}
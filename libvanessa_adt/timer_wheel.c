@@ -0,0 +1,535 @@
+/**********************************************************************
+ * timer_wheel.c                                           October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Hierarchical timer wheel.
+ *
+ * Timers are bucketed by expiry time in a wheel of several levels,
+ * each slot of a level covering as many ticks as a whole level below
+ * it. Scheduling and cancelling a timer take constant time, and
+ * advancing the clock only visits slots that hold timers. Timers in
+ * higher levels are cascaded down as the clock reaches them.
+ * vanessa_ttl_hash keeps the expiry times of its elements in one.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include "vanessa_adt.h"
+
+/*
+ * The wheel has WHEEL_LEVELS levels of WHEEL_SIZE slots each.
+ * A slot at level n covers WHEEL_SIZE^n ticks.
+ */
+#define WHEEL_BITS   8
+#define WHEEL_SIZE   (1 << WHEEL_BITS)
+#define WHEEL_MASK   (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 4
+#define WHEEL_WORDS  (WHEEL_SIZE / 64)
+
+/* Furthest a timer may be placed from the current tick.
+ * Timers that expire later are re-placed when they are cascaded. */
+#define WHEEL_MAX_DELTA \
+	((1UL << (WHEEL_BITS * (WHEEL_LEVELS - 1))) * (WHEEL_SIZE - 1) - 1)
+
+struct vanessa_timer_wheel_timer_t_struct {
+	vanessa_ilist_t link;
+	unsigned long expire;
+	unsigned int slot;
+	void *value;
+};
+
+struct vanessa_timer_wheel_t_struct {
+	unsigned long tick;
+	size_t count;
+	size_t level_count[WHEEL_LEVELS];
+	unsigned long long occupied[WHEEL_LEVELS][WHEEL_WORDS];
+	vanessa_ilist_t wheel[WHEEL_LEVELS][WHEEL_SIZE];
+	vanessa_pool_t *pool;
+	void (*e_expire) (void *e, void *data);
+	void (*e_destroy) (void *e);
+	void *data;
+};
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_create
+ * Create a new timer wheel, with no timers
+ * pre: element_expire:  Pointer to a function to run when a timer
+ *                       expires. It is passed the element the timer
+ *                       was scheduled with and data. May be NULL.
+ *      data:            data passed to element_expire
+ *      element_destroy: Pointer to a function to destroy the element
+ *                       of a timer that has not expired when the
+ *                       wheel is destroyed. May be NULL.
+ *      now:             Current time, in ticks
+ * post: timer wheel is allocated and initialised
+ * return: pointer to timer wheel
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_timer_wheel_t *vanessa_timer_wheel_create(
+		void (*element_expire) (void *e, void *data), void *data,
+		void (*element_destroy) (void *e), unsigned long now)
+{
+	vanessa_timer_wheel_t *tw;
+	unsigned int level;
+	unsigned int index;
+
+	tw = (vanessa_timer_wheel_t *)malloc(sizeof(vanessa_timer_wheel_t));
+	if(tw == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+	memset(tw, 0, sizeof(vanessa_timer_wheel_t));
+
+	tw->pool = vanessa_pool_create(sizeof(vanessa_timer_wheel_timer_t), 0);
+	if(tw->pool == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_pool_create");
+		free(tw);
+		return(NULL);
+	}
+
+	for(level = 0; level < WHEEL_LEVELS; level++) {
+		for(index = 0; index < WHEEL_SIZE; index++) {
+			vanessa_ilist_init(&tw->wheel[level][index]);
+		}
+	}
+
+	tw->tick = now;
+	tw->e_expire = element_expire;
+	tw->e_destroy = element_destroy;
+	tw->data = data;
+
+	return(tw);
+}
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_destroy
+ * Destroy a timer wheel, and the elements of timers that have not
+ * expired
+ * pre: tw: timer wheel
+ * post: element_destroy is called for the element of each timer
+ *       that has not expired, and the wheel and its timers are freed
+ * return: none
+ **********************************************************************/
+
+void vanessa_timer_wheel_destroy(vanessa_timer_wheel_t *tw)
+{
+	unsigned int level;
+	unsigned int index;
+	vanessa_timer_wheel_timer_t *t;
+
+	if(tw == NULL) {
+		return;
+	}
+
+	for(level = 0; tw->e_destroy != NULL && level < WHEEL_LEVELS;
+			level++) {
+		if(tw->level_count[level] == 0) {
+			continue;
+		}
+		for(index = 0; index < WHEEL_SIZE; index++) {
+			VANESSA_ILIST_FOREACH(t, &tw->wheel[level][index],
+					vanessa_timer_wheel_timer_t, link) {
+				if(t->value != NULL) {
+					tw->e_destroy(t->value);
+				}
+			}
+		}
+	}
+
+	/* Timers are freed along with the slabs of the pool */
+	vanessa_pool_destroy(tw->pool);
+	free(tw);
+}
+
+
+/**********************************************************************
+ * __vanessa_timer_wheel_add
+ * Place a timer in the wheel slot for its expiry time
+ * pre: tw: timer wheel
+ *      t: timer, not present in the wheel
+ * post: t is linked onto the end of a slot of the wheel
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_timer_wheel_add(vanessa_timer_wheel_t *tw,
+		vanessa_timer_wheel_timer_t *t)
+{
+	unsigned long expire;
+	unsigned long delta;
+	unsigned int level;
+	unsigned int index;
+
+	expire = t->expire;
+	if(expire < tw->tick) {
+		expire = tw->tick;
+	}
+	delta = expire - tw->tick;
+	if(delta > WHEEL_MAX_DELTA) {
+		delta = WHEEL_MAX_DELTA;
+		expire = tw->tick + delta;
+	}
+
+	for(level = 0; level < WHEEL_LEVELS - 1; level++) {
+		if(delta < 1UL << (WHEEL_BITS * (level + 1))) {
+			break;
+		}
+	}
+	index = (expire >> (WHEEL_BITS * level)) & WHEEL_MASK;
+
+	t->slot = level * WHEEL_SIZE + index;
+	vanessa_ilist_insert_before(&tw->wheel[level][index], &t->link);
+
+	tw->occupied[level][index / 64] |= 1ULL << (index % 64);
+	tw->level_count[level]++;
+}
+
+
+/**********************************************************************
+ * __vanessa_timer_wheel_remove
+ * Remove a timer from the wheel
+ * pre: tw: timer wheel
+ *      t: timer, present in the wheel or taken off it by
+ *         vanessa_timer_wheel_advance but not yet expired
+ * post: t is unlinked from its list
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_timer_wheel_remove(vanessa_timer_wheel_t *tw,
+		vanessa_timer_wheel_timer_t *t)
+{
+	unsigned int level;
+	unsigned int index;
+
+	level = t->slot / WHEEL_SIZE;
+	index = t->slot % WHEEL_SIZE;
+
+	vanessa_ilist_remove(&t->link);
+
+	if(vanessa_ilist_empty(&tw->wheel[level][index])) {
+		tw->occupied[level][index / 64] &= ~(1ULL << (index % 64));
+	}
+	tw->level_count[level]--;
+}
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_schedule
+ * Schedule a timer
+ * pre: tw: timer wheel
+ *      value: element to pass to element_expire when the timer expires
+ *      expire: time at which the timer expires, in ticks
+ *              If it has already passed the timer expires on the
+ *              next call to vanessa_timer_wheel_advance
+ * post: timer is added to the wheel, in constant time
+ * return: handle to the timer, which is valid until it expires or
+ *         is cancelled
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_timer_wheel_timer_t *vanessa_timer_wheel_schedule(
+		vanessa_timer_wheel_t *tw, void *value, unsigned long expire)
+{
+	vanessa_timer_wheel_timer_t *t;
+
+	if(tw == NULL) {
+		return(NULL);
+	}
+
+	t = (vanessa_timer_wheel_timer_t *)vanessa_pool_alloc(tw->pool);
+	if(t == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_pool_alloc");
+		return(NULL);
+	}
+	t->expire = expire;
+	t->value = value;
+
+	__vanessa_timer_wheel_add(tw, t);
+	tw->count++;
+
+	return(t);
+}
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_reschedule
+ * Change the expiry time of a timer
+ * pre: tw: timer wheel
+ *      t: handle of a timer that has not expired or been cancelled
+ *      expire: new time at which the timer expires, in ticks,
+ *              as for vanessa_timer_wheel_schedule
+ * post: timer is moved to the slot for its new expiry time,
+ *       in constant time
+ * return: none
+ **********************************************************************/
+
+void vanessa_timer_wheel_reschedule(vanessa_timer_wheel_t *tw,
+		vanessa_timer_wheel_timer_t *t, unsigned long expire)
+{
+	__vanessa_timer_wheel_remove(tw, t);
+	t->expire = expire;
+	__vanessa_timer_wheel_add(tw, t);
+}
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_cancel
+ * Cancel a timer
+ * pre: tw: timer wheel
+ *      t: handle of a timer that has not expired or been cancelled
+ * post: timer is removed from the wheel, in constant time, and its
+ *       handle is no longer valid
+ *       element_expire is not called and the element is not destroyed
+ * return: element the timer was scheduled with
+ **********************************************************************/
+
+void *vanessa_timer_wheel_cancel(vanessa_timer_wheel_t *tw,
+		vanessa_timer_wheel_timer_t *t)
+{
+	void *value;
+
+	__vanessa_timer_wheel_remove(tw, t);
+	tw->count--;
+
+	value = t->value;
+	vanessa_pool_free(tw->pool, t);
+
+	return(value);
+}
+
+
+/**********************************************************************
+ * __vanessa_timer_wheel_next_slot
+ * Find the next occupied slot at a level of the wheel
+ * pre: tw: timer wheel
+ *      level: level of the wheel to search
+ *      index: index to start searching from, inclusive
+ * return: distance from index to the next occupied slot,
+ *         wrapping around the end of the level
+ *         WHEEL_SIZE if the level is empty
+ **********************************************************************/
+
+static unsigned int __vanessa_timer_wheel_next_slot(
+		const vanessa_timer_wheel_t *tw, unsigned int level,
+		unsigned int index)
+{
+	unsigned int i;
+	unsigned int word;
+	unsigned long long bits;
+
+	for(i = 0; i <= WHEEL_WORDS; i++) {
+		word = (index / 64 + i) % WHEEL_WORDS;
+		bits = tw->occupied[level][word];
+		if(i == 0) {
+			bits &= ~0ULL << (index % 64);
+		}
+		else if(i == WHEEL_WORDS) {
+			bits &= ~(~0ULL << (index % 64));
+		}
+		if(bits) {
+			return((word * 64 + __builtin_ctzll(bits) + WHEEL_SIZE
+					- index) % WHEEL_SIZE);
+		}
+	}
+
+	return(WHEEL_SIZE);
+}
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_next_event
+ * Find the next tick at which the wheel needs to be advanced
+ * pre: tw: timer wheel
+ *      next: set to the first tick, no earlier than the tick after
+ *            that last passed to vanessa_timer_wheel_advance, at
+ *            which either a timer expires or timers are due to be
+ *            cascaded. No timer expires before it.
+ * post: none
+ * return: 0 if the wheel has timers
+ *         -1 if there are no timers or tw is NULL
+ **********************************************************************/
+
+int vanessa_timer_wheel_next_event(const vanessa_timer_wheel_t *tw,
+		unsigned long *next)
+{
+	unsigned int level;
+	unsigned int shift;
+	unsigned int distance;
+	unsigned long slot;
+	unsigned long event;
+	int status = -1;
+
+	if(tw == NULL) {
+		return(-1);
+	}
+
+	for(level = 0; level < WHEEL_LEVELS; level++) {
+		if(tw->level_count[level] == 0) {
+			continue;
+		}
+		shift = WHEEL_BITS * level;
+		/* First slot at this level that starts at or after tick */
+		slot = tw->tick >> shift;
+		if(slot << shift != tw->tick) {
+			slot++;
+		}
+		distance = __vanessa_timer_wheel_next_slot(tw, level,
+				slot & WHEEL_MASK);
+		if(distance == WHEEL_SIZE) {
+			continue;
+		}
+		event = (slot + distance) << shift;
+		if(status < 0 || event < *next) {
+			*next = event;
+			status = 0;
+		}
+	}
+
+	return(status);
+}
+
+
+/**********************************************************************
+ * __vanessa_timer_wheel_cascade
+ * Re-place the timers of a wheel slot
+ * pre: tw: timer wheel
+ *      level: level of the slot
+ *      index: index of the slot
+ * post: timers are moved to lower levels of the wheel
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_timer_wheel_cascade(vanessa_timer_wheel_t *tw,
+		unsigned int level, unsigned int index)
+{
+	vanessa_ilist_t list;
+	vanessa_timer_wheel_timer_t *t;
+
+	vanessa_ilist_init(&list);
+	vanessa_ilist_splice(&list, &tw->wheel[level][index]);
+	tw->occupied[level][index / 64] &= ~(1ULL << (index % 64));
+
+	while((t = VANESSA_ILIST_FIRST(&list, vanessa_timer_wheel_timer_t,
+					link)) != NULL) {
+		vanessa_ilist_remove(&t->link);
+		tw->level_count[level]--;
+		__vanessa_timer_wheel_add(tw, t);
+	}
+}
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_advance
+ * Advance the clock of a timer wheel, expiring timers
+ * pre: tw: timer wheel
+ *      now: current time, in ticks
+ * post: each timer whose expiry time is <= now is removed from the
+ *       wheel and element_expire is called for its element, in order
+ *       of expiry time, and then of scheduling for timers that expire
+ *       at the same tick.
+ *       element_expire may schedule, reschedule and cancel timers,
+ *       but must not advance or destroy the wheel.
+ *       Only occupied slots of the wheel are visited, so the cost
+ *       is proportional to the number of timers expired and cascaded.
+ * return: number of timers that expired
+ **********************************************************************/
+
+size_t vanessa_timer_wheel_advance(vanessa_timer_wheel_t *tw,
+		unsigned long now)
+{
+	size_t expired = 0;
+	unsigned long tick;
+	unsigned int level;
+	unsigned int index;
+	vanessa_ilist_t due;
+	vanessa_timer_wheel_timer_t *t;
+	void *value;
+
+	if(tw == NULL || now < tw->tick) {
+		return(0);
+	}
+
+	vanessa_ilist_init(&due);
+	while(vanessa_timer_wheel_next_event(tw, &tick) == 0 && tick <= now) {
+		tw->tick = tick;
+
+		for(level = 1; level < WHEEL_LEVELS; level++) {
+			if(tick & ((1UL << (WHEEL_BITS * level)) - 1)) {
+				break;
+			}
+			__vanessa_timer_wheel_cascade(tw, level,
+					(tick >> (WHEEL_BITS * level)) &
+					WHEEL_MASK);
+		}
+
+		/*
+		 * Take the slot off the wheel, so that timers scheduled
+		 * by element_expire are not run until the next tick.
+		 * Timers on due still count as being in their slot,
+		 * so that they may be cancelled.
+		 */
+		tw->tick = tick + 1;
+		index = tick & WHEEL_MASK;
+		vanessa_ilist_splice(&due, &tw->wheel[0][index]);
+		tw->occupied[0][index / 64] &= ~(1ULL << (index % 64));
+
+		while((t = VANESSA_ILIST_FIRST(&due,
+					vanessa_timer_wheel_timer_t,
+					link)) != NULL) {
+			vanessa_ilist_remove(&t->link);
+			tw->level_count[0]--;
+			if(t->expire > tick) {
+				/* Placement was clamped, re-place it */
+				__vanessa_timer_wheel_add(tw, t);
+				continue;
+			}
+			tw->count--;
+			value = t->value;
+			vanessa_pool_free(tw->pool, t);
+			expired++;
+			if(tw->e_expire != NULL) {
+				tw->e_expire(value, tw->data);
+			}
+		}
+	}
+
+	tw->tick = now + 1;
+
+	return(expired);
+}
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_get_count
+ * Get the number of timers in a timer wheel
+ * pre: tw: timer wheel
+ * post: none
+ * return: number of timers that have neither expired nor been
+ *         cancelled
+ *         0 if tw is NULL
+ **********************************************************************/
+
+size_t vanessa_timer_wheel_get_count(const vanessa_timer_wheel_t *tw)
+{
+	return(tw == NULL ? 0 : tw->count);
+}
@@ -0,0 +1,504 @@
+/**********************************************************************
+ * ttl_hash.c                                              October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Hash whose elements expire after a time to live.
+ *
+ * Elements are kept in hash buckets, as per vanessa_hash, and each
+ * has a timer in a vanessa_timer_wheel for its expiry time.
+ * Advancing the clock only visits wheel slots that hold elements,
+ * so the cost of expiring elements is proportional to the number of
+ * elements that expire rather than to the number of elements held.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include "vanessa_adt.h"
+
+typedef struct vanessa_ttl_hash_elem_struct vanessa_ttl_hash_elem_t;
+
+struct vanessa_ttl_hash_elem_struct {
+	vanessa_ttl_hash_elem_t *next;
+	vanessa_ttl_hash_elem_t *prev;
+	vanessa_timer_wheel_timer_t *timer;
+	unsigned long expire;
+	size_t bucket;
+	void *value;
+};
+
+struct vanessa_ttl_hash_t_struct {
+	vanessa_ttl_hash_elem_t **bucket;
+	size_t nobucket;
+	size_t count;
+	vanessa_timer_wheel_t *wheel;
+	void (*e_destroy) (void *e);
+	void *(*e_duplicate) (void *e);
+	int (*e_match) (void *e, void *key);
+	size_t (*e_hash) (void *e);
+};
+
+
+/**********************************************************************
+ * __vanessa_ttl_hash_expire
+ * Unlink an element from the hash and destroy it
+ * Called by the timer wheel when the timer of an element expires
+ * pre: value: element to remove, whose timer has expired or been
+ *             cancelled
+ *      data: ttl hash
+ * post: element is removed and destroyed
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_ttl_hash_expire(void *value, void *data)
+{
+	vanessa_ttl_hash_elem_t *e = (vanessa_ttl_hash_elem_t *)value;
+	vanessa_ttl_hash_t *h = (vanessa_ttl_hash_t *)data;
+
+	if(e->prev != NULL) {
+		e->prev->next = e->next;
+	}
+	else {
+		h->bucket[e->bucket] = e->next;
+	}
+	if(e->next != NULL) {
+		e->next->prev = e->prev;
+	}
+	h->count--;
+
+	if(h->e_destroy != NULL && e->value != NULL) {
+		h->e_destroy(e->value);
+	}
+	free(e);
+}
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_create
+ * Create a new, empty ttl hash
+ * pre: nobucket: number of buckets in the hash
+ *      element_destroy:   Pointer to a function to destroy an element
+ *                         May be NULL
+ *      element_duplicate: Pointer to a function to duplicate an element
+ *                         May be NULL in which case elements are
+ *                         inserted by reference
+ *      element_match:     Pointer to a function to match an element
+ *                         by a key.
+ *      element_hash:      Pointer to a function that return the hash
+ *                         bucket index, a number >= 0 && < nobucket,
+ *                         for an element.
+ *      now:               Current time, in ticks
+ * post: ttl hash structure is allocated and initialised
+ * return: pointer to ttl hash
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_ttl_hash_t *vanessa_ttl_hash_create(size_t nobucket,
+		void (*element_destroy) (void *e),
+		void *(*element_duplicate) (void *e),
+		int (*element_match) (void *e, void *key),
+		size_t (*element_hash) (void *e),
+		unsigned long now)
+{
+	vanessa_ttl_hash_t *h;
+
+	h = (vanessa_ttl_hash_t *)malloc(sizeof(vanessa_ttl_hash_t));
+	if(h == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+	memset(h, 0, sizeof(vanessa_ttl_hash_t));
+
+	h->bucket = (vanessa_ttl_hash_elem_t **)calloc(nobucket,
+			sizeof(vanessa_ttl_hash_elem_t *));
+	if(h->bucket == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("calloc");
+		free(h);
+		return(NULL);
+	}
+
+	h->wheel = vanessa_timer_wheel_create(__vanessa_ttl_hash_expire, h,
+			NULL, now);
+	if(h->wheel == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_timer_wheel_create");
+		free(h->bucket);
+		free(h);
+		return(NULL);
+	}
+
+	h->nobucket = nobucket;
+	h->e_destroy = element_destroy;
+	h->e_duplicate = element_duplicate;
+	h->e_match = element_match;
+	h->e_hash = element_hash;
+
+	return(h);
+}
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_destroy
+ * Destroy a ttl hash and all the data contained in the hash
+ * pre: h: ttl hash
+ * post: all elements of h are destroyed
+ **********************************************************************/
+
+void vanessa_ttl_hash_destroy(vanessa_ttl_hash_t *h)
+{
+	size_t i;
+	vanessa_ttl_hash_elem_t *e;
+	vanessa_ttl_hash_elem_t *next;
+
+	if(h == NULL) {
+		return;
+	}
+
+	for(i = 0 ; i < h->nobucket ; i++) {
+		for(e = h->bucket[i]; e != NULL; e = next) {
+			next = e->next;
+			if(h->e_destroy != NULL && e->value != NULL) {
+				h->e_destroy(e->value);
+			}
+			free(e);
+		}
+	}
+
+	vanessa_timer_wheel_destroy(h->wheel);
+	free(h->bucket);
+	free(h);
+}
+
+
+/**********************************************************************
+ * __vanessa_ttl_hash_remove
+ * Unlink an element from the hash and the wheel and destroy it
+ * pre: h: ttl hash
+ *      e: element to remove
+ * post: e is removed and destroyed
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_ttl_hash_remove(vanessa_ttl_hash_t *h,
+		vanessa_ttl_hash_elem_t *e)
+{
+	vanessa_timer_wheel_cancel(h->wheel, e->timer);
+	__vanessa_ttl_hash_expire(e, h);
+}
+
+
+/**********************************************************************
+ * __vanessa_ttl_hash_get_bucket
+ * Get the bucket index for a given value
+ * pre: h: ttl hash
+ *      value: value to hash
+ *      bucket: used to return the bucket index
+ * return: 0 on success
+ *         -1 on error
+ **********************************************************************/
+
+static int __vanessa_ttl_hash_get_bucket(vanessa_ttl_hash_t *h,
+		void *value, size_t *bucket)
+{
+	if(h == NULL || value == NULL || h->e_hash == NULL) {
+		return(-1);
+	}
+
+	*bucket = h->e_hash(value);
+	if(*bucket >= h->nobucket) {
+		VANESSA_LOGGER_DEBUG_UNSAFE("hash value too large: %lu >= %lu",
+				(unsigned long)*bucket,
+				(unsigned long)h->nobucket);
+		abort();
+	}
+
+	return(0);
+}
+
+
+/**********************************************************************
+ * __vanessa_ttl_hash_find
+ * Find an element in the ttl hash
+ * pre: h: ttl hash
+ *      key: key to match
+ * return: element if found
+ *         NULL otherwise
+ **********************************************************************/
+
+static vanessa_ttl_hash_elem_t *__vanessa_ttl_hash_find(vanessa_ttl_hash_t *h,
+		void *key)
+{
+	size_t bucket;
+	vanessa_ttl_hash_elem_t *e;
+
+	if(__vanessa_ttl_hash_get_bucket(h, key, &bucket) < 0) {
+		return(NULL);
+	}
+
+	for(e = h->bucket[bucket]; e != NULL; e = e->next) {
+		if(h->e_match != NULL) {
+			if(h->e_match(e->value, key) == 0) {
+				break;
+			}
+		}
+		else if(e->value == key) {
+			break;
+		}
+	}
+
+	return(e);
+}
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_add_element
+ * Insert element into a ttl hash
+ * pre: h: ttl hash to insert value into
+ *      value: value to insert
+ *      now: current time, in ticks
+ *      ttl: number of ticks after now that the element expires
+ * post: value is inserted into the ttl hash
+ * return: NULL if h is NULL or on error
+ *         h, unchanged if value is NULL
+ **********************************************************************/
+
+vanessa_ttl_hash_t *vanessa_ttl_hash_add_element(vanessa_ttl_hash_t *h,
+		void *value, unsigned long now, unsigned long ttl)
+{
+	size_t bucket;
+	vanessa_ttl_hash_elem_t *e;
+
+	if(h == NULL) {
+		return(NULL);
+	}
+	if(__vanessa_ttl_hash_get_bucket(h, value, &bucket) < 0) {
+		return(h);
+	}
+
+	e = (vanessa_ttl_hash_elem_t *)malloc(sizeof(vanessa_ttl_hash_elem_t));
+	if(e == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+
+	if(h->e_duplicate != NULL) {
+		e->value = h->e_duplicate(value);
+		if(e->value == NULL) {
+			VANESSA_LOGGER_DEBUG("e_duplicate");
+			free(e);
+			return(NULL);
+		}
+	}
+	else {
+		e->value = value;
+	}
+
+	e->expire = now + ttl;
+	e->timer = vanessa_timer_wheel_schedule(h->wheel, e, e->expire);
+	if(e->timer == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_timer_wheel_schedule");
+		if(h->e_duplicate != NULL && h->e_destroy != NULL) {
+			h->e_destroy(e->value);
+		}
+		free(e);
+		return(NULL);
+	}
+
+	e->bucket = bucket;
+	e->prev = NULL;
+	e->next = h->bucket[bucket];
+	if(e->next != NULL) {
+		e->next->prev = e;
+	}
+	h->bucket[bucket] = e;
+	h->count++;
+
+	return(h);
+}
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_get_element
+ * Retrieve an element from the ttl hash
+ * pre: h: ttl hash to search
+ *      key: key to match
+ *      now: current time, in ticks
+ * post: If the matching element has expired it is removed from the
+ *       hash and destroyed, regardless of whether
+ *       vanessa_ttl_hash_advance() has reached its expiry time.
+ * return: element if found
+ *         NULL if h or key is NULL, or if no unexpired element matches
+ **********************************************************************/
+
+void *vanessa_ttl_hash_get_element(vanessa_ttl_hash_t *h, void *key,
+		unsigned long now)
+{
+	vanessa_ttl_hash_elem_t *e;
+
+	e = __vanessa_ttl_hash_find(h, key);
+	if(e == NULL) {
+		return(NULL);
+	}
+
+	if(e->expire <= now) {
+		__vanessa_ttl_hash_remove(h, e);
+		return(NULL);
+	}
+
+	return(e->value);
+}
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_touch
+ * Change the time to live of an element
+ * pre: h: ttl hash to search
+ *      key: key to match
+ *      now: current time, in ticks
+ *      ttl: number of ticks after now that the element expires
+ * post: the expiry time of the element matching key is updated
+ *       If the element has already expired it is removed as per
+ *       vanessa_ttl_hash_get_element()
+ * return: element if found
+ *         NULL if h or key is NULL, or if no unexpired element matches
+ **********************************************************************/
+
+void *vanessa_ttl_hash_touch(vanessa_ttl_hash_t *h, void *key,
+		unsigned long now, unsigned long ttl)
+{
+	vanessa_ttl_hash_elem_t *e;
+
+	e = __vanessa_ttl_hash_find(h, key);
+	if(e == NULL) {
+		return(NULL);
+	}
+
+	if(e->expire <= now) {
+		__vanessa_ttl_hash_remove(h, e);
+		return(NULL);
+	}
+
+	e->expire = now + ttl;
+	vanessa_timer_wheel_reschedule(h->wheel, e->timer, e->expire);
+
+	return(e->value);
+}
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_remove_element
+ * Remove an element from a ttl hash
+ * pre: h: ttl hash to remove element from
+ *      key: key of element to remove
+ * post: matching element is removed from the hash and destroyed
+ * return: NULL if h is NULL
+ *         h otherwise
+ **********************************************************************/
+
+vanessa_ttl_hash_t *vanessa_ttl_hash_remove_element(vanessa_ttl_hash_t *h,
+		void *key)
+{
+	vanessa_ttl_hash_elem_t *e;
+
+	if(h == NULL) {
+		return(NULL);
+	}
+
+	e = __vanessa_ttl_hash_find(h, key);
+	if(e != NULL) {
+		__vanessa_ttl_hash_remove(h, e);
+	}
+
+	return(h);
+}
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_advance
+ * Advance the clock of a ttl hash, expiring elements
+ * pre: h: ttl hash
+ *      now: current time, in ticks
+ * post: all elements whose expiry time is <= now are removed from
+ *       the hash and destroyed.
+ *       Only occupied slots of the wheel are visited, so the cost
+ *       is proportional to the number of elements expired.
+ * return: number of elements that were expired
+ **********************************************************************/
+
+size_t vanessa_ttl_hash_advance(vanessa_ttl_hash_t *h, unsigned long now)
+{
+	if(h == NULL) {
+		return(0);
+	}
+
+	return(vanessa_timer_wheel_advance(h->wheel, now));
+}
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_get_count
+ * Get the number of elements stored in the ttl hash
+ * pre: h: ttl hash to count the elements of
+ * post: none
+ * return: Number of elements stored in the ttl hash, including
+ *         elements that have expired but not yet been removed
+ *         0 if h is NULL or empty
+ **********************************************************************/
+
+size_t vanessa_ttl_hash_get_count(vanessa_ttl_hash_t *h)
+{
+	return(h == NULL ? 0 : h->count);
+}
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_iterate
+ * Run a function over each element in the ttl hash
+ * pre: h: ttl hash run the function over
+ *      action: function to run
+ *              action should return < 0 if an error occurs,
+ *              which indicates that processing will be stopped
+ *      data: data passed to action
+ * post: action is run with the value of each element as its first argument
+ * return: 0 on success
+ *         < 0 if action returns < 0
+ **********************************************************************/
+
+int vanessa_ttl_hash_iterate(vanessa_ttl_hash_t *h,
+		int (*action)(void *e, void *data), void *data)
+{
+	size_t i;
+	int status;
+	vanessa_ttl_hash_elem_t *e;
+
+	if(h == NULL) {
+		return(0);
+	}
+
+	for(i = 0 ; i < h->nobucket ; i++) {
+		for(e = h->bucket[i]; e != NULL; e = e->next) {
+			status = action(e->value, data);
+			if(status < 0) {
+				return(status);
+			}
+		}
+	}
+
+	return(0);
+}
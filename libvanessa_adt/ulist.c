@@ -0,0 +1,617 @@
+/**********************************************************************
+ * ulist.c                                                 October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Unrolled linked list
+ *
+ * Each node holds a small array of values and is sized to two cache
+ * lines, so traversal reads values sequentially and only follows a
+ * pointer every few elements. Nodes are allocated from a pool so
+ * that they are also close to each other. Inserting into or
+ * removing from the middle of a node moves at most a node's worth of
+ * pointers. Nodes are split when they overflow and merged with their
+ * successor when they become sparse.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include "vanessa_adt.h"
+
+#define ULIST_NODE_SIZE 128
+#define ULIST_NOVALUE \
+	((ULIST_NODE_SIZE - 2 * sizeof(void *) - sizeof(int)) / sizeof(void *))
+
+typedef struct vanessa_ulist_node_struct vanessa_ulist_node_t;
+
+struct vanessa_ulist_node_struct {
+	vanessa_ulist_node_t *next;
+	vanessa_ulist_node_t *prev;
+	int count;
+	void *value[ULIST_NOVALUE];
+};
+
+struct vanessa_ulist_t_struct {
+	vanessa_ulist_node_t *first;
+	vanessa_ulist_node_t *last;
+	size_t count;
+	vanessa_pool_t *pool;
+	void (*e_destroy) (void *e);
+	void *(*e_duplicate) (void *e);
+	void (*e_display) (char *s, void *e);
+	size_t(*e_length) (void *e);
+	int (*e_match) (void *e, void *key);
+	int (*e_sort) (void *a, void *b);
+};
+
+
+/**********************************************************************
+ * vanessa_ulist_create
+ * Create a new, empty unrolled list
+ * pre: element_destroy:   Pointer to a function to destroy an element
+ *                         May be NULL
+ *      element_duplicate: Pointer to a function to duplicate an element
+ *                         May be NULL in which case elements are
+ *                         inserted by reference
+ *      element_display:   Pointer to a function to display an element
+ *                         May be NULL in which case
+ *                         vanessa_ulist_display will return an empty
+ *                         string ("")
+ *      element_size:      Pointer to a function to find the length of an
+ *                         ASCII representation of the element not
+ *                         including the trailing '\0'. May be NULL, in
+ *                         which case vanessa_ulist_display will return
+ *                         an empty string ("")
+ *      element_match:     Pointer to a function to match an element
+ *                         by a key. May be NULL in which case
+ *                         elements are matched by address.
+ *      element_sort:      Pointer to a function that will compare
+ *                         two elements, as for vanessa_list_create.
+ *                         May be NULL in which case elements are
+ *                         appended to the end of the list.
+ * post: list is allocated and initialised
+ * return: pointer to list
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_ulist_t *vanessa_ulist_create(void (*element_destroy) (void *e),
+		void *(*element_duplicate) (void *e),
+		void (*element_display) (char *s, void *e),
+		size_t(*element_size) (void *e),
+		int (*element_match) (void *e, void *key),
+		int (*element_sort) (void *a, void *b))
+{
+	vanessa_ulist_t *l;
+
+	l = (vanessa_ulist_t *)malloc(sizeof(vanessa_ulist_t));
+	if(l == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+
+	l->pool = vanessa_pool_create(sizeof(vanessa_ulist_node_t),
+			VANESSA_POOL_RELEASE);
+	if(l->pool == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_pool_create");
+		free(l);
+		return(NULL);
+	}
+
+	l->first = NULL;
+	l->last = NULL;
+	l->count = 0;
+	l->e_destroy = element_destroy;
+	l->e_duplicate = element_duplicate;
+	l->e_display = element_display;
+	l->e_length = element_size;
+	l->e_match = element_match;
+	l->e_sort = element_sort;
+
+	return(l);
+}
+
+
+/**********************************************************************
+ * vanessa_ulist_destroy
+ * Destroy an unrolled list and all the data contained in the list
+ * pre: l: list
+ * post: all elements of l are destroyed
+ **********************************************************************/
+
+void vanessa_ulist_destroy(vanessa_ulist_t *l)
+{
+	vanessa_ulist_node_t *n;
+	int i;
+
+	if(l == NULL) {
+		return;
+	}
+
+	if(l->e_destroy != NULL) {
+		for(n = l->first; n != NULL; n = n->next) {
+			for(i = 0; i < n->count; i++) {
+				l->e_destroy(n->value[i]);
+			}
+		}
+	}
+
+	/* Frees the nodes */
+	vanessa_pool_destroy(l->pool);
+	free(l);
+}
+
+
+/**********************************************************************
+ * vanessa_ulist_length
+ * Find the length of an ASCII representation of an unrolled list
+ * Not including a terminating '\0'.
+ * pre: l: list to find the length of
+ * return: Cumulative length of the elements, plus one character per
+ *         element for a delimiter between elements.
+ *         0 if l is NULL or there are no elements in l or if
+ *         element_length passed to vanessa_ulist_create is NULL.
+ **********************************************************************/
+
+size_t vanessa_ulist_length(vanessa_ulist_t *l)
+{
+	vanessa_ulist_node_t *n;
+	size_t len = 0;
+	int i;
+
+	if(l == NULL || l->count == 0 || l->e_length == NULL) {
+		return(0);
+	}
+
+	for(n = l->first; n != NULL; n = n->next) {
+		for(i = 0; i < n->count; i++) {
+			if(n->value[i] != NULL) {
+				len += l->e_length(n->value[i]);
+			}
+		}
+	}
+
+	/* Delimiters, but no space for trailing '\0' */
+	return(len + l->count - 1);
+}
+
+
+/**********************************************************************
+ * vanessa_ulist_display
+ * Make an ASCII representation of an unrolled list
+ * pre: l: list to display
+ *      delimiter: character to place between elements of the list
+ * post: If element_display or element_length, as passed to
+ *          vanessa_ulist_create, are NULL, then an empty string
+ *          ("") is returned.
+ *       Else a character buffer is allocated and an ASCII
+ *          representation of each list element, as determined by
+ *          element_display, separated by delimiter is placed in
+ *          the '\0' terminated buffer that is returned.
+ *          It is up to the user to free this buffer.
+ * return: Allocated buffer as above
+ *         NULL on error, NULL l or empty l
+ **********************************************************************/
+
+char *vanessa_ulist_display(vanessa_ulist_t *l, char delimiter)
+{
+	vanessa_ulist_node_t *n;
+	char *buffer;
+	char *p;
+	size_t len;
+	int i;
+
+	if(l == NULL || l->count == 0) {
+		return(NULL);
+	}
+
+	if(l->e_length == NULL || l->e_display == NULL) {
+		return(strdup(""));
+	}
+
+	buffer = (char *)malloc(vanessa_ulist_length(l) + 1);
+	if(buffer == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+
+	p = buffer;
+	for(n = l->first; n != NULL; n = n->next) {
+		for(i = 0; i < n->count; i++) {
+			if(n->value[i] != NULL &&
+					(len = l->e_length(n->value[i]))) {
+				l->e_display(p, n->value[i]);
+				p += len;
+			}
+			*p++ = delimiter;
+		}
+	}
+	*--p = '\0';
+
+	return(buffer);
+}
+
+
+/**********************************************************************
+ * __vanessa_ulist_find
+ * Find an element by key
+ * pre: l: list to search
+ *      key: key to match
+ *      node: set to the node holding the element
+ *      index: set to the index of the element in the node
+ * post: none
+ * return: 0 if found
+ *         -1 otherwise
+ **********************************************************************/
+
+static int __vanessa_ulist_find(vanessa_ulist_t *l, void *key,
+		vanessa_ulist_node_t **node, int *index)
+{
+	vanessa_ulist_node_t *n;
+	int i;
+
+	for(n = l->first; n != NULL; n = n->next) {
+		for(i = 0; i < n->count; i++) {
+			if(l->e_match != NULL ?
+					l->e_match(n->value[i], key) == 0 :
+					n->value[i] == key) {
+				*node = n;
+				*index = i;
+				return(0);
+			}
+		}
+	}
+
+	return(-1);
+}
+
+
+/**********************************************************************
+ * vanessa_ulist_get_element
+ * Find an element in an unrolled list by key using the element_match
+ * function passed to vanessa_ulist_create
+ * pre: l: list to search
+ *      key: key to match
+ * post: none
+ * return: value if it is found
+ *         NULL if l or key is NULL or if value matching key is not found
+ **********************************************************************/
+
+void *vanessa_ulist_get_element(vanessa_ulist_t *l, void *key)
+{
+	vanessa_ulist_node_t *n;
+	int i;
+
+	if(l == NULL || key == NULL ||
+			__vanessa_ulist_find(l, key, &n, &i) < 0) {
+		return(NULL);
+	}
+
+	return(n->value[i]);
+}
+
+
+/**********************************************************************
+ * vanessa_ulist_get_count
+ * Count the number of elements in an unrolled list
+ * pre: l: list to count
+ * post: none
+ * return: number of elements in the list, O(1)
+ *         0 if l is NULL
+ **********************************************************************/
+
+size_t vanessa_ulist_get_count(vanessa_ulist_t *l)
+{
+	if(l == NULL) {
+		return(0);
+	}
+
+	return(l->count);
+}
+
+
+/**********************************************************************
+ * __vanessa_ulist_node_create
+ * Create a node and link it into an unrolled list
+ * pre: l: list
+ *      prev: node to link the new node after, NULL for the start
+ * post: an empty node is linked after prev
+ * return: the new node
+ *         NULL on error
+ **********************************************************************/
+
+static vanessa_ulist_node_t *__vanessa_ulist_node_create(vanessa_ulist_t *l,
+		vanessa_ulist_node_t *prev)
+{
+	vanessa_ulist_node_t *n;
+
+	n = (vanessa_ulist_node_t *)vanessa_pool_alloc(l->pool);
+	if(n == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_pool_alloc");
+		return(NULL);
+	}
+
+	n->count = 0;
+	n->prev = prev;
+	n->next = prev ? prev->next : l->first;
+	if(n->next != NULL) {
+		n->next->prev = n;
+	}
+	else {
+		l->last = n;
+	}
+	if(prev != NULL) {
+		prev->next = n;
+	}
+	else {
+		l->first = n;
+	}
+
+	return(n);
+}
+
+
+/**********************************************************************
+ * __vanessa_ulist_node_destroy
+ * Unlink a node from an unrolled list and free it
+ * pre: l: list
+ *      n: node in l, its values have already been dealt with
+ * post: n is unlinked and freed
+ * return: none
+ **********************************************************************/
+
+static void __vanessa_ulist_node_destroy(vanessa_ulist_t *l,
+		vanessa_ulist_node_t *n)
+{
+	if(n->prev != NULL) {
+		n->prev->next = n->next;
+	}
+	else {
+		l->first = n->next;
+	}
+	if(n->next != NULL) {
+		n->next->prev = n->prev;
+	}
+	else {
+		l->last = n->prev;
+	}
+
+	vanessa_pool_free(l->pool, n);
+}
+
+
+/**********************************************************************
+ * vanessa_ulist_add_element
+ * Insert element into an unrolled list
+ * pre: l: list to insert value into
+ *      value: value to insert
+ * post: value is inserted into the list
+ *       if element_sort passed to vanessa_ulist_create is non-NULL
+ *       then the element will be inserted in order, after any equal
+ *       elements. Otherwise the element will be appended to the end
+ *       of the list.
+ * return: NULL if l is NULL or on error
+ *         l, unchanged if value is NULL
+ **********************************************************************/
+
+vanessa_ulist_t *vanessa_ulist_add_element(vanessa_ulist_t *l, void *value)
+{
+	vanessa_ulist_node_t *n;
+	vanessa_ulist_node_t *split;
+	int i;
+
+	if(l == NULL) {
+		return(NULL);
+	}
+	if(value == NULL) {
+		return(l);
+	}
+
+	/* Find the node and position to insert at */
+	n = l->last;
+	i = n ? n->count : 0;
+	if(l->e_sort != NULL) {
+		while(n != NULL && l->e_sort(value, n->value[0]) < 0) {
+			if(n->prev == NULL) {
+				i = 0;
+				break;
+			}
+			n = n->prev;
+			i = n->count;
+		}
+		while(i > 0 && l->e_sort(value, n->value[i - 1]) < 0) {
+			i--;
+		}
+	}
+
+	if(n == NULL) {
+		n = __vanessa_ulist_node_create(l, NULL);
+		if(n == NULL) {
+			return(NULL);
+		}
+	}
+	else if(n->count == ULIST_NOVALUE) {
+		/* Move the top half to a new node */
+		split = __vanessa_ulist_node_create(l, n);
+		if(split == NULL) {
+			return(NULL);
+		}
+		split->count = n->count / 2;
+		n->count -= split->count;
+		memcpy(split->value, n->value + n->count,
+				split->count * sizeof(void *));
+		if(i > n->count) {
+			i -= n->count;
+			n = split;
+		}
+	}
+
+	if(l->e_duplicate != NULL) {
+		value = l->e_duplicate(value);
+		if(value == NULL) {
+			VANESSA_LOGGER_DEBUG("e_duplicate");
+			if(n->count == 0) {
+				__vanessa_ulist_node_destroy(l, n);
+			}
+			return(NULL);
+		}
+	}
+
+	memmove(n->value + i + 1, n->value + i,
+			(n->count - i) * sizeof(void *));
+	n->value[i] = value;
+	n->count++;
+	l->count++;
+
+	return(l);
+}
+
+
+/**********************************************************************
+ * vanessa_ulist_remove_element
+ * Remove an element from an unrolled list
+ * pre: l: list to remove element from
+ *      key: key of element to remove
+ * post: first element matching key is removed from the list and
+ *       destroyed
+ * return: none
+ **********************************************************************/
+
+void vanessa_ulist_remove_element(vanessa_ulist_t *l, void *key)
+{
+	vanessa_ulist_node_t *n;
+	vanessa_ulist_node_t *next;
+	int i;
+
+	if(l == NULL || key == NULL ||
+			__vanessa_ulist_find(l, key, &n, &i) < 0) {
+		return;
+	}
+
+	if(l->e_destroy != NULL) {
+		l->e_destroy(n->value[i]);
+	}
+	n->count--;
+	memmove(n->value + i, n->value + i + 1,
+			(n->count - i) * sizeof(void *));
+	l->count--;
+
+	if(n->count == 0) {
+		__vanessa_ulist_node_destroy(l, n);
+		return;
+	}
+
+	/* Merge sparse nodes so that traversal stays dense */
+	next = n->next;
+	if(n->count < (int)ULIST_NOVALUE / 4 && next != NULL &&
+			n->count + next->count <= (int)ULIST_NOVALUE) {
+		memcpy(n->value + n->count, next->value,
+				next->count * sizeof(void *));
+		n->count += next->count;
+		__vanessa_ulist_node_destroy(l, next);
+	}
+}
+
+
+/**********************************************************************
+ * vanessa_ulist_duplicate
+ * Duplicate an unrolled list
+ * pre: l: list to duplicate
+ * post: list is duplicated, in the same order
+ * return: NULL if l is NULL or on error
+ *         duplicated list
+ **********************************************************************/
+
+vanessa_ulist_t *vanessa_ulist_duplicate(vanessa_ulist_t *l)
+{
+	vanessa_ulist_t *new_l;
+	vanessa_ulist_node_t *n;
+	vanessa_ulist_node_t *new_n;
+	int i;
+
+	if(l == NULL) {
+		return(NULL);
+	}
+
+	new_l = vanessa_ulist_create(l->e_destroy, l->e_duplicate,
+			l->e_display, l->e_length, l->e_match, l->e_sort);
+	if(new_l == NULL) {
+		VANESSA_LOGGER_DEBUG("vanessa_ulist_create");
+		return(NULL);
+	}
+
+	for(n = l->first; n != NULL; n = n->next) {
+		new_n = __vanessa_ulist_node_create(new_l, new_l->last);
+		if(new_n == NULL) {
+			vanessa_ulist_destroy(new_l);
+			return(NULL);
+		}
+		for(i = 0; i < n->count; i++) {
+			new_n->value[i] = l->e_duplicate ?
+				l->e_duplicate(n->value[i]) : n->value[i];
+			if(new_n->value[i] == NULL) {
+				VANESSA_LOGGER_DEBUG("e_duplicate");
+				vanessa_ulist_destroy(new_l);
+				return(NULL);
+			}
+			new_n->count++;
+			new_l->count++;
+		}
+	}
+
+	return(new_l);
+}
+
+
+/**********************************************************************
+ * vanessa_ulist_iterate
+ * Run a function over each element in an unrolled list
+ * pre: l: list run the function over
+ *      action: function to run
+ *              action should return < 0 if an error occurs,
+ *              which indicates that processing will be stopped
+ *      data: data passed to action
+ * post: action is run with the value of each element as its first
+ *       argument, in order
+ * return: 0 on success
+ *         < 0 if action returns < 0
+ **********************************************************************/
+
+int vanessa_ulist_iterate(vanessa_ulist_t *l,
+		int (*action)(void *e, void *data), void *data)
+{
+	vanessa_ulist_node_t *n;
+	int status;
+	int i;
+
+	if(l == NULL) {
+		return(0);
+	}
+
+	for(n = l->first; n != NULL; n = n->next) {
+		for(i = 0; i < n->count; i++) {
+			status = action(n->value[i], data);
+			if(status < 0) {
+				return(status);
+			}
+		}
+	}
+
+	return(0);
+}
@@ -30,6 +30,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <errno.h>
 #include <syslog.h>
@@ -68,6 +69,7 @@ vanessa_queue_t *vanessa_queue_create(void (*e_destroy) (const void *));
  * pre: q: vanessa_queue
  *      value: element to push onto the vanessa_queue
  * post: element is added to queue
+ *       The array of elements is doubled in size if it is full
  * return: vanessa_queue with element added
  *         NULL on error. On error, where possible the vanessa_queue is 
  *         destroyed.
@@ -83,6 +85,8 @@ vanessa_queue_t *vanessa_queue_push(vanessa_queue_t * q, void *value);
  *      value: element removed from the vanessa_queue is assigned to 
  *             *value
  * post: element is removed from queue
+ *       The array of elements is halved in size if it is less than
+ *       1/8 full
  * return: vanessa_queue with element removed
  * Note: popping an empty vanessa_queue results in NULL being returned
  **********************************************************************/
@@ -90,6 +94,39 @@ vanessa_queue_t *vanessa_queue_push(vanessa_queue_t * q, void *value);
 vanessa_queue_t *vanessa_queue_pop(vanessa_queue_t * q, void **value);
 
 
+/**********************************************************************
+ * vanessa_queue_push_n
+ * Push several elements onto the beginning of a vanessa_queue
+ * pre: q: vanessa_queue
+ *      value: elements to push, value[0] being pushed first
+ *      n: number of elements to push
+ * post: elements are added to the queue, so that they will be popped
+ *       in the order they appear in value
+ *       The array of elements is grown at most once, to fit them all
+ * return: vanessa_queue with elements added
+ *         NULL on error, in which case the vanessa_queue is unchanged
+ **********************************************************************/
+
+vanessa_queue_t *vanessa_queue_push_n(vanessa_queue_t * q, void **value,
+		size_t n);
+
+
+/**********************************************************************
+ * vanessa_queue_pop_n
+ * Pop several elements off the end of a vanessa_queue
+ * pre: q: vanessa_queue to pop the elements off
+ *      value: array to place elements in
+ *      n: maximum number of elements to pop
+ * post: up to n elements are removed from the queue, in the order
+ *       vanessa_queue_pop would remove them
+ *       The array of elements is shrunk at most once, if it is then
+ *       less than 1/8 full
+ * return: number of elements popped, 0 if the queue is empty or NULL
+ **********************************************************************/
+
+size_t vanessa_queue_pop_n(vanessa_queue_t * q, void **value, size_t n);
+
+
 /**********************************************************************
  * vanessa_queue_peek_last 
  * Retrieve the last element from a vanessa_queue without removing it 
@@ -150,945 +187,3666 @@ ssize_t vanessa_queue_length(const vanessa_queue_t * q);
 
 
 /**********************************************************************
- * Dynamic array, to store all your flims in. 
- *
- * The primitive type for the array is void *. Thus, providing your own
- * duplicate_primitive, destroy_primitive, display_primitive and
- * length_primitive functions will allow you to use the
- * vanessa_dynamic_array API to have a dynamic array containing any
- * primitive
+ * Double ended queue
  *
- * Includes macros required to create an array of strings or integers.
+ * Elements may be pushed onto and popped off either end, and looked
+ * up by their index, all in O(1) time.
  **********************************************************************/
 
-/*
- * Default blocking size for dynamic array
- * can be overridden when array is created
- */
-#define VANESSA_DEFAULT_DYNAMIC_ARRAY_BLOCK_SIZE (size_t)7
-
+typedef struct vanessa_deque_t_struct vanessa_deque_t;
 
-/* #defines to destroy and duplicate strings */
-#define VANESSA_DESTROY_STR (void (*)(void *s))free
-#define VANESSA_DUPLICATE_STR (void *(*)(void *s))strdup
-#define VANESSA_DISPLAY_STR (void (*)(char *d, void *s))strcpy
-#define VANESSA_LENGTH_STR (size_t (*)(void *s))strlen
-#define VANESSA_MATCH_STR (size_t (*)(void *s))strcmp
-#define VANESSA_SORT_STR VANESSA_MATCH_STR
 
-/* Sort versions */
-#define VANESSA_DESS VANESSA_DESTROY_STR
-#define VANESSA_DUPS VANESSA_DUPLICATE_STR
-#define VANESSA_DISS VANESSA_DISPLAY_STR
-#define VANESSA_LENS VANESSA_LENGTH_STR
-#define VANESSA_MATS VANESSA_MATCH_STR
-#define VANESSA_SORS VANESSA_MATCH_STR
+/**********************************************************************
+ * vanessa_deque_create
+ * Create a new, empty double ended queue
+ * pre: e_destroy: pointer to a function to destroy elements of the
+ *                 deque, as for vanessa_queue_create. It is passed a
+ *                 pointer to the element. If NULL, then elements will
+ *                 not be freed on calls to vanessa_deque_destroy
+ * post: memory is allocated for deque and values are initialised
+ * return: new, empty deque
+ *         NULL on error
+ **********************************************************************/
 
-typedef struct vanessa_dynamic_array_t_struct vanessa_dynamic_array_t;
+vanessa_deque_t *vanessa_deque_create(void (*e_destroy) (const void *));
 
 
 /**********************************************************************
- * vanessa_dynamic_array_create
- * Create a dynamic array
- * pre: block_size: blocking size to use.
- *                  DEFAULT_DYNAMIC_ARRAY_BLOCK_SIZE is used if 
- *                  block_size is 0.
- *                  Block size refers to how many elements are 
- *                  preallocated each time the array is grown. 
- *      element_destroy:   Pointer to a function to destroy an element
- *                         Function should take an argument of a pointer
- *                         and free the memory allocated to the structure
- *                         pointed to.
- *      element_duplicate: Pointer to a function to duplicate an element
- *                         Function should take a pointer to an element to
- *                         duplicate as the only element and return a copy
- *                         of the element Any memory allocation required
- *                         should be done by this function.
- *      element_display:   Pointer to a function to display an element
- *                         Function should take a pointer to char and a
- *                         pointer to an element as arguments. An ASCII
- *                         representation of the element should be placed
- *                         in the character buffer given as the first
- *                         argument.  May be NULL in which case
- *                         vanessa_dynamic_array_display will return an empty
- *                         string ("\0");
- *      element_length:    Pointer to a function to find the length of an
- *                         ASCII representation of the element not
- *                         including the trailing '\0'. Used to guard
- *                         against buffer over runs when using
- *                         element_display. May be NULL, in which case
- *                         vanessa_dynamic_array_display will return an
- *                         empty string ("");
- *
- * post: Dynamic array is allocated and initialised.
- * return: An empty dynamic array 
- *         NULL on error
+ * vanessa_deque_destroy
+ * Destroy a double ended queue, destroying each element present in
+ * the deque first
+ * pre: d: deque to destroy
+ * post: deque and all elements in the deque are destroyed
+ * return: none
  **********************************************************************/
 
-vanessa_dynamic_array_t *vanessa_dynamic_array_create(size_t block_size,
-		void (*element_destroy) (void *), void *(*element_duplicate)
-		(void *s), void (*element_display) (char *, void *),
-		size_t(*element_size) (void *));
+void vanessa_deque_destroy(vanessa_deque_t *d);
 
 
 /**********************************************************************
- * vanessa_dynamic_array_destroy
- * Free an array an all the elements held within
- * pre: a: array to destroy
- * post: array is freed and element_destroy as passed to
- *             vanessa_dynamic_array_create is called for all elements of 
- *             the array.
- *       Nothing if a is NULL
+ * vanessa_deque_reserve
+ * Make room in a double ended queue for a number of elements
+ * pre: d: deque
+ *      n: number of elements
+ * post: the deque is grown, if needed, so that it can hold n elements
+ *       without allocating memory. It may shrink again if elements
+ *       are popped until it is less than 1/8 full.
+ * return: d
+ *         NULL on error, in which case d is unchanged
  **********************************************************************/
 
-void vanessa_dynamic_array_destroy(vanessa_dynamic_array_t * a);
+vanessa_deque_t *vanessa_deque_reserve(vanessa_deque_t *d, size_t n);
 
 
 /**********************************************************************
- * vanessa_dynamic_array_add_element
- * Add an element to a dynamic array
- * pre: a: dynamic array to add element to
- *      e: element to add
- * post: element in inserted in the first unused position in the array
- *       array size is increased by block_size, as passed to
- *       vanessa_dynamic_array_create,if there is insufficient room in 
- *       the array to add the element.
- *       Nothing is done if e is NULL
- * return: a on success
- *         NULL if a is NULL or an error occurs
+ * vanessa_deque_push_first
+ * Push an element onto the beginning of a double ended queue
+ * pre: d: deque
+ *      value: element to push
+ * post: element is added to the deque, as its first element
+ *       The array of elements is doubled in size if it is full
+ * return: d
+ *         NULL on error, in which case d is unchanged
  **********************************************************************/
 
-vanessa_dynamic_array_t *vanessa_dynamic_array_add_element(
-		vanessa_dynamic_array_t * a, void *e);
+vanessa_deque_t *vanessa_deque_push_first(vanessa_deque_t *d, void *value);
 
 
 /**********************************************************************
- * vanessa_dynamic_array_delete_element
- * Delete an element from a dynamic array
- * pre: a: dynamic array to delete element from
- *      index: index of element to delete
- * post: Element is destroyed and removed from array. Subsequent
- *       elements in the array are shuffled up to fill the gap.
- *       array size is decreased by block_size, as passed to
- *       vanessa_dynamic_array_create,  if there number if used elements in
- *       the array falls below a block boundary.
- *       Nothing is done if e is NULL or index is not a valid element
- *       in the array.
- * return: a on success
- *         NULL if a is NULL, index is out of bounds or an error occurs
+ * vanessa_deque_push_last
+ * Push an element onto the end of a double ended queue
+ * pre: d: deque
+ *      value: element to push
+ * post: element is added to the deque, as its last element
+ *       The array of elements is doubled in size if it is full
+ * return: d
+ *         NULL on error, in which case d is unchanged
  **********************************************************************/
 
-vanessa_dynamic_array_t *vanessa_dynamic_array_delete_element(
-		vanessa_dynamic_array_t * a, const ssize_t index);
+vanessa_deque_t *vanessa_deque_push_last(vanessa_deque_t *d, void *value);
 
 
 /**********************************************************************
- * vanessa_dynamic_array_duplicate
- * Duplicate a dynamic array
- * pre: a: Dynamic Array to duplicate
- * return: An empty dynamic array 
- *         NULL on error
+ * vanessa_deque_pop_first
+ * Pop the first element off a double ended queue
+ * pre: d: deque
+ *      value: element removed from the deque is assigned to *value
+ * post: first element is removed from the deque
+ *       The array of elements is halved in size if it is less than
+ *       1/8 full
+ * return: d
+ *         NULL if the deque is empty
  **********************************************************************/
 
-vanessa_dynamic_array_t *vanessa_dynamic_array_duplicate(
-		vanessa_dynamic_array_t * a);
+vanessa_deque_t *vanessa_deque_pop_first(vanessa_deque_t *d, void **value);
 
 
 /**********************************************************************
- * vanessa_dynamic_array_length
- * Find the length of an ASCII representation of a dynamic array.
- * Not including a terminating '\0'.
- * pre: a: dynamic array to find the length of
- * post: If a is NULL or there are no elements in a then the 
- *          length is 0
- *       If element_length, as passed to vanessa_dynamic_array_create, 
- *          is NULL, then 0 is returned.
- *       Else the cumulative lenth of the elemements as per the
- *           element_length function, plus one character per 
- *           element for a delimiter between elements.
- *           The trailing '\0' is not counted.
- *          It is up to the user to free this buffer.  
- * return: Cumulative length of the elements.
- *         0 if a is NULL or there are no elements in a or if
- *           element_length passed to vanessa_list_create is NULL.
+ * vanessa_deque_pop_last
+ * Pop the last element off a double ended queue
+ * pre: d: deque
+ *      value: element removed from the deque is assigned to *value
+ * post: last element is removed from the deque
+ *       The array of elements is halved in size if it is less than
+ *       1/8 full
+ * return: d
+ *         NULL if the deque is empty
  **********************************************************************/
 
-size_t vanessa_dynamic_array_length(vanessa_dynamic_array_t * a);
+vanessa_deque_t *vanessa_deque_pop_last(vanessa_deque_t *d, void **value);
 
 
 /**********************************************************************
- * vanessa_dynamic_array_display
- * Make an ASCII representation of a dynamic array.
- * pre: a: dynamic array to display
- *      delimiter: character to place between elements of the array
- * post: If a is NULL or there are no elements in a then nothing is 
- *          done
- *       If element_display or element_length, as passed to
- *          vanessa_dynamic_array_create, are NULL, then an empty 
- *          string ("") is returned.  
- *       Else a character buffer is allocated and an ASCII 
- *          representation of of each array element, as determined by 
- *          element_display, separated by delimiter is placed in the 
- *          '\0' terminated buffer that is returned. 
- *       It is up to the user to free this buffer.  
- * return: Allocated buffer as above 
- *         NULL on error, 
- *         NULL a or empty a
+ * vanessa_deque_peek_first
+ * Retrieve the first element of a double ended queue without
+ * removing it
+ * pre: d: deque
+ * post: none
+ * return: first element
+ *         NULL if the deque is empty
  **********************************************************************/
 
-char *vanessa_dynamic_array_display(vanessa_dynamic_array_t * a,
-		char delimiter);
+void *vanessa_deque_peek_first(const vanessa_deque_t *d);
 
 
 /**********************************************************************
- * vanessa_dynamic_array_get_element
- * Get an element from an array
- * pre: a: array to retrieve element from
- *      elementno: index element in array to retrieve
- * post: no change is made to a
- * return: element requested
- *         NULL if element is beyond the number of elements in the array
- *         N.B. element may actually be NULL. You can check if an
- *         overflow has occured using by comparing elemntno to the output        *         of vanessa_dynamic_array_get_count()
+ * vanessa_deque_peek_last
+ * Retrieve the last element of a double ended queue without
+ * removing it
+ * pre: d: deque
+ * post: none
+ * return: last element
+ *         NULL if the deque is empty
  **********************************************************************/
 
-void * vanessa_dynamic_array_get_element(vanessa_dynamic_array_t * a,
-					 ssize_t elementno);
+void *vanessa_deque_peek_last(const vanessa_deque_t *d);
 
 
 /**********************************************************************
- * vanessa_dynamic_array_get_count
- * Get the number of elements in the array
- * pre: array to find the number of elements in
- * return: number of elements in the array
- *         -1 if a is NULL
+ * vanessa_deque_get_element
+ * Retrieve an element of a double ended queue by its index
+ * pre: d: deque
+ *      index: index of element, counting from 0 for the first
+ * post: none
+ * return: element at index
+ *         NULL if index is out of range
  **********************************************************************/
 
-ssize_t vanessa_dynamic_array_get_count(vanessa_dynamic_array_t * a);
+void *vanessa_deque_get_element(const vanessa_deque_t *d, size_t index);
 
 
 /**********************************************************************
- * vanessa_dynamic_array_get_vector
- * Get the array contained in the dynamic array
- * pre: array to find the vector of
- * return: vector
- *         NULL if a is NULL
+ * vanessa_deque_set_element
+ * Replace an element of a double ended queue by its index
+ * pre: d: deque
+ *      index: index of element, counting from 0 for the first
+ *      value: new element
+ * post: value is stored at index. The element it replaces is not
+ *       destroyed.
+ * return: element replaced
+ *         NULL if index is out of range
  **********************************************************************/
 
-void **vanessa_dynamic_array_get_vector(vanessa_dynamic_array_t * a);
+void *vanessa_deque_set_element(vanessa_deque_t *d, size_t index,
+		void *value);
 
 
 /**********************************************************************
- * vanessa_dynamic_array_reverse
- * Reverse the order of the elements in a dynamic array
- * pre: a: dynamic array to reverse
- * post: Elements of a are in the reverse order
- * return: none
+ * vanessa_deque_length
+ * Return the number of elements in a double ended queue
+ * pre: d: deque
+ * post: none
+ * return: number of elements in the deque
+ *         -1 if d is NULL
  **********************************************************************/
 
-void vanessa_dynamic_array_reverse(vanessa_dynamic_array_t * a);
+ssize_t vanessa_deque_length(const vanessa_deque_t *d);
 
 
 /**********************************************************************
- * vanessa_dynamic_array_split_str
- * Split a string into substrings on a delimiter
- * pre: str: string to split
- *      delimiter: character to split string on
- * post: string is split. 
- *       Note: The string is modified.
- * return: dynamic array containing sub_strings
- *         NULL on error
- *         string being NULL is an error state
+ * Blocking queue
+ *
+ * An unbounded queue which any number of threads may push elements
+ * onto, and pop elements off, waiting for elements to be pushed.
+ * A queue may be closed, after which the elements left in it may be
+ * drained before pops indicate that it is closed.
  **********************************************************************/
 
-vanessa_dynamic_array_t *vanessa_dynamic_array_split_str(char *string,
-							 const char
-							 delimiter);
+typedef struct vanessa_blocking_queue_t_struct vanessa_blocking_queue_t;
+
+#define VANESSA_BLOCKING_QUEUE_EVENTFD 0x1
 
 
 /**********************************************************************
- * vanessa_dynamic_array_split_str_to_int
- * Split a string into substrings on a delimiter
- *       The substrings are converted into the integers that they represent
- *       and the integers are stored.
- * pre: str: string to split
- *      delimiter: character to split string on
- * post: string is split. 
- *       Note: The string is modified.
- * return: dynamic array containing integers
- *         NULL on error
- *         string being NULL is an error state
+ * vanessa_blocking_queue_create
+ * Create a new, empty blocking queue
+ * pre: e_destroy: pointer to a function to destroy elements of the
+ *                 queue, as for vanessa_queue_create. It is passed a
+ *                 pointer to the element. If NULL, then elements will
+ *                 not be freed on calls to
+ *                 vanessa_blocking_queue_destroy
+ *      flag: VANESSA_BLOCKING_QUEUE_EVENTFD to create an eventfd that
+ *            is readable while the queue is not empty or is closed.
+ *            See vanessa_blocking_queue_fd.
+ * post: memory is allocated for queue and values are initialised
+ *       Any number of threads may push and pop elements concurrently.
+ * return: new, empty queue
+ *         NULL on error, including if VANESSA_BLOCKING_QUEUE_EVENTFD
+ *         is given and eventfds are not supported
  **********************************************************************/
 
-vanessa_dynamic_array_t *vanessa_dynamic_array_split_str_to_int(char
-								*string,
-								const char
-								delimiter);
+vanessa_blocking_queue_t *vanessa_blocking_queue_create(
+		void (*e_destroy) (const void *), vanessa_adt_flag_t flag);
 
 
 /**********************************************************************
- * vanessa_destroy_int
- * function to destroy an pointer to an int.
- * pre: i: int to "destroy"
- * post: none
+ * vanessa_blocking_queue_destroy
+ * Destroy a blocking queue, destroying each element present in the
+ * queue first
+ * pre: bq: queue to destroy, which no thread is using or waiting on
+ * post: queue and all elements in the queue are destroyed, and its
+ *       eventfd, if any, is closed
  * return: none
  **********************************************************************/
 
-void vanessa_destroy_int(int *i);
+void vanessa_blocking_queue_destroy(vanessa_blocking_queue_t *bq);
 
 
 /**********************************************************************
- * vanessa_dup_int
- * function to duplicate pointer to an int.
- * pre: i: int to duplicate
- * post: new int is alocated and value of i is copied into it
- * return: pointer to new integer
- *         NULL on error
+ * vanessa_blocking_queue_push
+ * Push an element onto the end of a blocking queue, waking a thread
+ * waiting to pop it
+ * pre: bq: queue
+ *      value: element to push
+ * post: element is added to the queue, unless it is closed
+ * return: bq
+ *         NULL on error, or if the queue is closed, in which case
+ *         errno is set to EPIPE. The queue is unchanged and the
+ *         caller keeps ownership of value.
  **********************************************************************/
 
-int *vanessa_dup_int(int *i);
+vanessa_blocking_queue_t *vanessa_blocking_queue_push(
+		vanessa_blocking_queue_t *bq, void *value);
 
 
 /**********************************************************************
- * vanessa_display_int
- * Display an int in ASCII as a decimal.
- * pre: d: buffer to display ASCII represetation of int to
- *      i: pointer to int to display
- * post: an ASCII representation of i is in d
+ * vanessa_blocking_queue_pop_n
+ * Pop up to n elements off the front of a blocking queue, waiting
+ * for at least one to be pushed if the queue is empty
+ * pre: bq: queue
+ *      value: array to place elements in
+ *      n: maximum number of elements to pop, at least 1
+ *      timeout: time to wait in milliseconds. 0 to return at once,
+ *               negative to wait indefinitely.
+ * post: as many elements as are present, up to n, are removed from
+ *       the queue, oldest first
+ * return: number of elements popped
+ *         0 if the timeout expired with the queue empty
+ *         -1 if the queue is closed and empty, so no more elements
+ *         will ever be popped
+ **********************************************************************/
+
+ssize_t vanessa_blocking_queue_pop_n(vanessa_blocking_queue_t *bq,
+		void **value, size_t n, int timeout);
+
+
+/**********************************************************************
+ * vanessa_blocking_queue_pop
+ * Pop an element off the front of a blocking queue, waiting for one
+ * to be pushed if the queue is empty
+ * pre: bq: queue
+ *      value: element removed from the queue is assigned to *value
+ *      timeout: as for vanessa_blocking_queue_pop_n
+ * post: oldest element is removed from the queue
+ * return: bq
+ *         NULL if the timeout expired, in which case errno is set to
+ *         ETIMEDOUT, or if the queue is closed and empty, in which
+ *         case errno is set to EPIPE
+ **********************************************************************/
+
+vanessa_blocking_queue_t *vanessa_blocking_queue_pop(
+		vanessa_blocking_queue_t *bq, void **value, int timeout);
+
+
+/**********************************************************************
+ * vanessa_blocking_queue_close
+ * Close a blocking queue, so that no more elements may be pushed
+ * onto it
+ * pre: bq: queue
+ * post: further pushes fail. Elements already in the queue may still
+ *       be popped, after which pops return at once, indicating that
+ *       the queue is closed. Threads waiting to pop are woken and the
+ *       eventfd, if any, is made readable so that event loops notice.
  * return: none
  **********************************************************************/
 
-void vanessa_display_int(char *d, int *i);
+void vanessa_blocking_queue_close(vanessa_blocking_queue_t *bq);
 
 
 /**********************************************************************
- * vanessa_length_int
- * Return the length in bytes of an ASCII representation of the in as a
- * decimal.
- * pre: i: pointer to int to find the "length" of
+ * vanessa_blocking_queue_fd
+ * Return the eventfd of a blocking queue
+ * pre: bq: queue created with VANESSA_BLOCKING_QUEUE_EVENTFD
  * post: none
- * return: length is returned
+ * return: file descriptor which polls readable while the queue is not
+ *         empty or is closed. It should not be read from or written
+ *         to, only polled, and is closed by
+ *         vanessa_blocking_queue_destroy. As another thread may pop
+ *         elements first, a pop after it polls readable should use a
+ *         timeout of 0.
+ *         -1 if bq was created without VANESSA_BLOCKING_QUEUE_EVENTFD
  **********************************************************************/
 
-size_t vanessa_length_int(int *i);
+int vanessa_blocking_queue_fd(const vanessa_blocking_queue_t *bq);
 
 
 /**********************************************************************
- * vanessa_match_int
- * Compare two integers. Return the difference. That is < 1 if a < b,
- * 0 if a == b and > 1 if a > b.
- * Analogous to strcmp(3)
- * pre: a: pointer to int to compare
- *      b: pointer to other int to compare
+ * vanessa_blocking_queue_length
+ * Return the number of elements in a blocking queue
+ * pre: bq: queue
  * post: none
- * return: difference between a and b
+ * return: number of elements in the queue, which may be out of date
+ *         by the time it is returned if the queue is in use
+ *         -1 if bq is NULL
  **********************************************************************/
 
-int vanessa_match_int(int *a, int *b);
-
-
-/* #defines to destroy and duplicate integers */
-#define VANESSA_DESTROY_INT (void (*)(void *s))free
-#define VANESSA_DUPLICATE_INT \
-	(void *(*)(void *s))vanessa_dup_int
-#define VANESSA_DISPLAY_INT \
-	(void (*)(char *d, void *s))vanessa_display_int
-#define VANESSA_LENGTH_INT \
-	(size_t (*)(void *s))vanessa_length_int
-#define VANESSA_MATCH_INT \
-	(int (*)(void *e, void *k))vanessa_match_int
-#define VANESSA_SORT_INT VANESSA_MATCH_INT
-
-/* ... and shorter versions */
-#define VANESSA_DESI VANESSA_DESTROY_INT
-#define VANESSA_DUPI VANESSA_DUPLICATE_INT
-#define VANESSA_DISI VANESSA_DISPLAY_INT
-#define VANESSA_LENI VANESSA_LENGTH_INT
-#define VANESSA_MATI VANESSA_MATCH_INT
-#define VANESSA_SORI VANESSA_MATCH_INT
+ssize_t vanessa_blocking_queue_length(vanessa_blocking_queue_t *bq);
 
 
 /**********************************************************************
- * Key value pair
+ * Lock-free single producer, single consumer queue
+ *
+ * A bounded queue for handing elements from one thread to another.
  **********************************************************************/
 
-typedef struct vanessa_key_value_t_struct vanessa_key_value_t;
+typedef struct vanessa_spsc_queue_t_struct vanessa_spsc_queue_t;
 
 
 /**********************************************************************
- * vanessa_key_value_create
- * Create a new vanessa_key_value structure
- * pre: none
- * post: a new vanessa_key_value structure is allocated and elements 
- *       are initialised
- * return: pointer to vanessa_key_value_t
+ * vanessa_spsc_queue_create
+ * Create a new, empty single producer, single consumer queue
+ * pre: size: maximum number of elements in the queue, rounded up to a
+ *            power of two
+ *      e_destroy: pointer to a function to destroy elements of the
+ *                 queue, as for vanessa_queue_create. It is passed a
+ *                 pointer to the element. If NULL, then elements will
+ *                 not be freed on calls to vanessa_spsc_queue_destroy
+ * post: memory is allocated for queue and values are initialised
+ *       One thread may push elements onto the queue and one thread
+ *       may pop them, concurrently, without locking.
+ * return: new, empty queue
  *         NULL on error
  **********************************************************************/
 
-vanessa_key_value_t *vanessa_key_value_create(void);
+vanessa_spsc_queue_t *vanessa_spsc_queue_create(size_t size,
+		void (*e_destroy) (const void *));
 
 
 /**********************************************************************
- * vanessa_key_value_destroy
- * Destroy a vanessa_key_value and its contents
- * pre: kv: vanessa_key_value structure to destroy
- * post: kv and its contents are freed
+ * vanessa_spsc_queue_destroy
+ * Destroy a single producer, single consumer queue, destroying each
+ * element present in the queue first
+ * pre: q: queue to destroy, which neither thread is using
+ * post: queue and all elements in the queue are destroyed
  * return: none
  **********************************************************************/
 
-void vanessa_key_value_destroy(vanessa_key_value_t * kv);
+void vanessa_spsc_queue_destroy(vanessa_spsc_queue_t *q);
 
 
 /**********************************************************************
- * vanessa_key_value_duplicate
- * Make a copy of a vanessa_key_value_structure
- * pre: kv: vanessa_key_value structure to duplicate
- * post: 
+ * vanessa_spsc_queue_push
+ * Push an element onto the end of a single producer, single consumer
+ * queue. May only be called by the producer.
+ * pre: q: queue
+ *      value: element to push
+ * post: element is added to the queue, if there is room
+ * return: q
+ *         NULL if the queue is full
  **********************************************************************/
 
-vanessa_key_value_t *vanessa_key_value_duplicate(vanessa_key_value_t * kv);
+vanessa_spsc_queue_t *vanessa_spsc_queue_push(vanessa_spsc_queue_t *q,
+		void *value);
 
 
 /**********************************************************************
- * vanessa_key_value_assign
- * Assign a key and value to a vanessa_key_value structure
- * pre: kv: key_value_structure to assign key and value to
- *      key: key to assign
- *      key_destroy: pointer to a function to destroy key
- *                   Use NULL if you do not want the key destroyed
- *                   when the vanessa_key_value_destroy is called
- *      key_duplicate: pointer to a function to duplicate key
- *                     Use NULL if you want the key duplicated
- *                     using new_key=old_key
- *      value: value to assign
- *      value_destroy: pointer to a function to destroy value
- *                     Use NULL if you do not want the value destroyed
- *                     when the value_value_destroy is called
- *      value_duplicate: pointer to a function to duplicate value
- *                       Use NULL if you want the value duplicated
- *                       using new_value=old_value
- * post: key and value are assigned and destroy functions are registered
- * return: pointer to vanessa_key_value structure
- *         NULL if kv is NULL
+ * vanessa_spsc_queue_push_n
+ * Push elements onto the end of a single producer, single consumer
+ * queue. May only be called by the producer.
+ * pre: q: queue
+ *      value: elements to push
+ *      n: number of elements to push
+ * post: as many elements as there is room for, up to n, are added to
+ *       the queue, in order, and made visible to the consumer at once
+ * return: number of elements pushed, 0 if the queue is full
  **********************************************************************/
 
-vanessa_key_value_t *vanessa_key_value_assign(vanessa_key_value_t * kv,
-					      void *key,
-					      void (*destroy_key) (void *),
-					      void *(*dup_key) (void *),
-					      void *value,
-					      void (*destroy_value) (void
-								     *),
-					      void *(*dup_value) (void *)
-    );
+size_t vanessa_spsc_queue_push_n(vanessa_spsc_queue_t *q, void **value,
+		size_t n);
 
 
 /**********************************************************************
- * vanessa_key_value_unassign
- * Unassign values in vanessa_key_values structure
- * Useful if you want to destroy the vanessa_key_value structure
- * without freeing the contents
- * pre: kv: key_value structure to unassign values of
- * post: All elements in vanessa_key_value structure are set to NULL
- * return: pointer to vanessa_key_value structure
- *         NULL if kv is NULL
+ * vanessa_spsc_queue_pop
+ * Pop an element off the front of a single producer, single consumer
+ * queue. May only be called by the consumer.
+ * pre: q: queue
+ *      value: element removed from the queue is assigned to *value
+ * post: oldest element is removed from the queue
+ * return: q
+ *         NULL if the queue is empty
  **********************************************************************/
 
-vanessa_key_value_t *vanessa_key_value_unassign(vanessa_key_value_t * kv);
+vanessa_spsc_queue_t *vanessa_spsc_queue_pop(vanessa_spsc_queue_t *q,
+		void **value);
 
 
 /**********************************************************************
- * vanessa_key_value_key_get_key
- * Get the key from a vanessa_key_value structure
- * pre: kv: key value structure to get the key of
- * return: key of kv
- *         NULL if kv is NULL
+ * vanessa_spsc_queue_pop_n
+ * Pop elements off the front of a single producer, single consumer
+ * queue. May only be called by the consumer.
+ * pre: q: queue
+ *      value: array to place elements in
+ *      n: maximum number of elements to pop
+ * post: up to n elements are removed from the queue, oldest first
+ * return: number of elements popped, 0 if the queue is empty
  **********************************************************************/
 
-void *vanessa_key_value_get_key(vanessa_key_value_t * kv);
+size_t vanessa_spsc_queue_pop_n(vanessa_spsc_queue_t *q, void **value,
+		size_t n);
 
 
 /**********************************************************************
- * vanessa_key_value_key_get_value
- * Get the value from a vanessa_key_value structure
- * pre: kv: key value structure to get the value of
- * return: value of kv
- *         NULL if kv is NULL
+ * vanessa_spsc_queue_length
+ * Return the number of elements in a single producer, single consumer
+ * queue
+ * pre: q: queue
+ * post: none
+ * return: number of elements in the queue, which may be out of date
+ *         by the time it is returned if the queue is in use
+ *         -1 if q is NULL
  **********************************************************************/
 
-void *vanessa_key_value_get_value(vanessa_key_value_t * kv);
+ssize_t vanessa_spsc_queue_length(const vanessa_spsc_queue_t *q);
 
 
-#define VANESSA_DESTROY_KV (void (*)(void *s))vanessa_key_value_destroy
-#define VANESSA_DUPLICATE_KV (void *(*)(void *s))vanessa_key_value_duplicate
+/**********************************************************************
+ * Lock-free bounded multiple producer, multiple consumer queue
+ *
+ * A bounded queue for handing elements between any number of threads.
+ **********************************************************************/
+
+typedef struct vanessa_mpmc_queue_t_struct vanessa_mpmc_queue_t;
 
 
 /**********************************************************************
- * Logging functionality
- *
- * Depreciated, but provided for backwards compatibility.
- * Call vanessa_logger_set() and vanessa_logger_unset() instead.
- *
+ * vanessa_mpmc_queue_create
+ * Create a new, empty multiple producer, multiple consumer queue
+ * pre: size: maximum number of elements in the queue, rounded up to a
+ *            power of two
+ *      e_destroy: pointer to a function to destroy elements of the
+ *                 queue, as for vanessa_queue_create. It is passed a
+ *                 pointer to the element. If NULL, then elements will
+ *                 not be freed on calls to vanessa_mpmc_queue_destroy
+ * post: memory is allocated for queue and values are initialised
+ *       Any number of threads may push and pop elements concurrently,
+ *       without locking.
+ * return: new, empty queue
+ *         NULL on error
  **********************************************************************/
 
+vanessa_mpmc_queue_t *vanessa_mpmc_queue_create(size_t size,
+		void (*e_destroy) (const void *));
+
+
 /**********************************************************************
- * vanessa_adt_logger_set
- *
- * Depreciated, but provided for backwards compatibility.
- * Call vanessa_logger_set() instead.
- *
- * set the logger function to use
- * No logging will take place if logger is set to NULL (default)
- * That is you _must_ call this function to enable logging.
- * pre: logger: pointer to a vanessa_logger
- * post: logger for vanessa_adt is set to logger
+ * vanessa_mpmc_queue_destroy
+ * Destroy a multiple producer, multiple consumer queue, destroying
+ * each element present in the queue first
+ * pre: q: queue to destroy, which no thread is using
+ * post: queue and all elements in the queue are destroyed
  * return: none
  **********************************************************************/
 
-#define vanessa_adt_logger_set(_vl) vanessa_logger_set(_vl)
+void vanessa_mpmc_queue_destroy(vanessa_mpmc_queue_t *q);
 
 
 /**********************************************************************
- * vanessa_adt_logger_unset
- *
- * Depreciated, but provided for backwards compatibility.
- * Call vanessa_logger_unset() instead.
- *
- * set logger to NULL
- * That is no logging will take place
- * pre: none
- * post: logger is NULL
- * return: none
+ * vanessa_mpmc_queue_try_push_n
+ * Push elements onto the end of a multiple producer, multiple
+ * consumer queue, without blocking
+ * pre: q: queue
+ *      value: elements to push
+ *      n: number of elements to push
+ * post: as many elements as there is room for, up to n, are added to
+ *       the queue. Elements pushed by one call are consecutive in the
+ *       queue.
+ * return: number of elements pushed, 0 if the queue is full
  **********************************************************************/
 
-#define vanessa_adt_logger_unset() vanessa_logger_unset()
+size_t vanessa_mpmc_queue_try_push_n(vanessa_mpmc_queue_t *q,
+		void **value, size_t n);
 
 
 /**********************************************************************
- * Linked List to store all your flims in.
- *
- * The primitive type for the array is void *. Thus, providing your own
- * duplicate_primitive, destroy_primitive, match_primative,
- * display_primitive and length_primitive functions will allow you to use
- * the vanessa_list API to have a listcontaining any primitive
- *
- * Includes macros required to create an array of strings or integers.
+ * vanessa_mpmc_queue_try_push
+ * Push an element onto the end of a multiple producer, multiple
+ * consumer queue, without blocking
+ * pre: q: queue
+ *      value: element to push
+ * post: element is added to the queue, if there is room
+ * return: q
+ *         NULL if the queue is full
  **********************************************************************/
 
+vanessa_mpmc_queue_t *vanessa_mpmc_queue_try_push(vanessa_mpmc_queue_t *q,
+		void *value);
 
-typedef struct vanessa_list_elem_struct vanessa_list_elem_t;
 
-typedef struct {
-	vanessa_list_elem_t *first;
-	vanessa_list_elem_t *last;
-	vanessa_list_elem_t **recent;
-	int norecent;
-	size_t recent_offset;
-	void (*e_destroy) (void *e);
-	void *(*e_duplicate) (void *e);
-	void (*e_display) (char *s, void *e);
-	size_t(*e_length) (void *e);
-	int (*e_match) (void *e, void *key);
-	int (*e_sort) (void *a, void *b);
-} vanessa_list_t;
+/**********************************************************************
+ * vanessa_mpmc_queue_try_pop_n
+ * Pop elements off the front of a multiple producer, multiple
+ * consumer queue, without blocking
+ * pre: q: queue
+ *      value: array to place elements in
+ *      n: maximum number of elements to pop
+ * post: up to n consecutive elements are removed from the queue,
+ *       oldest first
+ * return: number of elements popped, 0 if the queue is empty
+ **********************************************************************/
 
+size_t vanessa_mpmc_queue_try_pop_n(vanessa_mpmc_queue_t *q,
+		void **value, size_t n);
 
-#define VANESSA_LIST_REORDER -1
 
 /**********************************************************************
- * vanessa_list_create
- * Create a new, empty list
- * pre: norecent: number of elements for recent list.
- * 		  If VANESSA_LIST_REORDER then no recent list is used
- * 		  but elements are moved to the front of the list
- * 		  as they are retrieved using vanessa_list_get_element
- *      element_destroy:   Pointer to a function to destroy an element
- *                         Function should take an argument of a pointer
- *                         and free the memory allocated to the structure
- *                         pointed to.
- *      element_duplicate: Pointer to a function to duplicate an element
- *                         Function should take a pointer to an element to
- *                         duplicate as the only element and return a copy
- *                         of the element Any memory allocation required
- *                         should be done by this function.
- *      element_display:   Pointer to a function to display an element
- *                         Function should take a pointer to char and a
- *                         pointer to an element as arguments. An ASCII
- *                         representation of the element should be placed
- *                         in the character buffer given as the first
- *                         argument.  May be NULL in which case
- *                         vanessa_dynamic_array_display will return an empty
- *                         string ("\0");
- *      element_size:      Pointer to a function to find the length of an
- *                         ASCII representation of the element not
- *                         including the trailing '\0'. Used to guard
- *                         against buffer over runs when using
- *                         element_display. May be NULL, in which case
- *                         vanessa_dynamic_array_display will return an
- *                         empty string ("");
- *      element_match:     Pointer to a function to match an element
- *                         by a key.
- *      element_sort:      Pointer to a function that will compare
- *                         two elements and and b. Will return < 0 if a 
- *                         should be before b in the list > 0 if a should
- *                         be after b in the list. 0 if they are equal.
- *                         Used in vanessa_list_add_element
+ * vanessa_mpmc_queue_try_pop
+ * Pop an element off the front of a multiple producer, multiple
+ * consumer queue, without blocking
+ * pre: q: queue
+ *      value: element removed from the queue is assigned to *value
+ * post: oldest element is removed from the queue
+ * return: q
+ *         NULL if the queue is empty
+ **********************************************************************/
+
+vanessa_mpmc_queue_t *vanessa_mpmc_queue_try_pop(vanessa_mpmc_queue_t *q,
+		void **value);
+
+
+/**********************************************************************
+ * vanessa_mpmc_queue_length
+ * Return the number of elements in a multiple producer, multiple
+ * consumer queue
+ * pre: q: queue
+ * post: none
+ * return: number of elements claimed by producers and not yet claimed
+ *         by consumers, which may be out of date by the time it is
+ *         returned if the queue is in use
+ *         -1 if q is NULL
+ **********************************************************************/
+
+ssize_t vanessa_mpmc_queue_length(const vanessa_mpmc_queue_t *q);
+
+
+/**********************************************************************
+ * Shared memory queue
  *
- * post: list structure is alocated, and values initialised to NULL
- * return: pointer to list
+ * A bounded queue of messages, which are copied in and out of shared
+ * memory, for passing messages between processes.
+ **********************************************************************/
+
+typedef struct vanessa_shm_queue_t_struct vanessa_shm_queue_t;
+
+
+/**********************************************************************
+ * vanessa_shm_queue_create
+ * Create a new, empty queue of messages in shared memory
+ * pre: size: maximum number of messages in the queue, rounded up to a
+ *            power of two
+ *      slot_size: maximum size of a message in bytes
+ * post: shared memory is allocated and mapped for the queue. It is
+ *       shared with processes forked after this call, and with those
+ *       that open it with vanessa_shm_queue_open. Any of these
+ *       processes may push and pop messages concurrently.
+ * return: new, empty queue
  *         NULL on error
  **********************************************************************/
 
-vanessa_list_t *vanessa_list_create(int norecent,
-                                   void (*element_destroy) (void *e),
-                                   void *(*element_duplicate) (void *e),
-                                   void (*element_display) (char *s, void *e),
-                                   size_t(*element_size) (void *e),
-                                   int (*element_match) (void *e, void *key),
-				   int (*element_sort) (void *a, void *b));
+vanessa_shm_queue_t *vanessa_shm_queue_create(size_t size,
+		size_t slot_size);
 
 
 /**********************************************************************
- * vanessa_list_destroy
- * Destroy a list and all the data contained in the list
- * pre: l: list
- * post: all elements of l are destroyed
+ * vanessa_shm_queue_open
+ * Map a queue created by another process
+ * pre: fd: file descriptor of the queue, as returned by
+ *          vanessa_shm_queue_fd in the process that created it and
+ *          passed to this one. It is owned by the queue on success.
+ * post: the queue's shared memory is mapped
+ * return: queue
+ *         NULL on error, including if fd is not a queue
  **********************************************************************/
 
-void vanessa_list_destroy(vanessa_list_t * l);
+vanessa_shm_queue_t *vanessa_shm_queue_open(int fd);
 
 
 /**********************************************************************
- * vanessa_list_length
- * Find the length of an ASCII representation of a dynamic array.
- * Not including a terminating '\0'.
- * pre: l: list to find the length of
- * post: If l is NULL or there are no elements in l then the 
- *          length is 0
- *       If element_length, as passed to vanessa_list_create, 
- *          is NULL, then 0 is returned.
- *       Else the cumulative lenth of the elemements as per the
- *          element_length function, plus one character per element 
- *          for a delimiter between elements.
- *          The trailing '\0' is not counted.
- *          It is up to the user to free this buffer.  
- * return: Cumulative length of the elements.
- *         0 if a is NULL or there are no elements in a or if
- *           element_length passed to vanessa_list_create is NULL.
+ * vanessa_shm_queue_fd
+ * Return the file descriptor of a queue's shared memory
+ * pre: q: queue
+ * post: none
+ * return: file descriptor, which may be passed to another process
+ *         for use with vanessa_shm_queue_open. It is closed on exec
+ *         and by vanessa_shm_queue_destroy.
+ *         -1 if the system does not support memfds, in which case
+ *         the queue is only shared with forked processes
  **********************************************************************/
 
-size_t vanessa_list_length(vanessa_list_t * l);
+int vanessa_shm_queue_fd(const vanessa_shm_queue_t *q);
 
 
 /**********************************************************************
- * vanessa_list_display
- * Make an ASCII representation of the list
- * pre: l: list to display
- *      delimiter: character to place between elements of the list
- * post: If l is NULL or there are no elements in l then nothing is 
- *          done
- *       If element_display or element_length, as passed to
- *          vanessa_list_create, are NULL, then an empty string 
+ * vanessa_shm_queue_destroy
+ * Unmap a queue from this process
+ * pre: q: queue
+ * post: the queue's shared memory is unmapped and its file descriptor
+ *       closed. Messages in the queue are lost once every process
+ *       sharing it has done so.
+ * return: none
+ **********************************************************************/
+
+void vanessa_shm_queue_destroy(vanessa_shm_queue_t *q);
+
+
+/**********************************************************************
+ * vanessa_shm_queue_try_push
+ * Copy a message onto the end of a shared memory queue, without
+ * blocking
+ * pre: q: queue
+ *      buf: message
+ *      len: length of message, no more than the slot_size given to
+ *           vanessa_shm_queue_create
+ * post: message is added to the queue, if there is room, and a
+ *       process waiting for a message is woken
+ * return: q
+ *         NULL if the queue is full, in which case errno is set to
+ *         EAGAIN, or if len is too large, in which case it is set to
+ *         EMSGSIZE
+ **********************************************************************/
+
+vanessa_shm_queue_t *vanessa_shm_queue_try_push(vanessa_shm_queue_t *q,
+		const void *buf, size_t len);
+
+
+/**********************************************************************
+ * vanessa_shm_queue_try_pop
+ * Copy a message off the front of a shared memory queue, without
+ * blocking
+ * pre: q: queue
+ *      buf: buffer of at least the slot_size given to
+ *           vanessa_shm_queue_create
+ * post: oldest message is removed from the queue and copied into buf,
+ *       and a process waiting for room is woken
+ * return: length of the message
+ *         -1 if the queue is empty, in which case errno is set to
+ *         EAGAIN
+ **********************************************************************/
+
+ssize_t vanessa_shm_queue_try_pop(vanessa_shm_queue_t *q, void *buf);
+
+
+/**********************************************************************
+ * vanessa_shm_queue_push
+ * Copy a message onto the end of a shared memory queue, waiting for
+ * room if it is full
+ * pre: q: queue
+ *      buf: message
+ *      len: length of message, as for vanessa_shm_queue_try_push
+ *      timeout: time to wait in milliseconds. 0 to return at once,
+ *               negative to wait indefinitely.
+ * post: message is added to the queue, and a process waiting for a
+ *       message is woken
+ * return: q
+ *         NULL if the timeout expired, in which case errno is set to
+ *         ETIMEDOUT, or if len is too large, in which case it is set
+ *         to EMSGSIZE
+ **********************************************************************/
+
+vanessa_shm_queue_t *vanessa_shm_queue_push(vanessa_shm_queue_t *q,
+		const void *buf, size_t len, int timeout);
+
+
+/**********************************************************************
+ * vanessa_shm_queue_pop
+ * Copy a message off the front of a shared memory queue, waiting for
+ * one to be pushed if it is empty
+ * pre: q: queue
+ *      buf: buffer, as for vanessa_shm_queue_try_pop
+ *      timeout: time to wait in milliseconds. 0 to return at once,
+ *               negative to wait indefinitely.
+ * post: oldest message is removed from the queue and copied into buf,
+ *       and a process waiting for room is woken
+ * return: length of the message
+ *         -1 if the timeout expired, in which case errno is set to
+ *         ETIMEDOUT
+ **********************************************************************/
+
+ssize_t vanessa_shm_queue_pop(vanessa_shm_queue_t *q, void *buf,
+		int timeout);
+
+
+/**********************************************************************
+ * vanessa_shm_queue_length
+ * Return the number of messages in a shared memory queue
+ * pre: q: queue
+ * post: none
+ * return: number of messages claimed by producers and not yet claimed
+ *         by consumers, which may be out of date by the time it is
+ *         returned if the queue is in use
+ *         -1 if q is NULL
+ **********************************************************************/
+
+ssize_t vanessa_shm_queue_length(const vanessa_shm_queue_t *q);
+
+
+/**********************************************************************
+ * Work stealing deque
+ *
+ * A deque of tasks owned by one thread, which pushes and pops them at
+ * one end, while other threads steal them from the other, without
+ * locking.
+ **********************************************************************/
+
+typedef struct vanessa_ws_deque_t_struct vanessa_ws_deque_t;
+
+
+/**********************************************************************
+ * vanessa_ws_deque_create
+ * Create a new, empty work stealing deque
+ * pre: e_destroy: pointer to a function to destroy elements of the
+ *                 deque, as for vanessa_queue_create. It is passed a
+ *                 pointer to the element. If NULL, then elements will
+ *                 not be freed on calls to vanessa_ws_deque_destroy
+ * post: memory is allocated for deque and values are initialised
+ *       One thread, the owner, may push and pop elements, while any
+ *       number of other threads steal them, without locking.
+ * return: new, empty deque
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_ws_deque_t *vanessa_ws_deque_create(void (*e_destroy) (const void *));
+
+
+/**********************************************************************
+ * vanessa_ws_deque_destroy
+ * Destroy a work stealing deque, destroying each element present in
+ * the deque first
+ * pre: d: deque to destroy, which no thread is using
+ * post: deque and all elements in the deque are destroyed
+ * return: none
+ **********************************************************************/
+
+void vanessa_ws_deque_destroy(vanessa_ws_deque_t *d);
+
+
+/**********************************************************************
+ * vanessa_ws_deque_push
+ * Push an element onto the bottom of a work stealing deque.
+ * May only be called by the owner.
+ * pre: d: deque
+ *      value: element to push
+ * post: element is added to the deque. If it is full, the array of
+ *       elements is doubled in size.
+ * return: d
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_ws_deque_t *vanessa_ws_deque_push(vanessa_ws_deque_t *d,
+		void *value);
+
+
+/**********************************************************************
+ * vanessa_ws_deque_pop
+ * Pop the element most recently pushed onto a work stealing deque.
+ * May only be called by the owner.
+ * pre: d: deque
+ *      value: element removed from the deque is assigned to *value.
+ *             *value is left unchanged if no element is removed.
+ * post: element at the bottom of the deque is removed, unless a
+ *       thief took it first
+ * return: d
+ *         NULL if the deque is empty
+ **********************************************************************/
+
+vanessa_ws_deque_t *vanessa_ws_deque_pop(vanessa_ws_deque_t *d,
+		void **value);
+
+
+/**********************************************************************
+ * vanessa_ws_deque_steal
+ * Take the element least recently pushed onto a work stealing deque.
+ * May be called by any thread.
+ * pre: d: deque
+ *      value: element removed from the deque is assigned to *value.
+ *             *value is left unchanged if no element is removed.
+ * post: element at the top of the deque is removed, unless another
+ *       thread took it first
+ * return: 1 if an element was taken
+ *         0 if the deque is empty
+ *         -1 if another thread took the element first, in which case
+ *         the deque may still have elements and the caller may retry
+ **********************************************************************/
+
+int vanessa_ws_deque_steal(vanessa_ws_deque_t *d, void **value);
+
+
+/**********************************************************************
+ * vanessa_ws_deque_length
+ * Return the number of elements in a work stealing deque
+ * pre: d: deque
+ * post: none
+ * return: number of elements in the deque, which may be out of date
+ *         by the time it is returned if the deque is in use
+ *         -1 if d is NULL
+ **********************************************************************/
+
+ssize_t vanessa_ws_deque_length(const vanessa_ws_deque_t *d);
+
+
+/**********************************************************************
+ * Thread pool
+ *
+ * Worker threads which run tasks, each a function and the element
+ * and data to pass to it, spreading them between workers by work
+ * stealing.
+ **********************************************************************/
+
+typedef struct vanessa_thread_pool_t_struct vanessa_thread_pool_t;
+
+
+/**********************************************************************
+ * vanessa_thread_pool_create
+ * Create a pool of threads to run tasks
+ * pre: noworker: number of worker threads
+ * post: worker threads are started, and wait for tasks
+ * return: new thread pool
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_thread_pool_t *vanessa_thread_pool_create(int noworker);
+
+
+/**********************************************************************
+ * vanessa_thread_pool_destroy
+ * Destroy a thread pool, once all tasks submitted to it have run
+ * pre: tp: thread pool. No threads other than its workers may be
+ *          submitting tasks to it.
+ * post: tasks already submitted, and any they submit, are run, then
+ *       the workers exit and the pool is freed
+ * return: none
+ **********************************************************************/
+
+void vanessa_thread_pool_destroy(vanessa_thread_pool_t *tp);
+
+
+/**********************************************************************
+ * vanessa_thread_pool_submit
+ * Submit a task to a thread pool
+ * pre: tp: thread pool
+ *      action: function to run, as for vanessa_list_iterate.
+ *              It should return < 0 if an error occurs, which is
+ *              reported by vanessa_thread_pool_wait.
+ *      e: element passed to action as its first argument
+ *      data: data passed to action as its second argument
+ * post: the task is queued to be run by a worker. If called by a
+ *       worker of tp, it is queued on the worker's own deque, to be
+ *       run by it next unless another worker steals it first.
+ * return: tp
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_thread_pool_t *vanessa_thread_pool_submit(vanessa_thread_pool_t *tp,
+		int (*action) (void *e, void *data), void *e, void *data);
+
+
+/**********************************************************************
+ * vanessa_thread_pool_wait
+ * Wait for all tasks submitted to a thread pool to be run
+ * pre: tp: thread pool. Should not be called by its workers.
+ * post: all tasks submitted before, or while, waiting have been run
+ * return: 0 if all tasks run since vanessa_thread_pool_create, or the
+ *         last call to vanessa_thread_pool_wait, returned >= 0
+ *         -1 otherwise
+ **********************************************************************/
+
+int vanessa_thread_pool_wait(vanessa_thread_pool_t *tp);
+
+
+/**********************************************************************
+ * vanessa_thread_pool_length
+ * Return the number of tasks submitted to a thread pool which have
+ * not yet finished running
+ * pre: tp: thread pool
+ * post: none
+ * return: number of tasks, which may be out of date by the time it
+ *         is returned
+ *         -1 if tp is NULL
+ **********************************************************************/
+
+ssize_t vanessa_thread_pool_length(const vanessa_thread_pool_t *tp);
+
+
+/**********************************************************************
+ * Priority queue
+ *
+ * A heap from which the element that sorts first is popped. Pushing
+ * an element returns a handle by which it may later be moved, when
+ * its sort key changes, or removed.
+ **********************************************************************/
+
+typedef struct vanessa_pqueue_t_struct vanessa_pqueue_t;
+typedef struct vanessa_pqueue_elem_t_struct vanessa_pqueue_elem_t;
+
+
+/**********************************************************************
+ * vanessa_pqueue_create
+ * Create a new, empty priority queue
+ * pre: element_destroy: Pointer to a function to destroy an element,
+ *                       as for vanessa_list_create. May be NULL in
+ *                       which case elements are not freed on calls
+ *                       to vanessa_pqueue_destroy.
+ *      element_sort:    Pointer to a function that will compare two
+ *                       elements a and b, as for vanessa_list_create.
+ *                       Will return < 0 if a should be popped before
+ *                       b, > 0 if after, and 0 if they are equal.
+ * post: memory is allocated for queue and values are initialised
+ * return: new, empty priority queue
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_pqueue_t *vanessa_pqueue_create(void (*element_destroy) (void *e),
+		int (*element_sort) (void *a, void *b));
+
+
+/**********************************************************************
+ * vanessa_pqueue_destroy
+ * Destroy a priority queue, destroying each element present in the
+ * queue first
+ * pre: pq: priority queue to destroy
+ * post: priority queue and all elements in it are destroyed, and all
+ *       handles to its elements are invalid
+ * return: none
+ **********************************************************************/
+
+void vanessa_pqueue_destroy(vanessa_pqueue_t *pq);
+
+
+/**********************************************************************
+ * vanessa_pqueue_push
+ * Add an element to a priority queue
+ * pre: pq: priority queue
+ *      value: element to add
+ * post: element is added to the queue, in O(log n) time
+ * return: handle to the element, which is valid until it is popped
+ *         or removed from the queue
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_pqueue_elem_t *vanessa_pqueue_push(vanessa_pqueue_t *pq,
+		void *value);
+
+
+/**********************************************************************
+ * vanessa_pqueue_peek
+ * Retrieve the first element of a priority queue without removing it
+ * pre: pq: priority queue
+ * post: none
+ * return: element which sorts before all others
+ *         NULL if the queue is empty
+ **********************************************************************/
+
+void *vanessa_pqueue_peek(const vanessa_pqueue_t *pq);
+
+
+/**********************************************************************
+ * vanessa_pqueue_pop
+ * Remove the first element of a priority queue
+ * pre: pq: priority queue
+ *      value: element removed from the queue is assigned to *value
+ * post: element which sorts before all others is removed from the
+ *       queue, but not destroyed, in O(log n) time. Its handle is
+ *       invalid.
+ * return: pq
+ *         NULL if the queue is empty
+ **********************************************************************/
+
+vanessa_pqueue_t *vanessa_pqueue_pop(vanessa_pqueue_t *pq, void **value);
+
+
+/**********************************************************************
+ * vanessa_pqueue_update
+ * Restore the order of a priority queue after the sort key of one
+ * of its elements has changed
+ * pre: pq: priority queue
+ *      e: handle of the element whose key has changed, in place,
+ *         whether it should now sort earlier (decrease-key) or later
+ * post: element is moved to its place in the queue, in O(log n) time
+ * return: none
+ **********************************************************************/
+
+void vanessa_pqueue_update(vanessa_pqueue_t *pq, vanessa_pqueue_elem_t *e);
+
+
+/**********************************************************************
+ * vanessa_pqueue_remove
+ * Remove an element from a priority queue by its handle
+ * pre: pq: priority queue
+ *      e: handle of element to remove
+ * post: element is removed from the queue, but not destroyed, in
+ *       O(log n) time. e is invalid.
+ * return: the element removed
+ **********************************************************************/
+
+void *vanessa_pqueue_remove(vanessa_pqueue_t *pq, vanessa_pqueue_elem_t *e);
+
+
+/**********************************************************************
+ * vanessa_pqueue_elem_value
+ * Return the element a handle refers to
+ * pre: e: handle of an element in a priority queue
+ * post: none
+ * return: element
+ **********************************************************************/
+
+void *vanessa_pqueue_elem_value(const vanessa_pqueue_elem_t *e);
+
+
+/**********************************************************************
+ * vanessa_pqueue_length
+ * Return the number of elements in a priority queue
+ * pre: pq: priority queue
+ * post: none
+ * return: number of elements in the queue
+ *         -1 if pq is NULL
+ **********************************************************************/
+
+ssize_t vanessa_pqueue_length(const vanessa_pqueue_t *pq);
+
+
+/**********************************************************************
+ * Dynamic array, to store all your flims in. 
+ *
+ * The primitive type for the array is void *. Thus, providing your own
+ * duplicate_primitive, destroy_primitive, display_primitive and
+ * length_primitive functions will allow you to use the
+ * vanessa_dynamic_array API to have a dynamic array containing any
+ * primitive
+ *
+ * Includes macros required to create an array of strings or integers.
+ **********************************************************************/
+
+/*
+ * Default blocking size for dynamic array
+ * can be overridden when array is created
+ */
+#define VANESSA_DEFAULT_DYNAMIC_ARRAY_BLOCK_SIZE (size_t)7
+
+/* How a dynamic array grows, see vanessa_dynamic_array_create_growth */
+#define VANESSA_DYNAMIC_ARRAY_LINEAR    0x0
+#define VANESSA_DYNAMIC_ARRAY_GEOMETRIC 0x1
+
+
+/* #defines to destroy and duplicate strings */
+#define VANESSA_DESTROY_STR (void (*)(void *s))free
+#define VANESSA_DUPLICATE_STR (void *(*)(void *s))strdup
+#define VANESSA_DISPLAY_STR (void (*)(char *d, void *s))strcpy
+#define VANESSA_LENGTH_STR (size_t (*)(void *s))strlen
+#define VANESSA_MATCH_STR (size_t (*)(void *s))strcmp
+#define VANESSA_SORT_STR VANESSA_MATCH_STR
+
+/* Sort versions */
+#define VANESSA_DESS VANESSA_DESTROY_STR
+#define VANESSA_DUPS VANESSA_DUPLICATE_STR
+#define VANESSA_DISS VANESSA_DISPLAY_STR
+#define VANESSA_LENS VANESSA_LENGTH_STR
+#define VANESSA_MATS VANESSA_MATCH_STR
+#define VANESSA_SORS VANESSA_MATCH_STR
+
+typedef struct vanessa_dynamic_array_t_struct vanessa_dynamic_array_t;
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_create
+ * Create a dynamic array
+ * pre: block_size: blocking size to use.
+ *                  DEFAULT_DYNAMIC_ARRAY_BLOCK_SIZE is used if 
+ *                  block_size is 0.
+ *                  Block size refers to how many elements are 
+ *                  preallocated each time the array is grown. 
+ *      element_destroy:   Pointer to a function to destroy an element
+ *                         Function should take an argument of a pointer
+ *                         and free the memory allocated to the structure
+ *                         pointed to.
+ *      element_duplicate: Pointer to a function to duplicate an element
+ *                         Function should take a pointer to an element to
+ *                         duplicate as the only element and return a copy
+ *                         of the element Any memory allocation required
+ *                         should be done by this function.
+ *      element_display:   Pointer to a function to display an element
+ *                         Function should take a pointer to char and a
+ *                         pointer to an element as arguments. An ASCII
+ *                         representation of the element should be placed
+ *                         in the character buffer given as the first
+ *                         argument.  May be NULL in which case
+ *                         vanessa_dynamic_array_display will return an empty
+ *                         string ("\0");
+ *      element_length:    Pointer to a function to find the length of an
+ *                         ASCII representation of the element not
+ *                         including the trailing '\0'. Used to guard
+ *                         against buffer over runs when using
+ *                         element_display. May be NULL, in which case
+ *                         vanessa_dynamic_array_display will return an
+ *                         empty string ("");
+ *
+ * post: Dynamic array is allocated and initialised.
+ * return: An empty dynamic array 
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_dynamic_array_t *vanessa_dynamic_array_create(size_t block_size,
+		void (*element_destroy) (void *), void *(*element_duplicate)
+		(void *s), void (*element_display) (char *, void *),
+		size_t(*element_size) (void *));
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_create_growth
+ * Create a dynamic array that grows as given
+ * pre: block_size: as for vanessa_dynamic_array_create
+ *      growth: VANESSA_DYNAMIC_ARRAY_LINEAR: grow and shrink the array
+ *              by block_size elements at a time, as
+ *              vanessa_dynamic_array_create does.
+ *              VANESSA_DYNAMIC_ARRAY_GEOMETRIC: grow the array by half
+ *              its size, and by at least block_size, so that adding
+ *              n elements copies O(n) of them. The array is halved
+ *              when it is less than 1/4 full.
+ *      element_destroy, element_duplicate, element_display,
+ *      element_length: as for vanessa_dynamic_array_create
+ * post: Dynamic array is allocated and initialised.
+ * return: An empty dynamic array 
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_dynamic_array_t *vanessa_dynamic_array_create_growth(
+		size_t block_size, vanessa_adt_flag_t growth,
+		void (*element_destroy) (void *), void *(*element_duplicate)
+		(void *s), void (*element_display) (char *, void *),
+		size_t (*element_length) (void *));
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_destroy
+ * Free an array an all the elements held within
+ * pre: a: array to destroy
+ * post: array is freed and element_destroy as passed to
+ *             vanessa_dynamic_array_create is called for all elements of 
+ *             the array.
+ *       Nothing if a is NULL
+ **********************************************************************/
+
+void vanessa_dynamic_array_destroy(vanessa_dynamic_array_t * a);
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_add_element
+ * Add an element to a dynamic array
+ * pre: a: dynamic array to add element to
+ *      e: element to add
+ * post: element in inserted in the first unused position in the array
+ *       array size is increased by block_size, as passed to
+ *       vanessa_dynamic_array_create,if there is insufficient room in 
+ *       the array to add the element, or by half its size if it was
+ *       created with VANESSA_DYNAMIC_ARRAY_GEOMETRIC.
+ *       Nothing is done if e is NULL
+ * return: a on success
+ *         NULL if a is NULL or an error occurs
+ **********************************************************************/
+
+vanessa_dynamic_array_t *vanessa_dynamic_array_add_element(
+		vanessa_dynamic_array_t * a, void *e);
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_delete_element
+ * Delete an element from a dynamic array
+ * pre: a: dynamic array to delete element from
+ *      index: index of element to delete
+ * post: Element is destroyed and removed from array. Subsequent
+ *       elements in the array are shuffled up to fill the gap.
+ *       array size is decreased by block_size, as passed to
+ *       vanessa_dynamic_array_create,  if more than a block beyond
+ *       the last used element would remain unused, so that adding
+ *       and deleting an element at a block boundary does not
+ *       reallocate the array each time.
+ *       If the array was created with VANESSA_DYNAMIC_ARRAY_GEOMETRIC
+ *       it is instead halved when it is less than 1/4 full.
+ *       Nothing is done if e is NULL or index is not a valid element
+ *       in the array.
+ * return: a on success
+ *         NULL if a is NULL, index is out of bounds or an error occurs
+ **********************************************************************/
+
+vanessa_dynamic_array_t *vanessa_dynamic_array_delete_element(
+		vanessa_dynamic_array_t * a, const ssize_t index);
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_duplicate
+ * Duplicate a dynamic array
+ * pre: a: Dynamic Array to duplicate
+ * post: a vector of exactly the number of elements in a is allocated
+ *       and the elements are copied into it, in order
+ * return: An empty dynamic array 
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_dynamic_array_t *vanessa_dynamic_array_duplicate(
+		vanessa_dynamic_array_t * a);
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_length
+ * Find the length of an ASCII representation of a dynamic array.
+ * Not including a terminating '\0'.
+ * pre: a: dynamic array to find the length of
+ * post: If a is NULL or there are no elements in a then the 
+ *          length is 0
+ *       If element_length, as passed to vanessa_dynamic_array_create, 
+ *          is NULL, then 0 is returned.
+ *       Else the cumulative lenth of the elemements as per the
+ *           element_length function, plus one character per 
+ *           element for a delimiter between elements.
+ *           The trailing '\0' is not counted.
+ *          It is up to the user to free this buffer.  
+ * return: Cumulative length of the elements.
+ *         0 if a is NULL or there are no elements in a or if
+ *           element_length passed to vanessa_list_create is NULL.
+ **********************************************************************/
+
+size_t vanessa_dynamic_array_length(vanessa_dynamic_array_t * a);
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_display
+ * Make an ASCII representation of a dynamic array.
+ * pre: a: dynamic array to display
+ *      delimiter: character to place between elements of the array
+ * post: If a is NULL or there are no elements in a then nothing is 
+ *          done
+ *       If element_display or element_length, as passed to
+ *          vanessa_dynamic_array_create, are NULL, then an empty 
+ *          string ("") is returned.  
+ *       Else a character buffer is allocated and an ASCII 
+ *          representation of of each array element, as determined by 
+ *          element_display, separated by delimiter is placed in the 
+ *          '\0' terminated buffer that is returned. 
+ *       It is up to the user to free this buffer.  
+ * return: Allocated buffer as above 
+ *         NULL on error, 
+ *         NULL a or empty a
+ **********************************************************************/
+
+char *vanessa_dynamic_array_display(vanessa_dynamic_array_t * a,
+		char delimiter);
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_get_element
+ * Get an element from an array
+ * pre: a: array to retrieve element from
+ *      elementno: index element in array to retrieve
+ * post: no change is made to a
+ * return: element requested
+ *         NULL if element is beyond the number of elements in the array
+ *         N.B. element may actually be NULL. You can check if an
+ *         overflow has occured using by comparing elemntno to the output        *         of vanessa_dynamic_array_get_count()
+ **********************************************************************/
+
+void * vanessa_dynamic_array_get_element(vanessa_dynamic_array_t * a,
+					 ssize_t elementno);
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_get_count
+ * Get the number of elements in the array
+ * pre: array to find the number of elements in
+ * return: number of elements in the array
+ *         -1 if a is NULL
+ **********************************************************************/
+
+ssize_t vanessa_dynamic_array_get_count(vanessa_dynamic_array_t * a);
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_get_vector
+ * Get the array contained in the dynamic array
+ * pre: array to find the vector of
+ * return: vector
+ *         NULL if a is NULL
+ **********************************************************************/
+
+void **vanessa_dynamic_array_get_vector(vanessa_dynamic_array_t * a);
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_reverse
+ * Reverse the order of the elements in a dynamic array
+ * pre: a: dynamic array to reverse
+ * post: Elements of a are in the reverse order
+ * return: none
+ **********************************************************************/
+
+void vanessa_dynamic_array_reverse(vanessa_dynamic_array_t * a);
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_split_str
+ * Split a string into substrings on a delimiter
+ * pre: str: string to split
+ *      delimiter: character to split string on
+ * post: string is split. 
+ *       Note: The string is modified.
+ * return: dynamic array containing sub_strings
+ *         NULL on error
+ *         string being NULL is an error state
+ **********************************************************************/
+
+vanessa_dynamic_array_t *vanessa_dynamic_array_split_str(char *string,
+							 const char
+							 delimiter);
+
+
+/**********************************************************************
+ * vanessa_dynamic_array_split_str_to_int
+ * Split a string into substrings on a delimiter
+ *       The substrings are converted into the integers that they represent
+ *       and the integers are stored.
+ * pre: str: string to split
+ *      delimiter: character to split string on
+ * post: string is split. 
+ *       Note: The string is modified.
+ * return: dynamic array containing integers
+ *         NULL on error
+ *         string being NULL is an error state
+ **********************************************************************/
+
+vanessa_dynamic_array_t *vanessa_dynamic_array_split_str_to_int(char
+								*string,
+								const char
+								delimiter);
+
+
+/**********************************************************************
+ * vanessa_destroy_int
+ * function to destroy an pointer to an int.
+ * pre: i: int to "destroy"
+ * post: none
+ * return: none
+ **********************************************************************/
+
+void vanessa_destroy_int(int *i);
+
+
+/**********************************************************************
+ * vanessa_dup_int
+ * function to duplicate pointer to an int.
+ * pre: i: int to duplicate
+ * post: new int is alocated and value of i is copied into it
+ * return: pointer to new integer
+ *         NULL on error
+ **********************************************************************/
+
+int *vanessa_dup_int(int *i);
+
+
+/**********************************************************************
+ * vanessa_display_int
+ * Display an int in ASCII as a decimal.
+ * pre: d: buffer to display ASCII represetation of int to
+ *      i: pointer to int to display
+ * post: an ASCII representation of i is in d
+ * return: none
+ **********************************************************************/
+
+void vanessa_display_int(char *d, int *i);
+
+
+/**********************************************************************
+ * vanessa_length_int
+ * Return the length in bytes of an ASCII representation of the in as a
+ * decimal.
+ * pre: i: pointer to int to find the "length" of
+ * post: none
+ * return: length is returned
+ **********************************************************************/
+
+size_t vanessa_length_int(int *i);
+
+
+/**********************************************************************
+ * vanessa_match_int
+ * Compare two integers. Return the difference. That is < 1 if a < b,
+ * 0 if a == b and > 1 if a > b.
+ * Analogous to strcmp(3)
+ * pre: a: pointer to int to compare
+ *      b: pointer to other int to compare
+ * post: none
+ * return: difference between a and b
+ **********************************************************************/
+
+int vanessa_match_int(int *a, int *b);
+
+
+/* #defines to destroy and duplicate integers */
+#define VANESSA_DESTROY_INT (void (*)(void *s))free
+#define VANESSA_DUPLICATE_INT \
+	(void *(*)(void *s))vanessa_dup_int
+#define VANESSA_DISPLAY_INT \
+	(void (*)(char *d, void *s))vanessa_display_int
+#define VANESSA_LENGTH_INT \
+	(size_t (*)(void *s))vanessa_length_int
+#define VANESSA_MATCH_INT \
+	(int (*)(void *e, void *k))vanessa_match_int
+#define VANESSA_SORT_INT VANESSA_MATCH_INT
+
+/* ... and shorter versions */
+#define VANESSA_DESI VANESSA_DESTROY_INT
+#define VANESSA_DUPI VANESSA_DUPLICATE_INT
+#define VANESSA_DISI VANESSA_DISPLAY_INT
+#define VANESSA_LENI VANESSA_LENGTH_INT
+#define VANESSA_MATI VANESSA_MATCH_INT
+#define VANESSA_SORI VANESSA_MATCH_INT
+
+
+/**********************************************************************
+ * Key value pair
+ **********************************************************************/
+
+typedef struct vanessa_key_value_t_struct vanessa_key_value_t;
+
+
+/**********************************************************************
+ * vanessa_key_value_create
+ * Create a new vanessa_key_value structure
+ * pre: none
+ * post: a new vanessa_key_value structure is allocated and elements 
+ *       are initialised
+ * return: pointer to vanessa_key_value_t
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_key_value_t *vanessa_key_value_create(void);
+
+
+/**********************************************************************
+ * vanessa_key_value_destroy
+ * Destroy a vanessa_key_value and its contents
+ * pre: kv: vanessa_key_value structure to destroy
+ * post: kv and its contents are freed
+ * return: none
+ **********************************************************************/
+
+void vanessa_key_value_destroy(vanessa_key_value_t * kv);
+
+
+/**********************************************************************
+ * vanessa_key_value_duplicate
+ * Make a copy of a vanessa_key_value_structure
+ * pre: kv: vanessa_key_value structure to duplicate
+ * post: 
+ **********************************************************************/
+
+vanessa_key_value_t *vanessa_key_value_duplicate(vanessa_key_value_t * kv);
+
+
+/**********************************************************************
+ * vanessa_key_value_assign
+ * Assign a key and value to a vanessa_key_value structure
+ * pre: kv: key_value_structure to assign key and value to
+ *      key: key to assign
+ *      key_destroy: pointer to a function to destroy key
+ *                   Use NULL if you do not want the key destroyed
+ *                   when the vanessa_key_value_destroy is called
+ *      key_duplicate: pointer to a function to duplicate key
+ *                     Use NULL if you want the key duplicated
+ *                     using new_key=old_key
+ *      value: value to assign
+ *      value_destroy: pointer to a function to destroy value
+ *                     Use NULL if you do not want the value destroyed
+ *                     when the value_value_destroy is called
+ *      value_duplicate: pointer to a function to duplicate value
+ *                       Use NULL if you want the value duplicated
+ *                       using new_value=old_value
+ * post: key and value are assigned and destroy functions are registered
+ * return: pointer to vanessa_key_value structure
+ *         NULL if kv is NULL
+ **********************************************************************/
+
+vanessa_key_value_t *vanessa_key_value_assign(vanessa_key_value_t * kv,
+					      void *key,
+					      void (*destroy_key) (void *),
+					      void *(*dup_key) (void *),
+					      void *value,
+					      void (*destroy_value) (void
+								     *),
+					      void *(*dup_value) (void *)
+    );
+
+
+/**********************************************************************
+ * vanessa_key_value_unassign
+ * Unassign values in vanessa_key_values structure
+ * Useful if you want to destroy the vanessa_key_value structure
+ * without freeing the contents
+ * pre: kv: key_value structure to unassign values of
+ * post: All elements in vanessa_key_value structure are set to NULL
+ * return: pointer to vanessa_key_value structure
+ *         NULL if kv is NULL
+ **********************************************************************/
+
+vanessa_key_value_t *vanessa_key_value_unassign(vanessa_key_value_t * kv);
+
+
+/**********************************************************************
+ * vanessa_key_value_key_get_key
+ * Get the key from a vanessa_key_value structure
+ * pre: kv: key value structure to get the key of
+ * return: key of kv
+ *         NULL if kv is NULL
+ **********************************************************************/
+
+void *vanessa_key_value_get_key(vanessa_key_value_t * kv);
+
+
+/**********************************************************************
+ * vanessa_key_value_key_get_value
+ * Get the value from a vanessa_key_value structure
+ * pre: kv: key value structure to get the value of
+ * return: value of kv
+ *         NULL if kv is NULL
+ **********************************************************************/
+
+void *vanessa_key_value_get_value(vanessa_key_value_t * kv);
+
+
+#define VANESSA_DESTROY_KV (void (*)(void *s))vanessa_key_value_destroy
+#define VANESSA_DUPLICATE_KV (void *(*)(void *s))vanessa_key_value_duplicate
+
+
+/**********************************************************************
+ * Logging functionality
+ *
+ * Depreciated, but provided for backwards compatibility.
+ * Call vanessa_logger_set() and vanessa_logger_unset() instead.
+ *
+ **********************************************************************/
+
+/**********************************************************************
+ * vanessa_adt_logger_set
+ *
+ * Depreciated, but provided for backwards compatibility.
+ * Call vanessa_logger_set() instead.
+ *
+ * set the logger function to use
+ * No logging will take place if logger is set to NULL (default)
+ * That is you _must_ call this function to enable logging.
+ * pre: logger: pointer to a vanessa_logger
+ * post: logger for vanessa_adt is set to logger
+ * return: none
+ **********************************************************************/
+
+#define vanessa_adt_logger_set(_vl) vanessa_logger_set(_vl)
+
+
+/**********************************************************************
+ * vanessa_adt_logger_unset
+ *
+ * Depreciated, but provided for backwards compatibility.
+ * Call vanessa_logger_unset() instead.
+ *
+ * set logger to NULL
+ * That is no logging will take place
+ * pre: none
+ * post: logger is NULL
+ * return: none
+ **********************************************************************/
+
+#define vanessa_adt_logger_unset() vanessa_logger_unset()
+
+
+/**********************************************************************
+ * Pool of fixed size objects
+ *
+ * Objects are allocated from page sized slabs and recycled through
+ * free lists, so allocation and freeing are O(1) and avoid malloc
+ * for most calls, and objects allocated together are close together
+ * in memory. Used to allocate the elements of lists.
+ **********************************************************************/
+
+typedef struct vanessa_pool_t_struct vanessa_pool_t;
+
+#define VANESSA_POOL_RELEASE 0x1
+
+
+/**********************************************************************
+ * vanessa_pool_create
+ * Create a new, empty pool
+ * pre: size: size of each object in bytes
+ *      flag: VANESSA_POOL_RELEASE to free slabs as soon as all their
+ *            objects are freed. Otherwise slabs are kept for reuse
+ *            until the pool is destroyed.
+ * post: pool is allocated and initialised, no slabs are allocated
+ *       The reference count of the pool is 1
+ * return: pointer to pool
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_pool_t *vanessa_pool_create(size_t size, vanessa_adt_flag_t flag);
+
+
+/**********************************************************************
+ * vanessa_pool_ref
+ * Take a reference to a pool, so that it may be shared
+ * pre: p: pool
+ * post: reference count of p is incremented
+ *       vanessa_pool_destroy must be called once more before it is
+ *       freed
+ * return: p
+ **********************************************************************/
+
+vanessa_pool_t *vanessa_pool_ref(vanessa_pool_t *p);
+
+
+/**********************************************************************
+ * vanessa_pool_destroy
+ * Drop a reference to a pool, destroying it if it was the last
+ * pre: p: pool
+ * post: reference count of p is decremented. If it reaches zero
+ *       all slabs are freed, along with any objects still allocated
+ *       from them, and p is freed.
+ * return: none
+ **********************************************************************/
+
+void vanessa_pool_destroy(vanessa_pool_t *p);
+
+
+/**********************************************************************
+ * vanessa_pool_alloc
+ * Allocate an object from a pool
+ * pre: p: pool
+ * post: an object is allocated, adding a slab to the pool if needed
+ * return: pointer to uninitialised object of the size given to
+ *         vanessa_pool_create
+ *         NULL on error
+ **********************************************************************/
+
+void *vanessa_pool_alloc(vanessa_pool_t *p);
+
+
+/**********************************************************************
+ * vanessa_pool_free
+ * Return an object to a pool
+ * pre: p: pool
+ *      obj: object allocated from p, may be NULL
+ * post: obj is returned to the free list of its slab. If the slab
+ *       is now empty and p was created with VANESSA_POOL_RELEASE
+ *       then the slab is freed.
+ * return: none
+ **********************************************************************/
+
+void vanessa_pool_free(vanessa_pool_t *p, void *obj);
+
+
+/**********************************************************************
+ * vanessa_pool_get_slab_count
+ * Get the number of slabs allocated by a pool
+ * pre: p: pool
+ * return: number of slabs
+ *         0 if p is NULL
+ **********************************************************************/
+
+size_t vanessa_pool_get_slab_count(vanessa_pool_t *p);
+
+
+/**********************************************************************
+ * Linked List to store all your flims in.
+ *
+ * The primitive type for the array is void *. Thus, providing your own
+ * duplicate_primitive, destroy_primitive, match_primative,
+ * display_primitive and length_primitive functions will allow you to use
+ * the vanessa_list API to have a listcontaining any primitive
+ *
+ * Includes macros required to create an array of strings or integers.
+ **********************************************************************/
+
+
+typedef struct vanessa_list_elem_struct vanessa_list_elem_t;
+typedef struct vanessa_list_skip_struct vanessa_list_skip_t;
+typedef struct vanessa_list_index_struct vanessa_list_index_t;
+
+typedef struct {
+	vanessa_list_elem_t *first;
+	vanessa_list_elem_t *last;
+	vanessa_list_elem_t **recent;
+	int norecent;
+	size_t recent_offset;
+	void (*e_destroy) (void *e);
+	void *(*e_duplicate) (void *e);
+	void (*e_display) (char *s, void *e);
+	size_t(*e_length) (void *e);
+	int (*e_match) (void *e, void *key);
+	int (*e_sort) (void *a, void *b);
+	vanessa_pool_t *pool;
+	vanessa_adt_flag_t flag;
+	vanessa_list_skip_t *skip;
+	vanessa_list_index_t *index;
+	size_t count;
+} vanessa_list_t;
+
+
+#define VANESSA_LIST_REORDER -1
+
+#define VANESSA_LIST_SKIP 0x1
+#define VANESSA_LIST_BULK 0x2
+
+/**********************************************************************
+ * vanessa_list_create
+ * Create a new, empty list
+ * pre: norecent: number of elements for recent list.
+ * 		  If VANESSA_LIST_REORDER then no recent list is used
+ * 		  but elements are moved to the front of the list
+ * 		  as they are retrieved using vanessa_list_get_element
+ *      element_destroy:   Pointer to a function to destroy an element
+ *                         Function should take an argument of a pointer
+ *                         and free the memory allocated to the structure
+ *                         pointed to.
+ *      element_duplicate: Pointer to a function to duplicate an element
+ *                         Function should take a pointer to an element to
+ *                         duplicate as the only element and return a copy
+ *                         of the element Any memory allocation required
+ *                         should be done by this function.
+ *      element_display:   Pointer to a function to display an element
+ *                         Function should take a pointer to char and a
+ *                         pointer to an element as arguments. An ASCII
+ *                         representation of the element should be placed
+ *                         in the character buffer given as the first
+ *                         argument.  May be NULL in which case
+ *                         vanessa_dynamic_array_display will return an empty
+ *                         string ("\0");
+ *      element_size:      Pointer to a function to find the length of an
+ *                         ASCII representation of the element not
+ *                         including the trailing '\0'. Used to guard
+ *                         against buffer over runs when using
+ *                         element_display. May be NULL, in which case
+ *                         vanessa_dynamic_array_display will return an
+ *                         empty string ("");
+ *      element_match:     Pointer to a function to match an element
+ *                         by a key.
+ *      element_sort:      Pointer to a function that will compare
+ *                         two elements and and b. Will return < 0 if a 
+ *                         should be before b in the list > 0 if a should
+ *                         be after b in the list. 0 if they are equal.
+ *                         Used in vanessa_list_add_element
+ *
+ * post: list structure is alocated, and values initialised to NULL
+ * return: pointer to list
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_create(int norecent,
+                                   void (*element_destroy) (void *e),
+                                   void *(*element_duplicate) (void *e),
+                                   void (*element_display) (char *s, void *e),
+                                   size_t(*element_size) (void *e),
+                                   int (*element_match) (void *e, void *key),
+				   int (*element_sort) (void *a, void *b));
+
+
+/**********************************************************************
+ * vanessa_list_destroy
+ * Destroy a list and all the data contained in the list
+ * pre: l: list
+ * post: all elements of l are destroyed
+ **********************************************************************/
+
+void vanessa_list_destroy(vanessa_list_t * l);
+
+
+/**********************************************************************
+ * vanessa_list_length
+ * Find the length of an ASCII representation of a dynamic array.
+ * Not including a terminating '\0'.
+ * pre: l: list to find the length of
+ * post: If l is NULL or there are no elements in l then the 
+ *          length is 0
+ *       If element_length, as passed to vanessa_list_create, 
+ *          is NULL, then 0 is returned.
+ *       Else the cumulative lenth of the elemements as per the
+ *          element_length function, plus one character per element 
+ *          for a delimiter between elements.
+ *          The trailing '\0' is not counted.
+ *          It is up to the user to free this buffer.  
+ * return: Cumulative length of the elements.
+ *         0 if a is NULL or there are no elements in a or if
+ *           element_length passed to vanessa_list_create is NULL.
+ **********************************************************************/
+
+size_t vanessa_list_length(vanessa_list_t * l);
+
+
+/**********************************************************************
+ * vanessa_list_display
+ * Make an ASCII representation of the list
+ * pre: l: list to display
+ *      delimiter: character to place between elements of the list
+ * post: If l is NULL or there are no elements in l then nothing is 
+ *          done
+ *       If element_display or element_length, as passed to
+ *          vanessa_list_create, are NULL, then an empty string 
+ *          ("") is returned.  
+ *       Else a character buffer is allocated and an ASCII 
+ *          representation of each list element, as determined by 
+ *          element_display, separated by delimiter is placed in 
+ *          the '\0' terminated buffer that is returned. 
+ *          It is up to the user to free this buffer.  
+ * return: Allocated buffer as above 
+ *         NULL on error, 
+ *         NULL l or empty l
+ **********************************************************************/
+
+char *vanessa_list_display(vanessa_list_t * l, char delimiter);
+
+
+/**********************************************************************
+ * vanessa_list_get_element
+ * Find an element in the list by key using the element_match function
+ * passed to vanessa_list_create
+ * If VANESSA_LIST_SKIP is set this is O(log n) but key must also be
+ * suitable for comparing with elements using element_sort.
+ * If the list has an index, see vanessa_list_set_index, this is O(1).
+ * pre: l: list to search
+ *      key: key to match
+ * post: none
+ * return: value it is found
+ *         NULL if l or key is NULL or if value matching key is not found
+ **********************************************************************/
+
+void *vanessa_list_get_element(vanessa_list_t *l, void *key);
+
+
+/**********************************************************************
+ * vanessa_list_get_count
+ * Count the number of elements in the list
+ * pre: l: list to count
+ * post: none
+ * return: number of elements in the list, O(1)
+ *         0 if l is NULL
+ **********************************************************************/
+
+size_t vanessa_list_get_count(vanessa_list_t *l);
+
+
+/**********************************************************************
+ * vanessa_list_add_element
+ * Insert element into a list
+ * pre: l: list to insert value into
+ *      value: value to insert
+ * post: value is inserted into the list
+ *       if VANESSA_LIST_BULK is set the element is appended to the
+ *       end of the list. Otherwise if element_sort passed to
+ *       vanessa_list_create is non-NULL then the element will be
+ *       inserted in order, or else the element will be inserted at
+ *       the begining of the list.
+ * return: NULL if l is NULL
+ *         l, unchanged if value is NULL
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_add_element(vanessa_list_t * l, void *value);
+
+
+/**********************************************************************
+ * vanessa_list_remove_element
+ * Insert element into a list
+ * pre: l: list to insert value into
+ *      value: value to insert
+ * post: value is removed from the list
+ * return: NULL if l is NULL
+ *         l, unchanged if value is null
+ **********************************************************************/
+
+void vanessa_list_remove_element(vanessa_list_t *l, void *key);
+
+
+/**********************************************************************
+ * vanessa_list_duplicate
+ * Duplicate a list
+ * pre: l: list to duplicate
+ * post: list is duplicated, in the same order, in O(n)
+ *       Elements of the new list are allocated from the pool of l,
+ *       if it has one. Otherwise, if l has at least 64 elements,
+ *       the new list is given a pool of its own, so that its
+ *       elements are allocated a slab at a time rather than one
+ *       by one.
+ * return: NULL if l is NULL or on error
+ *         duplicated list 
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_duplicate(vanessa_list_t *l);
+
+
+/**********************************************************************
+ * vanessa_list_duplicate_pool
+ * Duplicate a list, allocating its elements from a given pool
+ * pre: l: list to duplicate
+ *      pool: pool created by vanessa_list_pool_create, which may be
+ *            shared with other lists. NULL to allocate elements
+ *            using malloc.
+ * post: list is duplicated, in the same order, in O(n)
+ *       Elements are copied rather than inserted, so element_sort
+ *       is not called, and the skip list and index of l, if any, are
+ *       built once the copy is complete. A copy of a list that is
+ *       being bulk loaded is too, and is sorted when
+ *       VANESSA_LIST_BULK is cleared.
+ * return: NULL if l is NULL or on error
+ *         duplicated list
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_duplicate_pool(vanessa_list_t *l,
+		vanessa_pool_t *pool);
+
+
+/**********************************************************************
+ * vanessa_list_iterate
+ * Run a fucntion over each element in the list
+ * pre: l: list run the function over
+ *      action: function to run
+ *              action should return < 0 if an error occurs,
+ *              which indicates that processing will be stopped
+ *      data: data passed to action
+ * post: action is run with the value of each element as its first argument
+ * return: 0 on success
+ *         < 0 if action returns < 0
+ **********************************************************************/
+
+int vanessa_list_iterate(vanessa_list_t *l, int(* action)(void *e, void *data),
+		void *data);
+
+
+/**********************************************************************
+ * vanessa_list_first
+ * Get the first element of a list
+ * Elements may be used as cursors, to walk a list and change it
+ * as it is walked, and as handles, to remove or move elements without
+ * searching for them. An element remains valid until it is removed
+ * from its list or the list is destroyed, or vanessa_list_set_pool is
+ * called.
+ * pre: l: list
+ * post: none
+ * return: first element of l
+ *         NULL if l is NULL or empty
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_first(vanessa_list_t *l);
+
+
+/**********************************************************************
+ * vanessa_list_last
+ * Get the last element of a list
+ * pre: l: list
+ * post: none
+ * return: last element of l
+ *         NULL if l is NULL or empty
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_last(vanessa_list_t *l);
+
+
+/**********************************************************************
+ * vanessa_list_next
+ * Get the element after an element of a list
+ * pre: e: element
+ * post: none
+ * return: element after e
+ *         NULL if e is NULL or the last element
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_next(vanessa_list_elem_t *e);
+
+
+/**********************************************************************
+ * vanessa_list_prev
+ * Get the element before an element of a list
+ * pre: e: element
+ * post: none
+ * return: element before e
+ *         NULL if e is NULL or the first element
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_prev(vanessa_list_elem_t *e);
+
+
+/**********************************************************************
+ * vanessa_list_elem_value
+ * Get the value of an element of a list
+ * pre: e: element
+ * post: none
+ * return: value of e
+ *         NULL if e is NULL
+ **********************************************************************/
+
+void *vanessa_list_elem_value(vanessa_list_elem_t *e);
+
+
+/**********************************************************************
+ * vanessa_list_get_elem
+ * Find an element in the list by key, as for vanessa_list_get_element
+ * pre: l: list to search
+ *      key: key to match
+ * post: none
+ * return: element whose value matches key
+ *         NULL if l or key is NULL or if no value matches key
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_get_elem(vanessa_list_t *l, void *key);
+
+
+/**********************************************************************
+ * vanessa_list_insert_before
+ * Insert a value into a list at a given position, in O(1)
+ * The position is used even if the list has element_sort, so it is
+ * up to the caller to keep a sorted list in order.
+ * pre: l: list
+ *      pos: element of l to insert before, NULL to append to l
+ *      value: value to insert, duplicated if element_duplicate passed
+ *             to vanessa_list_create is non-NULL
+ * post: value is inserted before pos
+ * return: element holding value
+ *         NULL if l or value is NULL or on error, in which case l is
+ *         unchanged
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_insert_before(vanessa_list_t *l,
+		vanessa_list_elem_t *pos, void *value);
+
+
+/**********************************************************************
+ * vanessa_list_remove_elem
+ * Remove an element from a list, in O(1) unless the list has a recent
+ * element cache, in which case it is O(norecent)
+ * pre: l: list
+ *      e: element of l, or one taken out of l with vanessa_list_unlink
+ * post: e is removed from l, unless it was unlinked, and destroyed,
+ *       along with its value if element_destroy was passed to
+ *       vanessa_list_create
+ * return: element that was after e, so that a list may be filtered
+ *         while it is walked
+ *         NULL if l or e is NULL, e was the last element or e had
+ *         been unlinked
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_remove_elem(vanessa_list_t *l,
+		vanessa_list_elem_t *e);
+
+
+/**********************************************************************
+ * vanessa_list_unlink
+ * Take an element out of a list without destroying it, so that it can
+ * be linked back in elsewhere with vanessa_list_link_before
+ * pre: l: list
+ *      e: element of l
+ * post: e is not in l, but it and its value remain allocated
+ *       e must be linked back into l, or removed from it with
+ *       vanessa_list_remove_elem, before l is destroyed
+ * return: element that was after e
+ *         NULL if l or e is NULL or e was the last element
+ **********************************************************************/
+
+vanessa_list_elem_t *vanessa_list_unlink(vanessa_list_t *l,
+		vanessa_list_elem_t *e);
+
+
+/**********************************************************************
+ * vanessa_list_link_before
+ * Link an element taken out of a list with vanessa_list_unlink back
+ * into it, in O(1)
+ * As for vanessa_list_insert_before, the position is used even if the
+ * list has element_sort.
+ * pre: l: list e was unlinked from
+ *      pos: element of l to link e before, NULL to append to l
+ *      e: element unlinked from l
+ * post: e is in l before pos
+ * return: l
+ *         NULL if l or e is NULL or on error, in which case e is
+ *         still unlinked
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_link_before(vanessa_list_t *l,
+		vanessa_list_elem_t *pos, vanessa_list_elem_t *e);
+
+
+/**********************************************************************
+ * vanessa_list_splice
+ * Move all the elements of one list to the end of another
+ * The lists should have the same element functions, and if dst is
+ * sorted it is up to the caller to keep it in order.
+ * pre: dst: list to move elements to
+ *      src: list to move elements from
+ * post: elements of src are at the end of dst, in order, and src is
+ *       empty. Nothing is allocated or freed, other than to grow the
+ *       index of dst. O(1), unless either list has an index or
+ *       VANESSA_LIST_SKIP set.
+ * return: dst
+ *         NULL if dst or src is NULL, dst and src are the same list,
+ *         they use different pools, or on error. In which case
+ *         neither list is changed.
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_splice(vanessa_list_t *dst, vanessa_list_t *src);
+
+
+/**********************************************************************
+ * vanessa_list_merge
+ * Merge the elements of one sorted list into another
+ * pre: dst: sorted list to move elements to
+ *      src: sorted list to move elements from
+ * post: elements of src are in dst, which is sorted using the
+ *       element_sort function passed to vanessa_list_create for dst.
+ *       Equal elements of dst come before those of src. src is empty.
+ *       O(n + m). Nothing is allocated or freed, other than to grow
+ *       the index of dst.
+ * return: dst
+ *         NULL if dst or src is NULL, dst has no element_sort, dst and
+ *         src are the same list, they use different pools, or on
+ *         error. In which case neither list is changed.
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_merge(vanessa_list_t *dst, vanessa_list_t *src);
+
+
+/**********************************************************************
+ * vanessa_list_split
+ * Split a list in two at an element
+ * pre: l: list to split
+ *      e: element of l, the first to move to the new list
+ *         NULL to create an empty list
+ * post: e and the elements after it are moved, in order, to a new
+ *       list with the same element functions, flags, pool and index
+ *       as l. O(k) in the number of elements moved, unless l has
+ *       VANESSA_LIST_SKIP set.
+ * return: new list
+ *         NULL if l is NULL or on error, in which case l is unchanged
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_split(vanessa_list_t *l, vanessa_list_elem_t *e);
+
+
+/**********************************************************************
+ * vanessa_list_pool_create
+ * Create a pool for list elements
+ * pre: flag: flag passed to vanessa_pool_create,
+ *            VANESSA_POOL_RELEASE to free empty slabs
+ * post: pool is allocated
+ * return: pool suitable for use with vanessa_list_set_pool
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_pool_t *vanessa_list_pool_create(vanessa_adt_flag_t flag);
+
+
+/**********************************************************************
+ * vanessa_list_set_pool
+ * Allocate the elements of a list from a pool
+ * pre: l: list
+ *      pool: pool created by vanessa_list_pool_create, which may be
+ *            shared with other lists. NULL to allocate elements
+ *            using malloc.
+ * post: l takes a reference to pool and drops its reference to
+ *       any pool it was previously using. Existing elements are
+ *       moved to the new pool, in order, so their values are
+ *       unchanged but they are contiguous in memory.
+ * return: l on success
+ *         NULL if l is NULL or on error, in which case l is unchanged
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_set_pool(vanessa_list_t *l, vanessa_pool_t *pool);
+
+
+/**********************************************************************
+ * vanessa_list_set_index
+ * Index the elements of a list by hash
+ * pre: l: list
+ *      element_hash: Pointer to a function that returns a hash of an
+ *                    element. It is also passed the keys given to
+ *                    vanessa_list_get_element and
+ *                    vanessa_list_remove_element, and must return the
+ *                    same hash for a key as for the elements that
+ *                    match it. NULL to drop the index.
+ * post: l keeps a hash table of its elements, so that
+ *       vanessa_list_get_element and vanessa_list_remove_element are
+ *       O(1) and the recently accessed element cache is not used.
+ *       The order of the list is unchanged. If more than one element
+ *       matches a key it is not defined which is found. Adds about
+ *       three to five pointers per element.
+ * return: l on success
+ *         NULL if l is NULL or on error, in which case l is unchanged
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_set_index(vanessa_list_t *l,
+		size_t (*element_hash)(void *e));
+
+
+/**********************************************************************
+ * vanessa_list_set_flag
+ * Set flags that change how a list is stored
+ * pre: l: list
+ *      flag: flags to set, may be ored together
+ *            VANESSA_LIST_SKIP: Keep a skip list over the elements of
+ *            a sorted list, so that vanessa_list_add_element,
+ *            vanessa_list_get_element and vanessa_list_remove_element
+ *            are O(log n) rather than O(n). Requires element_sort and
+ *            that keys passed to vanessa_list_get_element and
+ *            vanessa_list_remove_element can be compared to elements
+ *            using it. Adds about 1/3 of a pointer pair per element.
+ *            VANESSA_LIST_BULK: Append elements added with
+ *            vanessa_list_add_element to the end of the list, without
+ *            ordering them, until the flag is cleared, at which time
+ *            a sorted list is sorted. Loads a large sorted list in
+ *            O(n log n). Lookups do not use the skip list meanwhile.
+ * post: flags are set, existing elements are indexed as needed
+ * return: l on success
+ *         NULL if l is NULL or on error, in which case l is unchanged
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_set_flag(vanessa_list_t *l,
+		vanessa_adt_flag_t flag);
+
+
+/**********************************************************************
+ * vanessa_list_clear_flag
+ * Clear flags set by vanessa_list_set_flag
+ * pre: l: list
+ *      flag: flags to clear, may be ored together
+ * post: flags are cleared and any index they required is freed
+ *       Clearing VANESSA_LIST_BULK sorts the list if element_sort is
+ *       non-NULL.
+ * return: l
+ *         NULL if l is NULL
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_clear_flag(vanessa_list_t *l,
+		vanessa_adt_flag_t flag);
+
+
+/**********************************************************************
+ * vanessa_list_sort
+ * Sort a list using the element_sort function passed to
+ * vanessa_list_create
+ * Bottom up merge sort of the list elements themselves, O(n log n)
+ * and O(n) if the list is already sorted. Stable, so equal elements
+ * keep their order, and nothing is allocated.
+ * pre: l: list to sort
+ * post: elements of l are in order
+ * return: l
+ *         NULL if l is NULL or element_sort is NULL
+ **********************************************************************/
+
+vanessa_list_t *vanessa_list_sort(vanessa_list_t *l);
+
+
+/**********************************************************************
+ * Unrolled linked list
+ *
+ * As for vanessa_list, but each node holds several values so that
+ * walking the list is cache friendly. Values do not have a stable
+ * node, so there is no recently accessed element cache.
+ **********************************************************************/
+
+typedef struct vanessa_ulist_t_struct vanessa_ulist_t;
+
+
+/**********************************************************************
+ * vanessa_ulist_create
+ * Create a new, empty unrolled list
+ * pre: element_destroy:   Pointer to a function to destroy an element
+ *                         May be NULL
+ *      element_duplicate: Pointer to a function to duplicate an element
+ *                         May be NULL in which case elements are
+ *                         inserted by reference
+ *      element_display:   Pointer to a function to display an element
+ *                         May be NULL in which case
+ *                         vanessa_ulist_display will return an empty
+ *                         string ("")
+ *      element_size:      Pointer to a function to find the length of an
+ *                         ASCII representation of the element not
+ *                         including the trailing '\0'. May be NULL, in
+ *                         which case vanessa_ulist_display will return
+ *                         an empty string ("")
+ *      element_match:     Pointer to a function to match an element
+ *                         by a key. May be NULL in which case
+ *                         elements are matched by address.
+ *      element_sort:      Pointer to a function that will compare
+ *                         two elements, as for vanessa_list_create.
+ *                         May be NULL in which case elements are
+ *                         appended to the end of the list.
+ * post: list is allocated and initialised
+ * return: pointer to list
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_ulist_t *vanessa_ulist_create(void (*element_destroy) (void *e),
+		void *(*element_duplicate) (void *e),
+		void (*element_display) (char *s, void *e),
+		size_t(*element_size) (void *e),
+		int (*element_match) (void *e, void *key),
+		int (*element_sort) (void *a, void *b));
+
+
+/**********************************************************************
+ * vanessa_ulist_destroy
+ * Destroy an unrolled list and all the data contained in the list
+ * pre: l: list
+ * post: all elements of l are destroyed
+ **********************************************************************/
+
+void vanessa_ulist_destroy(vanessa_ulist_t *l);
+
+
+/**********************************************************************
+ * vanessa_ulist_length
+ * Find the length of an ASCII representation of an unrolled list
+ * Not including a terminating '\0'.
+ * pre: l: list to find the length of
+ * return: Cumulative length of the elements, plus one character per
+ *         element for a delimiter between elements.
+ *         0 if l is NULL or there are no elements in l or if
+ *         element_length passed to vanessa_ulist_create is NULL.
+ **********************************************************************/
+
+size_t vanessa_ulist_length(vanessa_ulist_t *l);
+
+
+/**********************************************************************
+ * vanessa_ulist_display
+ * Make an ASCII representation of an unrolled list
+ * pre: l: list to display
+ *      delimiter: character to place between elements of the list
+ * post: If element_display or element_length, as passed to
+ *          vanessa_ulist_create, are NULL, then an empty string
+ *          ("") is returned.
+ *       Else a character buffer is allocated and an ASCII
+ *          representation of each list element, as determined by
+ *          element_display, separated by delimiter is placed in
+ *          the '\0' terminated buffer that is returned.
+ *          It is up to the user to free this buffer.
+ * return: Allocated buffer as above
+ *         NULL on error, NULL l or empty l
+ **********************************************************************/
+
+char *vanessa_ulist_display(vanessa_ulist_t *l, char delimiter);
+
+
+/**********************************************************************
+ * vanessa_ulist_get_element
+ * Find an element in an unrolled list by key using the element_match
+ * function passed to vanessa_ulist_create
+ * pre: l: list to search
+ *      key: key to match
+ * post: none
+ * return: value if it is found
+ *         NULL if l or key is NULL or if value matching key is not found
+ **********************************************************************/
+
+void *vanessa_ulist_get_element(vanessa_ulist_t *l, void *key);
+
+
+/**********************************************************************
+ * vanessa_ulist_get_count
+ * Count the number of elements in an unrolled list
+ * pre: l: list to count
+ * post: none
+ * return: number of elements in the list, O(1)
+ *         0 if l is NULL
+ **********************************************************************/
+
+size_t vanessa_ulist_get_count(vanessa_ulist_t *l);
+
+
+/**********************************************************************
+ * vanessa_ulist_add_element
+ * Insert element into an unrolled list
+ * pre: l: list to insert value into
+ *      value: value to insert
+ * post: value is inserted into the list
+ *       if element_sort passed to vanessa_ulist_create is non-NULL
+ *       then the element will be inserted in order, after any equal
+ *       elements. Otherwise the element will be appended to the end
+ *       of the list.
+ * return: NULL if l is NULL or on error
+ *         l, unchanged if value is NULL
+ **********************************************************************/
+
+vanessa_ulist_t *vanessa_ulist_add_element(vanessa_ulist_t *l, void *value);
+
+
+/**********************************************************************
+ * vanessa_ulist_remove_element
+ * Remove an element from an unrolled list
+ * pre: l: list to remove element from
+ *      key: key of element to remove
+ * post: first element matching key is removed from the list and
+ *       destroyed
+ * return: none
+ **********************************************************************/
+
+void vanessa_ulist_remove_element(vanessa_ulist_t *l, void *key);
+
+
+/**********************************************************************
+ * vanessa_ulist_duplicate
+ * Duplicate an unrolled list
+ * pre: l: list to duplicate
+ * post: list is duplicated, in the same order
+ * return: NULL if l is NULL or on error
+ *         duplicated list
+ **********************************************************************/
+
+vanessa_ulist_t *vanessa_ulist_duplicate(vanessa_ulist_t *l);
+
+
+/**********************************************************************
+ * vanessa_ulist_iterate
+ * Run a function over each element in an unrolled list
+ * pre: l: list run the function over
+ *      action: function to run
+ *              action should return < 0 if an error occurs,
+ *              which indicates that processing will be stopped
+ *      data: data passed to action
+ * post: action is run with the value of each element as its first
+ *       argument, in order
+ * return: 0 on success
+ *         < 0 if action returns < 0
+ **********************************************************************/
+
+int vanessa_ulist_iterate(vanessa_ulist_t *l,
+		int (*action)(void *e, void *data), void *data);
+
+
+/**********************************************************************
+ * Intrusive doubly linked list
+ *
+ * Embed a vanessa_ilist_t in your structure for each list it may be
+ * on, and use another, initialised with vanessa_ilist_init, as the
+ * head of each list. Nothing is allocated or freed by these functions.
+ **********************************************************************/
+
+typedef struct vanessa_ilist_struct vanessa_ilist_t;
+
+struct vanessa_ilist_struct {
+	vanessa_ilist_t *next;
+	vanessa_ilist_t *prev;
+};
+
+/* Initialiser for a head or link, as for vanessa_ilist_init */
+#define VANESSA_ILIST_INIT(name) { &(name), &(name) }
+
+/* The structure of type that link, its member named member, is in */
+#define VANESSA_ILIST_ENTRY(link, type, member) \
+	((type *)((char *)(link) - offsetof(type, member)))
+
+/* The first and last entries of a list, NULL if it is empty */
+#define VANESSA_ILIST_FIRST(head, type, member) \
+	((head)->next == (head) ? (type *)NULL : \
+	 VANESSA_ILIST_ENTRY((head)->next, type, member))
+#define VANESSA_ILIST_LAST(head, type, member) \
+	((head)->prev == (head) ? (type *)NULL : \
+	 VANESSA_ILIST_ENTRY((head)->prev, type, member))
+
+/*
+ * Loop over the entries of a list with pos, a pointer to type.
+ * The list must not be changed by the body of the loop, except by
+ * removing pos when using VANESSA_ILIST_FOREACH_SAFE, which needs
+ * another pointer to type, tmp.
+ */
+#define VANESSA_ILIST_FOREACH(pos, head, type, member) \
+	for((pos) = VANESSA_ILIST_ENTRY((head)->next, type, member); \
+			&(pos)->member != (head); \
+			(pos) = VANESSA_ILIST_ENTRY((pos)->member.next, \
+				type, member))
+
+#define VANESSA_ILIST_FOREACH_REVERSE(pos, head, type, member) \
+	for((pos) = VANESSA_ILIST_ENTRY((head)->prev, type, member); \
+			&(pos)->member != (head); \
+			(pos) = VANESSA_ILIST_ENTRY((pos)->member.prev, \
+				type, member))
+
+#define VANESSA_ILIST_FOREACH_SAFE(pos, tmp, head, type, member) \
+	for((pos) = VANESSA_ILIST_ENTRY((head)->next, type, member), \
+			(tmp) = VANESSA_ILIST_ENTRY((pos)->member.next, \
+				type, member); \
+			&(pos)->member != (head); \
+			(pos) = (tmp), \
+			(tmp) = VANESSA_ILIST_ENTRY((tmp)->member.next, \
+				type, member))
+
+
+/**********************************************************************
+ * vanessa_ilist_init
+ * Initialise the head of an intrusive list, or a link
+ * pre: head: head or link to initialise
+ * post: head is an empty list. A link initialised like this may be
+ *       tested with vanessa_ilist_empty to see if it is on a list,
+ *       and removed from a list more than once.
+ * return: none
+ **********************************************************************/
+
+void vanessa_ilist_init(vanessa_ilist_t *head);
+
+
+/**********************************************************************
+ * vanessa_ilist_empty
+ * Check if an intrusive list is empty
+ * pre: head: head of list, or a link
+ * post: none
+ * return: non-zero if head is an empty list, or a link that is not
+ *         on a list
+ *         0 otherwise
+ **********************************************************************/
+
+int vanessa_ilist_empty(const vanessa_ilist_t *head);
+
+
+/**********************************************************************
+ * vanessa_ilist_insert_after
+ * Insert a link into an intrusive list after a given link
+ * pre: pos: head of a list, or a link on it
+ *      link: link that is not on a list
+ * post: link is on the list after pos. If pos is the head link is
+ *       the first element of the list.
+ * return: none
+ **********************************************************************/
+
+void vanessa_ilist_insert_after(vanessa_ilist_t *pos, vanessa_ilist_t *link);
+
+
+/**********************************************************************
+ * vanessa_ilist_insert_before
+ * Insert a link into an intrusive list before a given link
+ * pre: pos: head of a list, or a link on it
+ *      link: link that is not on a list
+ * post: link is on the list before pos. If pos is the head link is
+ *       the last element of the list.
+ * return: none
+ **********************************************************************/
+
+void vanessa_ilist_insert_before(vanessa_ilist_t *pos, vanessa_ilist_t *link);
+
+
+/**********************************************************************
+ * vanessa_ilist_remove
+ * Remove a link from the intrusive list it is on
+ * pre: link: link that is on a list, or initialised with
+ *            vanessa_ilist_init
+ * post: link is not on a list, and is initialised as for
+ *       vanessa_ilist_init
+ * return: none
+ **********************************************************************/
+
+void vanessa_ilist_remove(vanessa_ilist_t *link);
+
+
+/**********************************************************************
+ * vanessa_ilist_splice
+ * Move all the elements of one intrusive list to the end of another
+ * pre: head: head of list to add elements to
+ *      other: head of list to take elements from
+ * post: elements of other are at the end of head, in order
+ *       other is empty
+ * return: none
+ **********************************************************************/
+
+void vanessa_ilist_splice(vanessa_ilist_t *head, vanessa_ilist_t *other);
+
+
+/**********************************************************************
+ * vanessa_ilist_get_count
+ * Count the elements of an intrusive list
+ * pre: head: head of list
+ * post: none
+ * return: number of elements in the list, O(n)
+ **********************************************************************/
+
+size_t vanessa_ilist_get_count(const vanessa_ilist_t *head);
+
+
+
+/**********************************************************************
+ * Hash to put your flims in.
+ * 
+ * The primitive type for the array is void *. Thus, providing your
+ * own duplicate_primitive, destroy_primitive, match_primative,
+ * display_primitive, length_primitive and hash_primitive, functions
+ * will allow you to use the vanessa_hash API to have a
+ * hash containing any primitive
+ *
+ * Includes macros, excluding hash_primitive,  required to create an
+ * list of strings or integers.
+ **********************************************************************/
+
+
+typedef struct vanessa_hash_t_struct vanessa_hash_t;
+
+
+/**********************************************************************
+ * vanessa_hash_create
+ * Create a new, empty hash
+ * pre: nobucket: number of buckets in the hash
+ *      element_destroy:   Pointer to a function to destroy an element
+ *                         Function should take an argument of a pointer
+ *                         and free the memory allocated to the structure
+ *                         pointed to.
+ *      element_duplicate: Pointer to a function to duplicate an element
+ *                         Function should take a pointer to an element to
+ *                         duplicate as the only element and return a copy
+ *                         of the element Any memory allocation required
+ *                         should be done by this function.
+ *      element_match:     Pointer to a function to match an element
+ *                         by a key.
+ *      element_display:   Pointer to a function to display an element
+ *                         Function should take a pointer to char and a
+ *                         pointer to an element as arguments. An ASCII
+ *                         representation of the element should be placed
+ *                         in the character buffer given as the first
+ *                         argument.  May be NULL in which case
+ *                         vanessa_dynamic_array_display will return an empty
+ *                         string ("\0");
+ *      element_length:    Pointer to a function to find the length of an
+ *                         ASCII representation of the element not
+ *                         including the trailing '\0'. Used to guard
+ *                         against buffer over runs when using
+ *                         element_display. May be NULL, in which case
+ *                         vanessa_dynamic_array_display will return an
+ *                         empty string ("");
+ *      element_hash:      Pointer to a function that return the hash
+ *                         bucket index, a number >= 0 && < nobucket,
+ *                         for an element.
+ *
+ * post: hash structure is alocated, and values initialised to NULL
+ *       note that the hash buckets are linked lists and are created
+ *       on demand.
+ * return: pointer to hash
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_hash_t *vanessa_hash_create(size_t nobucket, 
+		                    void (*element_destroy) (void *e),
+		                    void *(*element_duplicate) (void *e),
+		                    int (*element_match) (void *e, void *key),
+		                    void (*element_display) (char *s, void *e),
+		                    size_t(*element_length) (void *e),
+		                    size_t (*element_hash) (void *e));
+
+
+/**********************************************************************
+ * vanessa_hash_destroy
+ * Destroy a hash and all the data contained in the hash
+ * pre: h: hash
+ * post: all elements of h are destroyed
+ **********************************************************************/
+
+void vanessa_hash_destroy(vanessa_hash_t *h);
+
+
+/**********************************************************************
+ * vanessa_hash_length
+ * Find the length of an ASCII representation of a dynamic array.
+ * Not including a terminating '\0'.
+ * pre: h: hash to find the length of
+ * post: If h is NULL or there are no elements in h then the 
+ *          length is 0
+ *       If element_length, as passed to vanessa_hash_create, 
+ *          is NULL, then 0 is returned. 
+ *       Else the cumulative lenth of the elemements as per the 
+ *          element_length, plus one character per element for a 
+ *          delimiter between elements.
+ *          The trailing '\0' is not counted.
+ *          It is up to the user to free this buffer.  
+ * return: Cumulative length of the elements.
+ *         0 if a is NULL or there are no elements in a or if
+ *            element_length passed to vanessa_hash_create is NULL.
+ **********************************************************************/
+
+
+size_t vanessa_hash_length(vanessa_hash_t *h) ;
+
+
+/**********************************************************************
+ * vanessa_hash_display
+ * Make an ASCII representation of the hash
+ * pre: h: hash to display
+ *      delimiter: character to place between elements of the hash
+ * post: If h is NULL or there are no elements in h then nothing is 
+ *         done
+ *       If element_display or element_length, as passed to
+ *          vanessa_hash_create, are NULL, then an empty string 
  *          ("") is returned.  
  *       Else a character buffer is allocated and an ASCII 
- *          representation of each list element, as determined by 
- *          element_display, separated by delimiter is placed in 
- *          the '\0' terminated buffer that is returned. 
+ *          representation of each hashed element, as determined by 
+ *          element_display, separated by delimiter is placed in the 
+ *          '\0' terminated buffer that is returned. 
  *          It is up to the user to free this buffer.  
  * return: Allocated buffer as above 
  *         NULL on error, 
- *         NULL l or empty l
+ *         NULL h or empty h
+ **********************************************************************/
+
+char *vanessa_hash_display(vanessa_hash_t *h, const char delimiter);
+
+
+/**********************************************************************
+ * vanessa_hash_get_element
+ * Get the number of elements stored in the hash
+ * pre: h: hash to count the elements of
+ * post: none
+ * return: Number of elements stored in the hash
+ *         0 if h is NULL or empty
+ **********************************************************************/
+
+size_t vanessa_hash_get_count(vanessa_hash_t *h) ;
+
+
+/**********************************************************************
+ * vanessa_hash_get_element
+ * Retrieve an element from the hash by value
+ * passed to vanessa_list_create
+ * pre: h: hash to search
+ *      value: value to match
+ * post: none
+ * return: element if found
+ *         NULL if h or value is NULL or if the element is in the hash
+ **********************************************************************/
+
+void *vanessa_hash_get_element(vanessa_hash_t *h, void *value);
+
+
+/**********************************************************************
+ * vanessa_hash_add_element
+ * Insert element into a hash
+ * pre: h: hash to insert value into
+ *      value: value to insert
+ * post: value is inserted into the hash
+ * return: NULL if h is NULL
+ *         h, unchanged if value is NULL
+ **********************************************************************/
+
+vanessa_hash_t *vanessa_hash_add_element(vanessa_hash_t *h, void *value);
+
+
+/**********************************************************************
+ * vanessa_hash_remove_element
+ * Insert element into a hash
+ * pre: h: hash to insert value into
+ *      value: value to insert
+ * post: value is removed from the hash
+ * return: NULL if h is NULL
+ *         h, unchanged if value is null
+ **********************************************************************/
+
+vanessa_hash_t *vanessa_hash_remove_element(vanessa_hash_t *h, void *value);
+
+
+/**********************************************************************
+ * vanessa_hash_duplicate
+ * Duplicate a hash
+ * pre: h: hash to duplicate
+ * post: hash is duplicated, in O(n). The elements of all the buckets
+ *       of the new hash are allocated from a single pool.
+ * return: NULL if h is NULL or on error
+ *         duplicated hash 
+ **********************************************************************/
+
+vanessa_hash_t *vanessa_hash_duplicate(vanessa_hash_t *h);
+
+
+/**********************************************************************
+ * vanessa_hash_iterate
+ * Run a fucntion over each element in the hash
+ * pre: h: hash run the function over
+ *      action: function to run
+ *              action should return < 0 if an error occurs,
+ *              which indicates that processing will be stopped
+ *      data: data passed to action
+ * post: action is run with the value of each element as its first argument
+ * return: 0 on success
+ *         < 0 if action returns < 0
+ **********************************************************************/
+
+int vanessa_hash_iterate(vanessa_hash_t *h, int(* action)(void *e, void *data),
+		                void *data);
+
+
+/**********************************************************************
+ * Hash whose elements expire after a time to live
+ *
+ * Elements are stored as per vanessa_hash and each has a timer in a
+ * vanessa_timer_wheel for its expiry time, so advancing the clock
+ * costs time proportional to the number of elements that expire.
+ *
+ * Time is measured in ticks of whatever granularity the caller
+ * chooses, for instance seconds as returned by time(2). Time is
+ * expected to be monotonic.
+ **********************************************************************/
+
+typedef struct vanessa_ttl_hash_t_struct vanessa_ttl_hash_t;
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_create
+ * Create a new, empty ttl hash
+ * pre: nobucket: number of buckets in the hash
+ *      element_destroy:   Pointer to a function to destroy an element
+ *                         May be NULL
+ *      element_duplicate: Pointer to a function to duplicate an element
+ *                         May be NULL in which case elements are
+ *                         inserted by reference
+ *      element_match:     Pointer to a function to match an element
+ *                         by a key.
+ *      element_hash:      Pointer to a function that return the hash
+ *                         bucket index, a number >= 0 && < nobucket,
+ *                         for an element.
+ *      now:               Current time, in ticks
+ * post: ttl hash structure is allocated and initialised
+ * return: pointer to ttl hash
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_ttl_hash_t *vanessa_ttl_hash_create(size_t nobucket,
+		void (*element_destroy) (void *e),
+		void *(*element_duplicate) (void *e),
+		int (*element_match) (void *e, void *key),
+		size_t (*element_hash) (void *e),
+		unsigned long now);
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_destroy
+ * Destroy a ttl hash and all the data contained in the hash
+ * pre: h: ttl hash
+ * post: all elements of h are destroyed
+ **********************************************************************/
+
+void vanessa_ttl_hash_destroy(vanessa_ttl_hash_t *h);
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_add_element
+ * Insert element into a ttl hash
+ * pre: h: ttl hash to insert value into
+ *      value: value to insert
+ *      now: current time, in ticks
+ *      ttl: number of ticks after now that the element expires
+ * post: value is inserted into the ttl hash
+ * return: NULL if h is NULL or on error
+ *         h, unchanged if value is NULL
+ **********************************************************************/
+
+vanessa_ttl_hash_t *vanessa_ttl_hash_add_element(vanessa_ttl_hash_t *h,
+		void *value, unsigned long now, unsigned long ttl);
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_get_element
+ * Retrieve an element from the ttl hash
+ * pre: h: ttl hash to search
+ *      key: key to match
+ *      now: current time, in ticks
+ * post: If the matching element has expired it is removed from the
+ *       hash and destroyed, regardless of whether
+ *       vanessa_ttl_hash_advance() has reached its expiry time.
+ * return: element if found
+ *         NULL if h or key is NULL, or if no unexpired element matches
+ **********************************************************************/
+
+void *vanessa_ttl_hash_get_element(vanessa_ttl_hash_t *h, void *key,
+		unsigned long now);
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_touch
+ * Change the time to live of an element
+ * pre: h: ttl hash to search
+ *      key: key to match
+ *      now: current time, in ticks
+ *      ttl: number of ticks after now that the element expires
+ * post: the expiry time of the element matching key is updated
+ *       If the element has already expired it is removed as per
+ *       vanessa_ttl_hash_get_element()
+ * return: element if found
+ *         NULL if h or key is NULL, or if no unexpired element matches
+ **********************************************************************/
+
+void *vanessa_ttl_hash_touch(vanessa_ttl_hash_t *h, void *key,
+		unsigned long now, unsigned long ttl);
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_remove_element
+ * Remove an element from a ttl hash
+ * pre: h: ttl hash to remove element from
+ *      key: key of element to remove
+ * post: matching element is removed from the hash and destroyed
+ * return: NULL if h is NULL
+ *         h otherwise
+ **********************************************************************/
+
+vanessa_ttl_hash_t *vanessa_ttl_hash_remove_element(vanessa_ttl_hash_t *h,
+		void *key);
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_advance
+ * Advance the clock of a ttl hash, expiring elements
+ * pre: h: ttl hash
+ *      now: current time, in ticks
+ * post: all elements whose expiry time is <= now are removed from
+ *       the hash and destroyed.
+ *       Only occupied slots of the wheel are visited, so the cost
+ *       is proportional to the number of elements expired.
+ * return: number of elements that were expired
+ **********************************************************************/
+
+size_t vanessa_ttl_hash_advance(vanessa_ttl_hash_t *h, unsigned long now);
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_get_count
+ * Get the number of elements stored in the ttl hash
+ * pre: h: ttl hash to count the elements of
+ * post: none
+ * return: Number of elements stored in the ttl hash, including
+ *         elements that have expired but not yet been removed
+ *         0 if h is NULL or empty
+ **********************************************************************/
+
+size_t vanessa_ttl_hash_get_count(vanessa_ttl_hash_t *h);
+
+
+/**********************************************************************
+ * vanessa_ttl_hash_iterate
+ * Run a function over each element in the ttl hash
+ * pre: h: ttl hash run the function over
+ *      action: function to run
+ *              action should return < 0 if an error occurs,
+ *              which indicates that processing will be stopped
+ *      data: data passed to action
+ * post: action is run with the value of each element as its first argument
+ * return: 0 on success
+ *         < 0 if action returns < 0
+ **********************************************************************/
+
+int vanessa_ttl_hash_iterate(vanessa_ttl_hash_t *h,
+		int (*action)(void *e, void *data), void *data);
+
+
+/**********************************************************************
+ * Hierarchical timer wheel
+ *
+ * Timers are scheduled to expire at a time, and a function is run for
+ * the element of each timer as the clock is advanced past it.
+ * Scheduling, rescheduling and cancelling a timer take constant time,
+ * and advancing the clock costs time proportional to the number of
+ * timers that expire, so very many timers may be outstanding at once.
+ *
+ * Time is measured in ticks, as for vanessa_ttl_hash.
+ **********************************************************************/
+
+typedef struct vanessa_timer_wheel_t_struct vanessa_timer_wheel_t;
+typedef struct vanessa_timer_wheel_timer_t_struct vanessa_timer_wheel_timer_t;
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_create
+ * Create a new timer wheel, with no timers
+ * pre: element_expire:  Pointer to a function to run when a timer
+ *                       expires. It is passed the element the timer
+ *                       was scheduled with and data. May be NULL.
+ *      data:            data passed to element_expire
+ *      element_destroy: Pointer to a function to destroy the element
+ *                       of a timer that has not expired when the
+ *                       wheel is destroyed. May be NULL.
+ *      now:             Current time, in ticks
+ * post: timer wheel is allocated and initialised
+ * return: pointer to timer wheel
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_timer_wheel_t *vanessa_timer_wheel_create(
+		void (*element_expire) (void *e, void *data), void *data,
+		void (*element_destroy) (void *e), unsigned long now);
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_destroy
+ * Destroy a timer wheel, and the elements of timers that have not
+ * expired
+ * pre: tw: timer wheel
+ * post: element_destroy is called for the element of each timer
+ *       that has not expired, and the wheel and its timers are freed
+ * return: none
+ **********************************************************************/
+
+void vanessa_timer_wheel_destroy(vanessa_timer_wheel_t *tw);
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_schedule
+ * Schedule a timer
+ * pre: tw: timer wheel
+ *      value: element to pass to element_expire when the timer expires
+ *      expire: time at which the timer expires, in ticks
+ *              If it has already passed the timer expires on the
+ *              next call to vanessa_timer_wheel_advance
+ * post: timer is added to the wheel, in constant time
+ * return: handle to the timer, which is valid until it expires or
+ *         is cancelled
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_timer_wheel_timer_t *vanessa_timer_wheel_schedule(
+		vanessa_timer_wheel_t *tw, void *value, unsigned long expire);
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_reschedule
+ * Change the expiry time of a timer
+ * pre: tw: timer wheel
+ *      t: handle of a timer that has not expired or been cancelled
+ *      expire: new time at which the timer expires, in ticks,
+ *              as for vanessa_timer_wheel_schedule
+ * post: timer is moved to the slot for its new expiry time,
+ *       in constant time
+ * return: none
+ **********************************************************************/
+
+void vanessa_timer_wheel_reschedule(vanessa_timer_wheel_t *tw,
+		vanessa_timer_wheel_timer_t *t, unsigned long expire);
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_cancel
+ * Cancel a timer
+ * pre: tw: timer wheel
+ *      t: handle of a timer that has not expired or been cancelled
+ * post: timer is removed from the wheel, in constant time, and its
+ *       handle is no longer valid
+ *       element_expire is not called and the element is not destroyed
+ * return: element the timer was scheduled with
+ **********************************************************************/
+
+void *vanessa_timer_wheel_cancel(vanessa_timer_wheel_t *tw,
+		vanessa_timer_wheel_timer_t *t);
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_next_event
+ * Find the next tick at which the wheel needs to be advanced
+ * pre: tw: timer wheel
+ *      next: set to the first tick, no earlier than the tick after
+ *            that last passed to vanessa_timer_wheel_advance, at
+ *            which either a timer expires or timers are due to be
+ *            cascaded. No timer expires before it.
+ * post: none
+ * return: 0 if the wheel has timers
+ *         -1 if there are no timers or tw is NULL
+ **********************************************************************/
+
+int vanessa_timer_wheel_next_event(const vanessa_timer_wheel_t *tw,
+		unsigned long *next);
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_advance
+ * Advance the clock of a timer wheel, expiring timers
+ * pre: tw: timer wheel
+ *      now: current time, in ticks
+ * post: each timer whose expiry time is <= now is removed from the
+ *       wheel and element_expire is called for its element, in order
+ *       of expiry time, and then of scheduling for timers that expire
+ *       at the same tick.
+ *       element_expire may schedule, reschedule and cancel timers,
+ *       but must not advance or destroy the wheel.
+ *       Only occupied slots of the wheel are visited, so the cost
+ *       is proportional to the number of timers expired and cascaded.
+ * return: number of timers that expired
+ **********************************************************************/
+
+size_t vanessa_timer_wheel_advance(vanessa_timer_wheel_t *tw,
+		unsigned long now);
+
+
+/**********************************************************************
+ * vanessa_timer_wheel_get_count
+ * Get the number of timers in a timer wheel
+ * pre: tw: timer wheel
+ * post: none
+ * return: number of timers that have neither expired nor been
+ *         cancelled
+ *         0 if tw is NULL
+ **********************************************************************/
+
+size_t vanessa_timer_wheel_get_count(const vanessa_timer_wheel_t *tw);
+
+
+/**********************************************************************
+ * Fixed capacity cache
+ *
+ * Uses ARC, Adaptive Replacement Cache, by default. ARC balances
+ * recency and frequency and resists being flushed by a scan of many
+ * elements that are each only used once. Plain LRU may be selected
+ * instead, for comparison. All operations are O(1) and no memory is
+ * allocated after the cache is created, other than by
+ * element_duplicate.
+ **********************************************************************/
+
+typedef struct vanessa_cache_t_struct vanessa_cache_t;
+
+#define VANESSA_CACHE_ARC 0x0
+#define VANESSA_CACHE_LRU 0x1
+
+
+/**********************************************************************
+ * vanessa_cache_create
+ * Create a new, empty cache
+ * pre: capacity: maximum number of elements held in the cache
+ *      policy: VANESSA_CACHE_ARC or VANESSA_CACHE_LRU
+ *      element_destroy:   Pointer to a function to destroy an element
+ *                         May be NULL
+ *      element_duplicate: Pointer to a function to duplicate an element
+ *                         May be NULL in which case elements are
+ *                         inserted by reference
+ *      element_match:     Pointer to a function to match an element
+ *                         by a key.
+ *      element_hash:      Pointer to a function that returns a hash
+ *                         of an element. Unlike vanessa_hash this is
+ *                         not a bucket index and should use the
+ *                         full range of size_t. Evicted elements are
+ *                         remembered by their hash alone.
+ * post: cache is allocated, including space for all the elements
+ *       and ghost entries it may hold.
+ * return: pointer to cache
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_cache_t *vanessa_cache_create(size_t capacity,
+		vanessa_adt_flag_t policy,
+		void (*element_destroy) (void *e),
+		void *(*element_duplicate) (void *e),
+		int (*element_match) (void *e, void *key),
+		size_t (*element_hash) (void *e));
+
+
+/**********************************************************************
+ * vanessa_cache_destroy
+ * Destroy a cache and all the elements it holds
+ * pre: c: cache
+ * post: all elements of c are destroyed
+ **********************************************************************/
+
+void vanessa_cache_destroy(vanessa_cache_t *c);
+
+
+/**********************************************************************
+ * vanessa_cache_get_element
+ * Retrieve an element from the cache
+ * pre: c: cache to search
+ *      key: key to match
+ * post: hit or miss is counted. On a hit the element is promoted
+ *       according to the replacement policy.
+ * return: element if found
+ *         NULL if c or key is NULL or if the element is not cached
  **********************************************************************/
 
-char *vanessa_list_display(vanessa_list_t * l, char delimiter);
+void *vanessa_cache_get_element(vanessa_cache_t *c, void *key);
 
 
 /**********************************************************************
- * vanessa_list_get_element
- * Find an element in the list by key using the element_match function
- * passed to vanessa_list_create
- * pre: l: list to search
- *      key: key to match
- * post: none
- * return: value it is found
- *         NULL if l or key is NULL or if value matching key is not found
+ * vanessa_cache_add_element
+ * Insert an element into the cache
+ * Typically called after vanessa_cache_get_element() misses
+ * pre: c: cache to insert value into
+ *      value: value to insert
+ * post: value is inserted into the cache, evicting and destroying
+ *       another element if the cache is full.
+ *       If an element matching value is already cached it is
+ *       destroyed and replaced by value.
+ * return: NULL if c is NULL or on error
+ *         c, unchanged if value is NULL
  **********************************************************************/
 
-void *vanessa_list_get_element(vanessa_list_t *l, void *key);
+vanessa_cache_t *vanessa_cache_add_element(vanessa_cache_t *c, void *value);
 
 
 /**********************************************************************
- * vanessa_list_get_count
- * Count the number of elements in the list
- * pre: l: list to count
- * post: none
- * return: number of elements in the list
- *         0 if l is NULL
+ * vanessa_cache_remove_element
+ * Remove an element from the cache
+ * pre: c: cache to remove element from
+ *      key: key of element to remove
+ * post: matching element is removed from the cache and destroyed
+ * return: NULL if c is NULL
+ *         c otherwise
  **********************************************************************/
 
-size_t vanessa_list_get_count(vanessa_list_t *l);
+vanessa_cache_t *vanessa_cache_remove_element(vanessa_cache_t *c, void *key);
 
 
 /**********************************************************************
- * vanessa_list_add_element
- * Insert element into a list
- * pre: l: list to insert value into
- *      value: value to insert
- * post: value is inserted into the list
- *       if element_sort passed to vanessa_list_create is non-NULL
- *       then the element will be inserted in order. Otherwise
- *       the element will be inserted at the begining of the list.
- * return: NULL if l is NULL
- *         l, unchanged if value is NULL
+ * vanessa_cache_get_count
+ * Get the number of elements held in the cache
+ * pre: c: cache
+ * return: number of elements in the cache, not including ghosts
+ *         0 if c is NULL
  **********************************************************************/
 
-vanessa_list_t *vanessa_list_add_element(vanessa_list_t * l, void *value);
+size_t vanessa_cache_get_count(vanessa_cache_t *c);
 
 
 /**********************************************************************
- * vanessa_list_remove_element
- * Insert element into a list
- * pre: l: list to insert value into
- *      value: value to insert
- * post: value is removed from the list
- * return: NULL if l is NULL
- *         l, unchanged if value is null
+ * vanessa_cache_get_hits
+ * Get the number of lookups that found an element
+ * pre: c: cache
+ * return: number of hits since the cache was created or the
+ *         counters were reset
+ *         0 if c is NULL
  **********************************************************************/
 
-void vanessa_list_remove_element(vanessa_list_t *l, void *key);
+unsigned long long vanessa_cache_get_hits(vanessa_cache_t *c);
 
 
 /**********************************************************************
- * vanessa_list_duplicate
- * Duplicate a list
- * pre: l: list to duplicate
- * post: list is duplicated
- * return: NULL if l is NULL or on error
- *         duplicated list 
+ * vanessa_cache_get_misses
+ * Get the number of lookups that did not find an element
+ * pre: c: cache
+ * return: number of misses since the cache was created or the
+ *         counters were reset
+ *         0 if c is NULL
  **********************************************************************/
 
-vanessa_list_t *vanessa_list_duplicate(vanessa_list_t *l);
+unsigned long long vanessa_cache_get_misses(vanessa_cache_t *c);
+
 
 /**********************************************************************
- * vanessa_list_iterate
- * Run a fucntion over each element in the list
- * pre: l: list run the function over
+ * vanessa_cache_reset_stats
+ * Reset the hit and miss counters of a cache
+ * pre: c: cache
+ * post: hit and miss counters are zero
+ * return: none
+ **********************************************************************/
+
+void vanessa_cache_reset_stats(vanessa_cache_t *c);
+
+
+/**********************************************************************
+ * vanessa_cache_iterate
+ * Run a function over each element in the cache
+ * pre: c: cache run the function over
  *      action: function to run
  *              action should return < 0 if an error occurs,
  *              which indicates that processing will be stopped
  *      data: data passed to action
- * post: action is run with the value of each element as its first argument
+ * post: action is run with the value of each element as its first
+ *       argument. Elements are not promoted.
  * return: 0 on success
  *         < 0 if action returns < 0
  **********************************************************************/
 
-int vanessa_list_iterate(vanessa_list_t *l, int(* action)(void *e, void *data),
-		void *data);
-
+int vanessa_cache_iterate(vanessa_cache_t *c,
+		int (*action)(void *e, void *data), void *data);
 
 
 /**********************************************************************
- * Hash to put your flims in.
- * 
- * The primitive type for the array is void *. Thus, providing your
- * own duplicate_primitive, destroy_primitive, match_primative,
- * display_primitive, length_primitive and hash_primitive, functions
- * will allow you to use the vanessa_hash API to have a
- * hash containing any primitive
+ * Fixed capacity LRU cache that may be shared between threads
  *
- * Includes macros, excluding hash_primitive,  required to create an
- * list of strings or integers.
+ * Elements are spread by hash over segments that are locked
+ * independently. Lookups only take their segment's lock for reading
+ * and buffer the resulting LRU promotion, which is later applied in
+ * a batch by a thread holding the lock for writing. So concurrent
+ * lookups of popular elements do not serialise on a single lock.
+ * The LRU order within each segment is approximate as buffered
+ * promotions may be dropped when a buffer is full.
  **********************************************************************/
 
-
-typedef struct vanessa_hash_t_struct vanessa_hash_t;
+typedef struct vanessa_shard_cache_t_struct vanessa_shard_cache_t;
 
 
 /**********************************************************************
- * vanessa_hash_create
- * Create a new, empty hash
- * pre: nobucket: number of buckets in the hash
+ * vanessa_shard_cache_create
+ * Create a new, empty sharded cache
+ * pre: capacity: maximum number of elements held in the cache
+ *                This is divided evenly between the segments
+ *      nosegment: number of independently locked segments
+ *                 Should be somewhat more than the number of threads
+ *                 that use the cache concurrently
  *      element_destroy:   Pointer to a function to destroy an element
- *                         Function should take an argument of a pointer
- *                         and free the memory allocated to the structure
- *                         pointed to.
+ *                         May be NULL
  *      element_duplicate: Pointer to a function to duplicate an element
- *                         Function should take a pointer to an element to
- *                         duplicate as the only element and return a copy
- *                         of the element Any memory allocation required
- *                         should be done by this function.
+ *                         Used when inserting and when retrieving
+ *                         elements. May be NULL in which case elements
+ *                         are inserted and retrieved by reference.
  *      element_match:     Pointer to a function to match an element
  *                         by a key.
- *      element_display:   Pointer to a function to display an element
- *                         Function should take a pointer to char and a
- *                         pointer to an element as arguments. An ASCII
- *                         representation of the element should be placed
- *                         in the character buffer given as the first
- *                         argument.  May be NULL in which case
- *                         vanessa_dynamic_array_display will return an empty
- *                         string ("\0");
- *      element_length:    Pointer to a function to find the length of an
- *                         ASCII representation of the element not
- *                         including the trailing '\0'. Used to guard
- *                         against buffer over runs when using
- *                         element_display. May be NULL, in which case
- *                         vanessa_dynamic_array_display will return an
- *                         empty string ("");
- *      element_hash:      Pointer to a function that return the hash
- *                         bucket index, a number >= 0 && < nobucket,
- *                         for an element.
- *
- * post: hash structure is alocated, and values initialised to NULL
- *       note that the hash buckets are linked lists and are created
- *       on demand.
- * return: pointer to hash
+ *      element_hash:      Pointer to a function that returns a hash
+ *                         of an element. Should use the full range
+ *                         of size_t.
+ * post: cache is allocated and initialised
+ * return: pointer to cache
  *         NULL on error
  **********************************************************************/
 
-vanessa_hash_t *vanessa_hash_create(size_t nobucket, 
-		                    void (*element_destroy) (void *e),
-		                    void *(*element_duplicate) (void *e),
-		                    int (*element_match) (void *e, void *key),
-		                    void (*element_display) (char *s, void *e),
-		                    size_t(*element_length) (void *e),
-		                    size_t (*element_hash) (void *e));
+vanessa_shard_cache_t *vanessa_shard_cache_create(size_t capacity,
+		size_t nosegment,
+		void (*element_destroy) (void *e),
+		void *(*element_duplicate) (void *e),
+		int (*element_match) (void *e, void *key),
+		size_t (*element_hash) (void *e));
 
 
 /**********************************************************************
- * vanessa_hash_destroy
- * Destroy a hash and all the data contained in the hash
- * pre: h: hash
- * post: all elements of h are destroyed
+ * vanessa_shard_cache_destroy
+ * Destroy a sharded cache and all the elements it holds
+ * pre: c: cache, no other thread may be using it
+ * post: all elements of c are destroyed
  **********************************************************************/
 
-void vanessa_hash_destroy(vanessa_hash_t *h);
+void vanessa_shard_cache_destroy(vanessa_shard_cache_t *c);
 
 
 /**********************************************************************
- * vanessa_hash_length
- * Find the length of an ASCII representation of a dynamic array.
- * Not including a terminating '\0'.
- * pre: h: hash to find the length of
- * post: If h is NULL or there are no elements in h then the 
- *          length is 0
- *       If element_length, as passed to vanessa_hash_create, 
- *          is NULL, then 0 is returned. 
- *       Else the cumulative lenth of the elemements as per the 
- *          element_length, plus one character per element for a 
- *          delimiter between elements.
- *          The trailing '\0' is not counted.
- *          It is up to the user to free this buffer.  
- * return: Cumulative length of the elements.
- *         0 if a is NULL or there are no elements in a or if
- *            element_length passed to vanessa_hash_create is NULL.
+ * vanessa_shard_cache_get_element
+ * Retrieve an element from the cache
+ * pre: c: cache to search
+ *      key: key to match
+ * post: hit or miss is counted and on a hit a promotion of the
+ *       element is buffered
+ * return: If element_duplicate passed to vanessa_shard_cache_create
+ *         is non-NULL, a duplicate of the element which the caller
+ *         must destroy. Otherwise the element itself, in which case
+ *         the caller must ensure that it is not evicted or removed by
+ *         another thread while it is in use.
+ *         NULL if c or key is NULL, if the element is not cached,
+ *         or on error.
  **********************************************************************/
 
+void *vanessa_shard_cache_get_element(vanessa_shard_cache_t *c, void *key);
 
-size_t vanessa_hash_length(vanessa_hash_t *h) ;
+
+/**********************************************************************
+ * vanessa_shard_cache_add_element
+ * Insert an element into the cache
+ * pre: c: cache to insert value into
+ *      value: value to insert
+ * post: value is inserted into the cache, evicting and destroying
+ *       the least recently used element of its segment if the
+ *       segment is full. If an element matching value is already
+ *       cached it is destroyed and replaced by value.
+ * return: NULL if c is NULL or on error
+ *         c, unchanged if value is NULL
+ **********************************************************************/
+
+vanessa_shard_cache_t *vanessa_shard_cache_add_element(
+		vanessa_shard_cache_t *c, void *value);
 
 
 /**********************************************************************
- * vanessa_hash_display
- * Make an ASCII representation of the hash
- * pre: h: hash to display
- *      delimiter: character to place between elements of the hash
- * post: If h is NULL or there are no elements in h then nothing is 
- *         done
- *       If element_display or element_length, as passed to
- *          vanessa_hash_create, are NULL, then an empty string 
- *          ("") is returned.  
- *       Else a character buffer is allocated and an ASCII 
- *          representation of each hashed element, as determined by 
- *          element_display, separated by delimiter is placed in the 
- *          '\0' terminated buffer that is returned. 
- *          It is up to the user to free this buffer.  
- * return: Allocated buffer as above 
- *         NULL on error, 
- *         NULL h or empty h
+ * vanessa_shard_cache_remove_element
+ * Remove an element from the cache
+ * pre: c: cache to remove element from
+ *      key: key of element to remove
+ * post: matching element is removed from the cache and destroyed
+ * return: NULL if c is NULL
+ *         c otherwise
  **********************************************************************/
 
-char *vanessa_hash_display(vanessa_hash_t *h, const char delimiter);
+vanessa_shard_cache_t *vanessa_shard_cache_remove_element(
+		vanessa_shard_cache_t *c, void *key);
 
 
 /**********************************************************************
- * vanessa_hash_get_element
- * Get the number of elements stored in the hash
- * pre: h: hash to count the elements of
- * post: none
- * return: Number of elements stored in the hash
- *         0 if h is NULL or empty
+ * vanessa_shard_cache_get_count
+ * Get the number of elements held in the cache
+ * pre: c: cache
+ * return: number of elements in the cache. This is only a snapshot
+ *         if other threads are modifying the cache.
+ *         0 if c is NULL
  **********************************************************************/
 
-size_t vanessa_hash_get_count(vanessa_hash_t *h) ;
+size_t vanessa_shard_cache_get_count(vanessa_shard_cache_t *c);
 
 
 /**********************************************************************
- * vanessa_hash_get_element
- * Retrieve an element from the hash by value
- * passed to vanessa_list_create
- * pre: h: hash to search
- *      value: value to match
- * post: none
- * return: element if found
- *         NULL if h or value is NULL or if the element is in the hash
+ * vanessa_shard_cache_get_hits
+ * Get the number of lookups that found an element
+ * pre: c: cache
+ * return: number of hits since the cache was created
+ *         0 if c is NULL
  **********************************************************************/
 
-void *vanessa_hash_get_element(vanessa_hash_t *h, void *value);
+unsigned long long vanessa_shard_cache_get_hits(vanessa_shard_cache_t *c);
 
 
 /**********************************************************************
- * vanessa_hash_add_element
- * Insert element into a hash
- * pre: h: hash to insert value into
- *      value: value to insert
- * post: value is inserted into the hash
- * return: NULL if h is NULL
- *         h, unchanged if value is NULL
+ * vanessa_shard_cache_get_misses
+ * Get the number of lookups that did not find an element
+ * pre: c: cache
+ * return: number of misses since the cache was created
+ *         0 if c is NULL
  **********************************************************************/
 
-vanessa_hash_t *vanessa_hash_add_element(vanessa_hash_t *h, void *value);
+unsigned long long vanessa_shard_cache_get_misses(vanessa_shard_cache_t *c);
 
 
 /**********************************************************************
- * vanessa_hash_remove_element
- * Insert element into a hash
- * pre: h: hash to insert value into
- *      value: value to insert
- * post: value is removed from the hash
- * return: NULL if h is NULL
- *         h, unchanged if value is null
+ * Consistent hash ring
+ *
+ * Maps keys to members, such as backend servers, so that adding or
+ * removing a member only remaps about 1/N of the keys. Each member
+ * is placed at a number of points on the ring proportional to its
+ * weight. Lookups are O(1) on average, using a jump table into the
+ * sorted array of points. Adding and removing members is O(n) in
+ * the number of points.
+ *
+ * Jump consistent hashing and rendezvous hashing are also provided.
+ * They need no ring, only the number of buckets or an array of
+ * member hashes, at the cost of only allowing the last bucket to be
+ * removed or of O(n) lookups respectively.
+ **********************************************************************/
+
+typedef struct vanessa_chash_t_struct vanessa_chash_t;
+
+
+/**********************************************************************
+ * vanessa_chash_create
+ * Create a new, empty consistent hash ring
+ * pre: nopoint: number of points on the ring per unit of weight
+ *               of a member. 100 to 200 gives a reasonably even
+ *               distribution of keys.
+ *      element_destroy:   Pointer to a function to destroy a member
+ *                         May be NULL
+ *      element_duplicate: Pointer to a function to duplicate a member
+ *                         May be NULL in which case members are
+ *                         inserted by reference
+ *      element_match:     Pointer to a function to match a member
+ *                         by a key
+ *      element_hash:      Pointer to a function that returns a hash
+ *                         of a member. The hash determines where the
+ *                         member is placed on the ring so it should
+ *                         be the same each time the member is added.
+ * post: ring is allocated and initialised
+ * return: pointer to ring
+ *         NULL on error
  **********************************************************************/
 
-vanessa_hash_t *vanessa_hash_remove_element(vanessa_hash_t *h, void *value);
+vanessa_chash_t *vanessa_chash_create(unsigned int nopoint,
+		void (*element_destroy) (void *e),
+		void *(*element_duplicate) (void *e),
+		int (*element_match) (void *e, void *key),
+		size_t (*element_hash) (void *e));
 
 
 /**********************************************************************
- * vanessa_hash_duplicate
- * Duplicate a hash
- * pre: h: hash to duplicate
- * post: hash is duplicated
- * return: NULL if h is NULL or on error
- *         duplicated hash 
+ * vanessa_chash_destroy
+ * Destroy a consistent hash ring and all of its members
+ * pre: c: ring to destroy
+ * post: c and its members are destroyed
+ * return: none
  **********************************************************************/
 
-vanessa_hash_t *vanessa_hash_duplicate(vanessa_hash_t *h);
+void vanessa_chash_destroy(vanessa_chash_t *c);
 
 
 /**********************************************************************
- * vanessa_hash_iterate
- * Run a fucntion over each element in the hash
- * pre: h: hash run the function over
+ * vanessa_chash_add_element
+ * Add a member to a consistent hash ring
+ * pre: c: ring to add member to
+ *      value: member to add
+ *      weight: relative weight of the member, must be at least 1.
+ *              The member is placed at weight times the number of
+ *              points per unit of weight given to
+ *              vanessa_chash_create.
+ * post: value is added to the ring. If a member matching value
+ *       is already present it is destroyed and replaced, allowing
+ *       the weight of a member to be changed.
+ *       O(n) where n is the number of points on the ring.
+ * return: c on success
+ *         NULL on error, c is unchanged other than that a member
+ *         matching value may have been removed
+ **********************************************************************/
+
+vanessa_chash_t *vanessa_chash_add_element(vanessa_chash_t *c, void *value,
+		unsigned int weight);
+
+
+/**********************************************************************
+ * vanessa_chash_remove_element
+ * Remove a member from a consistent hash ring
+ * pre: c: ring to remove member from
+ *      key: key to match the member
+ * post: matching member is removed from the ring and destroyed.
+ *       O(n) where n is the number of points on the ring.
+ * return: c, including if there is no matching member
+ *         NULL if c is NULL
+ **********************************************************************/
+
+vanessa_chash_t *vanessa_chash_remove_element(vanessa_chash_t *c, void *key);
+
+
+/**********************************************************************
+ * vanessa_chash_get_element
+ * Find the member of a consistent hash ring that a key maps to
+ * pre: c: ring to search
+ *      hash: hash of the key. Should use the full range of size_t,
+ *            vanessa_chash_hash_str may be used for strings.
+ * post: none
+ * return: member that the key maps to
+ *         NULL if c is NULL or has no members
+ **********************************************************************/
+
+void *vanessa_chash_get_element(vanessa_chash_t *c, size_t hash);
+
+
+/**********************************************************************
+ * vanessa_chash_get_count
+ * Get the number of members of a consistent hash ring
+ * pre: c: ring
+ * return: number of members
+ *         0 if c is NULL
+ **********************************************************************/
+
+size_t vanessa_chash_get_count(vanessa_chash_t *c);
+
+
+/**********************************************************************
+ * vanessa_chash_iterate
+ * Run a function over each member of a consistent hash ring
+ * pre: c: ring run the function over
  *      action: function to run
  *              action should return < 0 if an error occurs,
  *              which indicates that processing will be stopped
  *      data: data passed to action
- * post: action is run with the value of each element as its first argument
+ * post: action is run with the value of each member as its first
+ *       argument, in no particular order
  * return: 0 on success
  *         < 0 if action returns < 0
  **********************************************************************/
 
-int vanessa_hash_iterate(vanessa_hash_t *h, int(* action)(void *e, void *data),
-		                void *data);
+int vanessa_chash_iterate(vanessa_chash_t *c,
+		int (*action)(void *e, void *data), void *data);
+
+
+/**********************************************************************
+ * vanessa_chash_hash_str
+ * Hash a string, FNV-1a
+ * Suitable for use as the hash of a key or as element_hash
+ * pre: str: string to hash
+ * return: hash of str
+ **********************************************************************/
+
+size_t vanessa_chash_hash_str(const char *str);
+
+
+/**********************************************************************
+ * vanessa_chash_get_element_n
+ * Find the members of a consistent hash ring that an array of keys
+ * map to
+ * pre: c: ring to search
+ *      hash: hashes of the keys
+ *      value: array to store the members in
+ *      n: number of keys
+ * post: value[i] is vanessa_chash_get_element(c, hash[i])
+ * return: none
+ **********************************************************************/
+
+void vanessa_chash_get_element_n(vanessa_chash_t *c, const size_t *hash,
+		void **value, size_t n);
+
+
+/**********************************************************************
+ * vanessa_chash_jump
+ * Jump consistent hash, Lamping and Veach
+ * Maps a key to one of nobucket buckets, without any state, such
+ * that when nobucket grows by one only about 1/nobucket of keys move,
+ * all of them to the new bucket. Buckets are numbered, so only the
+ * last bucket may be removed.
+ * pre: hash: hash of the key
+ *      nobucket: number of buckets, must be at least 1
+ * post: none
+ * return: bucket, between 0 and nobucket - 1
+ *         -1 if nobucket is less than 1
+ **********************************************************************/
+
+int vanessa_chash_jump(size_t hash, int nobucket);
+
+
+/**********************************************************************
+ * vanessa_chash_jump_n
+ * Jump consistent hash of an array of keys
+ * pre: hash: hashes of the keys
+ *      bucket: array to store the buckets in
+ *      n: number of keys
+ *      nobucket: number of buckets, must be at least 1
+ * post: bucket[i] is vanessa_chash_jump(hash[i], nobucket)
+ * return: none
+ **********************************************************************/
+
+void vanessa_chash_jump_n(const size_t *hash, int *bucket, size_t n,
+		int nobucket);
+
+
+/**********************************************************************
+ * vanessa_chash_hrw
+ * Weighted rendezvous, highest random weight, hashing
+ * Maps a key to the member that scores highest for it. Removing a
+ * member only moves the keys that mapped to it and adding one only
+ * moves keys to it. Unlike vanessa_chash_jump any member may be
+ * removed, but a lookup is O(n) in the number of members.
+ * pre: hash: hash of the key
+ *      member_hash: hashes of the members, e.g. of their names
+ *      weight: relative weights of the members, each > 0
+ *              May be NULL in which case members are weighted equally
+ *      nomember: number of members
+ * post: none
+ * return: index of the member
+ *         -1 if nomember is less than 1
+ **********************************************************************/
+
+int vanessa_chash_hrw(size_t hash, const size_t *member_hash,
+		const double *weight, int nomember);
+
+
+/**********************************************************************
+ * vanessa_chash_hrw_n
+ * Weighted rendezvous hashing of an array of keys
+ * pre: hash: hashes of the keys
+ *      member: array to store the indexes of the members in
+ *      n: number of keys
+ *      member_hash: hashes of the members
+ *      weight: relative weights of the members, or NULL
+ *      nomember: number of members
+ * post: member[i] is vanessa_chash_hrw(hash[i], member_hash, weight,
+ *       nomember)
+ * return: none
+ **********************************************************************/
+
+void vanessa_chash_hrw_n(const size_t *hash, int *member, size_t n,
+		const size_t *member_hash, const double *weight, int nomember);
 
 
 /**********************************************************************
@@ -0,0 +1,336 @@
+/**********************************************************************
+ * ws_deque.c                                              October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * Work stealing deque
+ *
+ * The deque of Chase and Lev, "Dynamic Circular Work-Stealing Deque",
+ * SPAA 2005, with the memory ordering of Le, Pop, Cohen and Zappa
+ * Nardelli, "Correct and Efficient Work-Stealing for Weak Memory
+ * Models", PPoPP 2013. The owner pushes and pops at the bottom
+ * without atomic read-modify-write operations except when taking the
+ * last element, which it may race a thief for. Thieves take from the
+ * top with compare and swap.
+ *
+ * When the array is full the owner replaces it with one twice the
+ * size. Thieves may still be reading the old array so it is kept
+ * until the deque is destroyed. As each array is twice the size of
+ * the last, together they use less memory than the current one.
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include "vanessa_adt.h"
+
+#define CACHE_LINE 64
+
+/* Number of slots of the first array */
+#define WS_DEQUE_MINSLOT 64
+
+typedef struct vanessa_ws_deque_array_t_struct vanessa_ws_deque_array_t;
+
+struct vanessa_ws_deque_array_t_struct {
+	size_t mask;
+	vanessa_ws_deque_array_t *prev;
+	void *slot[1];
+};
+
+struct vanessa_ws_deque_t_struct {
+	vanessa_ws_deque_array_t *array;
+	void (*e_destroy) (const void *);
+	char pad0[CACHE_LINE];
+	/* Taken from by thieves */
+	ssize_t top;
+	char pad1[CACHE_LINE];
+	/* Pushed onto and popped from by the owner */
+	ssize_t bottom;
+	char pad2[CACHE_LINE];
+};
+
+#define WS_DEQUE_LOAD(a, i) \
+	__atomic_load_n(&(a)->slot[(i) & (a)->mask], __ATOMIC_RELAXED)
+#define WS_DEQUE_STORE(a, i, v) \
+	__atomic_store_n(&(a)->slot[(i) & (a)->mask], (v), __ATOMIC_RELAXED)
+
+
+static vanessa_ws_deque_array_t *__vanessa_ws_deque_array_create(
+		size_t noslot, vanessa_ws_deque_array_t *prev)
+{
+	vanessa_ws_deque_array_t *a;
+
+	a = (vanessa_ws_deque_array_t *)malloc(
+			sizeof(vanessa_ws_deque_array_t) +
+			(noslot - 1) * sizeof(void *));
+	if(a == NULL) {
+		VANESSA_LOGGER_DEBUG_ERRNO("malloc");
+		return(NULL);
+	}
+
+	a->mask = noslot - 1;
+	a->prev = prev;
+
+	return(a);
+}
+
+
+/**********************************************************************
+ * vanessa_ws_deque_create
+ * Create a new, empty work stealing deque
+ * pre: e_destroy: pointer to a function to destroy elements of the
+ *                 deque, as for vanessa_queue_create. It is passed a
+ *                 pointer to the element. If NULL, then elements will
+ *                 not be freed on calls to vanessa_ws_deque_destroy
+ * post: memory is allocated for deque and values are initialised
+ *       One thread, the owner, may push and pop elements, while any
+ *       number of other threads steal them, without locking.
+ * return: new, empty deque
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_ws_deque_t *vanessa_ws_deque_create(void (*e_destroy) (const void *))
+{
+	vanessa_ws_deque_t *d;
+	void *mem;
+
+	if(posix_memalign(&mem, CACHE_LINE,
+				sizeof(vanessa_ws_deque_t)) != 0) {
+		VANESSA_LOGGER_DEBUG("posix_memalign");
+		return(NULL);
+	}
+	d = (vanessa_ws_deque_t *)mem;
+
+	d->array = __vanessa_ws_deque_array_create(WS_DEQUE_MINSLOT, NULL);
+	if(d->array == NULL) {
+		free(d);
+		return(NULL);
+	}
+
+	d->e_destroy = e_destroy;
+	d->top = 0;
+	d->bottom = 0;
+
+	return(d);
+}
+
+
+/**********************************************************************
+ * vanessa_ws_deque_destroy
+ * Destroy a work stealing deque, destroying each element present in
+ * the deque first
+ * pre: d: deque to destroy, which no thread is using
+ * post: deque and all elements in the deque are destroyed
+ * return: none
+ **********************************************************************/
+
+void vanessa_ws_deque_destroy(vanessa_ws_deque_t *d)
+{
+	vanessa_ws_deque_array_t *a;
+	void *value;
+	ssize_t i;
+
+	if(d == NULL) {
+		return;
+	}
+
+	for(i = d->top; d->e_destroy != NULL && i < d->bottom; i++) {
+		value = d->array->slot[i & d->array->mask];
+		if(value != NULL) {
+			d->e_destroy(&value);
+		}
+	}
+
+	while(d->array != NULL) {
+		a = d->array;
+		d->array = a->prev;
+		free(a);
+	}
+	free(d);
+}
+
+
+/**********************************************************************
+ * vanessa_ws_deque_push
+ * Push an element onto the bottom of a work stealing deque.
+ * May only be called by the owner.
+ * pre: d: deque
+ *      value: element to push
+ * post: element is added to the deque. If it is full, the array of
+ *       elements is doubled in size.
+ * return: d
+ *         NULL on error
+ **********************************************************************/
+
+vanessa_ws_deque_t *vanessa_ws_deque_push(vanessa_ws_deque_t *d,
+		void *value)
+{
+	vanessa_ws_deque_array_t *a;
+	vanessa_ws_deque_array_t *new;
+	ssize_t bottom;
+	ssize_t top;
+	ssize_t i;
+
+	bottom = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED);
+	top = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+	a = __atomic_load_n(&d->array, __ATOMIC_RELAXED);
+
+	if((size_t)(bottom - top) > a->mask) {
+		new = __vanessa_ws_deque_array_create((a->mask + 1) * 2, a);
+		if(new == NULL) {
+			return(NULL);
+		}
+		for(i = top; i < bottom; i++) {
+			WS_DEQUE_STORE(new, i, WS_DEQUE_LOAD(a, i));
+		}
+		__atomic_store_n(&d->array, new, __ATOMIC_RELEASE);
+		a = new;
+	}
+
+	WS_DEQUE_STORE(a, bottom, value);
+	__atomic_store_n(&d->bottom, bottom + 1, __ATOMIC_RELEASE);
+
+	return(d);
+}
+
+
+/**********************************************************************
+ * vanessa_ws_deque_pop
+ * Pop the element most recently pushed onto a work stealing deque.
+ * May only be called by the owner.
+ * pre: d: deque
+ *      value: element removed from the deque is assigned to *value.
+ *             *value is left unchanged if no element is removed.
+ * post: element at the bottom of the deque is removed, unless a
+ *       thief took it first
+ * return: d
+ *         NULL if the deque is empty
+ **********************************************************************/
+
+vanessa_ws_deque_t *vanessa_ws_deque_pop(vanessa_ws_deque_t *d,
+		void **value)
+{
+	vanessa_ws_deque_array_t *a;
+	ssize_t bottom;
+	ssize_t top;
+	void *v;
+	int won;
+
+	bottom = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+	a = __atomic_load_n(&d->array, __ATOMIC_RELAXED);
+	__atomic_store_n(&d->bottom, bottom, __ATOMIC_RELAXED);
+	/* Thieves must see bottom reduced before we read top */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	top = __atomic_load_n(&d->top, __ATOMIC_RELAXED);
+
+	if(top > bottom) {
+		/* Empty */
+		__atomic_store_n(&d->bottom, bottom + 1, __ATOMIC_RELAXED);
+		return(NULL);
+	}
+
+	v = WS_DEQUE_LOAD(a, bottom);
+	if(top < bottom) {
+		*value = v;
+		return(d);
+	}
+
+	/*
+	 * Last element, which a thief may be taking too. Either way
+	 * the deque is now empty.
+	 */
+	won = __atomic_compare_exchange_n(&d->top, &top, top + 1, 0,
+			__ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+	__atomic_store_n(&d->bottom, bottom + 1, __ATOMIC_RELAXED);
+	if(!won) {
+		return(NULL);
+	}
+
+	*value = v;
+	return(d);
+}
+
+
+/**********************************************************************
+ * vanessa_ws_deque_steal
+ * Take the element least recently pushed onto a work stealing deque.
+ * May be called by any thread.
+ * pre: d: deque
+ *      value: element removed from the deque is assigned to *value.
+ *             *value is left unchanged if no element is removed.
+ * post: element at the top of the deque is removed, unless another
+ *       thread took it first
+ * return: 1 if an element was taken
+ *         0 if the deque is empty
+ *         -1 if another thread took the element first, in which case
+ *         the deque may still have elements and the caller may retry
+ **********************************************************************/
+
+int vanessa_ws_deque_steal(vanessa_ws_deque_t *d, void **value)
+{
+	vanessa_ws_deque_array_t *a;
+	ssize_t bottom;
+	ssize_t top;
+	void *v;
+
+	top = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+	/* Pairs with the fence in vanessa_ws_deque_pop */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	bottom = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+
+	if(top >= bottom) {
+		return(0);
+	}
+
+	a = __atomic_load_n(&d->array, __ATOMIC_ACQUIRE);
+	v = WS_DEQUE_LOAD(a, top);
+	if(!__atomic_compare_exchange_n(&d->top, &top, top + 1, 0,
+				__ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+		return(-1);
+	}
+
+	*value = v;
+	return(1);
+}
+
+
+/**********************************************************************
+ * vanessa_ws_deque_length
+ * Return the number of elements in a work stealing deque
+ * pre: d: deque
+ * post: none
+ * return: number of elements in the deque, which may be out of date
+ *         by the time it is returned if the deque is in use
+ *         -1 if d is NULL
+ **********************************************************************/
+
+ssize_t vanessa_ws_deque_length(const vanessa_ws_deque_t *d)
+{
+	ssize_t top;
+	ssize_t bottom;
+
+	if(d == NULL) {
+		return(-1);
+	}
+
+	top = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+	bottom = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+
+	return(bottom > top ? bottom - top : 0);
+}
@@ -0,0 +1,276 @@
+/**********************************************************************
+ * blocking_queue_test.c                                   October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <pthread.h>
+#include <poll.h>
+#include <time.h>
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOTHREAD 3
+#define NOELEMENT 100000
+#define BATCH 4
+
+static vanessa_blocking_queue_t *bq;
+static unsigned char seen[NOELEMENT];
+
+static void destroy_function(const void *e) {
+	free(*(void **)e);
+}
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+#ifdef __GLIBC__
+/*
+ * Fail allocations of fail_size bytes, so that a queue may be made
+ * unable to grow
+ */
+extern void *__libc_malloc(size_t size);
+static size_t fail_size;
+
+void *malloc(size_t size) {
+	if(fail_size != 0 && size == fail_size) {
+		errno = ENOMEM;
+		return(NULL);
+	}
+	return(__libc_malloc(size));
+}
+#endif
+
+static int readable(int fd) {
+	struct pollfd pfd;
+
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	return(poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN));
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return(ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+/* Pop values, waiting for them, until the queue is closed and empty */
+static void *consumer(void *data) {
+	void *value[BATCH];
+	ssize_t n;
+	ssize_t i;
+	size_t v;
+
+	while((n = vanessa_blocking_queue_pop_n(bq, value, BATCH, -1)) >= 0) {
+		if(n == 0) {
+			die("vanessa_blocking_queue_pop_n");
+		}
+		for(i = 0; i < n; i++) {
+			v = (size_t)value[i];
+			if(v >= NOELEMENT || seen[v]++) {
+				die("vanessa_blocking_queue_pop_n");
+			}
+		}
+	}
+
+	return(data);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	pthread_t thread[NOTHREAD];
+	void *value[BATCH];
+	double t;
+	int fd;
+	size_t i;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "blocking_queue_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	bq = vanessa_blocking_queue_create(destroy_function,
+			VANESSA_BLOCKING_QUEUE_EVENTFD);
+	if(bq == NULL) {
+		die("vanessa_blocking_queue_create");
+	}
+	fd = vanessa_blocking_queue_fd(bq);
+	if(fd < 0 || readable(fd)) {
+		die("vanessa_blocking_queue_fd");
+	}
+
+	/*
+	 * Popping an empty queue times out
+	 */
+	if(vanessa_blocking_queue_pop(bq, value, 0) != NULL ||
+			errno != ETIMEDOUT) {
+		die("vanessa_blocking_queue_pop");
+	}
+	t = now();
+	if(vanessa_blocking_queue_pop_n(bq, value, BATCH, 50) != 0 ||
+			now() - t < 0.045) {
+		die("vanessa_blocking_queue_pop_n");
+	}
+
+	/*
+	 * The eventfd is readable while there are elements to pop
+	 */
+	for(i = 0; i < 3; i++) {
+		value[i] = malloc(16);
+		if(value[i] == NULL ||
+				vanessa_blocking_queue_push(bq, value[i]) == NULL) {
+			die("vanessa_blocking_queue_push");
+		}
+		if(!readable(fd)) {
+			die("vanessa_blocking_queue_fd");
+		}
+	}
+	if(vanessa_blocking_queue_pop_n(bq, value, 2, 0) != 2 ||
+			!readable(fd)) {
+		die("vanessa_blocking_queue_pop_n");
+	}
+	free(value[0]);
+	free(value[1]);
+	if(vanessa_blocking_queue_pop_n(bq, value, BATCH, -1) != 1 ||
+			readable(fd)) {
+		die("vanessa_blocking_queue_pop_n");
+	}
+	free(value[0]);
+
+	/*
+	 * Closing wakes the consumers once the queue is drained
+	 */
+	for(i = 0; i < NOTHREAD; i++) {
+		if(pthread_create(thread + i, NULL, consumer, NULL) != 0) {
+			die("pthread_create");
+		}
+	}
+	for(i = 0; i < NOELEMENT; i++) {
+		if(vanessa_blocking_queue_push(bq, (void *)i) == NULL) {
+			die("vanessa_blocking_queue_push");
+		}
+	}
+	vanessa_blocking_queue_close(bq);
+	for(i = 0; i < NOTHREAD; i++) {
+		pthread_join(thread[i], NULL);
+	}
+	for(i = 0; i < NOELEMENT; i++) {
+		if(seen[i] != 1) {
+			die("vanessa_blocking_queue_pop_n");
+		}
+	}
+
+	/*
+	 * A closed queue refuses elements, and stays readable
+	 */
+	if(vanessa_blocking_queue_push(bq, value) != NULL ||
+			errno != EPIPE) {
+		die("vanessa_blocking_queue_push");
+	}
+	if(vanessa_blocking_queue_pop(bq, value, -1) != NULL ||
+			errno != EPIPE || !readable(fd)) {
+		die("vanessa_blocking_queue_pop");
+	}
+	printf("%d %ld\n", NOELEMENT,
+			(long)vanessa_blocking_queue_length(bq));
+	vanessa_blocking_queue_destroy(bq);
+
+#ifdef __GLIBC__
+	/*
+	 * A queue that cannot grow refuses an element, and keeps those
+	 * it has. vanessa_queue starts with 16 slots and doubles them.
+	 */
+	bq = vanessa_blocking_queue_create(NULL, 0);
+	if(bq == NULL) {
+		die("vanessa_blocking_queue_create");
+	}
+	for(i = 0; i < 16; i++) {
+		if(vanessa_blocking_queue_push(bq, (void *)i) == NULL) {
+			die("vanessa_blocking_queue_push");
+		}
+	}
+	fail_size = 32 * sizeof(void *);
+	if(vanessa_blocking_queue_push(bq, (void *)i) != NULL) {
+		die("vanessa_blocking_queue_push");
+	}
+	fail_size = 0;
+	if(vanessa_blocking_queue_length(bq) != 16 ||
+			vanessa_blocking_queue_push(bq, (void *)i) == NULL) {
+		die("vanessa_blocking_queue_push");
+	}
+	for(i = 0; i <= 16; i++) {
+		if(vanessa_blocking_queue_pop(bq, &value[0], 0) == NULL ||
+				value[0] != (void *)i) {
+			die("vanessa_blocking_queue_pop");
+		}
+	}
+	vanessa_blocking_queue_destroy(bq);
+#endif
+
+	/*
+	 * Elements left in the queue are destroyed with it
+	 */
+	bq = vanessa_blocking_queue_create(destroy_function, 0);
+	if(bq == NULL || vanessa_blocking_queue_fd(bq) != -1) {
+		die("vanessa_blocking_queue_create");
+	}
+	for(i = 0; i < 3; i++) {
+		if(vanessa_blocking_queue_push(bq, malloc(16)) == NULL) {
+			die("vanessa_blocking_queue_push");
+		}
+	}
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_blocking_queue_destroy(bq);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
@@ -0,0 +1,181 @@
+/**********************************************************************
+ * cache_test.c                                            October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define CAPACITY 500
+#define NOHOT 400
+#define NOSCAN 5000
+#define NOROUND 20
+
+static size_t hash_function(int *i) {
+	return((size_t)*i * 2654435761UL);
+}
+
+static int match_function(int *a, int *b) {
+	return(*a != *b);
+}
+
+#define HASH_FUNCTION (size_t (*)(void *))hash_function
+#define MATCH_FUNCTION (int (*)(void *, void *))match_function
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+static void reference(vanessa_cache_t *c, int i) {
+	if(vanessa_cache_get_element(c, &i) != NULL) {
+		return;
+	}
+	if(vanessa_cache_add_element(c, &i) == NULL) {
+		die("vanessa_cache_add_element");
+	}
+	if(vanessa_cache_get_count(c) > CAPACITY) {
+		die("vanessa_cache_get_count exceeds capacity");
+	}
+}
+
+/*
+ * Replay a trace of a hot working set, referenced repeatedly,
+ * interleaved with scans of elements that are each used once.
+ * Return the hit ratio as a percentage.
+ */
+static int replay(vanessa_adt_flag_t policy) {
+	vanessa_cache_t *c;
+	int round;
+	int i;
+	int j;
+	int scan = NOHOT;
+	unsigned long long hits;
+	unsigned long long misses;
+
+	c = vanessa_cache_create(CAPACITY, policy, VANESSA_DESTROY_INT,
+			VANESSA_DUPLICATE_INT, MATCH_FUNCTION, HASH_FUNCTION);
+	if(c == NULL) {
+		die("vanessa_cache_create");
+	}
+
+	for(round = 0; round < NOROUND; round++) {
+		for(j = 0; j < 3; j++) {
+			for(i = 0; i < NOHOT; i++) {
+				reference(c, i);
+			}
+		}
+		for(i = 0; i < NOSCAN; i++) {
+			reference(c, scan++);
+		}
+	}
+
+	hits = vanessa_cache_get_hits(c);
+	misses = vanessa_cache_get_misses(c);
+	vanessa_cache_destroy(c);
+
+	return((int)(hits * 100 / (hits + misses)));
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_cache_t *c;
+	int lru;
+	int arc;
+	int i;
+	int *p;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "cache_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	/*
+	 * Basic operations
+	 */
+	printf("Creating Cache\n");
+	c = vanessa_cache_create(4, VANESSA_CACHE_ARC, VANESSA_DESTROY_INT,
+			VANESSA_DUPLICATE_INT, MATCH_FUNCTION, HASH_FUNCTION);
+	if(c == NULL) {
+		die("vanessa_cache_create");
+	}
+	printf("Inserting Elements into Cache\n");
+	for(i = 0; i < 8; i++) {
+		reference(c, i);
+	}
+	printf("%lu\n", (unsigned long)vanessa_cache_get_count(c));
+	i = 7;
+	p = (int *)vanessa_cache_get_element(c, &i);
+	if(p == NULL || *p != 7) {
+		die("vanessa_cache_get_element");
+	}
+	printf("Removing element \"7\"\n");
+	vanessa_cache_remove_element(c, &i);
+	if(vanessa_cache_get_element(c, &i) != NULL) {
+		die("vanessa_cache_remove_element");
+	}
+	printf("%lu\n", (unsigned long)vanessa_cache_get_count(c));
+	vanessa_cache_destroy(c);
+
+	/*
+	 * Compare policies on a trace with scans
+	 */
+	printf("Replaying trace\n");
+	lru = replay(VANESSA_CACHE_LRU);
+	arc = replay(VANESSA_CACHE_ARC);
+	printf("LRU hit ratio: %d%%\n", lru);
+	printf("ARC hit ratio: %d%%\n", arc);
+	if(arc <= lru) {
+		die("ARC is not scan resistant");
+	}
+
+	/*
+	 * Clean Up
+	 */
+	printf("Cleaning Up\n");
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
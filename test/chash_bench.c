@@ -0,0 +1,208 @@
+/**********************************************************************
+ * chash_bench.c                                           October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <time.h>
+#include <math.h>
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+/*
+ * Compare the lookup cost and balance of a consistent hash ring,
+ * jump consistent hashing and rendezvous hashing
+ */
+
+#define NOPOINT 160
+#define NOMEMBER 1000
+#define NOKEY (1 << 20)
+#define NOKEY_HRW (1 << 14)
+#define BATCH 256
+
+static size_t hash_function(int *i) {
+	return((size_t)*i * 0x9e3779b97f4a7c15ULL);
+}
+
+static int match_function(int *a, int *b) {
+	return(*a != *b);
+}
+
+#define HASH_FUNCTION (size_t (*)(void *))hash_function
+#define MATCH_FUNCTION (int (*)(void *, void *))match_function
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return(ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+/*
+ * Print the time per lookup, and the spread of the number of keys
+ * per member, as the standard deviation and maximum relative to
+ * the mean
+ */
+static void report(const char *name, double t, size_t nokey,
+		const int *count, int nomember) {
+	double mean = (double)nokey / nomember;
+	double var = 0;
+	int max = 0;
+	int i;
+
+	for(i = 0; i < nomember; i++) {
+		var += (count[i] - mean) * (count[i] - mean);
+		if(count[i] > max) {
+			max = count[i];
+		}
+	}
+
+	printf("%-14s %8.1f ns/lookup  stddev %5.1f%%  max %5.1f%%\n",
+			name, t * 1e9 / nokey,
+			sqrt(var / nomember) * 100 / mean, max * 100 / mean);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_chash_t *c;
+	size_t *hash;
+	size_t member_hash[NOMEMBER];
+	double weight[NOMEMBER];
+	int count[NOMEMBER];
+	int bucket[BATCH];
+	void *value[BATCH];
+	char buf[32];
+	double t;
+	size_t i;
+	size_t j;
+	int m;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "chash_bench",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	hash = (size_t *)malloc(NOKEY * sizeof(size_t));
+	if(hash == NULL) {
+		die("malloc");
+	}
+	for(i = 0; i < NOKEY; i++) {
+		snprintf(buf, sizeof(buf), "user%lu", (unsigned long)i);
+		hash[i] = vanessa_chash_hash_str(buf);
+	}
+	c = vanessa_chash_create(NOPOINT, VANESSA_DESTROY_INT,
+			VANESSA_DUPLICATE_INT, MATCH_FUNCTION, HASH_FUNCTION);
+	if(c == NULL) {
+		die("vanessa_chash_create");
+	}
+	for(m = 0; m < NOMEMBER; m++) {
+		if(vanessa_chash_add_element(c, &m, 1) == NULL) {
+			die("vanessa_chash_add_element");
+		}
+		member_hash[m] = hash_function(&m);
+		weight[m] = 1.0;
+	}
+	printf("%d members, %d keys (%d for rendezvous)\n", NOMEMBER,
+			NOKEY, NOKEY_HRW);
+
+	/* Ring */
+	memset(count, 0, sizeof(count));
+	t = now();
+	for(i = 0; i < NOKEY; i += BATCH) {
+		vanessa_chash_get_element_n(c, hash + i, value, BATCH);
+		for(j = 0; j < BATCH; j++) {
+			count[*(int *)value[j]]++;
+		}
+	}
+	report("ring", now() - t, NOKEY, count, NOMEMBER);
+
+	/* Jump */
+	memset(count, 0, sizeof(count));
+	t = now();
+	for(i = 0; i < NOKEY; i += BATCH) {
+		vanessa_chash_jump_n(hash + i, bucket, BATCH, NOMEMBER);
+		for(j = 0; j < BATCH; j++) {
+			count[bucket[j]]++;
+		}
+	}
+	report("jump", now() - t, NOKEY, count, NOMEMBER);
+
+	/* Rendezvous, unweighted and weighted */
+	memset(count, 0, sizeof(count));
+	t = now();
+	for(i = 0; i < NOKEY_HRW; i += BATCH) {
+		vanessa_chash_hrw_n(hash + i, bucket, BATCH, member_hash,
+				NULL, NOMEMBER);
+		for(j = 0; j < BATCH; j++) {
+			count[bucket[j]]++;
+		}
+	}
+	report("hrw", now() - t, i, count, NOMEMBER);
+
+	memset(count, 0, sizeof(count));
+	t = now();
+	for(i = 0; i < NOKEY_HRW; i += BATCH) {
+		vanessa_chash_hrw_n(hash + i, bucket, BATCH, member_hash,
+				weight, NOMEMBER);
+		for(j = 0; j < BATCH; j++) {
+			count[bucket[j]]++;
+		}
+	}
+	report("hrw weighted", now() - t, i, count, NOMEMBER);
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_chash_destroy(c);
+	free(hash);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
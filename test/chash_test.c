@@ -0,0 +1,261 @@
+/**********************************************************************
+ * chash_test.c                                            October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOPOINT 160
+#define NOMEMBER 10
+#define NOKEY 100000
+
+static size_t hash_function(int *i) {
+	return((size_t)*i);
+}
+
+static int match_function(int *a, int *b) {
+	return(*a != *b);
+}
+
+/* Step between the points of a member, before they are mixed */
+static size_t stride_function(int *i) {
+	return((size_t)(*i * 0x9e3779b97f4a7c15ULL));
+}
+
+#define HASH_FUNCTION (size_t (*)(void *))hash_function
+#define STRIDE_FUNCTION (size_t (*)(void *))stride_function
+#define MATCH_FUNCTION (int (*)(void *, void *))match_function
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+static size_t key_hash(int key) {
+	char buf[16];
+
+	snprintf(buf, sizeof(buf), "user%d", key);
+	return(vanessa_chash_hash_str(buf));
+}
+
+static int lookup(vanessa_chash_t *c, int key) {
+	int *p;
+
+	p = (int *)vanessa_chash_get_element(c, key_hash(key));
+	if(p == NULL) {
+		die("vanessa_chash_get_element");
+	}
+	return(*p);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_chash_t *c;
+	int *before;
+	int count[NOMEMBER + 1];
+	size_t member_hash[NOMEMBER + 1];
+	double weight[NOMEMBER + 1];
+	int moved;
+	int i;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "chash_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	before = (int *)malloc(NOKEY * sizeof(int));
+	if(before == NULL) {
+		die("malloc");
+	}
+
+	/*
+	 * Members whose hashes differ by the step between the points of
+	 * a member should not share points, and so keys
+	 */
+	c = vanessa_chash_create(NOPOINT, VANESSA_DESTROY_INT,
+			VANESSA_DUPLICATE_INT, MATCH_FUNCTION, STRIDE_FUNCTION);
+	if(c == NULL) {
+		die("vanessa_chash_create");
+	}
+	for(i = 0; i < 2; i++) {
+		if(vanessa_chash_add_element(c, &i, 1) == NULL) {
+			die("vanessa_chash_add_element");
+		}
+	}
+	memset(count, 0, sizeof(count));
+	for(i = 0; i < NOKEY; i++) {
+		count[lookup(c, i)]++;
+	}
+	if(count[0] < NOKEY / 4 || count[1] < NOKEY / 4) {
+		die("members with nearby hashes share points");
+	}
+	vanessa_chash_destroy(c);
+
+	/*
+	 * Create a ring, member 0 has twice the weight of the others
+	 */
+	printf("Creating Consistent Hash Ring\n");
+	c = vanessa_chash_create(NOPOINT, VANESSA_DESTROY_INT,
+			VANESSA_DUPLICATE_INT, MATCH_FUNCTION, HASH_FUNCTION);
+	if(c == NULL) {
+		die("vanessa_chash_create");
+	}
+	if(vanessa_chash_get_element(c, 0) != NULL) {
+		die("vanessa_chash_get_element of empty ring");
+	}
+	for(i = 0; i < NOMEMBER; i++) {
+		if(vanessa_chash_add_element(c, &i, i ? 1 : 2) == NULL) {
+			die("vanessa_chash_add_element");
+		}
+	}
+	printf("%lu\n", (unsigned long)vanessa_chash_get_count(c));
+
+	/*
+	 * Distribution of keys should follow the weights
+	 */
+	memset(count, 0, sizeof(count));
+	for(i = 0; i < NOKEY; i++) {
+		before[i] = lookup(c, i);
+		count[before[i]]++;
+	}
+	for(i = 0; i < NOMEMBER; i++) {
+		printf("%d: %d\n", i, count[i]);
+		if(count[i] * (NOMEMBER + 1) < NOKEY * (i ? 1 : 2) * 3 / 4 ||
+				count[i] * (NOMEMBER + 1) >
+				NOKEY * (i ? 1 : 2) * 5 / 4) {
+			die("uneven distribution");
+		}
+	}
+
+	/*
+	 * Adding a member should only move keys to that member
+	 */
+	printf("Adding member \"%d\"\n", NOMEMBER);
+	i = NOMEMBER;
+	if(vanessa_chash_add_element(c, &i, 1) == NULL) {
+		die("vanessa_chash_add_element");
+	}
+	moved = 0;
+	for(i = 0; i < NOKEY; i++) {
+		if(lookup(c, i) != before[i]) {
+			if(lookup(c, i) != NOMEMBER) {
+				die("key moved between existing members");
+			}
+			moved++;
+		}
+	}
+	printf("%d%% of keys moved\n", moved * 100 / NOKEY);
+	if(moved * (NOMEMBER + 2) < NOKEY / 2 ||
+			moved * (NOMEMBER + 2) > NOKEY * 3 / 2) {
+		die("unexpected number of keys moved");
+	}
+
+	/*
+	 * Removing it again should restore the original mapping
+	 */
+	printf("Removing member \"%d\"\n", NOMEMBER);
+	i = NOMEMBER;
+	vanessa_chash_remove_element(c, &i);
+	for(i = 0; i < NOKEY; i++) {
+		if(lookup(c, i) != before[i]) {
+			die("vanessa_chash_remove_element");
+		}
+	}
+	printf("%lu\n", (unsigned long)vanessa_chash_get_count(c));
+
+	/*
+	 * Growing the number of buckets by one should only move keys
+	 * to the new bucket
+	 */
+	printf("Jump consistent hash\n");
+	for(i = 0; i < NOKEY; i++) {
+		before[i] = vanessa_chash_jump(key_hash(i), NOMEMBER);
+		if(before[i] < 0 || before[i] >= NOMEMBER) {
+			die("vanessa_chash_jump");
+		}
+	}
+	for(i = 0; i < NOKEY; i++) {
+		moved = vanessa_chash_jump(key_hash(i), NOMEMBER + 1);
+		if(moved != before[i] && moved != NOMEMBER) {
+			die("key moved between existing buckets");
+		}
+	}
+
+	/*
+	 * Removing a member should only move the keys that mapped to it
+	 */
+	printf("Rendezvous hash\n");
+	for(i = 0; i < NOMEMBER + 1; i++) {
+		member_hash[i] = vanessa_chash_hash_str(i ? "b" : "a") + i;
+		weight[i] = i ? 1.0 : 2.0;
+	}
+	memset(count, 0, sizeof(count));
+	for(i = 0; i < NOKEY; i++) {
+		before[i] = vanessa_chash_hrw(key_hash(i), member_hash,
+				weight, NOMEMBER + 1);
+		count[before[i]]++;
+	}
+	if(count[0] < count[1] * 3 / 2) {
+		die("vanessa_chash_hrw ignored weight");
+	}
+	for(i = 0; i < NOKEY; i++) {
+		moved = vanessa_chash_hrw(key_hash(i), member_hash,
+				weight, NOMEMBER);
+		if(moved != before[i] && before[i] != NOMEMBER) {
+			die("key moved between remaining members");
+		}
+	}
+
+	/*
+	 * Clean Up
+	 */
+	printf("Cleaning Up\n");
+	vanessa_chash_destroy(c);
+	free(before);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
@@ -0,0 +1,194 @@
+/**********************************************************************
+ * deque_test.c                                            October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOOP 200000
+#define MAXELEMENT 4096
+
+static void destroy_function(const void *e) {
+	free(*(void **)e);
+}
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_deque_t *d;
+	static size_t model[MAXELEMENT * 2];
+	size_t first = MAXELEMENT;
+	size_t last = MAXELEMENT;
+	size_t next = 1;
+	void *value;
+	size_t i;
+	int op;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "deque_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	d = vanessa_deque_create(NULL);
+	if(d == NULL) {
+		die("vanessa_deque_create");
+	}
+	if(vanessa_deque_pop_first(d, &value) != NULL ||
+			vanessa_deque_pop_last(d, &value) != NULL ||
+			vanessa_deque_peek_first(d) != NULL ||
+			vanessa_deque_get_element(d, 0) != NULL) {
+		die("vanessa_deque_pop_first");
+	}
+
+	/*
+	 * Random pushes and pops at both ends, checked against an array
+	 * holding the elements from first to last. Phases favouring
+	 * pushes and pops make the deque grow and shrink with elements
+	 * wrapped around the end of its array.
+	 */
+	srand(1);
+	for(i = 0; i < NOOP; i++) {
+		op = rand() % 8;
+		if((i / 10000) % 2 == 0 ? op < 5 : op < 3) {
+			if(last - first == MAXELEMENT) {
+				continue;
+			}
+			if(op % 2 && first > 0) {
+				if(vanessa_deque_push_first(d,
+						(void *)next) == NULL) {
+					die("vanessa_deque_push_first");
+				}
+				model[--first] = next++;
+			}
+			else if(last < MAXELEMENT * 2) {
+				if(vanessa_deque_push_last(d,
+						(void *)next) == NULL) {
+					die("vanessa_deque_push_last");
+				}
+				model[last++] = next++;
+			}
+		}
+		else if(first != last) {
+			if(op % 2) {
+				if(vanessa_deque_pop_first(d, &value) == NULL ||
+						value != (void *)model[first++]) {
+					die("vanessa_deque_pop_first");
+				}
+			}
+			else {
+				if(vanessa_deque_pop_last(d, &value) == NULL ||
+						value != (void *)model[--last]) {
+					die("vanessa_deque_pop_last");
+				}
+			}
+		}
+		if(first == last) {
+			first = last = MAXELEMENT;
+		}
+
+		if(vanessa_deque_length(d) != (ssize_t)(last - first) ||
+				(first != last &&
+				 (vanessa_deque_peek_first(d) !=
+				  (void *)model[first] ||
+				  vanessa_deque_peek_last(d) !=
+				  (void *)model[last - 1] ||
+				  vanessa_deque_get_element(d, (i * 7) %
+					  (last - first)) !=
+				  (void *)model[first + (i * 7) %
+				  (last - first)]))) {
+			die("vanessa_deque_get_element");
+		}
+	}
+	printf("%lu %ld\n", (unsigned long)next,
+			(long)vanessa_deque_length(d));
+
+	/*
+	 * Indexed replacement
+	 */
+	for(i = 0; first + i < last; i++) {
+		if(vanessa_deque_set_element(d, i, (void *)i) !=
+				(void *)model[first + i]) {
+			die("vanessa_deque_set_element");
+		}
+	}
+	for(i = 0; first + i < last; i++) {
+		if(vanessa_deque_get_element(d, i) != (void *)i) {
+			die("vanessa_deque_set_element");
+		}
+	}
+	if(vanessa_deque_set_element(d, i, NULL) != NULL) {
+		die("vanessa_deque_set_element");
+	}
+	vanessa_deque_destroy(d);
+
+	/*
+	 * Reserved room, and elements left are destroyed with the deque
+	 */
+	d = vanessa_deque_create(destroy_function);
+	if(d == NULL || vanessa_deque_reserve(d, 100) != d) {
+		die("vanessa_deque_reserve");
+	}
+	for(i = 0; i < 100; i++) {
+		value = malloc(16);
+		if(value == NULL || (i % 2 ?
+				vanessa_deque_push_first(d, value) :
+				vanessa_deque_push_last(d, value)) == NULL) {
+			die("vanessa_deque_push_first");
+		}
+	}
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_deque_destroy(d);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
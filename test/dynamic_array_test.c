@@ -26,6 +26,7 @@
 #include <vanessa_adt.h>
 #include <vanessa_logger.h>
 
+#define NOELEMENT 100000
 
 /**********************************************************************
  * Muriel the main function
@@ -37,6 +38,7 @@ int main()
 	vanessa_dynamic_array_t *a;
 	char *str;
 	int i;
+	long j;
 
 	/* 
 	 * Open logger to filehandle stderr
@@ -125,6 +127,43 @@ int main()
 	printf("%s\n", str);
 	free(str);
 
+	vanessa_dynamic_array_destroy(a);
+
+	/*
+	 * Add many elements to a dynamic array that grows geometrically,
+	 * then delete all but one of them
+	 */
+	printf("Growing Dynamic Array Geometrically\n");
+	a = vanessa_dynamic_array_create_growth(0,
+			VANESSA_DYNAMIC_ARRAY_GEOMETRIC, NULL, NULL, NULL, NULL);
+	if (a == NULL) {
+		vanessa_logger_log(vl, LOG_DEBUG,
+				   "main: vanessa_dynamic_array_create_growth");
+		vanessa_logger_log(vl, LOG_ERR,
+				   "Fatal error creating dynamic array. Exiting.");
+		exit(-1);
+	}
+	for (j = 1; j <= NOELEMENT; j++) {
+		if (vanessa_dynamic_array_add_element(a, (void *)j) == NULL) {
+			vanessa_logger_log(vl, LOG_ERR,
+					   "Fatal error adding element. Exiting.");
+			exit(-1);
+		}
+	}
+	for (j = NOELEMENT; j > 1; j--) {
+		if (vanessa_dynamic_array_get_count(a) != j ||
+				vanessa_dynamic_array_get_element(a, j - 1) !=
+				(void *)j ||
+				vanessa_dynamic_array_delete_element(a, j - 1)
+				== NULL) {
+			vanessa_logger_log(vl, LOG_ERR,
+					   "Fatal error deleting element. Exiting.");
+			exit(-1);
+		}
+	}
+	printf("%ld %ld\n", (long)vanessa_dynamic_array_get_count(a),
+			(long)vanessa_dynamic_array_get_element(a, 0));
+
 	/* 
 	 * Clean Up
 	 */
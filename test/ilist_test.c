@@ -0,0 +1,147 @@
+/**********************************************************************
+ * ilist_test.c                                            October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOCONN 16
+
+/* A connection on three lists at once */
+typedef struct {
+	int fd;
+	int backend;
+	vanessa_ilist_t all;
+	vanessa_ilist_t idle;
+	vanessa_ilist_t backend_link;
+} conn_t;
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_ilist_t all = VANESSA_ILIST_INIT(all);
+	vanessa_ilist_t idle;
+	vanessa_ilist_t backend[2];
+	conn_t conn[NOCONN];
+	conn_t *c;
+	conn_t *tmp;
+	int i;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "ilist_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	vanessa_ilist_init(&idle);
+	vanessa_ilist_init(&backend[0]);
+	vanessa_ilist_init(&backend[1]);
+	if(!vanessa_ilist_empty(&all) ||
+			VANESSA_ILIST_FIRST(&all, conn_t, all) != NULL) {
+		die("vanessa_ilist_empty");
+	}
+
+	for(i = 0; i < NOCONN; i++) {
+		conn[i].fd = i;
+		conn[i].backend = i % 2;
+		vanessa_ilist_init(&conn[i].idle);
+		vanessa_ilist_insert_before(&all, &conn[i].all);
+		vanessa_ilist_insert_after(&backend[i % 2],
+				&conn[i].backend_link);
+		if(i % 3 == 0) {
+			vanessa_ilist_insert_before(&idle, &conn[i].idle);
+		}
+	}
+
+	/* All connections, in order */
+	VANESSA_ILIST_FOREACH(c, &all, conn_t, all) {
+		printf("%d%c", c->fd, &c->all == all.prev ? '\n' : ',');
+	}
+
+	/* Backend 1, newest first */
+	VANESSA_ILIST_FOREACH(c, &backend[1], conn_t, backend_link) {
+		printf("%d%c", c->fd, &c->backend_link == backend[1].prev ?
+				'\n' : ',');
+	}
+
+	/* Reap idle connections, taking them off every list */
+	VANESSA_ILIST_FOREACH_SAFE(c, tmp, &idle, conn_t, idle) {
+		vanessa_ilist_remove(&c->idle);
+		vanessa_ilist_remove(&c->all);
+		vanessa_ilist_remove(&c->backend_link);
+	}
+	if(!vanessa_ilist_empty(&idle) || !vanessa_ilist_empty(&conn[0].idle)
+			|| vanessa_ilist_empty(&conn[1].all)) {
+		die("vanessa_ilist_remove");
+	}
+	/* Removing twice is harmless */
+	vanessa_ilist_remove(&conn[0].idle);
+
+	/* Move backend 0 to backend 1 */
+	vanessa_ilist_splice(&backend[1], &backend[0]);
+	if(!vanessa_ilist_empty(&backend[0])) {
+		die("vanessa_ilist_splice");
+	}
+	printf("%lu %lu\n", (unsigned long)vanessa_ilist_get_count(&all),
+			(unsigned long)vanessa_ilist_get_count(&backend[1]));
+
+	VANESSA_ILIST_FOREACH_REVERSE(c, &backend[1], conn_t, backend_link) {
+		printf("%d%c", c->fd, &c->backend_link == backend[1].next ?
+				'\n' : ',');
+	}
+	c = VANESSA_ILIST_LAST(&all, conn_t, all);
+	printf("%d\n", c->fd);
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
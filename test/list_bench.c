@@ -0,0 +1,229 @@
+/**********************************************************************
+ * list_bench.c                                            October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <time.h>
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+/*
+ * Compare the cost of walking a linked list, a linked list whose
+ * elements are allocated from a pool and an unrolled list.
+ *
+ * Values are stored by reference so that only the list layout
+ * differs. Blocks of random size are allocated between elements to
+ * give the heap the sort of layout a long running process has.
+ */
+
+#define NOELEMENT (1 << 20)
+#define REPEAT 10
+
+static int sum_function(void *e, void *data) {
+	*(long *)data += *(int *)e;
+	return(0);
+}
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return(ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+static void report(const char *name, const char *op, double t) {
+	printf("%-10s %-8s %6.2f ns/element\n", name, op,
+			t * 1e9 / ((double)NOELEMENT * REPEAT));
+}
+
+/*
+ * Time iterate, length and display of a list or an unrolled list
+ */
+static void bench_list(const char *name, vanessa_list_t *l) {
+	double t;
+	long sum = 0;
+	size_t len = 0;
+	char *str;
+	int i;
+
+	t = now();
+	for(i = 0; i < REPEAT; i++) {
+		vanessa_list_iterate(l, sum_function, &sum);
+	}
+	report(name, "iterate", now() - t);
+
+	t = now();
+	for(i = 0; i < REPEAT; i++) {
+		len += vanessa_list_length(l);
+	}
+	report(name, "length", now() - t);
+
+	t = now();
+	for(i = 0; i < REPEAT; i++) {
+		str = vanessa_list_display(l, ',');
+		if(str == NULL) {
+			die("vanessa_list_display");
+		}
+		free(str);
+	}
+	report(name, "display", now() - t);
+
+	if(sum != (long)REPEAT * NOELEMENT * (NOELEMENT - 1) / 2) {
+		die("vanessa_list_iterate");
+	}
+}
+
+static void bench_ulist(const char *name, vanessa_ulist_t *l) {
+	double t;
+	long sum = 0;
+	size_t len = 0;
+	char *str;
+	int i;
+
+	t = now();
+	for(i = 0; i < REPEAT; i++) {
+		vanessa_ulist_iterate(l, sum_function, &sum);
+	}
+	report(name, "iterate", now() - t);
+
+	t = now();
+	for(i = 0; i < REPEAT; i++) {
+		len += vanessa_ulist_length(l);
+	}
+	report(name, "length", now() - t);
+
+	t = now();
+	for(i = 0; i < REPEAT; i++) {
+		str = vanessa_ulist_display(l, ',');
+		if(str == NULL) {
+			die("vanessa_ulist_display");
+		}
+		free(str);
+	}
+	report(name, "display", now() - t);
+
+	if(sum != (long)REPEAT * NOELEMENT * (NOELEMENT - 1) / 2) {
+		die("vanessa_ulist_iterate");
+	}
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_list_t *l;
+	vanessa_list_t *pl;
+	vanessa_ulist_t *ul;
+	vanessa_pool_t *pool;
+	void **noise;
+	int *value;
+	int i;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "list_bench",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	value = (int *)malloc(NOELEMENT * sizeof(int));
+	noise = (void **)malloc(NOELEMENT * sizeof(void *));
+	if(value == NULL || noise == NULL) {
+		die("malloc");
+	}
+
+	l = vanessa_list_create(0, NULL, NULL, VANESSA_DISPLAY_INT,
+			VANESSA_LENGTH_INT, NULL, NULL);
+	pl = vanessa_list_create(0, NULL, NULL, VANESSA_DISPLAY_INT,
+			VANESSA_LENGTH_INT, NULL, NULL);
+	ul = vanessa_ulist_create(NULL, NULL, VANESSA_DISPLAY_INT,
+			VANESSA_LENGTH_INT, NULL, NULL);
+	if(l == NULL || pl == NULL || ul == NULL) {
+		die("create");
+	}
+	pool = vanessa_list_pool_create(0);
+	if(pool == NULL || vanessa_list_set_pool(pl, pool) == NULL) {
+		die("vanessa_list_set_pool");
+	}
+	vanessa_pool_destroy(pool);
+
+	srandom(1);
+	for(i = 0; i < NOELEMENT; i++) {
+		value[i] = i;
+		if(vanessa_list_add_element(l, value + i) == NULL ||
+				vanessa_list_add_element(pl, value + i)
+				== NULL ||
+				vanessa_ulist_add_element(ul, value + i)
+				== NULL) {
+			die("add_element");
+		}
+		noise[i] = malloc(16 + random() % 240);
+		if(noise[i] == NULL) {
+			die("malloc");
+		}
+	}
+	printf("%d elements, %d passes\n", NOELEMENT, REPEAT);
+
+	bench_list("list", l);
+	bench_list("pool list", pl);
+	bench_ulist("ulist", ul);
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_list_destroy(l);
+	vanessa_list_destroy(pl);
+	vanessa_ulist_destroy(ul);
+	for(i = 0; i < NOELEMENT; i++) {
+		free(noise[i]);
+	}
+	free(noise);
+	free(value);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
@@ -26,6 +26,44 @@
 #include <vanessa_adt.h>
 #include <vanessa_logger.h>
 
+#define NOSKIP 100000
+
+static int sort_function(int *a, int *b) {
+	return((*a > *b) - (*a < *b));
+}
+
+#define SORT_FUNCTION (int (*)(void *, void *))sort_function
+
+static size_t hash_function(int *i) {
+	return((size_t)*i * 0x9e3779b9U);
+}
+
+#define HASH_FUNCTION (size_t (*)(void *))hash_function
+
+/* Elements of the indexed list are in insertion order, less removals */
+static int check_insertion_order(void *e, void *data) {
+	long *i = (long *)data;
+
+	while((*i * 7919L) % NOSKIP % 3 == 0) {
+		(*i)++;
+	}
+	if(*(int *)e != (*i * 7919L) % NOSKIP) {
+		return(-1);
+	}
+	(*i)++;
+	return(0);
+}
+
+static int check_order(void *e, void *data) {
+	int *prev = (int *)data;
+
+	if(*(int *)e < *prev) {
+		return(-1);
+	}
+	*prev = *(int *)e;
+	return(0);
+}
+
 
 /**********************************************************************
  * Muriel the main function
@@ -36,9 +74,14 @@ int main(void)
 	vanessa_logger_t *vl;
 	vanessa_list_t *l;
 	vanessa_list_t *l_copy;
+	vanessa_list_t *l_tmp;
 	char *str;
 	int i;
+	int j;
+	long k;
 	int *p;
+	vanessa_list_elem_t *e;
+	vanessa_list_elem_t *next;
 
 	/* 
 	 * Open logger to filehandle stderr
@@ -173,6 +216,367 @@ int main(void)
 	}
 	printf("%s\n", str);
 	free(str);
+	vanessa_list_destroy(l_copy);
+
+	/*
+	 * Large sorted list, kept as a skip list
+	 */
+	printf("Inserting %d Elements into Sorted List\n", NOSKIP);
+	if ((l_copy = vanessa_list_create(0, VANESSA_DESTROY_INT,
+				     VANESSA_DUPLICATE_INT,
+				     VANESSA_DISPLAY_INT,
+				     VANESSA_LENGTH_INT,
+				     VANESSA_MATCH_INT,
+				     SORT_FUNCTION)) == NULL ||
+			vanessa_list_set_flag(l_copy,
+				VANESSA_LIST_SKIP) == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error creating sorted list. Exiting.");
+		exit(-1);
+	}
+	for (i = 0; i < NOSKIP; i++) {
+		j = (int)((i * 7919L) % NOSKIP);
+		if ((vanessa_list_add_element(l_copy, &j)) == NULL) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error adding element. Exiting.");
+			exit(-1);
+		}
+	}
+	for (i = 0; i < NOSKIP; i += 2) {
+		vanessa_list_remove_element(l_copy, &i);
+	}
+	for (i = 0; i < NOSKIP; i++) {
+		p = (int *)vanessa_list_get_element(l_copy, &i);
+		if ((p == NULL) != (i % 2 == 0) || (p && *p != i)) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error finding element %d. "
+					"Exiting.", i);
+			exit(-1);
+		}
+	}
+	j = -1;
+	if (vanessa_list_get_count(l_copy) != NOSKIP / 2 ||
+			vanessa_list_iterate(l_copy, check_order, &j) < 0) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error, sorted list corrupted. Exiting.");
+		exit(-1);
+	}
+	printf("%d\n", (int)vanessa_list_get_count(l_copy));
+	vanessa_list_destroy(l_copy);
+
+	/*
+	 * Bulk load a sorted list, then sort it once
+	 */
+	printf("Bulk loading %d Elements into Sorted List\n", NOSKIP * 2);
+	if ((l_copy = vanessa_list_create(0, VANESSA_DESTROY_INT,
+				     VANESSA_DUPLICATE_INT,
+				     VANESSA_DISPLAY_INT,
+				     VANESSA_LENGTH_INT,
+				     VANESSA_MATCH_INT,
+				     SORT_FUNCTION)) == NULL ||
+			vanessa_list_set_flag(l_copy, VANESSA_LIST_SKIP |
+				VANESSA_LIST_BULK) == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error creating sorted list. Exiting.");
+		exit(-1);
+	}
+	for (i = 0; i < NOSKIP * 2; i++) {
+		j = (int)((i * 7919L) % NOSKIP);
+		if ((vanessa_list_add_element(l_copy, &j)) == NULL) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error adding element. Exiting.");
+			exit(-1);
+		}
+	}
+	/* A duplicate made part way through is still being bulk loaded */
+	l_tmp = vanessa_list_duplicate(l_copy);
+	if (l_tmp == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error duplicating list. Exiting.");
+		exit(-1);
+	}
+	for (i = 0; i < NOSKIP; i += 97) {
+		if (vanessa_list_get_element(l_tmp, &i) == NULL) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error finding element %d. "
+					"Exiting.", i);
+			exit(-1);
+		}
+	}
+	for (k = 0; k < 2; k++) {
+		vanessa_list_clear_flag(k ? l_tmp : l_copy,
+				VANESSA_LIST_BULK);
+		j = -1;
+		if (vanessa_list_get_count(k ? l_tmp : l_copy) !=
+					NOSKIP * 2 ||
+				vanessa_list_iterate(k ? l_tmp : l_copy,
+					check_order, &j) < 0) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error, bulk loaded list is "
+					"not sorted. Exiting.");
+			exit(-1);
+		}
+	}
+	i = NOSKIP - 1;
+	if (vanessa_list_get_element(l_tmp, &i) == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error finding element %d. Exiting.", i);
+		exit(-1);
+	}
+	printf("%d\n", (int)vanessa_list_get_count(l_copy));
+	vanessa_list_destroy(l_copy);
+	vanessa_list_destroy(l_tmp);
+
+	/*
+	 * Unsorted list, appended to and indexed by hash. The index is
+	 * added half way through to check existing elements are indexed.
+	 */
+	printf("Inserting %d Elements into Indexed List\n", NOSKIP);
+	if ((l_copy = vanessa_list_create(0, VANESSA_DESTROY_INT,
+				     VANESSA_DUPLICATE_INT,
+				     VANESSA_DISPLAY_INT,
+				     VANESSA_LENGTH_INT,
+				     VANESSA_MATCH_INT, NULL)) == NULL ||
+			vanessa_list_set_flag(l_copy,
+				VANESSA_LIST_BULK) == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error creating indexed list. Exiting.");
+		exit(-1);
+	}
+	for (i = 0; i < NOSKIP; i++) {
+		if (i == NOSKIP / 2 && vanessa_list_set_index(l_copy,
+					HASH_FUNCTION) == NULL) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error indexing list. Exiting.");
+			exit(-1);
+		}
+		j = (int)((i * 7919L) % NOSKIP);
+		if ((vanessa_list_add_element(l_copy, &j)) == NULL) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error adding element. Exiting.");
+			exit(-1);
+		}
+	}
+	for (i = 0; i < NOSKIP; i += 3) {
+		vanessa_list_remove_element(l_copy, &i);
+	}
+	for (i = 0; i < NOSKIP; i++) {
+		p = (int *)vanessa_list_get_element(l_copy, &i);
+		if ((p == NULL) != (i % 3 == 0) || (p && *p != i)) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error finding element %d. "
+					"Exiting.", i);
+			exit(-1);
+		}
+	}
+	k = 0;
+	if (vanessa_list_iterate(l_copy, check_insertion_order, &k) < 0) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error, indexed list corrupted. Exiting.");
+		exit(-1);
+	}
+	printf("%d\n", (int)vanessa_list_get_count(l_copy));
+
+	/* A duplicate keeps the order and the index */
+	l_tmp = vanessa_list_duplicate(l_copy);
+	vanessa_list_destroy(l_copy);
+	l_copy = l_tmp;
+	k = 0;
+	i = 99998;
+	if (l_copy == NULL ||
+			vanessa_list_iterate(l_copy, check_insertion_order,
+				&k) < 0 ||
+			vanessa_list_get_element(l_copy, &i) == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error duplicating list. Exiting.");
+		exit(-1);
+	}
+	vanessa_list_destroy(l_copy);
+
+	/*
+	 * Walk a list with a cursor, removing and moving elements
+	 */
+	printf("Filtering List Using a Cursor\n");
+	if ((l_copy = vanessa_list_create(3, VANESSA_DESTROY_INT,
+				     VANESSA_DUPLICATE_INT,
+				     VANESSA_DISPLAY_INT,
+				     VANESSA_LENGTH_INT,
+				     VANESSA_MATCH_INT, NULL)) == NULL ||
+			vanessa_list_set_index(l_copy,
+				HASH_FUNCTION) == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error creating list. Exiting.");
+		exit(-1);
+	}
+	for (i = 0; i < 10; i++) {
+		if (vanessa_list_insert_before(l_copy, NULL, &i) == NULL) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error adding element. Exiting.");
+			exit(-1);
+		}
+	}
+	/* Remove odd values, and move multiples of 4 to the end */
+	e = vanessa_list_first(l_copy);
+	for (i = 0; i < 10; i++) {
+		j = *(int *)vanessa_list_elem_value(e);
+		if (j % 2) {
+			e = vanessa_list_remove_elem(l_copy, e);
+		}
+		else if (j % 4 == 0) {
+			next = vanessa_list_unlink(l_copy, e);
+			vanessa_list_link_before(l_copy, NULL, e);
+			e = next;
+		}
+		else {
+			e = vanessa_list_next(e);
+		}
+	}
+	j = 6;
+	e = vanessa_list_get_elem(l_copy, &j);
+	j = 11;
+	if (e == NULL || vanessa_list_insert_before(l_copy, e, &j) == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error inserting element. Exiting.");
+		exit(-1);
+	}
+	if ((str = vanessa_list_display(l_copy, ',')) == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error displaying list. Exiting.");
+		exit(-1);
+	}
+	printf("%s\n", str);
+	free(str);
+
+	/*
+	 * An unlinked element is only destroyed by vanessa_list_remove_elem,
+	 * first without an index and then with one
+	 */
+	for (i = 0; i < 2; i++) {
+		if (i == 1 && vanessa_list_set_index(l_copy,
+					HASH_FUNCTION) == NULL) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error indexing list. Exiting.");
+			exit(-1);
+		}
+		j = (int)vanessa_list_get_count(l_copy);
+		e = vanessa_list_first(l_copy);
+		vanessa_list_unlink(l_copy, e);
+		if ((int)vanessa_list_get_count(l_copy) != j - 1 ||
+				vanessa_list_remove_elem(l_copy, e) != NULL ||
+				(int)vanessa_list_get_count(l_copy) != j - 1) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error removing unlinked "
+					"element. Exiting.");
+			exit(-1);
+		}
+	}
+	printf("%d\n", (int)vanessa_list_get_count(l_copy));
+	vanessa_list_destroy(l_copy);
+
+	/*
+	 * Merge two sorted lists, split the result and splice it back
+	 */
+	printf("Merging, Splitting and Splicing Sorted Lists\n");
+	l_copy = vanessa_list_create(3, VANESSA_DESTROY_INT,
+			VANESSA_DUPLICATE_INT, VANESSA_DISPLAY_INT,
+			VANESSA_LENGTH_INT, VANESSA_MATCH_INT, SORT_FUNCTION);
+	l_tmp = vanessa_list_create(3, VANESSA_DESTROY_INT,
+			VANESSA_DUPLICATE_INT, VANESSA_DISPLAY_INT,
+			VANESSA_LENGTH_INT, VANESSA_MATCH_INT, SORT_FUNCTION);
+	if (l_copy == NULL || l_tmp == NULL ||
+			vanessa_list_set_flag(l_copy,
+				VANESSA_LIST_SKIP) == NULL ||
+			vanessa_list_set_index(l_tmp, HASH_FUNCTION) == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error creating list. Exiting.");
+		exit(-1);
+	}
+	for (i = 0; i < 10; i++) {
+		if (vanessa_list_add_element(i % 2 ? l_copy : l_tmp,
+					&i) == NULL) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error adding element. Exiting.");
+			exit(-1);
+		}
+	}
+	if (vanessa_list_merge(l_copy, l_tmp) == NULL ||
+			vanessa_list_get_count(l_copy) != 10 ||
+			vanessa_list_get_count(l_tmp) != 0) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error merging lists. Exiting.");
+		exit(-1);
+	}
+	vanessa_list_destroy(l_tmp);
+	i = 6;
+	l_tmp = vanessa_list_split(l_copy, vanessa_list_get_elem(l_copy, &i));
+	if (l_tmp == NULL || vanessa_list_get_count(l_copy) != 6 ||
+			vanessa_list_get_count(l_tmp) != 4 ||
+			vanessa_list_get_element(l_copy, &i) != NULL ||
+			vanessa_list_get_element(l_tmp, &i) == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error splitting list. Exiting.");
+		exit(-1);
+	}
+	for (j = 0; j < 2; j++) {
+		if ((str = vanessa_list_display(j ? l_tmp : l_copy,
+						',')) == NULL) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error displaying list. "
+					"Exiting.");
+			exit(-1);
+		}
+		printf("%s\n", str);
+		free(str);
+	}
+	if (vanessa_list_splice(l_copy, l_tmp) == NULL ||
+			vanessa_list_get_count(l_copy) != 10 ||
+			vanessa_list_get_element(l_copy, &i) == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error splicing lists. Exiting.");
+		exit(-1);
+	}
+	if ((str = vanessa_list_display(l_copy, ',')) == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error displaying list. Exiting.");
+		exit(-1);
+	}
+	printf("%s\n", str);
+	free(str);
+	vanessa_list_destroy(l_tmp);
+
+	/*
+	 * Splice plain lists, which takes the count of src rather than
+	 * walking it, and forgets its recently used elements
+	 */
+	l_tmp = vanessa_list_create(3, VANESSA_DESTROY_INT,
+			VANESSA_DUPLICATE_INT, VANESSA_DISPLAY_INT,
+			VANESSA_LENGTH_INT, VANESSA_MATCH_INT, NULL);
+	if (l_tmp == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error creating list. Exiting.");
+		exit(-1);
+	}
+	for (i = 10; i < 13; i++) {
+		if (vanessa_list_add_element(l_tmp, &i) == NULL) {
+			vanessa_logger_log(vl, LOG_ERR,
+					"Fatal error adding element. Exiting.");
+			exit(-1);
+		}
+	}
+	i = 11;
+	if (vanessa_list_get_element(l_tmp, &i) == NULL ||
+			vanessa_list_clear_flag(l_copy,
+				VANESSA_LIST_SKIP) == NULL ||
+			vanessa_list_splice(l_copy, l_tmp) == NULL ||
+			vanessa_list_get_count(l_copy) != 13 ||
+			vanessa_list_get_count(l_tmp) != 0 ||
+			vanessa_list_get_element(l_tmp, &i) != NULL ||
+			vanessa_list_get_element(l_copy, &i) == NULL) {
+		vanessa_logger_log(vl, LOG_ERR,
+				"Fatal error splicing lists. Exiting.");
+		exit(-1);
+	}
+	vanessa_list_destroy(l_tmp);
 
 	/* 
 	 * Clean Up
@@ -0,0 +1,251 @@
+/**********************************************************************
+ * mpmc_bench.c                                            October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+/*
+ * Compare a lock-free multiple producer, multiple consumer queue with
+ * a vanessa_queue protected by a mutex, with 1 to 64 producer threads
+ * each handing elements to as many consumer threads.
+ *
+ * Reports the rate of pushes and pops, and the 99th percentile of the
+ * time taken by a push or pop, including retries while the queue is
+ * full or empty.
+ */
+
+#define NOOP (1 << 18)
+#define MAXTHREAD 64
+#define SIZE 1024
+
+typedef struct {
+	size_t (*push)(void *q, void *value);
+	size_t (*pop)(void *q, void **value);
+	void *q;
+	size_t noop;
+	long *latency;
+} bench_t;
+
+typedef struct {
+	vanessa_queue_t *q;
+	pthread_mutex_t lock;
+} locked_queue_t;
+
+static size_t locked_push(void *data, void *value) {
+	locked_queue_t *lq = (locked_queue_t *)data;
+	size_t n = 0;
+
+	pthread_mutex_lock(&lq->lock);
+	if(vanessa_queue_length(lq->q) < SIZE) {
+		n = vanessa_queue_push(lq->q, value) ? 1 : 0;
+	}
+	pthread_mutex_unlock(&lq->lock);
+	return(n);
+}
+
+static size_t locked_pop(void *data, void **value) {
+	locked_queue_t *lq = (locked_queue_t *)data;
+	size_t n;
+
+	pthread_mutex_lock(&lq->lock);
+	n = vanessa_queue_pop(lq->q, value) ? 1 : 0;
+	pthread_mutex_unlock(&lq->lock);
+	return(n);
+}
+
+static size_t mpmc_push(void *q, void *value) {
+	return(vanessa_mpmc_queue_try_push_n((vanessa_mpmc_queue_t *)q,
+				&value, 1));
+}
+
+static size_t mpmc_pop(void *q, void **value) {
+	return(vanessa_mpmc_queue_try_pop_n((vanessa_mpmc_queue_t *)q,
+				value, 1));
+}
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return(ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+static long now_ns(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return(ts.tv_sec * 1000000000L + ts.tv_nsec);
+}
+
+static int long_cmp(const void *a, const void *b) {
+	return((*(const long *)a > *(const long *)b) -
+			(*(const long *)a < *(const long *)b));
+}
+
+static void *producer(void *data) {
+	bench_t *b = (bench_t *)data;
+	long t;
+	size_t i;
+
+	for(i = 0; i < b->noop; i++) {
+		t = now_ns();
+		while(b->push(b->q, (void *)(i + 1)) == 0) {
+			sched_yield();
+		}
+		b->latency[i] = now_ns() - t;
+	}
+
+	return(NULL);
+}
+
+static void *consumer(void *data) {
+	bench_t *b = (bench_t *)data;
+	void *value;
+	long t;
+	size_t i;
+
+	for(i = 0; i < b->noop; i++) {
+		t = now_ns();
+		while(b->pop(b->q, &value) == 0) {
+			sched_yield();
+		}
+		b->latency[i] = now_ns() - t;
+	}
+
+	return(NULL);
+}
+
+/*
+ * Run nothread producers and nothread consumers, which between them
+ * push and pop NOOP elements
+ */
+static void run(const char *name, size_t (*push)(void *, void *),
+		size_t (*pop)(void *, void **), void *q, int nothread,
+		long *latency) {
+	pthread_t thread[MAXTHREAD * 2];
+	bench_t b[MAXTHREAD * 2];
+	size_t noop = NOOP / nothread;
+	double t;
+	int i;
+
+	for(i = 0; i < nothread * 2; i++) {
+		b[i].push = push;
+		b[i].pop = pop;
+		b[i].q = q;
+		b[i].noop = noop;
+		b[i].latency = latency + i * noop;
+	}
+
+	t = now();
+	for(i = 0; i < nothread * 2; i++) {
+		if(pthread_create(thread + i, NULL,
+					i < nothread ? producer : consumer,
+					b + i) != 0) {
+			die("pthread_create");
+		}
+	}
+	for(i = 0; i < nothread * 2; i++) {
+		pthread_join(thread[i], NULL);
+	}
+	t = now() - t;
+
+	qsort(latency, noop * nothread * 2, sizeof(long), long_cmp);
+	printf("%-6s %3d %8.2f Mops/s  p99 %8ld ns\n", name, nothread,
+			noop * nothread * 2 / t / 1e6,
+			latency[noop * nothread * 2 * 99 / 100]);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_mpmc_queue_t *q;
+	locked_queue_t lq;
+	long *latency;
+	int nothread;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "mpmc_bench",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	latency = (long *)malloc(NOOP * 2 * sizeof(long));
+	if(latency == NULL) {
+		die("malloc");
+	}
+	q = vanessa_mpmc_queue_create(SIZE, NULL);
+	lq.q = vanessa_queue_create(NULL);
+	if(q == NULL || lq.q == NULL) {
+		die("create");
+	}
+	pthread_mutex_init(&lq.lock, NULL);
+
+	printf("queue  threads\n");
+	for(nothread = 1; nothread <= MAXTHREAD; nothread *= 2) {
+		run("mutex", locked_push, locked_pop, &lq, nothread,
+				latency);
+		run("mpmc", mpmc_push, mpmc_pop, q, nothread, latency);
+	}
+
+	/*
+	 * Clean Up
+	 */
+	pthread_mutex_destroy(&lq.lock);
+	vanessa_queue_destroy(lq.q);
+	vanessa_mpmc_queue_destroy(q);
+	free(latency);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
@@ -0,0 +1,203 @@
+/**********************************************************************
+ * mpmc_queue_test.c                                       October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOTHREAD 4
+#define NOELEMENT (1 << 18)
+#define BATCH 8
+
+static vanessa_mpmc_queue_t *q;
+static unsigned char seen[NOTHREAD * NOELEMENT];
+static size_t nopopped;
+
+static void destroy_function(const void *e) {
+	free(*(void **)e);
+}
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+/*
+ * Push NOELEMENT values, tagged with the thread number, alternately
+ * one at a time and in batches
+ */
+static void *producer(void *data) {
+	size_t base = (size_t)data * NOELEMENT;
+	void *value[BATCH];
+	size_t i = 0;
+	size_t n;
+	size_t j;
+
+	while(i < NOELEMENT) {
+		for(j = 0; j < (i % 2 ? 1 : BATCH) && i + j < NOELEMENT; j++) {
+			value[j] = (void *)(base + i + j + 1);
+		}
+		n = vanessa_mpmc_queue_try_push_n(q, value, j);
+		if(n == 0) {
+			sched_yield();
+		}
+		i += n;
+	}
+
+	return(NULL);
+}
+
+/*
+ * Pop values until all have been popped, checking that each is seen
+ * once and that the values of each producer arrive in order
+ */
+static void *consumer(void *data) {
+	size_t last[NOTHREAD];
+	void *value[BATCH];
+	size_t v;
+	size_t n;
+	size_t i;
+
+	memset(last, 0, sizeof(last));
+	while(__atomic_load_n(&nopopped, __ATOMIC_RELAXED) <
+			NOTHREAD * NOELEMENT) {
+		n = vanessa_mpmc_queue_try_pop_n(q, value,
+				(size_t)data % 2 ? 1 : BATCH);
+		if(n == 0) {
+			sched_yield();
+			continue;
+		}
+		for(i = 0; i < n; i++) {
+			v = (size_t)value[i] - 1;
+			if(v >= NOTHREAD * NOELEMENT || seen[v]++ ||
+					v + 1 <= last[v / NOELEMENT]) {
+				die("vanessa_mpmc_queue_try_pop_n");
+			}
+			last[v / NOELEMENT] = v + 1;
+		}
+		__atomic_add_fetch(&nopopped, n, __ATOMIC_RELAXED);
+	}
+
+	return(NULL);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	pthread_t thread[NOTHREAD * 2];
+	void *value[4];
+	size_t i;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "mpmc_queue_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	/*
+	 * Capacity is rounded up, and the queue refuses elements when
+	 * full. A batch is only partly pushed if there is not room for
+	 * all of it.
+	 */
+	q = vanessa_mpmc_queue_create(3, destroy_function);
+	if(q == NULL) {
+		die("vanessa_mpmc_queue_create");
+	}
+	for(i = 0; i < 4; i++) {
+		value[i] = malloc(16);
+		if(value[i] == NULL) {
+			die("malloc");
+		}
+	}
+	if(vanessa_mpmc_queue_try_push_n(q, value, 3) != 3 ||
+			vanessa_mpmc_queue_try_push_n(q, value + 3, 2) != 1 ||
+			vanessa_mpmc_queue_try_push(q, value[0]) != NULL ||
+			vanessa_mpmc_queue_length(q) != 4) {
+		die("vanessa_mpmc_queue_try_push");
+	}
+	if(vanessa_mpmc_queue_try_pop_n(q, value, 2) != 2 ||
+			vanessa_mpmc_queue_length(q) != 2) {
+		die("vanessa_mpmc_queue_try_pop_n");
+	}
+	free(value[0]);
+	free(value[1]);
+	vanessa_mpmc_queue_destroy(q);
+
+	/*
+	 * Hand elements between several producers and consumers
+	 */
+	q = vanessa_mpmc_queue_create(64, NULL);
+	if(q == NULL) {
+		die("vanessa_mpmc_queue_create");
+	}
+	for(i = 0; i < NOTHREAD; i++) {
+		if(pthread_create(thread + i, NULL, producer,
+					(void *)i) != 0 ||
+				pthread_create(thread + NOTHREAD + i, NULL,
+					consumer, (void *)i) != 0) {
+			die("pthread_create");
+		}
+	}
+	for(i = 0; i < NOTHREAD * 2; i++) {
+		pthread_join(thread[i], NULL);
+	}
+	for(i = 0; i < NOTHREAD * NOELEMENT; i++) {
+		if(seen[i] != 1) {
+			die("vanessa_mpmc_queue_try_pop_n");
+		}
+	}
+	printf("%lu %ld\n", (unsigned long)nopopped,
+			(long)vanessa_mpmc_queue_length(q));
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_mpmc_queue_destroy(q);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
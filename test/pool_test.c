@@ -0,0 +1,225 @@
+/**********************************************************************
+ * pool_test.c                                             October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <time.h>
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOOBJECT 10000
+#define NOCHURN 1000000
+#define NOCOPY 10000
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return(ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+/*
+ * Insert and remove elements at the front of a list, with or
+ * without a pool, and return the time taken
+ */
+static double churn(vanessa_pool_t *pool) {
+	vanessa_list_t *l;
+	double t;
+	int i;
+
+	l = vanessa_list_create(0, NULL, NULL, NULL, NULL, NULL, NULL);
+	if(l == NULL || vanessa_list_set_pool(l, pool) == NULL) {
+		die("vanessa_list_create");
+	}
+
+	t = now();
+	for(i = 0; i < NOCHURN; i++) {
+		if(vanessa_list_add_element(l, (void *)(size_t)(i + 1))
+				== NULL) {
+			die("vanessa_list_add_element");
+		}
+		if(i % 4 == 3) {
+			vanessa_list_remove_element(l, (void *)(size_t)i);
+			vanessa_list_remove_element(l,
+					(void *)(size_t)(i + 1));
+		}
+	}
+	vanessa_list_destroy(l);
+
+	return(now() - t);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_pool_t *p;
+	vanessa_list_t *a;
+	vanessa_list_t *b;
+	void *obj[NOOBJECT];
+	char *str;
+	size_t noslab;
+	int i;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "pool_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	/*
+	 * Objects are recycled and, if asked, empty slabs released
+	 */
+	printf("Allocating %d objects\n", NOOBJECT);
+	p = vanessa_pool_create(24, VANESSA_POOL_RELEASE);
+	if(p == NULL) {
+		die("vanessa_pool_create");
+	}
+	for(i = 0; i < NOOBJECT; i++) {
+		obj[i] = vanessa_pool_alloc(p);
+		if(obj[i] == NULL) {
+			die("vanessa_pool_alloc");
+		}
+		memset(obj[i], i, 24);
+	}
+	noslab = vanessa_pool_get_slab_count(p);
+	printf("%lu slabs\n", (unsigned long)noslab);
+	for(i = 0; i < NOOBJECT; i += 2) {
+		vanessa_pool_free(p, obj[i]);
+	}
+	for(i = 0; i < NOOBJECT; i += 2) {
+		obj[i] = vanessa_pool_alloc(p);
+	}
+	if(vanessa_pool_get_slab_count(p) != noslab) {
+		die("freed objects were not reused");
+	}
+	for(i = 0; i < NOOBJECT; i++) {
+		vanessa_pool_free(p, obj[i]);
+	}
+	printf("%lu slabs after freeing\n",
+			(unsigned long)vanessa_pool_get_slab_count(p));
+	if(vanessa_pool_get_slab_count(p) != 0) {
+		die("empty slabs were not released");
+	}
+	vanessa_pool_destroy(p);
+
+	/*
+	 * Lists sharing a pool
+	 */
+	printf("Creating Lists sharing a Pool\n");
+	p = vanessa_list_pool_create(0);
+	a = vanessa_list_create(2, VANESSA_DESI, VANESSA_DUPI, VANESSA_DISI,
+			VANESSA_LENI, VANESSA_MATI, NULL);
+	if(p == NULL || a == NULL) {
+		die("vanessa_list_create");
+	}
+	for(i = 0; i < 4; i++) {
+		vanessa_list_add_element(a, &i);
+	}
+	if(vanessa_list_set_pool(a, p) == NULL) {
+		die("vanessa_list_set_pool");
+	}
+	for(; i < 8; i++) {
+		vanessa_list_add_element(a, &i);
+	}
+	b = vanessa_list_duplicate(a);
+	if(b == NULL) {
+		die("vanessa_list_duplicate");
+	}
+	vanessa_pool_destroy(p);
+	i = 6;
+	vanessa_list_remove_element(a, &i);
+	str = vanessa_list_display(a, ',');
+	printf("%s\n", str);
+	free(str);
+	vanessa_list_destroy(a);
+	str = vanessa_list_display(b, ',');
+	printf("%s\n", str);
+	free(str);
+	vanessa_list_destroy(b);
+
+	/*
+	 * A long list without a pool is duplicated into a pool of its own
+	 */
+	a = vanessa_list_create(0, NULL, NULL, NULL, NULL, NULL, NULL);
+	if(a == NULL) {
+		die("vanessa_list_create");
+	}
+	for(i = 0; i < NOCOPY; i++) {
+		if(vanessa_list_add_element(a, (void *)(size_t)(i + 1)) ==
+				NULL) {
+			die("vanessa_list_add_element");
+		}
+	}
+	b = vanessa_list_duplicate(a);
+	if(b == NULL || b->pool == NULL ||
+			vanessa_list_get_count(b) != NOCOPY ||
+			vanessa_pool_get_slab_count(b->pool) * 64 > NOCOPY) {
+		die("vanessa_list_duplicate");
+	}
+	printf("%lu\n", (unsigned long)vanessa_list_get_count(b));
+	vanessa_list_destroy(a);
+	vanessa_list_destroy(b);
+
+	/*
+	 * Compare with malloc
+	 */
+	printf("Churning %d elements\n", NOCHURN);
+	printf("malloc: %.3fs\n", churn(NULL));
+	p = vanessa_list_pool_create(0);
+	printf("pool:   %.3fs\n", churn(p));
+	vanessa_pool_destroy(p);
+
+	/*
+	 * Clean Up
+	 */
+	printf("Cleaning Up\n");
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
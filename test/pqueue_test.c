@@ -0,0 +1,154 @@
+/**********************************************************************
+ * pqueue_test.c                                           October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOELEMENT 10000
+
+static int sort_function(int *a, int *b) {
+	return((*a > *b) - (*a < *b));
+}
+
+#define SORT_FUNCTION (int (*)(void *, void *))sort_function
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_pqueue_t *pq;
+	vanessa_pqueue_elem_t *e[NOELEMENT];
+	int *value;
+	int last;
+	int count;
+	int i;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "pqueue_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	pq = vanessa_pqueue_create(VANESSA_DESTROY_INT, SORT_FUNCTION);
+	if(pq == NULL) {
+		die("vanessa_pqueue_create");
+	}
+	if(vanessa_pqueue_peek(pq) != NULL ||
+			vanessa_pqueue_pop(pq, (void **)&value) != NULL) {
+		die("vanessa_pqueue_pop");
+	}
+
+	/*
+	 * Push keys in random order
+	 */
+	srand(1);
+	for(i = 0; i < NOELEMENT; i++) {
+		value = (int *)malloc(sizeof(int));
+		if(value == NULL) {
+			die("malloc");
+		}
+		*value = rand() % NOELEMENT;
+		e[i] = vanessa_pqueue_push(pq, value);
+		if(e[i] == NULL || vanessa_pqueue_elem_value(e[i]) != value) {
+			die("vanessa_pqueue_push");
+		}
+	}
+
+	/*
+	 * Move every third element to the front, every third to the
+	 * back, and remove the rest of every tenth
+	 */
+	for(i = 0; i < NOELEMENT; i++) {
+		value = (int *)vanessa_pqueue_elem_value(e[i]);
+		switch(i % 3) {
+		case 0:
+			*value = -i;
+			vanessa_pqueue_update(pq, e[i]);
+			break;
+		case 1:
+			*value += NOELEMENT;
+			vanessa_pqueue_update(pq, e[i]);
+			break;
+		default:
+			if(i % 10 == 5) {
+				if(vanessa_pqueue_remove(pq, e[i]) != value) {
+					die("vanessa_pqueue_remove");
+				}
+				free(value);
+			}
+			break;
+		}
+	}
+	if(*(int *)vanessa_pqueue_peek(pq) != -(NOELEMENT - 1) / 3 * 3) {
+		die("vanessa_pqueue_peek");
+	}
+
+	/*
+	 * Pop half of the elements, which should come out in order
+	 */
+	count = vanessa_pqueue_length(pq);
+	last = -NOELEMENT;
+	for(i = 0; i < count / 2; i++) {
+		if(vanessa_pqueue_pop(pq, (void **)&value) == NULL ||
+				*value < last) {
+			die("vanessa_pqueue_pop");
+		}
+		last = *value;
+		free(value);
+	}
+	printf("%d %d %ld\n", count, last, (long)vanessa_pqueue_length(pq));
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_pqueue_destroy(pq);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
@@ -0,0 +1,180 @@
+/**********************************************************************
+ * queue_test.c                                            October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOELEMENT 100000
+#define BATCH 256
+
+/* Elements are passed to e_destroy by reference */
+static void destroy_function(const void *e) {
+	free(*(void **)e);
+}
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_queue_t *q;
+	void *value;
+	void *batch[BATCH];
+	size_t n;
+	long i;
+	long j;
+	long k;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "queue_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	q = vanessa_queue_create(NULL);
+	if(q == NULL) {
+		die("vanessa_queue_create");
+	}
+	if(vanessa_queue_pop(q, &value) != NULL ||
+			vanessa_queue_peek_first(q) != NULL ||
+			vanessa_queue_peek_last(q) != NULL) {
+		die("empty queue");
+	}
+
+	/*
+	 * Push two for every one popped, so that the queue wraps
+	 * around and grows, then drain it so that it shrinks
+	 */
+	for(i = 1, j = 1; i <= NOELEMENT; i++) {
+		if(vanessa_queue_push(q, (void *)i) == NULL) {
+			die("vanessa_queue_push");
+		}
+		if(vanessa_queue_peek_first(q) != (void *)i ||
+				vanessa_queue_peek_last(q) != (void *)j) {
+			die("vanessa_queue_peek");
+		}
+		if(i % 2 == 0) {
+			if(vanessa_queue_pop(q, &value) == NULL ||
+					value != (void *)j++) {
+				die("vanessa_queue_pop");
+			}
+		}
+	}
+	printf("%ld\n", (long)vanessa_queue_length(q));
+	while(vanessa_queue_pop(q, &value) != NULL) {
+		if(value != (void *)j++) {
+			die("vanessa_queue_pop");
+		}
+	}
+	printf("%ld %ld\n", (long)vanessa_queue_length(q), j - 1);
+	vanessa_queue_destroy(q);
+
+	q = vanessa_queue_create(NULL);
+	if(q == NULL || vanessa_queue_pop_n(q, batch, BATCH) != 0) {
+		die("vanessa_queue_create");
+	}
+
+	/*
+	 * Push and pop in batches of varying size, more being pushed
+	 * than popped, then drain the queue
+	 */
+	for(i = 1, j = 1; i <= NOELEMENT; ) {
+		n = (i * 7) % BATCH + 1;
+		for(k = 0; k < (long)n; k++) {
+			batch[k] = (void *)(i + k);
+		}
+		if(vanessa_queue_push_n(q, batch, n) != q) {
+			die("vanessa_queue_push_n");
+		}
+		i += n;
+		n = vanessa_queue_pop_n(q, batch, n * 2 / 3);
+		for(k = 0; k < (long)n; k++) {
+			if(batch[k] != (void *)j++) {
+				die("vanessa_queue_pop_n");
+			}
+		}
+		if(vanessa_queue_length(q) != i - j) {
+			die("vanessa_queue_length");
+		}
+	}
+	while((n = vanessa_queue_pop_n(q, batch, BATCH)) > 0) {
+		for(k = 0; k < (long)n; k++) {
+			if(batch[k] != (void *)j++) {
+				die("vanessa_queue_pop_n");
+			}
+		}
+	}
+	printf("%ld %ld\n", (long)vanessa_queue_length(q), j - 1);
+	vanessa_queue_destroy(q);
+
+	/*
+	 * Elements left in the queue are destroyed with it
+	 */
+	q = vanessa_queue_create(destroy_function);
+	if(q == NULL) {
+		die("vanessa_queue_create");
+	}
+	for(i = 0; i < 100; i++) {
+		value = malloc(16);
+		if(value == NULL || vanessa_queue_push(q, value) == NULL) {
+			die("vanessa_queue_push");
+		}
+		if(i % 3 == 0) {
+			vanessa_queue_pop(q, &value);
+			free(value);
+		}
+	}
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_queue_destroy(q);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
@@ -0,0 +1,225 @@
+/**********************************************************************
+ * shard_cache_test.c                                      October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <pthread.h>
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define CAPACITY 1000
+#define NOSEGMENT 16
+#define NOTHREAD 8
+#define NOKEY 2000
+#define NOITERATION 100000
+
+static size_t hash_function(int *i) {
+	return((size_t)*i * 2654435761UL);
+}
+
+/* Only the low bits vary for small keys */
+static size_t identity_function(int *i) {
+	return((size_t)*i);
+}
+
+static int match_function(int *a, int *b) {
+	return(*a != *b);
+}
+
+#define HASH_FUNCTION (size_t (*)(void *))hash_function
+#define IDENTITY_FUNCTION (size_t (*)(void *))identity_function
+#define MATCH_FUNCTION (int (*)(void *, void *))match_function
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+/*
+ * Look up keys, mostly from a small hot set, adding those that miss
+ */
+static void *worker(void *data) {
+	vanessa_shard_cache_t *c = (vanessa_shard_cache_t *)data;
+	unsigned int seed = (unsigned int)pthread_self();
+	int i;
+	int key;
+	int *p;
+
+	for(i = 0; i < NOITERATION; i++) {
+		seed = seed * 1103515245 + 12345;
+		key = (seed >> 16) % (i % 4 ? CAPACITY / 2 : NOKEY);
+		p = (int *)vanessa_shard_cache_get_element(c, &key);
+		if(p != NULL) {
+			if(*p != key) {
+				die("vanessa_shard_cache_get_element");
+			}
+			free(p);
+		}
+		else if(vanessa_shard_cache_add_element(c, &key) == NULL) {
+			die("vanessa_shard_cache_add_element");
+		}
+	}
+
+	return(NULL);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_shard_cache_t *c;
+	pthread_t thread[NOTHREAD];
+	unsigned long long hits;
+	unsigned long long misses;
+	int i;
+	int *p;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "shard_cache_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	/*
+	 * LRU order, with buffered promotions applied before eviction
+	 */
+	printf("Creating Shard Cache\n");
+	c = vanessa_shard_cache_create(4, 1, VANESSA_DESTROY_INT,
+			VANESSA_DUPLICATE_INT, MATCH_FUNCTION, HASH_FUNCTION);
+	if(c == NULL) {
+		die("vanessa_shard_cache_create");
+	}
+	printf("Inserting Elements into Shard Cache\n");
+	for(i = 0; i < 4; i++) {
+		if(vanessa_shard_cache_add_element(c, &i) == NULL) {
+			die("vanessa_shard_cache_add_element");
+		}
+	}
+	i = 0;
+	p = (int *)vanessa_shard_cache_get_element(c, &i);
+	if(p == NULL || *p != 0) {
+		die("vanessa_shard_cache_get_element");
+	}
+	free(p);
+	i = 4;
+	if(vanessa_shard_cache_add_element(c, &i) == NULL) {
+		die("vanessa_shard_cache_add_element");
+	}
+	printf("%lu\n", (unsigned long)vanessa_shard_cache_get_count(c));
+	i = 0;
+	p = (int *)vanessa_shard_cache_get_element(c, &i);
+	if(p == NULL) {
+		die("promoted element was evicted");
+	}
+	free(p);
+	i = 1;
+	if(vanessa_shard_cache_get_element(c, &i) != NULL) {
+		die("least recently used element was not evicted");
+	}
+	printf("Removing element \"0\"\n");
+	i = 0;
+	vanessa_shard_cache_remove_element(c, &i);
+	if(vanessa_shard_cache_get_element(c, &i) != NULL) {
+		die("vanessa_shard_cache_remove_element");
+	}
+	printf("%lu\n", (unsigned long)vanessa_shard_cache_get_count(c));
+	vanessa_shard_cache_destroy(c);
+
+	/*
+	 * Small hashes are spread over the segments, rather than all
+	 * being evicted from one
+	 */
+	c = vanessa_shard_cache_create(NOSEGMENT * 4, NOSEGMENT,
+			VANESSA_DESTROY_INT, VANESSA_DUPLICATE_INT,
+			MATCH_FUNCTION, IDENTITY_FUNCTION);
+	if(c == NULL) {
+		die("vanessa_shard_cache_create");
+	}
+	for(i = 0; i < NOSEGMENT * 4; i++) {
+		if(vanessa_shard_cache_add_element(c, &i) == NULL) {
+			die("vanessa_shard_cache_add_element");
+		}
+	}
+	printf("%lu\n", (unsigned long)vanessa_shard_cache_get_count(c));
+	if(vanessa_shard_cache_get_count(c) < NOSEGMENT * 2) {
+		die("small hashes share a segment");
+	}
+	vanessa_shard_cache_destroy(c);
+
+	/*
+	 * Concurrent use
+	 */
+	printf("Running %d threads\n", NOTHREAD);
+	c = vanessa_shard_cache_create(CAPACITY, NOSEGMENT,
+			VANESSA_DESTROY_INT, VANESSA_DUPLICATE_INT,
+			MATCH_FUNCTION, HASH_FUNCTION);
+	if(c == NULL) {
+		die("vanessa_shard_cache_create");
+	}
+	for(i = 0; i < NOTHREAD; i++) {
+		if(pthread_create(thread + i, NULL, worker, c) != 0) {
+			die("pthread_create");
+		}
+	}
+	for(i = 0; i < NOTHREAD; i++) {
+		pthread_join(thread[i], NULL);
+	}
+	if(vanessa_shard_cache_get_count(c) > CAPACITY + NOSEGMENT) {
+		die("vanessa_shard_cache_get_count exceeds capacity");
+	}
+	hits = vanessa_shard_cache_get_hits(c);
+	misses = vanessa_shard_cache_get_misses(c);
+	if(hits + misses != (unsigned long long)NOTHREAD * NOITERATION) {
+		die("hits and misses do not add up");
+	}
+	printf("Hit ratio: %d%%\n", (int)(hits * 100 / (hits + misses)));
+	vanessa_shard_cache_destroy(c);
+
+	/*
+	 * Clean Up
+	 */
+	printf("Cleaning Up\n");
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
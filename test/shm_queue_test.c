@@ -0,0 +1,210 @@
+/**********************************************************************
+ * shm_queue_test.c                                        October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOCHILD 2
+#define NOMESSAGE 100000
+#define SLOT_SIZE 32
+
+typedef struct {
+	int child;
+	int seq;
+	char pad[SLOT_SIZE - 2 * sizeof(int)];
+} message_t;
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+/* Messages vary in length, and are filled according to their number */
+static size_t message_len(int seq) {
+	return(2 * sizeof(int) + seq % (SLOT_SIZE - 2 * sizeof(int) + 1));
+}
+
+/* Push messages, waiting for room, and exit */
+static void producer(vanessa_shm_queue_t *q, int child) {
+	message_t m;
+	size_t len;
+
+	for(m.seq = 0; m.seq < NOMESSAGE; m.seq++) {
+		m.child = child;
+		len = message_len(m.seq);
+		memset(m.pad, m.seq, len - 2 * sizeof(int));
+		if(vanessa_shm_queue_push(q, &m, len, -1) == NULL) {
+			_exit(1);
+		}
+	}
+
+	_exit(0);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_shm_queue_t *q;
+	vanessa_shm_queue_t *q2;
+	message_t m;
+	char buf[SLOT_SIZE + 1];
+	int next[NOCHILD];
+	pid_t pid;
+	ssize_t len;
+	size_t i;
+	int status;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "shm_queue_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	/*
+	 * Messages are limited to the slot size, and the queue refuses
+	 * messages when full
+	 */
+	q = vanessa_shm_queue_create(3, SLOT_SIZE);
+	if(q == NULL) {
+		die("vanessa_shm_queue_create");
+	}
+	memset(buf, 'x', sizeof(buf));
+	if(vanessa_shm_queue_try_push(q, buf, SLOT_SIZE + 1) != NULL ||
+			errno != EMSGSIZE) {
+		die("vanessa_shm_queue_try_push");
+	}
+	for(i = 0; i < 4; i++) {
+		if(vanessa_shm_queue_try_push(q, buf, i) == NULL) {
+			die("vanessa_shm_queue_try_push");
+		}
+	}
+	if(vanessa_shm_queue_try_push(q, buf, 1) != NULL ||
+			errno != EAGAIN ||
+			vanessa_shm_queue_push(q, buf, 1, 20) != NULL ||
+			errno != ETIMEDOUT ||
+			vanessa_shm_queue_length(q) != 4) {
+		die("vanessa_shm_queue_push");
+	}
+
+	/*
+	 * A queue opened from the file descriptor shares the messages
+	 */
+	if(vanessa_shm_queue_fd(q) >= 0) {
+		q2 = vanessa_shm_queue_open(dup(vanessa_shm_queue_fd(q)));
+		if(q2 == NULL || vanessa_shm_queue_length(q2) != 4) {
+			die("vanessa_shm_queue_open");
+		}
+		if(vanessa_shm_queue_try_pop(q2, buf) != 0) {
+			die("vanessa_shm_queue_try_pop");
+		}
+		vanessa_shm_queue_destroy(q2);
+	}
+	else if(vanessa_shm_queue_try_pop(q, buf) != 0) {
+		die("vanessa_shm_queue_try_pop");
+	}
+	for(i = 1; i < 4; i++) {
+		if(vanessa_shm_queue_pop(q, buf, -1) != (ssize_t)i) {
+			die("vanessa_shm_queue_pop");
+		}
+	}
+	if(vanessa_shm_queue_try_pop(q, buf) != -1 || errno != EAGAIN ||
+			vanessa_shm_queue_pop(q, buf, 20) != -1 ||
+			errno != ETIMEDOUT) {
+		die("vanessa_shm_queue_pop");
+	}
+	vanessa_shm_queue_destroy(q);
+
+	/*
+	 * Forked producers fill a small queue faster than it is emptied,
+	 * and wait for room, while this process waits for messages
+	 */
+	q = vanessa_shm_queue_create(8, SLOT_SIZE);
+	if(q == NULL) {
+		die("vanessa_shm_queue_create");
+	}
+	for(i = 0; i < NOCHILD; i++) {
+		pid = fork();
+		if(pid < 0) {
+			die("fork");
+		}
+		if(pid == 0) {
+			producer(q, i);
+		}
+		next[i] = 0;
+	}
+	for(i = 0; i < NOCHILD * NOMESSAGE; i++) {
+		len = vanessa_shm_queue_pop(q, &m, -1);
+		if(len < (ssize_t)(2 * sizeof(int)) || m.child < 0 ||
+				m.child >= NOCHILD ||
+				m.seq != next[m.child]++ ||
+				(size_t)len != message_len(m.seq)) {
+			die("vanessa_shm_queue_pop");
+		}
+		for(len -= 2 * sizeof(int); len > 0; len--) {
+			if(m.pad[len - 1] != (char)m.seq) {
+				die("vanessa_shm_queue_pop");
+			}
+		}
+	}
+	for(i = 0; i < NOCHILD; i++) {
+		if(wait(&status) < 0 || !WIFEXITED(status) ||
+				WEXITSTATUS(status) != 0) {
+			die("producer");
+		}
+	}
+	printf("%d %ld\n", next[0] + next[1],
+			(long)vanessa_shm_queue_length(q));
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_shm_queue_destroy(q);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
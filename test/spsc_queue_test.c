@@ -0,0 +1,157 @@
+/**********************************************************************
+ * spsc_queue_test.c                                       October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <pthread.h>
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOELEMENT 1000000
+#define BATCH 16
+
+static void destroy_function(const void *e) {
+	free(*(void **)e);
+}
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+/* Push 1..NOELEMENT, alternately one at a time and in batches */
+static void *producer(void *data) {
+	vanessa_spsc_queue_t *q = (vanessa_spsc_queue_t *)data;
+	void *value[BATCH];
+	size_t i = 1;
+	size_t n;
+	size_t j;
+
+	while(i <= NOELEMENT) {
+		if(i % 2) {
+			if(vanessa_spsc_queue_push(q, (void *)i) != NULL) {
+				i++;
+			}
+			continue;
+		}
+		for(j = 0; j < BATCH && i + j <= NOELEMENT; j++) {
+			value[j] = (void *)(i + j);
+		}
+		n = vanessa_spsc_queue_push_n(q, value, j);
+		i += n;
+	}
+
+	return(NULL);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_spsc_queue_t *q;
+	pthread_t thread;
+	void *value[BATCH];
+	size_t expect = 1;
+	size_t n;
+	size_t i;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "spsc_queue_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	/*
+	 * Capacity is rounded up, and the queue refuses elements when full
+	 */
+	q = vanessa_spsc_queue_create(3, destroy_function);
+	if(q == NULL) {
+		die("vanessa_spsc_queue_create");
+	}
+	for(i = 0; i < 4; i++) {
+		value[i] = malloc(16);
+		if(value[i] == NULL) {
+			die("malloc");
+		}
+	}
+	if(vanessa_spsc_queue_push_n(q, value, 4) != 4 ||
+			vanessa_spsc_queue_push(q, value[0]) != NULL ||
+			vanessa_spsc_queue_length(q) != 4) {
+		die("vanessa_spsc_queue_push");
+	}
+	if(vanessa_spsc_queue_pop(q, value) == NULL) {
+		die("vanessa_spsc_queue_pop");
+	}
+	free(value[0]);
+	vanessa_spsc_queue_destroy(q);
+
+	/*
+	 * Hand elements from one thread to another, in order
+	 */
+	q = vanessa_spsc_queue_create(256, NULL);
+	if(q == NULL) {
+		die("vanessa_spsc_queue_create");
+	}
+	if(pthread_create(&thread, NULL, producer, q) != 0) {
+		die("pthread_create");
+	}
+	while(expect <= NOELEMENT) {
+		n = vanessa_spsc_queue_pop_n(q, value, expect % 3 ? BATCH : 1);
+		for(i = 0; i < n; i++) {
+			if(value[i] != (void *)expect++) {
+				die("vanessa_spsc_queue_pop_n");
+			}
+		}
+	}
+	pthread_join(thread, NULL);
+	printf("%lu %ld\n", (unsigned long)(expect - 1),
+			(long)vanessa_spsc_queue_length(q));
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_spsc_queue_destroy(q);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
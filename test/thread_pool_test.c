@@ -0,0 +1,195 @@
+/**********************************************************************
+ * thread_pool_test.c                                      October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOWORKER 4
+#define NOTASK 1000
+#define NOELEMENT 100000
+#define LEAF 64
+
+typedef struct {
+	vanessa_thread_pool_t *tp;
+	long sum;
+	int count;
+} total_t;
+
+typedef struct {
+	long first;
+	long last;
+} range_t;
+
+static range_t range[NOELEMENT];
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+static int count_function(void *e, void *data) {
+	__atomic_add_fetch(&((total_t *)data)->count, 1, __ATOMIC_RELAXED);
+	return(e == NULL ? -1 : 0);
+}
+
+/*
+ * Sum the numbers in a range, splitting it in two and submitting
+ * the halves as new tasks until it is small
+ */
+static int sum_function(void *e, void *data) {
+	total_t *total = (total_t *)data;
+	range_t *r = (range_t *)e;
+	long mid;
+	long sum = 0;
+	long i;
+
+	__atomic_add_fetch(&total->count, 1, __ATOMIC_RELAXED);
+
+	if(r->last - r->first > LEAF) {
+		mid = (r->first + r->last) / 2;
+		range[mid].first = r->first;
+		range[mid].last = mid;
+		range[mid + 1].first = mid;
+		range[mid + 1].last = r->last;
+		if(vanessa_thread_pool_submit(total->tp, sum_function,
+					range + mid, data) == NULL ||
+				vanessa_thread_pool_submit(total->tp,
+					sum_function, range + mid + 1,
+					data) == NULL) {
+			return(-1);
+		}
+		return(0);
+	}
+
+	for(i = r->first; i < r->last; i++) {
+		sum += i;
+	}
+	__atomic_add_fetch(&total->sum, sum, __ATOMIC_RELAXED);
+
+	return(0);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_thread_pool_t *tp;
+	range_t all;
+	total_t total;
+	int i;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "thread_pool_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	tp = vanessa_thread_pool_create(NOWORKER);
+	if(tp == NULL) {
+		die("vanessa_thread_pool_create");
+	}
+	memset(&total, 0, sizeof(total));
+	total.tp = tp;
+
+	/*
+	 * Tasks submitted from outside the pool
+	 */
+	for(i = 0; i < NOTASK; i++) {
+		if(vanessa_thread_pool_submit(tp, count_function, &total,
+					&total) == NULL) {
+			die("vanessa_thread_pool_submit");
+		}
+	}
+	if(vanessa_thread_pool_wait(tp) != 0 || total.count != NOTASK ||
+			vanessa_thread_pool_length(tp) != 0) {
+		die("vanessa_thread_pool_wait");
+	}
+
+	/*
+	 * A failing task is reported by the next wait only
+	 */
+	if(vanessa_thread_pool_submit(tp, count_function, NULL,
+				&total) == NULL ||
+			vanessa_thread_pool_wait(tp) != -1 ||
+			vanessa_thread_pool_wait(tp) != 0) {
+		die("vanessa_thread_pool_wait");
+	}
+
+	/*
+	 * Tasks which submit more tasks to their own workers, which
+	 * other workers steal
+	 */
+	total.count = 0;
+	all.first = 0;
+	all.last = NOELEMENT;
+	if(vanessa_thread_pool_submit(tp, sum_function, &all,
+				&total) == NULL ||
+			vanessa_thread_pool_wait(tp) != 0 ||
+			total.sum != (long)NOELEMENT * (NOELEMENT - 1) / 2) {
+		die("vanessa_thread_pool_wait");
+	}
+	printf("%ld %d\n", total.sum, total.count);
+
+	/*
+	 * Tasks still queued are run before the pool is destroyed
+	 */
+	total.count = 0;
+	for(i = 0; i < NOTASK; i++) {
+		if(vanessa_thread_pool_submit(tp, count_function, &total,
+					&total) == NULL) {
+			die("vanessa_thread_pool_submit");
+		}
+	}
+	vanessa_thread_pool_destroy(tp);
+	if(total.count != NOTASK) {
+		die("vanessa_thread_pool_destroy");
+	}
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
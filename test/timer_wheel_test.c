@@ -0,0 +1,279 @@
+/**********************************************************************
+ * timer_wheel_test.c                                      October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOTIMER 1000000
+#define START 1000000UL
+
+#define PENDING   0
+#define EXPIRED   1
+#define CANCELLED 2
+
+struct timer_elem {
+	unsigned long expire;
+	vanessa_timer_wheel_timer_t *t;
+	int state;
+	struct timer_elem *cancel;
+	struct timer_elem *schedule;
+};
+
+struct expire_data {
+	vanessa_timer_wheel_t *tw;
+	unsigned long lo;
+	unsigned long hi;
+	unsigned long last;
+	size_t expired;
+};
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+static void expire_function_free(void *e, void *data) {
+	free(e);
+	(*(size_t *)data)++;
+}
+
+/* Spread expiry times over all levels of the wheel, and beyond */
+static unsigned long expire_function(int i) {
+	return(START + ((((unsigned long)i * 2654435761UL) & 0xffffffffUL) >>
+				(i % 4 * 8)));
+}
+
+/*
+ * Check that timers expire in order, during the call to advance
+ * that passes their expiry time, and act on other timers
+ */
+static void expire_function_check(void *e, void *data) {
+	struct timer_elem *te = (struct timer_elem *)e;
+	struct expire_data *d = (struct expire_data *)data;
+
+	if(te->state != PENDING) {
+		die("expired twice");
+	}
+	if(te->expire <= d->lo || te->expire > d->hi) {
+		die("expired at the wrong time");
+	}
+	if(te->expire < d->last) {
+		die("expired out of order");
+	}
+	te->state = EXPIRED;
+	d->last = te->expire;
+	d->expired++;
+
+	if(te->cancel != NULL) {
+		if(vanessa_timer_wheel_cancel(d->tw, te->cancel->t) !=
+				te->cancel) {
+			die("vanessa_timer_wheel_cancel");
+		}
+		te->cancel->state = CANCELLED;
+	}
+	if(te->schedule != NULL) {
+		te->schedule->t = vanessa_timer_wheel_schedule(d->tw,
+				te->schedule, te->schedule->expire);
+		if(te->schedule->t == NULL) {
+			die("vanessa_timer_wheel_schedule");
+		}
+	}
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_timer_wheel_t *tw;
+	struct timer_elem *te;
+	struct timer_elem *p;
+	struct expire_data d;
+	unsigned long now;
+	unsigned long next;
+	size_t expected;
+	int i;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "timer_wheel_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	te = (struct timer_elem *)calloc(NOTIMER, sizeof(struct timer_elem));
+	if(te == NULL) {
+		die("calloc");
+	}
+
+	memset(&d, 0, sizeof(d));
+	d.tw = tw = vanessa_timer_wheel_create(expire_function_check, &d,
+			NULL, START);
+	if(tw == NULL) {
+		die("vanessa_timer_wheel_create");
+	}
+	if(vanessa_timer_wheel_next_event(tw, &next) != -1) {
+		die("empty wheel");
+	}
+
+	/*
+	 * Schedule many timers, then cancel and reschedule some of them
+	 */
+	for(i = 0; i < NOTIMER; i++) {
+		te[i].expire = expire_function(i);
+		te[i].t = vanessa_timer_wheel_schedule(tw, te + i,
+				te[i].expire);
+		if(te[i].t == NULL) {
+			die("vanessa_timer_wheel_schedule");
+		}
+	}
+	expected = NOTIMER;
+	for(i = 0; i < NOTIMER; i += 3) {
+		if(vanessa_timer_wheel_cancel(tw, te[i].t) != te + i) {
+			die("vanessa_timer_wheel_cancel");
+		}
+		te[i].state = CANCELLED;
+		expected--;
+	}
+	for(i = 1; i < NOTIMER; i += 6) {
+		te[i].expire = START + (te[i].expire - START) / 2 + 1;
+		vanessa_timer_wheel_reschedule(tw, te[i].t, te[i].expire);
+	}
+	if(vanessa_timer_wheel_get_count(tw) != expected) {
+		die("vanessa_timer_wheel_get_count");
+	}
+
+	/*
+	 * Advance to, or a little past, each event until none remain.
+	 * The tick the wheel was created at has yet to pass.
+	 */
+	d.hi = START - 1;
+	while(vanessa_timer_wheel_next_event(tw, &next) == 0) {
+		if(next <= d.hi) {
+			die("vanessa_timer_wheel_next_event");
+		}
+		d.lo = d.hi;
+		d.hi = next + next % 3;
+		expected -= vanessa_timer_wheel_advance(tw, d.hi);
+		if(vanessa_timer_wheel_get_count(tw) != expected) {
+			die("vanessa_timer_wheel_advance");
+		}
+	}
+	for(i = 0; i < NOTIMER; i++) {
+		if(te[i].state != (i % 3 ? EXPIRED : CANCELLED)) {
+			die("timer did not expire");
+		}
+	}
+	printf("%lu %lu\n", (unsigned long)d.expired,
+			(unsigned long)vanessa_timer_wheel_get_count(tw));
+
+	/*
+	 * Timers may be cancelled and scheduled as others expire,
+	 * including one due at the same tick, and one whose expiry
+	 * time has already passed, which expires at the next tick
+	 */
+	now = d.hi;
+	memset(te, 0, 4 * sizeof(struct timer_elem));
+	te[0].expire = te[1].expire = now + 10;
+	te[2].expire = now + 5;
+	te[3].expire = now + 11;
+	te[0].cancel = te + 1;
+	te[0].schedule = te + 2;
+	for(i = 0; i < 4; i += i == 1 ? 2 : 1) {
+		te[i].t = vanessa_timer_wheel_schedule(tw, te + i,
+				te[i].expire);
+		if(te[i].t == NULL) {
+			die("vanessa_timer_wheel_schedule");
+		}
+	}
+	d.lo = now + 9;
+	d.hi = now + 10;
+	d.last = 0;
+	if(vanessa_timer_wheel_advance(tw, d.hi) != 1 ||
+			te[0].state != EXPIRED || te[1].state != CANCELLED ||
+			te[2].state != PENDING ||
+			vanessa_timer_wheel_get_count(tw) != 2 ||
+			vanessa_timer_wheel_next_event(tw, &next) != 0 ||
+			next != now + 11) {
+		die("expire action");
+	}
+	te[2].expire = now + 11;
+	d.lo = d.hi;
+	d.hi = now + 11;
+	if(vanessa_timer_wheel_advance(tw, d.hi) != 2 ||
+			te[2].state != EXPIRED || te[3].state != EXPIRED ||
+			vanessa_timer_wheel_get_count(tw) != 0) {
+		die("expire action");
+	}
+	vanessa_timer_wheel_destroy(tw);
+	free(te);
+
+	/*
+	 * Elements of timers left in the wheel are destroyed with it
+	 */
+	tw = vanessa_timer_wheel_create(expire_function_free, &expected,
+			free, 0);
+	if(tw == NULL) {
+		die("vanessa_timer_wheel_create");
+	}
+	for(i = 0; i < 1000; i++) {
+		p = (struct timer_elem *)malloc(sizeof(struct timer_elem));
+		if(p == NULL || vanessa_timer_wheel_schedule(tw, p,
+					expire_function(i)) == NULL) {
+			die("vanessa_timer_wheel_schedule");
+		}
+	}
+	expected = 0;
+	if(vanessa_timer_wheel_advance(tw, START + 1000) != expected) {
+		die("vanessa_timer_wheel_advance");
+	}
+	printf("%lu %lu\n", (unsigned long)expected,
+			(unsigned long)vanessa_timer_wheel_get_count(tw));
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_timer_wheel_destroy(tw);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
@@ -0,0 +1,166 @@
+/**********************************************************************
+ * ttl_hash_test.c                                         October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOBUCKET 31
+#define NOELEMENT 1000
+#define START 1000000UL
+
+static size_t hash_function(int *i) {
+	return(*i%NOBUCKET);
+}
+
+static int match_function(int *a, int *b) {
+	return(*a != *b);
+}
+
+#define HASH_FUNCTION (size_t (*)(void *))hash_function
+#define MATCH_FUNCTION (int (*)(void *, void *))match_function
+
+/* Spread times to live over all levels of the wheel */
+static unsigned long ttl_function(int i) {
+	return((((unsigned long)i * 2654435761UL) & 0xffffffffUL) >>
+			(i % 4 * 8));
+}
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_ttl_hash_t *h;
+	unsigned long now;
+	unsigned long step;
+	size_t expected;
+	size_t expired;
+	int i;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "ttl_hash_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	/*
+	 * Create a ttl hash
+	 */
+	printf("Creating TTL Hash\n");
+	h = vanessa_ttl_hash_create(NOBUCKET, VANESSA_DESTROY_INT,
+			VANESSA_DUPLICATE_INT, MATCH_FUNCTION,
+			HASH_FUNCTION, START);
+	if (h == NULL) {
+		die("vanessa_ttl_hash_create");
+	}
+
+	/*
+	 * Insert some elements
+	 */
+	printf("Inserting %d Elements into TTL Hash\n", NOELEMENT);
+	for (i = 0; i < NOELEMENT; i++) {
+		if (vanessa_ttl_hash_add_element(h, &i, START,
+					ttl_function(i)) == NULL) {
+			die("vanessa_ttl_hash_add_element");
+		}
+	}
+	printf("%lu\n", (unsigned long)vanessa_ttl_hash_get_count(h));
+
+	/*
+	 * Lazy expiry
+	 */
+	printf("Looking up expired element \"4\"\n");
+	i = 4;
+	if (vanessa_ttl_hash_get_element(h, &i, START + ttl_function(i))
+			!= NULL) {
+		die("vanessa_ttl_hash_get_element returned expired element");
+	}
+	if (vanessa_ttl_hash_get_count(h) != NOELEMENT - 1) {
+		die("vanessa_ttl_hash_get_element did not expire element");
+	}
+	printf("Looking up live element \"5\"\n");
+	i = 5;
+	if (vanessa_ttl_hash_get_element(h, &i, START + ttl_function(i) - 1)
+			== NULL) {
+		die("vanessa_ttl_hash_get_element");
+	}
+
+	/*
+	 * Advance the clock in irregular steps, checking that exactly
+	 * the elements that should have expired have expired
+	 */
+	printf("Advancing the clock\n");
+	for (now = START, step = 1; now < START + 0xffffffffUL; step *= 3) {
+		now += step;
+		expired = vanessa_ttl_hash_advance(h, now);
+		expected = 0;
+		for (i = 0; i < NOELEMENT; i++) {
+			if (i != 4 && START + ttl_function(i) > now) {
+				expected++;
+			}
+		}
+		if (vanessa_ttl_hash_get_count(h) != expected) {
+			fprintf(stderr, "now=%lu count=%lu expected=%lu\n",
+				now, (unsigned long)vanessa_ttl_hash_get_count(h),
+				(unsigned long)expected);
+			die("vanessa_ttl_hash_advance");
+		}
+		printf("%lu: expired %lu, %lu remain\n", now - START,
+				(unsigned long)expired,
+				(unsigned long)expected);
+	}
+
+	/*
+	 * Clean Up
+	 */
+	printf("Cleaning Up\n");
+	vanessa_ttl_hash_destroy(h);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
@@ -0,0 +1,166 @@
+/**********************************************************************
+ * ulist_test.c                                            October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOELEMENT 10000
+
+static int sort_function(int *a, int *b) {
+	return((*a > *b) - (*a < *b));
+}
+
+#define SORT_FUNCTION (int (*)(void *, void *))sort_function
+
+static int check_order(void *e, void *data) {
+	int *prev = (int *)data;
+
+	if(*(int *)e < *prev) {
+		return(-1);
+	}
+	*prev = *(int *)e;
+
+	return(0);
+}
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	vanessa_ulist_t *l;
+	vanessa_ulist_t *d;
+	char *str;
+	int prev;
+	int i;
+	int *p;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "ulist_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	/*
+	 * Unsorted list, elements are appended
+	 */
+	l = vanessa_ulist_create(VANESSA_DESTROY_INT, VANESSA_DUPLICATE_INT,
+			VANESSA_DISPLAY_INT, VANESSA_LENGTH_INT, NULL, NULL);
+	if(l == NULL) {
+		die("vanessa_ulist_create");
+	}
+	for(i = 0; i < 40; i++) {
+		if(vanessa_ulist_add_element(l, &i) == NULL) {
+			die("vanessa_ulist_add_element");
+		}
+	}
+	str = vanessa_ulist_display(l, ',');
+	if(str == NULL) {
+		die("vanessa_ulist_display");
+	}
+	printf("%s\n", str);
+	free(str);
+	vanessa_ulist_destroy(l);
+
+	/*
+	 * Sorted list, inserted out of order so that nodes are split
+	 */
+	l = vanessa_ulist_create(VANESSA_DESTROY_INT, VANESSA_DUPLICATE_INT,
+			VANESSA_DISPLAY_INT, VANESSA_LENGTH_INT,
+			VANESSA_MATCH_INT, SORT_FUNCTION);
+	if(l == NULL) {
+		die("vanessa_ulist_create");
+	}
+	for(i = 0; i < NOELEMENT; i++) {
+		int j = (int)((i * 7919L) % NOELEMENT);
+		if(vanessa_ulist_add_element(l, &j) == NULL) {
+			die("vanessa_ulist_add_element");
+		}
+	}
+	prev = -1;
+	if(vanessa_ulist_iterate(l, check_order, &prev) < 0) {
+		die("vanessa_ulist_iterate");
+	}
+
+	/* Remove all but every tenth element, so that nodes are merged */
+	for(i = 0; i < NOELEMENT; i++) {
+		if(i % 10) {
+			vanessa_ulist_remove_element(l, &i);
+		}
+	}
+	for(i = 0; i < NOELEMENT; i++) {
+		p = (int *)vanessa_ulist_get_element(l, &i);
+		if((i % 10 == 0) != (p != NULL && *p == i)) {
+			die("vanessa_ulist_get_element");
+		}
+	}
+	printf("%lu\n", (unsigned long)vanessa_ulist_get_count(l));
+
+	d = vanessa_ulist_duplicate(l);
+	if(d == NULL) {
+		die("vanessa_ulist_duplicate");
+	}
+	vanessa_ulist_destroy(l);
+	for(i = 100; i < NOELEMENT; i++) {
+		vanessa_ulist_remove_element(d, &i);
+	}
+	str = vanessa_ulist_display(d, ',');
+	if(str == NULL) {
+		die("vanessa_ulist_display");
+	}
+	printf("%s\n", str);
+	free(str);
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_ulist_destroy(d);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}
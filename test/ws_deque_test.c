@@ -0,0 +1,185 @@
+/**********************************************************************
+ * ws_deque_test.c                                         October 2026
+ * Simon Horman                                      horms@verge.net.au
+ *
+ * vanessa_adt
+ * Library of Abstract Data Types
+ * Copyright (C) 1999-2008  Simon Horman <horms@verge.net.au>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307 USA
+ *
+ **********************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <vanessa_adt.h>
+#include <vanessa_logger.h>
+
+#define NOTHIEF 3
+#define NOELEMENT 200000
+
+static vanessa_ws_deque_t *d;
+static unsigned char seen[NOELEMENT];
+static size_t notaken;
+
+static void destroy_function(const void *e) {
+	free(*(void **)e);
+}
+
+static void die(const char *str) {
+	VANESSA_LOGGER_DEBUG(str);
+	fprintf(stderr, "Fatal error: %s. Exiting.\n", str);
+	exit(-1);
+}
+
+static void take(void *value) {
+	size_t v = (size_t)value - 1;
+
+	if(v >= NOELEMENT || __atomic_add_fetch(seen + v, 1,
+				__ATOMIC_RELAXED) != 1) {
+		die("element taken twice");
+	}
+	__atomic_add_fetch(&notaken, 1, __ATOMIC_RELAXED);
+}
+
+/* Steal until every element has been taken */
+static void *thief(void *data) {
+	void *value;
+
+	while(__atomic_load_n(&notaken, __ATOMIC_RELAXED) < NOELEMENT) {
+		switch(vanessa_ws_deque_steal(d, &value)) {
+		case 1:
+			take(value);
+			break;
+		case 0:
+			sched_yield();
+			break;
+		}
+	}
+
+	return(data);
+}
+
+
+/**********************************************************************
+ * Muriel the main function
+ **********************************************************************/
+
+int main(void)
+{
+	vanessa_logger_t *vl;
+	pthread_t thread[NOTHIEF];
+	void *value;
+	size_t i;
+
+	/*
+	 * Open logger to filehandle stderr
+	 */
+	vl = vanessa_logger_openlog_filehandle(stderr,
+					       "ws_deque_test",
+					       LOG_DEBUG, 0);
+	if (vl == NULL) {
+		fprintf(stderr,
+			"Error: vanessa_logger_openlog_filehandle\n");
+		fprintf(stderr,
+			"Fatal Error registering logger. Exiting.\n");
+		exit(-1);
+	}
+
+	/*
+	 * Set this as the logger for this programme
+	 */
+	vanessa_logger_set(vl);
+
+	/*
+	 * The owner pops newest first, thieves steal oldest first, and
+	 * the deque grows to hold what is pushed
+	 */
+	d = vanessa_ws_deque_create(destroy_function);
+	if(d == NULL) {
+		die("vanessa_ws_deque_create");
+	}
+	for(i = 0; i < 1000; i++) {
+		value = malloc(16);
+		if(value == NULL || vanessa_ws_deque_push(d, value) == NULL) {
+			die("vanessa_ws_deque_push");
+		}
+	}
+	if(vanessa_ws_deque_length(d) != 1000 ||
+			vanessa_ws_deque_pop(d, &value) == NULL) {
+		die("vanessa_ws_deque_pop");
+	}
+	free(value);
+	if(vanessa_ws_deque_steal(d, &value) != 1 ||
+			vanessa_ws_deque_length(d) != 998) {
+		die("vanessa_ws_deque_steal");
+	}
+	free(value);
+	vanessa_ws_deque_destroy(d);
+
+	/*
+	 * Thieves race the owner, which pushes and pops. Each element
+	 * should be taken exactly once.
+	 */
+	d = vanessa_ws_deque_create(NULL);
+	if(d == NULL) {
+		die("vanessa_ws_deque_create");
+	}
+	for(i = 0; i < NOTHIEF; i++) {
+		if(pthread_create(thread + i, NULL, thief, NULL) != 0) {
+			die("pthread_create");
+		}
+	}
+	for(i = 0; i < NOELEMENT; i++) {
+		if(vanessa_ws_deque_push(d, (void *)(i + 1)) == NULL) {
+			die("vanessa_ws_deque_push");
+		}
+		if(i % 3 != 0) {
+			continue;
+		}
+		/* Losing the last element to a thief leaves value alone */
+		value = NULL;
+		if(vanessa_ws_deque_pop(d, &value) != NULL) {
+			take(value);
+		}
+		else if(value != NULL) {
+			die("vanessa_ws_deque_pop");
+		}
+	}
+	while(vanessa_ws_deque_pop(d, &value) != NULL) {
+		take(value);
+	}
+	for(i = 0; i < NOTHIEF; i++) {
+		pthread_join(thread[i], NULL);
+	}
+	for(i = 0; i < NOELEMENT; i++) {
+		if(seen[i] != 1) {
+			die("element not taken");
+		}
+	}
+	printf("%lu %ld\n", (unsigned long)notaken,
+			(long)vanessa_ws_deque_length(d));
+
+	/*
+	 * Clean Up
+	 */
+	vanessa_ws_deque_destroy(d);
+	vanessa_adt_logger_unset();
+	vanessa_logger_closelog(vl);
+
+	exit(0);
+}